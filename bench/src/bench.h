@@ -0,0 +1,73 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <random>
+#include <string>
+
+
+/**
+ * @brief The bench_timer class     Wall clock stopwatch.
+ */
+class bench_timer
+{
+private:
+    std::chrono::steady_clock::time_point   started;
+
+public:
+    bench_timer() : started( std::chrono::steady_clock::now() ) {}
+
+    inline void restart() { started = std::chrono::steady_clock::now(); }
+
+    /// @brief seconds      Seconds elapsed since construction or restart().
+    inline double seconds() const
+    {
+        return std::chrono::duration<double>( std::chrono::steady_clock::now() - started ).count();
+    }
+};
+
+
+/**
+ * @brief bench_arg     Get numeric command line argument.
+ * @param argc          Count of arguments.
+ * @param argv          Arguments.
+ * @param pos           Position of argument.
+ * @param default_value Value if argument is not set.
+ * @return              Value of argument.
+ */
+inline size_t bench_arg( int argc, char *argv[], int pos, size_t default_value )
+{
+    return argc > pos ? static_cast<size_t>( std::strtoull( argv[ pos ], nullptr, 10 ) ) : default_value;
+}
+
+
+/**
+ * @brief bench_word    Generate random word of [a-z].
+ * @param rnd           Random generator.
+ * @param min_len       Minimal length.
+ * @param max_len       Maximal length.
+ * @return              Word.
+ */
+inline std::string bench_word( std::mt19937_64 &rnd, size_t min_len, size_t max_len )
+{
+    std::string word( min_len + rnd() % ( max_len - min_len + 1 ), 'a' );
+    for ( auto &c : word )
+        c = static_cast<char>( 'a' + rnd() % 26 );
+    return word;
+}
+
+
+/**
+ * @brief bench_report  Print result line.
+ * @param name          Name of measure.
+ * @param ops           Count of operations.
+ * @param seconds       Time.
+ */
+inline void bench_report( const char *name, size_t ops, double seconds )
+{
+    std::printf( "%-40s %12zu ops %10.3f s %14.0f ops/s\n", name, ops, seconds, ops / seconds );
+}
+
+#endif // BENCH_H
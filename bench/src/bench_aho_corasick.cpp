@@ -0,0 +1,109 @@
+/**
+ * Aho-Corasick scanner vs probing tree at every offset on synthetic logs.
+ *
+ * Usage: bench_aho_corasick [keywords=50000] [text_mb=64] [chunk_kb=64]
+ */
+
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/aho_corasick.h"
+
+
+static std::string make_log( std::mt19937_64 &rnd, const std::vector<std::string> &keywords, size_t size )
+{
+    static const char *LEVELS[] = { "INFO", "WARN", "DEBUG", "ERROR" };
+
+    std::string text;
+    text.reserve( size + 256 );
+
+    unsigned long long line = 0;
+    while ( text.size() < size )
+    {
+        text += "2021-06-01T12:00:";
+        text += std::to_string( line++ % 60 );
+        text += " ";
+        text += LEVELS[ rnd() % 4 ];
+        text += " worker-";
+        text += std::to_string( rnd() % 64 );
+
+        size_t words = 4 + rnd() % 8;
+        for ( size_t i = 0; i < words; ++i )
+        {
+            text += ' ';
+            text += rnd() % 50 ? bench_word( rnd, 3, 10 ) : keywords[ rnd() % keywords.size() ];
+        }
+        text += '\n';
+    }
+
+    return text;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    size_t keywords_count = bench_arg( argc, argv, 1, 50000 );
+    size_t text_size      = bench_arg( argc, argv, 2, 64 ) << 20;
+    size_t chunk_size     = bench_arg( argc, argv, 3, 64 ) << 10;
+
+    std::mt19937_64 rnd( 42 );
+
+    prefix_tree::prefix_tree tree;
+    std::vector<std::string> keywords;
+    size_t max_len = 0;
+    for ( size_t i = 0; i < keywords_count; ++i )
+    {
+        keywords.push_back( bench_word( rnd, 6, 14 ) );
+        max_len = std::max( max_len, keywords.back().size() );
+        tree.append( keywords.back() );
+    }
+
+    std::string text = make_log( rnd, keywords, text_size );
+
+    bench_timer timer;
+    prefix_tree::aho_corasick ac( tree );
+    bench_report( "compile", ac.states_count(), timer.seconds() );
+
+    size_t matches = 0;
+    timer.restart();
+
+    prefix_tree::aho_corasick::stream s;
+    for ( size_t pos = 0; pos < text.size(); pos += chunk_size )
+    {
+        ac.scan(
+                    s,
+                    text.data() + pos,
+                    std::min( chunk_size, text.size() - pos ),
+                    [&] ( const prefix_tree::aho_corasick::match & ) { ++matches; }
+        );
+    }
+
+    double seconds = timer.seconds();
+    bench_report( "aho_corasick scan (bytes)", text.size(), seconds );
+    std::printf( "%-40s %12zu matches %10.3f GB/s\n", "", matches, text.size() / seconds / 1e9 );
+
+    // Baseline: probe every offset with exists(), on a slice of text.
+    size_t slice = std::min<size_t>( text.size(), 8 << 20 );
+    size_t naive_matches = 0;
+    timer.restart();
+
+    std::string probe;
+    for ( size_t pos = 0; pos < slice; ++pos )
+    {
+        probe.clear();
+        for ( size_t len = 1; len <= max_len && pos + len <= slice; ++len )
+        {
+            probe += text[ pos + len - 1 ];
+            if ( !tree.exists( probe, false ) )
+                break;
+            if ( tree.exists( probe, true ) )
+                ++naive_matches;
+        }
+    }
+
+    seconds = timer.seconds();
+    bench_report( "exists() at every offset (bytes)", slice, seconds );
+    std::printf( "%-40s %12zu matches %10.3f GB/s\n", "", naive_matches, slice / seconds / 1e9 );
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+/**
+ * Miss heavy lookups: exists() of prefix_tree against filtered_prefix_tree
+ * whose Bloom filter rejects most of absent keys before walk over nodes.
+ *
+ * Usage: bench_bloom_filter [keys=1000000] [lookups=5000000] [miss_percent=95] [bits_per_key=10]
+ */
+
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/filtered_prefix_tree.h"
+
+
+/// @brief sink     Keeps results of lookups alive.
+static volatile long sink = 0;
+
+
+int main( int argc, char *argv[] )
+{
+    size_t count        = bench_arg( argc, argv, 1, 1000000 );
+    size_t lookups      = bench_arg( argc, argv, 2, 5000000 );
+    size_t miss_percent = bench_arg( argc, argv, 3, 95 );
+    size_t bits_per_key = bench_arg( argc, argv, 4, 10 );
+
+    std::mt19937_64 rnd( 42 );
+
+    // Misses are words of the same alphabet and lengths, they share prefixes
+    // with stored keys and walk some nodes down.
+    std::vector<std::string> keys( count );
+    for ( auto &key : keys )
+        key = bench_word( rnd, 6, 16 );
+
+    prefix_tree::key_filter::options opts;
+    opts.bits_per_key   = bits_per_key;
+    opts.prefix_lengths = { 6 };
+
+    prefix_tree::prefix_tree            plain;
+    prefix_tree::filtered_prefix_tree   filtered( count, opts );
+
+    for ( const auto &key : keys )
+    {
+        plain.append( key );
+        filtered.append( key );
+    }
+
+    std::vector<std::string> input( 1 << 16 );
+    for ( auto &key : input )
+        key = rnd() % 100 < miss_percent ? bench_word( rnd, 6, 16 ) + "#" : keys[ rnd() % count ];
+
+    size_t mask = input.size() - 1;
+
+    long found = 0;
+    bench_timer timer;
+    for ( size_t i = 0; i < lookups; ++i )
+        found += plain.exists( input[ i & mask ] );
+    bench_report( "prefix_tree exists", lookups, timer.seconds() );
+    sink = found;
+
+    found = 0;
+    timer.restart();
+    for ( size_t i = 0; i < lookups; ++i )
+        found += filtered.exists( input[ i & mask ] );
+    bench_report( "filtered_prefix_tree exists", lookups, timer.seconds() );
+    sink = found;
+
+    found = 0;
+    timer.restart();
+    for ( size_t i = 0; i < lookups; ++i )
+        found += plain.exists( input[ i & mask ].substr( 0, 7 ), false );
+    bench_report( "prefix_tree exists prefix", lookups, timer.seconds() );
+    sink = found;
+
+    found = 0;
+    timer.restart();
+    for ( size_t i = 0; i < lookups; ++i )
+        found += filtered.exists( input[ i & mask ].substr( 0, 7 ), false );
+    bench_report( "filtered_prefix_tree exists prefix", lookups, timer.seconds() );
+    sink = found;
+
+    // Measured rate of false positives among absent keys.
+    size_t absent = 0, false_positives = 0;
+    for ( const auto &key : input )
+    {
+        if ( !plain.exists( key ) )
+        {
+            ++absent;
+            false_positives += filtered.get_filter().may_contain( key );
+        }
+    }
+
+    auto stats = filtered.filter_stats();
+    std::printf( "false positives: measured %.4f, estimated %.4f\n",
+                 absent ? static_cast<double>( false_positives ) / absent : 0.0, stats.key_false_positive_rate );
+    std::printf( "filter memory: %zu bytes, tree memory: %zu bytes\n", stats.memory, plain.memory_usage().total() );
+    return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * Node modes: plain bytes, nibble split and alphabet remap. Memory of nodes
+ * and blocks, append and lookup of DNS like names and of random bytes.
+ *
+ * Usage: bench_coded_prefix_tree [keys=300000]
+ */
+
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/coded_prefix_tree.h"
+
+
+/// @brief sink     Keeps results of lookups alive.
+static volatile size_t sink = 0;
+
+
+template <typename tree_t>
+static void run( const char *mode, const char *data, tree_t &tree, const std::vector<std::string> &keys )
+{
+    char name[ 64 ];
+
+    bench_timer timer;
+    for ( const auto &key : keys )
+        tree.append( key );
+    std::snprintf( name, sizeof( name ), "%s %s append", data, mode );
+    bench_report( name, keys.size(), timer.seconds() );
+
+    size_t found = 0;
+    timer.restart();
+    for ( const auto &key : keys )
+        found += tree.exists( key );
+    std::snprintf( name, sizeof( name ), "%s %s exists", data, mode );
+    bench_report( name, keys.size(), timer.seconds() );
+    sink = found;
+
+    auto usage = tree.memory_usage();
+    std::printf( "%s %s memory: nodes=%zu node_bytes=%zu container_bytes=%zu total=%zu\n",
+                 data, mode, usage.nodes, usage.node_bytes, usage.container_bytes, usage.total() );
+}
+
+
+static void run_all( const char *data, const std::vector<std::string> &keys )
+{
+    prefix_tree::prefix_tree            plain;
+    prefix_tree::nibble_prefix_tree     nibble;
+    prefix_tree::alphabet_prefix_tree   alphabet( prefix_tree::alphabet_codec::from_keys( keys.begin(), keys.end() ) );
+
+    run( "plain", data, plain, keys );
+    run( "nibble", data, nibble, keys );
+    run( "alphabet", data, alphabet, keys );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    size_t keys_count = bench_arg( argc, argv, 1, 300000 );
+
+    std::mt19937_64 rnd( 42 );
+    const char      dns[] = "abcdefghijklmnopqrstuvwxyz0123456789-";
+    const char     *tlds[] = { "com", "net", "org", "io", "de", "ru" };
+
+    std::vector<std::string> names;
+    for ( size_t i = 0; i < keys_count; ++i )
+    {
+        std::string name;
+        for ( size_t labels = 1 + rnd() % 3; labels; --labels )
+        {
+            for ( size_t n = 3 + rnd() % 10; n; --n )
+                name.push_back( dns[ rnd() % ( sizeof( dns ) - 1 ) ] );
+            name.push_back( '.' );
+        }
+        names.push_back( name + tlds[ rnd() % 6 ] );
+    }
+
+    std::vector<std::string> bytes;
+    for ( size_t i = 0; i < keys_count; ++i )
+    {
+        std::string key( 4 + rnd() % 12, ' ' );
+        for ( auto &c : key )
+            c = static_cast<char>( 1 + rnd() % 255 );
+        bytes.push_back( key );
+    }
+
+    run_all( "dns", names );
+    run_all( "bytes", bytes );
+    return 0;
+}
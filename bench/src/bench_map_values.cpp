@@ -0,0 +1,86 @@
+/**
+ * prefix_tree_map insert paths with heavy values: copy, move and in-place
+ * construction, and update via operator[].
+ *
+ * Usage: bench_map_values [keys=200000] [value_bytes=512]
+ */
+
+#include <array>
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/prefix_tree_map.h"
+
+
+/// @brief fixed_value  Large trivially copyable value.
+typedef std::array<char, 256> fixed_value;
+
+
+int main( int argc, char *argv[] )
+{
+    size_t keys_count  = bench_arg( argc, argv, 1, 200000 );
+    size_t value_bytes = bench_arg( argc, argv, 2, 512 );
+
+    std::mt19937_64 rnd( 42 );
+
+    std::vector<std::string> keys;
+    for ( size_t i = 0; i < keys_count; ++i )
+        keys.push_back( bench_word( rnd, 6, 14 ) );
+
+    const std::vector<char> heap_value( value_bytes, 'x' );
+
+    {
+        prefix_tree::prefix_tree_map<std::vector<char> > map;
+        bench_timer timer;
+        for ( const auto &key : keys )
+            map.append( key, heap_value );
+        bench_report( "vector<char>: append copy", keys_count, timer.seconds() );
+    }
+
+    {
+        prefix_tree::prefix_tree_map<std::vector<char> > map;
+        bench_timer timer;
+        for ( const auto &key : keys )
+            map.append( key, std::vector<char>( value_bytes, 'x' ) );
+        bench_report( "vector<char>: append temporary", keys_count, timer.seconds() );
+    }
+
+    {
+        prefix_tree::prefix_tree_map<std::vector<char> > map;
+        bench_timer timer;
+        for ( const auto &key : keys )
+            map.emplace( key, value_bytes, 'x' );
+        bench_report( "vector<char>: emplace", keys_count, timer.seconds() );
+
+        timer.restart();
+        for ( const auto &key : keys )
+            map[ key ][ 0 ] = 'y';
+        bench_report( "vector<char>: operator[] update", keys_count, timer.seconds() );
+
+        timer.restart();
+        for ( const auto &key : keys )
+            map.insert_or_assign( key, heap_value );
+        bench_report( "vector<char>: insert_or_assign copy", keys_count, timer.seconds() );
+    }
+
+    fixed_value fixed;
+    fixed.fill( 'x' );
+
+    {
+        prefix_tree::prefix_tree_map<fixed_value> map;
+        bench_timer timer;
+        for ( const auto &key : keys )
+            map.append( key, fixed );
+        bench_report( "array<256>: append copy", keys_count, timer.seconds() );
+    }
+
+    {
+        prefix_tree::prefix_tree_map<fixed_value> map;
+        bench_timer timer;
+        for ( const auto &key : keys )
+            map.emplace( key, fixed );
+        bench_report( "array<256>: emplace", keys_count, timer.seconds() );
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * Replica sync: delta of merkle_prefix_tree against full snapshot, for
+ * growing count of changed keys. Cost of hashes on append is reported too.
+ *
+ * Usage: bench_merkle_diff [keys=1000000]
+ */
+
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/merkle_prefix_tree.h"
+
+
+/// @brief sink     Keeps results alive.
+static volatile size_t sink = 0;
+
+
+int main( int argc, char *argv[] )
+{
+    size_t count = bench_arg( argc, argv, 1, 1000000 );
+
+    std::mt19937_64 rnd( 42 );
+
+    std::vector<std::string> keys( count );
+    for ( auto &key : keys )
+        key = bench_word( rnd, 6, 16 );
+
+    prefix_tree::prefix_tree plain;
+    bench_timer timer;
+    for ( const auto &key : keys )
+        plain.append( key );
+    bench_report( "prefix_tree append", count, timer.seconds() );
+
+    prefix_tree::merkle_prefix_tree primary;
+    timer.restart();
+    for ( const auto &key : keys )
+        primary.append( key );
+    bench_report( "merkle_prefix_tree append", count, timer.seconds() );
+
+    size_t snapshot = 0;
+    for ( const auto &key : keys )
+        snapshot += key.size() + 5;
+
+    prefix_tree::merkle_prefix_tree replica;
+    for ( const auto &key : keys )
+        replica.append( key );
+
+    // Replica is synced after every round.
+    for ( size_t changes : { 10, 1000, 100000 } )
+    {
+        // Half of changes are removals, half are new keys.
+        for ( size_t changed = 0; changed < changes; changed += 2 )
+        {
+            primary.remove( keys[ rnd() % count ] );
+            primary.append( bench_word( rnd, 6, 16 ) );
+        }
+
+        timer.restart();
+        std::string delta = prefix_tree::merkle_prefix_tree::encode_delta( replica, primary );
+        double encode = timer.seconds();
+        size_t visited = prefix_tree::merkle_prefix_tree::diff( replica, primary, [] ( const std::string &, prefix_tree::log_op ) {} );
+
+        timer.restart();
+        bool applied = replica.apply_delta( delta );
+        double apply = timer.seconds();
+
+        std::printf( "%6zu changes: delta %9zu bytes (snapshot %zu), %8zu nodes visited, encode %.6f s, apply %.6f s, %s\n",
+                     changes, delta.size(), snapshot, visited, encode, apply, applied ? "in sync" : "FAILED" );
+        sink = visited;
+    }
+
+    return 0;
+}
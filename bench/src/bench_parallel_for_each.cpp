@@ -0,0 +1,71 @@
+/**
+ * Parallel traversal of prefix_tree_map on work-stealing executor: value
+ * rescoring by parallel_for_each and ordered parallel_reduce, 1 to
+ * max_threads workers. Keys are skewed: half of them share one prefix.
+ *
+ * Usage: bench_parallel_for_each [keys=1000000] [max_threads=64] [work=64]
+ */
+
+#include <thread>
+
+#include "bench.h"
+#include "prefix_tree/prefix_tree_map.h"
+
+
+/// @brief sink     Keeps results of reduce.
+static volatile uint64_t sink = 0;
+
+
+/// @brief rescore  CPU work per value.
+inline uint64_t rescore( uint64_t value, size_t work )
+{
+    for ( size_t i = 0; i < work; ++i )
+        value = value * 6364136223846793005ull + 1442695040888963407ull;
+    return value;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    size_t keys_count  = bench_arg( argc, argv, 1, 1000000 );
+    size_t max_threads = bench_arg( argc, argv, 2, 64 );
+    size_t work        = bench_arg( argc, argv, 3, 64 );
+
+    std::mt19937_64 rnd( 42 );
+
+    prefix_tree::prefix_tree_map<uint64_t> map;
+    for ( size_t i = 0; i < keys_count; ++i )
+        map.append( ( i % 2 ? "skewed/" : "" ) + bench_word( rnd, 6, 14 ), i );
+
+    std::printf( "hardware threads: %u\n", std::thread::hardware_concurrency() );
+
+    double base = 0;
+    for ( size_t threads = 1; threads <= max_threads; threads *= 2 )
+    {
+        prefix_tree::executor ex( threads );
+        char name[ 64 ];
+
+        bench_timer timer;
+        map.parallel_for_each( "", [work] ( const std::string &, uint64_t &value ) { value = rescore( value, work ); }, ex );
+        double seconds = timer.seconds();
+        if ( threads == 1 )
+            base = seconds;
+
+        std::snprintf( name, sizeof( name ), "for_each %zu threads (x%.2f)", threads, base / seconds );
+        bench_report( name, keys_count, seconds );
+
+        timer.restart();
+        sink = map.parallel_reduce(
+                    "", uint64_t( 0 ),
+                    [work] ( const std::string &, uint64_t &value ) { return rescore( value, work ); },
+                    [] ( uint64_t &&a, uint64_t &&b ) { return a + b; },
+                    ex
+        );
+        seconds = timer.seconds();
+
+        std::snprintf( name, sizeof( name ), "reduce %zu threads", threads );
+        bench_report( name, keys_count, seconds );
+    }
+
+    return 0;
+}
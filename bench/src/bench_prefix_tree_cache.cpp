@@ -0,0 +1,71 @@
+/**
+ * Path keyed lookup cache: prefix_tree_cache with CLOCK eviction under
+ * Zipf-like access for several budgets, hit rate, evictions and memory.
+ *
+ * Usage: bench_prefix_tree_cache [paths=1000000] [lookups=5000000]
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/prefix_tree_cache.h"
+
+
+/// @brief sink     Keeps results of lookups alive.
+static volatile size_t sink = 0;
+
+
+int main( int argc, char *argv[] )
+{
+    size_t count   = bench_arg( argc, argv, 1, 1000000 );
+    size_t lookups = bench_arg( argc, argv, 2, 5000000 );
+
+    std::mt19937_64 rnd( 42 );
+
+    std::vector<std::string> paths( count );
+    for ( auto &path : paths )
+        path = "/" + bench_word( rnd, 3, 8 ) + "/" + bench_word( rnd, 3, 8 ) + "/" + bench_word( rnd, 4, 12 );
+
+    // Zipf-like ranks: rank = count ^ u - 1 for uniform u.
+    std::vector<uint32_t> input( 1 << 20 );
+    std::uniform_real_distribution<double> uniform( 0, 1 );
+    for ( auto &i : input )
+        i = static_cast<uint32_t>( std::pow( static_cast<double>( count ), uniform( rnd ) ) - 1 );
+
+    size_t mask = input.size() - 1;
+
+    for ( size_t percent : { 1, 10, 50 } )
+    {
+        prefix_tree::prefix_tree_cache<size_t>::options opts;
+        opts.max_entries = count * percent / 100;
+
+        prefix_tree::prefix_tree_cache<size_t> cache( opts );
+
+        size_t sum = 0;
+        bench_timer timer;
+        for ( size_t i = 0; i < lookups; ++i )
+        {
+            uint32_t       rank  = input[ i & mask ];
+            const size_t  *value = cache.get( paths[ rank ] );
+            sum += value ? *value : cache.put( paths[ rank ], rank );
+        }
+        double seconds = timer.seconds();
+        sink = sum;
+
+        char name[ 64 ];
+        std::snprintf( name, sizeof( name ), "cache of %zu%% get/put", percent );
+        bench_report( name, lookups, seconds );
+
+        auto stats = cache.stats();
+        std::printf( "    hit rate %.4f, evictions %llu, entries %zu, node memory %zu bytes\n",
+                     stats.hit_rate(), static_cast<unsigned long long>( stats.evictions ),
+                     stats.entries, cache.memory_usage().total() );
+    }
+
+    prefix_tree::prefix_tree_map<size_t> unbounded;
+    for ( size_t i = 0; i < lookups; ++i )
+        unbounded.try_emplace( paths[ input[ i & mask ] ], input[ i & mask ] );
+    std::printf( "unbounded map: %zu bytes\n", unbounded.memory_usage().total() );
+    return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * durable_prefix_tree_map: write throughput with group commit and time of
+ * recovery from log only, from snapshot only and from snapshot plus log
+ * tail.
+ *
+ * Usage: bench_recovery [keys=200000] [directory=/tmp]
+ */
+
+#include <filesystem>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench.h"
+#include "prefix_tree/durable_prefix_tree_map.h"
+
+
+typedef prefix_tree::durable_prefix_tree_map<uint64_t> map_type;
+
+
+/**
+ * @brief recover   Open map and report time of recovery.
+ */
+void recover( const char *name, const std::string &directory, const map_type::options &opts )
+{
+    bench_timer timer;
+    map_type map( directory, opts );
+    double seconds = timer.seconds();
+
+    const map_type::recovery_info &info = map.recovery();
+    bench_report( name, info.snapshot_records + info.log_records, seconds );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    size_t      keys_count = bench_arg( argc, argv, 1, 200000 );
+    std::string base       = argc > 2 ? argv[ 2 ] : "/tmp";
+
+    std::string pattern = base + "/bench_recovery_XXXXXX";
+    if ( !mkdtemp( &pattern[ 0 ] ) )
+    {
+        std::perror( "mkdtemp" );
+        return 1;
+    }
+    const std::string directory = pattern;
+
+    std::mt19937_64 rnd( 42 );
+
+    std::vector<std::string> keys;
+    for ( size_t i = 0; i < keys_count; ++i )
+        keys.push_back( bench_word( rnd, 6, 14 ) );
+
+    map_type::options opts;
+    opts.snapshot_records = 0;
+
+    {
+        map_type::options every = opts;
+        every.sync_every_operation = true;
+
+        size_t count = std::min<size_t>( keys_count, 2000 );
+        map_type map( directory + "/every", every );
+        bench_timer timer;
+        for ( size_t i = 0; i < count; ++i )
+            map.append( keys[ i ], i );
+        bench_report( "append, sync every operation", count, timer.seconds() );
+    }
+
+    {
+        map_type map( directory, opts );
+        bench_timer timer;
+        for ( size_t i = 0; i < keys_count; ++i )
+            map.append( keys[ i ], i );
+        map.flush();
+        bench_report( "append, group commit 256", keys_count, timer.seconds() );
+    }
+
+    recover( "recover: log", directory, opts );
+
+    {
+        map_type map( directory, opts );
+        bench_timer timer;
+        map.snapshot();
+        bench_report( "snapshot", keys_count, timer.seconds() );
+    }
+
+    recover( "recover: snapshot", directory, opts );
+
+    {
+        map_type map( directory, opts );
+        for ( size_t i = 0; i < keys_count / 10; ++i )
+            map.append( keys[ i ], i + 1 );
+    }
+
+    recover( "recover: snapshot + 10% log tail", directory, opts );
+
+    std::filesystem::remove_all( directory );
+    return 0;
+}
@@ -0,0 +1,62 @@
+/**
+ * Lookup throughput of tree scattered by appends and removes before and
+ * after relayout().
+ *
+ * Usage: bench_relayout [keys=1000000] [lookups=2000000]
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/prefix_tree.h"
+
+
+static size_t lookup( prefix_tree::prefix_tree &tree, const std::vector<std::string> &keys, size_t lookups )
+{
+    size_t found = 0;
+    for ( size_t i = 0; i < lookups; ++i )
+        found += tree.exists( keys[ i % keys.size() ] );
+    return found;
+}
+
+
+int main( int argc, char *argv[] )
+{
+    size_t keys_count = bench_arg( argc, argv, 1, 1000000 );
+    size_t lookups    = bench_arg( argc, argv, 2, 2000000 );
+
+    std::mt19937_64 rnd( 42 );
+
+    // Every second key is removed to scatter survivors over the heap.
+    std::vector<std::string> keys;
+    prefix_tree::prefix_tree tree;
+    bench_timer timer;
+    for ( size_t i = 0; i < keys_count * 2; ++i )
+    {
+        keys.push_back( bench_word( rnd, 8, 16 ) );
+        tree.append( keys.back() );
+    }
+    for ( size_t i = 0; i < keys.size(); i += 2 )
+        tree.remove( keys[ i ] );
+    bench_report( "build", keys.size() + keys_count, timer.seconds() );
+
+    std::vector<std::string> probes;
+    for ( size_t i = 1; i < keys.size(); i += 2 )
+        probes.push_back( keys[ i ] );
+    std::shuffle( probes.begin(), probes.end(), rnd );
+
+    timer.restart();
+    size_t found = lookup( tree, probes, lookups );
+    bench_report( "exists() scattered", lookups, timer.seconds() );
+
+    timer.restart();
+    tree.relayout();
+    bench_report( "relayout (nodes)", tree.memory_usage().nodes, timer.seconds() );
+
+    timer.restart();
+    found -= lookup( tree, probes, lookups );
+    bench_report( "exists() after relayout", lookups, timer.seconds() );
+
+    return found ? 1 : 0;
+}
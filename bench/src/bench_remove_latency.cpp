@@ -0,0 +1,82 @@
+/**
+ * Latency of deletes under churn: every operation appends new key and
+ * removes old one. Eager remove() against remove_lazy(), compact() of
+ * bounded budget runs every period operations (idle time of caller) and
+ * its slices are measured apart.
+ *
+ * Usage: bench_remove_latency [keys=200000] [ops=1000000] [budget=512] [period=32]
+ */
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/prefix_tree.h"
+
+
+static void percentiles( const char *name, std::vector<double> &ns )
+{
+    if ( ns.empty() )
+        return;
+
+    std::sort( ns.begin(), ns.end() );
+    auto at = [&] ( double q ) { return ns[ std::min( ns.size() - 1, static_cast<size_t>( q * ns.size() ) ) ]; };
+
+    std::printf( "    %s ns: p50=%.0f p99=%.0f p99.9=%.0f max=%.0f\n", name, at( 0.5 ), at( 0.99 ), at( 0.999 ), ns.back() );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    size_t keys_count = bench_arg( argc, argv, 1, 200000 );
+    size_t ops        = bench_arg( argc, argv, 2, 1000000 );
+    size_t budget     = bench_arg( argc, argv, 3, 512 );
+    size_t period     = std::max<size_t>( bench_arg( argc, argv, 4, 32 ), 1 );
+
+    std::mt19937_64 rnd( 42 );
+
+    std::vector<std::string> keys;
+    for ( size_t i = 0; i < keys_count + ops; ++i )
+        keys.push_back( bench_word( rnd, 8, 24 ) );
+
+    for ( bool lazy : { false, true } )
+    {
+        prefix_tree::prefix_tree tree;
+        for ( size_t i = 0; i < keys_count; ++i )
+            tree.append( keys[ i ] );
+
+        std::vector<double> ns;
+        std::vector<double> slices;
+        ns.reserve( ops );
+
+        bench_timer total;
+        for ( size_t i = 0; i < ops; ++i )
+        {
+            tree.append( keys[ keys_count + i ] );
+
+            bench_timer timer;
+            if ( lazy )
+                tree.remove_lazy( keys[ i ] );
+            else
+                tree.remove( keys[ i ] );
+            ns.push_back( timer.seconds() * 1e9 );
+
+            if ( lazy && i % period == period - 1 )
+            {
+                timer.restart();
+                tree.compact( budget );
+                slices.push_back( timer.seconds() * 1e9 );
+            }
+        }
+        while ( tree.compact( budget ) )
+            ;
+
+        bench_report( lazy ? "remove_lazy, compact every period" : "remove", ops, total.seconds() );
+        percentiles( "remove", ns );
+        percentiles( "compact slice", slices );
+        std::printf( "    nodes left: %zu\n", tree.memory_usage().nodes );
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * Multi-threaded insert and lookup: one prefix_tree_map under a single
+ * shared mutex against sharded_prefix_tree_map with a lock per shard.
+ *
+ * Usage: bench_sharded_map [keys=400000] [threads=hardware concurrency]
+ */
+
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/sharded_prefix_tree_map.h"
+
+
+/**
+ * @brief The locked_map class  Baseline: single map, single lock.
+ */
+class locked_map
+{
+private:
+    mutable std::shared_mutex           lock;
+    prefix_tree::prefix_tree_map<size_t> map;
+
+public:
+    void insert_or_assign( const std::string &key, size_t value )
+    {
+        std::unique_lock<std::shared_mutex> guard( lock );
+        map.insert_or_assign( key, value );
+    }
+
+    bool find( const std::string &key, size_t &value ) const
+    {
+        std::shared_lock<std::shared_mutex> guard( lock );
+        const size_t *found = const_cast<prefix_tree::prefix_tree_map<size_t>&>( map ).get_value( key );
+        if ( found )
+            value = *found;
+        return found;
+    }
+};
+
+
+/**
+ * @brief run   Run function in threads, every thread takes own stripe of keys.
+ */
+template <typename function_t>
+double run( size_t threads_count, size_t keys_count, function_t f )
+{
+    bench_timer timer;
+
+    std::vector<std::thread> threads;
+    for ( size_t t = 0; t < threads_count; ++t )
+        threads.emplace_back(
+            [=] ()
+            {
+                for ( size_t i = t; i < keys_count; i += threads_count )
+                    f( i );
+            }
+        );
+
+    for ( auto &t : threads )
+        t.join();
+
+    return timer.seconds();
+}
+
+
+template <typename map_t>
+void measure( const char *name, const std::vector<std::string> &keys, size_t threads_count )
+{
+    map_t map;
+    std::string label( name );
+
+    double seconds = run( threads_count, keys.size(), [&] ( size_t i ) { map.insert_or_assign( keys[ i ], i ); } );
+    bench_report( ( label + ": insert" ).c_str(), keys.size(), seconds );
+
+    seconds = run(
+                threads_count, keys.size(),
+                [&] ( size_t i )
+                {
+                    size_t value;
+                    map.find( keys[ ( i * 31 ) % keys.size() ], value );
+                }
+    );
+    bench_report( ( label + ": find" ).c_str(), keys.size(), seconds );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    size_t keys_count    = bench_arg( argc, argv, 1, 400000 );
+    size_t threads_count = bench_arg( argc, argv, 2, std::max( 1u, std::thread::hardware_concurrency() ) );
+
+    std::mt19937_64 rnd( 42 );
+
+    std::vector<std::string> keys;
+    for ( size_t i = 0; i < keys_count; ++i )
+        keys.push_back( bench_word( rnd, 6, 14 ) );
+
+    std::printf( "threads: %zu\n", threads_count );
+
+    measure<locked_map>( "single lock", keys, threads_count );
+    measure<prefix_tree::sharded_prefix_tree_map<size_t, 16> >( "16 shards, leading byte", keys, threads_count );
+    measure<prefix_tree::sharded_prefix_tree_map<size_t, 64, prefix_tree::prefix_hash_shard<2> > >( "64 shards, prefix hash", keys, threads_count );
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * Byte kernels of every supported level: label search of wide nodes and
+ * first mismatch of long keys.
+ *
+ * Usage: bench_simd [iterations=20000000] [key_len=100]
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/simd.h"
+
+
+static const char *LEVEL_NAMES[] = { "scalar", "sse2", "avx2" };
+
+/// @brief sink     Keeps results of kernels alive.
+static volatile size_t sink = 0;
+
+
+int main( int argc, char *argv[] )
+{
+    using prefix_tree::simd::level;
+
+    size_t iterations = bench_arg( argc, argv, 1, 20000000 );
+    size_t key_len    = bench_arg( argc, argv, 2, 100 );
+
+    std::mt19937_64 rnd( 42 );
+
+    std::vector<unsigned char> needles( 4096 );
+    for ( auto &c : needles )
+        c = static_cast<unsigned char>( rnd() );
+
+    std::string a = bench_word( rnd, key_len, key_len );
+    std::string b = a;
+    b.back() ^= 1;
+
+    for ( level l : { level::SCALAR, level::SSE2, level::AVX2 } )
+    {
+        if ( !prefix_tree::simd::supported( l ) )
+            continue;
+
+        prefix_tree::simd::kernels k = prefix_tree::simd::get_kernels( l );
+        char name[ 64 ];
+
+        for ( size_t n : { 16, 64, 256 } )
+        {
+            std::vector<unsigned char> labels( 256 );
+            for ( size_t i = 0; i < 256; ++i )
+                labels[ i ] = static_cast<unsigned char>( i );
+            std::shuffle( labels.begin(), labels.end(), rnd );
+            labels.resize( n );
+            std::sort( labels.begin(), labels.end() );
+
+            size_t sum = 0;
+            bench_timer timer;
+            for ( size_t i = 0; i < iterations; ++i )
+                sum += k.lower_bound( labels.data(), n, needles[ i & 4095 ] );
+
+            std::snprintf( name, sizeof( name ), "%s lower_bound n=%zu", LEVEL_NAMES[ static_cast<int>( l ) ], n );
+            bench_report( name, iterations, timer.seconds() );
+            sink = sum;
+        }
+
+        size_t sum = 0;
+        bench_timer timer;
+        for ( size_t i = 0; i < iterations / 4; ++i )
+        {
+            sum += k.mismatch(
+                        reinterpret_cast<const unsigned char*>( a.data() ),
+                        reinterpret_cast<const unsigned char*>( b.data() ),
+                        key_len - ( i & 1 )
+            );
+        }
+
+        std::snprintf( name, sizeof( name ), "%s mismatch len=%zu", LEVEL_NAMES[ static_cast<int>( l ) ], key_len );
+        bench_report( name, iterations / 4, timer.seconds() );
+        sink = sum;
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * Lookup of HTTP methods: static_prefix_tree built at compile time, runtime
+ * prefix_tree_map and hand written switch on length.
+ *
+ * Usage: bench_static_prefix_tree [iterations=50000000] [miss_percent=20]
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/prefix_tree_map.h"
+#include "prefix_tree/static_prefix_tree.h"
+
+
+static constexpr std::string_view METHODS[] = { "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT", "OPTIONS", "TRACE", "PATCH" };
+
+static constexpr std::string_view MISSES[] = { "GETS", "PUSH", "HEAP", "OPTION", "DELETED", "X", "PATH", "CONNECTS" };
+
+static constexpr auto STATIC_METHODS = prefix_tree::make_static_prefix_tree<METHODS>();
+
+/// @brief sink     Keeps results of lookups alive.
+static volatile long sink = 0;
+
+
+/**
+ * @brief switch_find   Baseline: switch on length, then compare.
+ */
+static int switch_find( std::string_view key )
+{
+    switch ( key.size() )
+    {
+    case 3:
+        if ( !std::memcmp( key.data(), "GET", 3 ) ) return 0;
+        if ( !std::memcmp( key.data(), "PUT", 3 ) ) return 3;
+        return -1;
+    case 4:
+        if ( !std::memcmp( key.data(), "HEAD", 4 ) ) return 1;
+        if ( !std::memcmp( key.data(), "POST", 4 ) ) return 2;
+        return -1;
+    case 5:
+        if ( !std::memcmp( key.data(), "TRACE", 5 ) ) return 7;
+        if ( !std::memcmp( key.data(), "PATCH", 5 ) ) return 8;
+        return -1;
+    case 6:
+        return !std::memcmp( key.data(), "DELETE", 6 ) ? 4 : -1;
+    case 7:
+        if ( !std::memcmp( key.data(), "CONNECT", 7 ) ) return 5;
+        if ( !std::memcmp( key.data(), "OPTIONS", 7 ) ) return 6;
+        return -1;
+    default:
+        return -1;
+    }
+}
+
+
+int main( int argc, char *argv[] )
+{
+    size_t iterations   = bench_arg( argc, argv, 1, 50000000 );
+    size_t miss_percent = bench_arg( argc, argv, 2, 20 );
+
+    std::mt19937_64 rnd( 42 );
+
+    std::vector<std::string> input( 4096 );
+    for ( auto &key : input )
+    {
+        if ( rnd() % 100 < miss_percent )
+            key = MISSES[ rnd() % std::size( MISSES ) ];
+        else
+            key = METHODS[ rnd() % std::size( METHODS ) ];
+    }
+
+    prefix_tree::prefix_tree_map<int> runtime;
+    for ( size_t i = 0; i < std::size( METHODS ); ++i )
+        runtime.insert_or_assign( std::string( METHODS[ i ] ), static_cast<int>( i ) );
+
+    long sum = 0;
+    bench_timer timer;
+    for ( size_t i = 0; i < iterations; ++i )
+        sum += STATIC_METHODS.find( input[ i & 4095 ] );
+    bench_report( "static_prefix_tree find", iterations, timer.seconds() );
+    sink = sum;
+
+    sum = 0;
+    timer.restart();
+    for ( size_t i = 0; i < iterations; ++i )
+        sum += switch_find( input[ i & 4095 ] );
+    bench_report( "switch on length", iterations, timer.seconds() );
+    sink = sum;
+
+    sum = 0;
+    timer.restart();
+    for ( size_t i = 0; i < iterations; ++i )
+    {
+        auto it = runtime.find( input[ i & 4095 ] );
+        sum += it != runtime.end() ? it.get_value() : -1;
+    }
+    bench_report( "prefix_tree_map find", iterations, timer.seconds() );
+    sink = sum;
+
+    std::printf( "static_prefix_tree tables: %zu bytes\n", STATIC_METHODS.memory_usage() );
+    return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * Ends-with queries on host names: prefix_suffix_tree against full scan of
+ * prefix_tree by begin( true ), for suffix and prefix+suffix queries.
+ *
+ * Usage: bench_suffix_index [hosts=10000000] [queries=100]
+ */
+
+#include <vector>
+
+#include "bench.h"
+#include "prefix_tree/prefix_suffix_tree.h"
+
+
+/// @brief sink     Keeps results of queries alive.
+static volatile size_t sink = 0;
+
+
+/// @brief domain   Name of domain of index.
+static std::string domain( size_t i )
+{
+    static const char *zones[] = { ".com", ".org", ".net", ".io", ".co.uk" };
+    return "site" + std::to_string( i ) + zones[ i % 5 ];
+}
+
+
+int main( int argc, char *argv[] )
+{
+    size_t count   = bench_arg( argc, argv, 1, 10000000 );
+    size_t queries = bench_arg( argc, argv, 2, 100 );
+
+    std::mt19937_64 rnd( 42 );
+
+    // About 100 host names per domain.
+    size_t domains = count / 100 + 1;
+
+    prefix_tree::prefix_tree         plain;
+    prefix_tree::prefix_suffix_tree  index;
+
+    bench_timer timer;
+    for ( size_t i = 0; i < count; ++i )
+        plain.append( bench_word( rnd, 2, 10 ) + "." + domain( rnd() % domains ) );
+    bench_report( "prefix_tree append", count, timer.seconds() );
+
+    rnd.seed( 42 );
+    timer.restart();
+    for ( size_t i = 0; i < count; ++i )
+        index.append( bench_word( rnd, 2, 10 ) + "." + domain( rnd() % domains ) );
+    bench_report( "prefix_suffix_tree append", count, timer.seconds() );
+
+    std::vector<std::string> suffixes( queries );
+    for ( auto &suffix : suffixes )
+        suffix = "." + domain( rnd() % domains );
+
+    // Full scan is slow: a few queries are enough.
+    size_t scans = std::min<size_t>( queries, 3 );
+    size_t found = 0;
+
+    timer.restart();
+    for ( size_t q = 0; q < scans; ++q )
+    {
+        const std::string &suffix = suffixes[ q ];
+        for ( auto it = plain.begin( true ); it != plain.end(); ++it )
+        {
+            std::string key = it.get_key();
+            found += key.size() >= suffix.size() && key.compare( key.size() - suffix.size(), suffix.size(), suffix ) == 0;
+        }
+    }
+    bench_report( "scan ends_with", scans, timer.seconds() );
+    sink = found;
+
+    found = 0;
+    timer.restart();
+    for ( const auto &suffix : suffixes )
+        found += index.ends_with( suffix, [] ( const std::string & ) {} );
+    bench_report( "prefix_suffix_tree ends_with", queries, timer.seconds() );
+    std::printf( "    %.1f keys per query\n", static_cast<double>( found ) / queries );
+    sink = found;
+
+    // Selective prefix and suffix: "a*.siteN.com" and "*.com" with long prefix.
+    found = 0;
+    timer.restart();
+    for ( const auto &suffix : suffixes )
+        found += index.match( "a", suffix, [] ( const std::string & ) {} );
+    bench_report( "prefix_suffix_tree match a*suffix", queries, timer.seconds() );
+    sink = found;
+
+    found = 0;
+    timer.restart();
+    for ( size_t q = 0; q < queries; ++q )
+        found += index.match( bench_word( rnd, 4, 4 ), ".com", [] ( const std::string & ) {} );
+    bench_report( "prefix_suffix_tree match abcd*.com", queries, timer.seconds() );
+    sink = found;
+
+    std::printf( "memory: prefix_tree %zu bytes, prefix_suffix_tree %zu bytes\n",
+                 plain.memory_usage().total(), index.memory_usage().total() );
+    return 0;
+}
@@ -0,0 +1,280 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef AHO_CORASICK_H
+#define AHO_CORASICK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "prefix_tree.h"
+#include "prefix_tree_map.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The aho_corasick class    Multi-pattern text scanner compiled from
+ *                                  finite nodes of prefix tree.
+ *
+ * States are numbered in BFS order of the source tree. Transitions are kept
+ * in flat arrays: top states (depth less than DENSE_DEPTH, at most
+ * DENSE_STATES) have dense 256-entry rows with failure links already
+ * resolved, other states have sorted sparse edges and fall back via
+ * failure links.
+ */
+class aho_corasick
+{
+public:
+    typedef uint32_t                        state_id;
+    typedef uint32_t                        pattern_id;
+
+    /// @brief NO_PATTERN   Marker of state without pattern.
+    static constexpr pattern_id             NO_PATTERN = UINT32_MAX;
+
+    /**
+     * @brief The match struct  Found pattern.
+     */
+    struct match
+    {
+        /// @brief end          Stream offset of byte next to the last byte of pattern.
+        uint64_t                            end;
+        /// @brief pattern      Id of pattern (see get_pattern()).
+        pattern_id                          pattern;
+        /// @brief length       Length of pattern.
+        uint32_t                            length;
+    };
+
+
+    /**
+     * @brief The stream class  State of scanning carried across chunks.
+     */
+    class stream
+    {
+        friend class aho_corasick;
+
+    private:
+        state_id                            state;
+        uint64_t                            offset;
+
+    public:
+        stream() : state( 0 ), offset( 0 ) {}
+
+        /// @brief reset    Start new stream.
+        inline void reset()
+        {
+            state  = 0;
+            offset = 0;
+        }
+
+        /// @brief position     Count of bytes scanned.
+        inline uint64_t position() const { return offset; }
+    };
+
+private:
+    /// @brief DENSE_DEPTH      States with depth less than the value have dense rows.
+    static constexpr unsigned int           DENSE_DEPTH = 3;
+    /// @brief DENSE_STATES     Limit of dense rows (1 KiB per row).
+    static constexpr unsigned int           DENSE_STATES = 4096;
+    static constexpr unsigned int           ALPHABET    = 256;
+    /// @brief LINEAR_SEARCH    Edges count to use linear search instead of binary.
+    static constexpr unsigned int           LINEAR_SEARCH = 8;
+
+    struct state_info
+    {
+        /// @brief edges        Index of first edge in edge_labels/edge_targets.
+        uint32_t                            edges;
+        /// @brief edges_count  Count of edges.
+        uint32_t                            edges_count;
+        /// @brief fail         Failure link.
+        state_id                            fail;
+        /// @brief first_output This state if it has pattern else output link.
+        state_id                            first_output;
+        /// @brief output       Nearest state with pattern reachable via failure links.
+        state_id                            output;
+        /// @brief pattern      Pattern of the state or NO_PATTERN.
+        pattern_id                          pattern;
+    };
+
+    std::vector<state_info>                 states;
+    std::vector<unsigned char>              edge_labels;
+    std::vector<state_id>                   edge_targets;
+    /// @brief dense        Rows of states [0, dense_count).
+    std::vector<state_id>                   dense;
+    state_id                                dense_count;
+    std::vector<std::string>                patterns;
+
+public:
+    /**
+     * @brief aho_corasick  Compile automaton from finite nodes of tree.
+     * @param tree          Source tree. Empty key is ignored.
+     */
+    explicit aho_corasick( const prefix_tree &tree );
+
+
+    /**
+     * @brief aho_corasick  Compile automaton from keys of map.
+     * @param tree          Source map. Empty key is ignored.
+     */
+    template <typename value_type, typename instrumentation_t>
+    explicit aho_corasick( const prefix_tree_map<value_type, instrumentation_t> &tree )
+        : aho_corasick( static_cast<const prefix_tree&>( tree ) )
+    {
+    }
+
+    ~aho_corasick() = default;
+
+
+    /**
+     * @brief scan          Scan chunk of stream.
+     * @param s             State of stream. Matches crossed chunk boundary are found.
+     * @param buffer        Chunk.
+     * @param size          Size of chunk.
+     * @param callback      Callable object called as callback( const match& )
+     *                      for every occurrence of every pattern.
+     */
+    template <typename callback_t>
+    void scan( stream &s, const char *buffer, size_t size, callback_t callback ) const
+    {
+        const unsigned char *data = reinterpret_cast<const unsigned char*>( buffer );
+        const state_info    *info = states.data();
+        state_id             cur  = s.state;
+
+        for ( size_t i = 0; i < size; ++i )
+        {
+            unsigned char c = data[ i ];
+
+            while ( cur >= dense_count )
+            {
+                state_id target = find_edge( cur, c );
+                if ( target )
+                {
+                    cur = target;
+                    goto next_state;
+                }
+                cur = info[ cur ].fail;
+            }
+            cur = dense[ static_cast<size_t>( cur ) * ALPHABET + c ];
+
+        next_state:
+            for ( state_id out = info[ cur ].first_output; out; out = info[ out ].output )
+            {
+                match m;
+                m.end     = s.offset + i + 1;
+                m.pattern = info[ out ].pattern;
+                m.length  = static_cast<uint32_t>( patterns[ m.pattern ].size() );
+                callback( static_cast<const match&>( m ) );
+            }
+        }
+
+        s.state   = cur;
+        s.offset += size;
+    }
+
+
+    /**
+     * @brief scan          Scan chunk of stream.
+     * @param s             State of stream.
+     * @param buffer        Chunk.
+     * @param callback      Callable object called as callback( const match& ).
+     */
+    template <typename callback_t>
+    inline void scan( stream &s, const std::string &buffer, callback_t callback ) const
+    {
+        scan( s, buffer.data(), buffer.size(), callback );
+    }
+
+
+    /**
+     * @brief scan          Scan whole text.
+     * @param buffer        Text.
+     * @param size          Size of text.
+     * @param callback      Callable object called as callback( const match& ).
+     */
+    template <typename callback_t>
+    inline void scan( const char *buffer, size_t size, callback_t callback ) const
+    {
+        stream s;
+        scan( s, buffer, size, callback );
+    }
+
+
+    /**
+     * @brief scan          Scan whole text.
+     * @param buffer        Text.
+     * @param callback      Callable object called as callback( const match& ).
+     */
+    template <typename callback_t>
+    inline void scan( const std::string &buffer, callback_t callback ) const
+    {
+        scan( buffer.data(), buffer.size(), callback );
+    }
+
+
+    /**
+     * @brief get_pattern   Get key of pattern.
+     * @param id            Id of pattern from match.
+     * @return              Key.
+     */
+    inline const std::string& get_pattern( pattern_id id ) const
+    {
+        return patterns[ id ];
+    }
+
+
+    /// @brief patterns_count   Count of patterns.
+    inline size_t patterns_count() const { return patterns.size(); }
+
+
+    /// @brief states_count     Count of states of automaton.
+    inline size_t states_count() const { return states.size(); }
+
+private:
+    /**
+     * @brief find_edge     Find goto transition.
+     * @param state         State.
+     * @param c             Symbol.
+     * @return              Target state or 0 if there is no edge.
+     */
+    inline state_id find_edge( state_id state, unsigned char c ) const
+    {
+        const state_info    &info   = states[ state ];
+        const unsigned char *labels = edge_labels.data() + info.edges;
+
+        if ( info.edges_count <= LINEAR_SEARCH )
+        {
+            for ( uint32_t i = 0; i < info.edges_count; ++i )
+                if ( labels[ i ] == c )
+                    return edge_targets[ info.edges + i ];
+            return 0;
+        }
+
+        uint32_t lo = 0;
+        uint32_t hi = info.edges_count;
+        while ( lo < hi )
+        {
+            uint32_t mid = ( lo + hi ) / 2;
+            if ( labels[ mid ] < c )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        return lo < info.edges_count && labels[ lo ] == c ? edge_targets[ info.edges + lo ] : 0;
+    }
+
+
+    void build( const prefix_tree &tree );
+};
+
+
+} // namespace prefix_tree
+
+#endif // AHO_CORASICK_H
@@ -0,0 +1,229 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief hash64    Fast 64-bit hash of bytes for filters.
+ */
+inline uint64_t hash64( std::string_view data )
+{
+    const uint64_t  M = 0x9E3779B97F4A7C15ull;
+    uint64_t        h = data.size() * M;
+    const char     *p = data.data();
+    size_t          n = data.size();
+
+    for ( ; n >= 8; p += 8, n -= 8 )
+    {
+        uint64_t w;
+        std::memcpy( &w, p, 8 );
+        h = ( h ^ w ) * M;
+        h ^= h >> 29;
+    }
+
+    if ( n )
+    {
+        uint64_t w = 0;
+        std::memcpy( &w, p, n );
+        h = ( h ^ w ) * M;
+    }
+
+    h ^= h >> 32;
+    h *= 0xD6E8FEB86659FD93ull;
+    h ^= h >> 32;
+    return h;
+}
+
+
+/**
+ * @brief The blocked_bloom_filter class    Bloom filter whose probes of key
+ *                                          hit one 64-byte block, lookup
+ *                                          costs one cache miss.
+ */
+class blocked_bloom_filter
+{
+private:
+    struct alignas( 64 ) block
+    {
+        uint64_t                            words[ 8 ];
+    };
+
+    /// @brief MAX_PROBES   Bit positions of 9 bits taken from one hash.
+    static constexpr unsigned int           MAX_PROBES = 7;
+
+    std::vector<block>                      blocks;
+    unsigned int                            probes;
+    size_t                                  capacity_;
+    size_t                                  count;
+
+public:
+    /**
+     * @brief blocked_bloom_filter  Empty filter.
+     * @param expected_keys         Count of keys filter is sized for.
+     * @param bits_per_key          Bits of filter per key, false positive
+     *                              rate is about 1% for 10 bits.
+     */
+    explicit blocked_bloom_filter( size_t expected_keys = 0, size_t bits_per_key = 10 );
+
+
+    /// @brief clear    Remove all keys, size is kept.
+    void clear();
+
+
+    inline void insert( std::string_view key )
+    {
+        insert_hash( hash64( key ) );
+    }
+
+
+    inline void insert_hash( uint64_t h )
+    {
+        block   &b = blocks[ block_of( h ) ];
+        uint64_t p = probe_bits( h );
+        for ( unsigned int i = 0; i < probes; ++i )
+        {
+            unsigned int bit = ( p >> ( 9 * i ) ) & 511;
+            b.words[ bit >> 6 ] |= uint64_t( 1 ) << ( bit & 63 );
+        }
+        ++count;
+    }
+
+
+    /**
+     * @brief may_contain   Check key may be in filter.
+     * @return              false if key has never been inserted.
+     */
+    inline bool may_contain( std::string_view key ) const
+    {
+        return may_contain_hash( hash64( key ) );
+    }
+
+
+    inline bool may_contain_hash( uint64_t h ) const
+    {
+        const block &b    = blocks[ block_of( h ) ];
+        uint64_t     p    = probe_bits( h );
+        uint64_t     miss = 0;
+        for ( unsigned int i = 0; i < probes; ++i )
+        {
+            unsigned int bit = ( p >> ( 9 * i ) ) & 511;
+            miss |= ~b.words[ bit >> 6 ] & ( uint64_t( 1 ) << ( bit & 63 ) );
+        }
+        return !miss;
+    }
+
+
+    /// @brief size         Count of insertions.
+    inline size_t size() const { return count; }
+
+    /// @brief capacity     Count of keys filter is sized for.
+    inline size_t capacity() const { return capacity_; }
+
+    /// @brief memory_usage Size of bits.
+    inline size_t memory_usage() const { return blocks.size() * sizeof( block ); }
+
+
+    /**
+     * @brief estimated_false_positive_rate     Rate of false positives
+     *                                          estimated by share of set
+     *                                          bits of every block.
+     */
+    double estimated_false_positive_rate() const;
+
+private:
+    /// @brief block_of     Block is chosen by upper half of hash.
+    inline size_t block_of( uint64_t h ) const
+    {
+        return static_cast<size_t>( ( ( h >> 32 ) * blocks.size() ) >> 32 );
+    }
+
+
+    /// @brief probe_bits   Positions in block are spread from lower half.
+    static inline uint64_t probe_bits( uint64_t h )
+    {
+        uint64_t p = ( h & 0xffffffffull ) * 0x9E3779B97F4A7C15ull;
+        return p ^ ( p >> 29 );
+    }
+};
+
+
+/**
+ * @brief The key_filter class  Filters of keys and of fixed length prefixes
+ *                              of keys: negative answer of filter means key
+ *                              or prefix is absent.
+ */
+class key_filter
+{
+public:
+    struct options
+    {
+        /// @brief bits_per_key     Bits of each filter per key.
+        size_t                              bits_per_key;
+        /// @brief prefix_lengths   Lengths of prefixes to filter, for
+        ///                         exists( key, false ), empty to disable.
+        std::vector<size_t>                 prefix_lengths;
+
+        options() : bits_per_key( 10 ), prefix_lengths() {}
+    };
+
+private:
+    options                                 opts;
+    blocked_bloom_filter                    keys;
+    blocked_bloom_filter                    prefixes;
+
+public:
+    /**
+     * @brief key_filter        Empty filter.
+     * @param expected_keys     Count of keys filters are sized for.
+     * @param opts_             Options.
+     */
+    explicit key_filter( size_t expected_keys = 0, options opts_ = options() );
+
+
+    void insert( std::string_view key );
+
+
+    /// @brief may_contain  false if key is absent.
+    inline bool may_contain( std::string_view key ) const
+    {
+        return keys.may_contain( key );
+    }
+
+
+    /// @brief may_contain_prefix   false if no key starts with prefix.
+    bool may_contain_prefix( std::string_view prefix ) const;
+
+
+    /// @brief reset    Remove all keys and size filters for count of keys.
+    void reset( size_t expected_keys );
+
+
+    inline const options& get_options() const { return opts; }
+
+    inline const blocked_bloom_filter& key_bits() const { return keys; }
+
+    inline const blocked_bloom_filter& prefix_bits() const { return prefixes; }
+
+    inline size_t memory_usage() const { return keys.memory_usage() + prefixes.memory_usage(); }
+};
+
+
+} // namespace prefix_tree
+
+#endif // BLOOM_FILTER_H
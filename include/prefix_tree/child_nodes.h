@@ -0,0 +1,540 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef CHILD_NODES_H
+#define CHILD_NODES_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "node_arena.h"
+#include "simd.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The child_nodes class     Sorted container of owned child nodes
+ *                                  packed to one machine word.
+ *
+ * The word keeps:
+ *  - bits 0..2     tag bits of owner node (e.g. finite flag);
+ *  - bits 3..47    pointer to single child or to block of children;
+ *  - bits 48..63   inline flag and label of single child or
+ *                  size and capacity of block, flags of node_arena.
+ *
+ * No child: no memory is allocated. Single child: the pointer to it is
+ * stored in the word. Two or more children: block of node pointers
+ * followed by labels, labels are sorted as unsigned char.
+ *
+ * Packing relies on 48-bit virtual addresses (x86_64, aarch64).
+ * Blocks are taken from current node_arena if any. Block and owner node
+ * taken from arena are flagged, so memory of heap is freed without search
+ * of arena registry.
+ */
+template <typename node_type>
+class child_nodes
+{
+public:
+    typedef std::unique_ptr<node_type>      ptr;
+
+    /// @brief npos         Index of not found child.
+    static constexpr size_t                 npos     = SIZE_MAX;
+    /// @brief TAG_MASK     Bits available for owner.
+    static constexpr uintptr_t              TAG_MASK = 7;
+
+private:
+    static_assert( sizeof( uintptr_t ) == 8, "64-bit platform is required" );
+
+    static constexpr unsigned int           HIGH_SHIFT    = 48;
+    static constexpr uintptr_t              INLINE_BIT    = uintptr_t( 1 ) << 63;
+    static constexpr uintptr_t              HIGH_MASK     = uintptr_t( 0xffff ) << HIGH_SHIFT;
+    static constexpr uintptr_t              POINTER_MASK  = ~( HIGH_MASK | TAG_MASK );
+    /// @brief SIZE_MASK    Size of block (9 bits, up to 256).
+    static constexpr uintptr_t              SIZE_MASK     = 0x1ff;
+    /// @brief CAP_SHIFT    Shift of log2 of block capacity (4 bits).
+    static constexpr unsigned int           CAP_SHIFT     = 9;
+    /// @brief BLOCK_ARENA_BIT  Block is taken from node_arena.
+    static constexpr uintptr_t              BLOCK_ARENA_BIT = uintptr_t( 1 ) << 61;
+    /// @brief OWNER_ARENA_BIT  Owner node is taken from node_arena.
+    static constexpr uintptr_t              OWNER_ARENA_BIT = uintptr_t( 1 ) << 62;
+    /// @brief OWNER_MASK   Bits of owner, kept by all changes of children.
+    static constexpr uintptr_t              OWNER_MASK    = TAG_MASK | OWNER_ARENA_BIT;
+    static constexpr size_t                 MIN_CAPACITY  = 2;
+    static constexpr size_t                 LINEAR_SEARCH = 8;
+
+    uintptr_t                               bits;
+
+public:
+    child_nodes() : bits( 0 ) {}
+    child_nodes( const child_nodes & ) = delete;
+    child_nodes& operator=( const child_nodes & ) = delete;
+
+    ~child_nodes()
+    {
+        clear();
+    }
+
+
+    /// @brief tag      Tag bits of owner.
+    inline uintptr_t tag() const { return bits & TAG_MASK; }
+
+
+    /// @brief set_tag  Set tag bits of owner.
+    inline void set_tag( uintptr_t tag_ )
+    {
+        bits = ( bits & ~TAG_MASK ) | ( tag_ & TAG_MASK );
+    }
+
+
+    /// @brief size     Count of children.
+    inline size_t size() const
+    {
+        if ( bits & INLINE_BIT )
+            return 1;
+        return ( bits >> HIGH_SHIFT ) & SIZE_MASK;
+    }
+
+
+    inline bool empty() const { return !( bits & ~OWNER_MASK ); }
+
+
+    /// @brief owner_in_arena   Owner node is taken from node_arena.
+    inline bool owner_in_arena() const { return bits & OWNER_ARENA_BIT; }
+
+
+    /// @brief set_owner_in_arena   Mark owner node as taken from node_arena.
+    inline void set_owner_in_arena() { bits |= OWNER_ARENA_BIT; }
+
+
+    /**
+     * @brief label     Label of edge to child.
+     * @param i         Index of child.
+     */
+    inline unsigned char label( size_t i ) const
+    {
+        if ( bits & INLINE_BIT )
+            return static_cast<unsigned char>( bits >> HIGH_SHIFT );
+        return labels()[ i ];
+    }
+
+
+    /**
+     * @brief node      Child node.
+     * @param i         Index of child.
+     */
+    inline node_type* node( size_t i ) const
+    {
+        if ( bits & INLINE_BIT )
+            return reinterpret_cast<node_type*>( bits & POINTER_MASK );
+        return nodes()[ i ];
+    }
+
+
+    /**
+     * @brief lower_bound   Index of first child with label not less than c.
+     */
+    inline size_t lower_bound( unsigned char c ) const
+    {
+        size_t n = size();
+        if ( n <= 1 )
+            return n && label( 0 ) < c ? 1 : 0;
+
+        const unsigned char *l = labels();
+        if ( n <= LINEAR_SEARCH )
+        {
+            size_t i = 0;
+            while ( i < n && l[ i ] < c )
+                ++i;
+            return i;
+        }
+
+        return simd::lower_bound( l, n, c );
+    }
+
+
+    /**
+     * @brief upper_bound   Index of first child with label greater than c.
+     */
+    inline size_t upper_bound( unsigned char c ) const
+    {
+        size_t i = lower_bound( c );
+        return i < size() && label( i ) == c ? i + 1 : i;
+    }
+
+
+    /**
+     * @brief find      Index of child with label c.
+     * @return          Index or npos.
+     */
+    inline size_t find( unsigned char c ) const
+    {
+        size_t i = lower_bound( c );
+        return i < size() && label( i ) == c ? i : npos;
+    }
+
+
+    /**
+     * @brief get       Child with label c.
+     * @return          Child or nullptr.
+     */
+    inline node_type* get( unsigned char c ) const
+    {
+        if ( bits & INLINE_BIT )
+            return label( 0 ) == c ? node( 0 ) : nullptr;
+
+        size_t i = find( c );
+        return i == npos ? nullptr : nodes()[ i ];
+    }
+
+
+    /**
+     * @brief insert    Insert child. Label must be absent.
+     * @param pos       Index of child with label greater than c (see lower_bound()).
+     * @param c         Label.
+     * @param child     Child node.
+     * @return          Raw pointer to inserted child.
+     */
+    node_type* insert( size_t pos, unsigned char c, ptr &&child )
+    {
+        node_type *raw = child.release();
+        size_t     n   = size();
+
+        if ( !n )
+        {
+            set_inline( c, raw );
+            return raw;
+        }
+
+        size_t cap = n == 1 ? 0 : capacity();
+        if ( n == cap )
+        {
+            relocate( n + 1, pos );
+        }
+        else if ( n == 1 )
+        {
+            unsigned char old_label = label( 0 );
+            node_type    *old_node  = node( 0 );
+
+            bool  in_arena;
+            void *block_ = allocate( MIN_CAPACITY, in_arena );
+
+            set_block( block_, 2, MIN_CAPACITY, in_arena );
+            nodes()[ pos ? 0 : 1 ]  = old_node;
+            labels()[ pos ? 0 : 1 ] = old_label;
+        }
+        else
+        {
+            std::memmove( nodes() + pos + 1, nodes() + pos, ( n - pos ) * sizeof( node_type* ) );
+            std::memmove( labels() + pos + 1, labels() + pos, n - pos );
+            set_size( n + 1 );
+        }
+
+        nodes()[ pos ]  = raw;
+        labels()[ pos ] = c;
+        return raw;
+    }
+
+
+    /**
+     * @brief assign    Fill empty container with sorted children at once.
+     * @param n         Count of children.
+     * @param labels_   Sorted labels.
+     * @param children  Children, released to the container.
+     */
+    void assign( size_t n, const unsigned char *labels_, ptr *children )
+    {
+        if ( !n )
+            return;
+
+        if ( n == 1 )
+        {
+            set_inline( labels_[ 0 ], children[ 0 ].release() );
+            return;
+        }
+
+        size_t cap = block_capacity( n );
+        bool   in_arena;
+        void  *block_ = allocate( cap, in_arena );
+
+        set_block( block_, n, cap, in_arena );
+
+        for ( size_t i = 0; i < n; ++i )
+            nodes()[ i ] = children[ i ].release();
+        std::memcpy( labels(), labels_, n );
+    }
+
+
+    /**
+     * @brief allocated_bytes_for   Size of block allocated by assign() of n children.
+     */
+    static inline size_t allocated_bytes_for( size_t n )
+    {
+        return n <= 1 ? 0 : block_bytes( block_capacity( n ) );
+    }
+
+
+    /**
+     * @brief insert    Insert child to sorted position. Label must be absent.
+     * @param c         Label.
+     * @param child     Child node.
+     * @return          Raw pointer to inserted child.
+     */
+    inline node_type* insert( unsigned char c, ptr &&child )
+    {
+        return insert( lower_bound( c ), c, std::move( child ) );
+    }
+
+
+    /**
+     * @brief release   Unlink child without deleting.
+     * @param pos       Index of child.
+     * @return          Child.
+     */
+    ptr release( size_t pos )
+    {
+        size_t n     = size();
+        ptr    child( node( pos ) );
+
+        if ( n == 1 )
+        {
+            bits &= OWNER_MASK;
+            return child;
+        }
+
+        if ( n == 2 )
+        {
+            size_t         other       = pos ? 0 : 1;
+            unsigned char  other_label = labels()[ other ];
+            node_type     *other_node  = nodes()[ other ];
+
+            deallocate( block(), block_in_arena() );
+            set_inline( other_label, other_node );
+            return child;
+        }
+
+        std::memmove( nodes() + pos, nodes() + pos + 1, ( n - pos - 1 ) * sizeof( node_type* ) );
+        std::memmove( labels() + pos, labels() + pos + 1, n - pos - 1 );
+        set_size( n - 1 );
+
+        if ( n - 1 <= capacity() / 4 )
+            relocate( n - 1, npos );
+
+        return child;
+    }
+
+
+    /**
+     * @brief erase     Delete child.
+     * @param pos       Index of child.
+     */
+    inline void erase( size_t pos )
+    {
+        release( pos );
+    }
+
+
+    /**
+     * @brief release_all   Unlink all children without deleting. Tag is kept.
+     * @param out           Container to append children to.
+     */
+    template <typename container_t>
+    void release_all( container_t &out )
+    {
+        if ( empty() )
+            return;
+
+        if ( bits & INLINE_BIT )
+            out.push_back( node( 0 ) );
+        else
+        {
+            out.insert( out.end(), nodes(), nodes() + size() );
+            deallocate( block(), block_in_arena() );
+        }
+
+        bits &= OWNER_MASK;
+    }
+
+
+    /// @brief clear    Delete all children. Tag is kept.
+    void clear()
+    {
+        if ( empty() )
+            return;
+
+        if ( bits & INLINE_BIT )
+            delete node( 0 );
+        else
+        {
+            size_t n = size();
+            for ( size_t i = 0; i < n; ++i )
+                delete nodes()[ i ];
+            deallocate( block(), block_in_arena() );
+        }
+
+        bits &= OWNER_MASK;
+    }
+
+
+    /// @brief swap     Swap children. Tags are kept.
+    inline void swap( child_nodes &other )
+    {
+        uintptr_t mine = bits & ~OWNER_MASK;
+        bits       = ( bits & OWNER_MASK ) | ( other.bits & ~OWNER_MASK );
+        other.bits = ( other.bits & OWNER_MASK ) | mine;
+    }
+
+
+    /// @brief allocated_bytes  Size of block of children.
+    inline size_t allocated_bytes() const
+    {
+        if ( empty() || ( bits & INLINE_BIT ) )
+            return 0;
+        return block_bytes( capacity() );
+    }
+
+private:
+    inline void* block() const
+    {
+        return reinterpret_cast<void*>( bits & POINTER_MASK );
+    }
+
+
+    inline bool block_in_arena() const
+    {
+        return bits & BLOCK_ARENA_BIT;
+    }
+
+
+    inline node_type** nodes() const
+    {
+        return static_cast<node_type**>( block() );
+    }
+
+
+    inline unsigned char* labels() const
+    {
+        return reinterpret_cast<unsigned char*>( nodes() + capacity() );
+    }
+
+
+    inline size_t capacity() const
+    {
+        return size_t( 1 ) << ( ( bits >> ( HIGH_SHIFT + CAP_SHIFT ) ) & 0xf );
+    }
+
+
+    inline void set_size( size_t n )
+    {
+        uintptr_t high = ( ( bits >> HIGH_SHIFT ) & ~SIZE_MASK ) | n;
+        bits = ( bits & ~HIGH_MASK ) | ( high << HIGH_SHIFT );
+    }
+
+
+    inline void set_inline( unsigned char c, node_type *child )
+    {
+        bits =
+                ( bits & OWNER_MASK )                           |
+                INLINE_BIT                                      |
+                ( uintptr_t( c ) << HIGH_SHIFT )                |
+                reinterpret_cast<uintptr_t>( child )
+        ;
+    }
+
+
+    inline void set_block( void *block_, size_t n, size_t cap, bool in_arena )
+    {
+        uintptr_t log2 = 0;
+        while ( ( size_t( 1 ) << log2 ) < cap )
+            ++log2;
+
+        bits =
+                ( bits & OWNER_MASK )                           |
+                ( in_arena ? BLOCK_ARENA_BIT : 0 )              |
+                ( ( ( log2 << CAP_SHIFT ) | n ) << HIGH_SHIFT ) |
+                reinterpret_cast<uintptr_t>( block_ )
+        ;
+    }
+
+
+    static inline size_t block_bytes( size_t cap )
+    {
+        return cap * ( sizeof( node_type* ) + 1 );
+    }
+
+
+    static inline size_t block_capacity( size_t n )
+    {
+        size_t cap = MIN_CAPACITY;
+        while ( cap < n )
+            cap *= 2;
+        return cap;
+    }
+
+
+    /**
+     * @brief allocate  Block from current node_arena or heap.
+     * @param cap       Capacity.
+     * @param in_arena  Set to true if block is taken from arena.
+     */
+    static inline void* allocate( size_t cap, bool &in_arena )
+    {
+        void *block_ = node_arena::allocate( block_bytes( cap ) );
+        in_arena = block_;
+        return block_ ? block_ : ::operator new( block_bytes( cap ) );
+    }
+
+
+    /// @brief deallocate   Free block, registry of arenas is searched for blocks of arena only.
+    static inline void deallocate( void *block_, bool in_arena )
+    {
+        if ( !in_arena || !node_arena::deallocate( block_ ) )
+            ::operator delete( block_ );
+    }
+
+
+    /**
+     * @brief relocate  Move children to new block of capacity enough for n.
+     * @param n         New size.
+     * @param gap       Index of inserted child to skip or npos.
+     */
+    void relocate( size_t n, size_t gap )
+    {
+        size_t cap = block_capacity( n );
+
+        size_t         old_n      = gap == npos ? n : n - 1;
+        bool           old_arena  = block_in_arena();
+        node_type    **old_nodes  = nodes();
+        unsigned char *old_labels = labels();
+
+        bool           new_arena;
+        void          *new_block  = allocate( cap, new_arena );
+        node_type    **new_nodes  = static_cast<node_type**>( new_block );
+        unsigned char *new_labels = reinterpret_cast<unsigned char*>( new_nodes + cap );
+
+        size_t head = gap == npos ? old_n : gap;
+        std::memcpy( new_nodes, old_nodes, head * sizeof( node_type* ) );
+        std::memcpy( new_labels, old_labels, head );
+        if ( gap != npos )
+        {
+            std::memcpy( new_nodes + gap + 1, old_nodes + gap, ( old_n - gap ) * sizeof( node_type* ) );
+            std::memcpy( new_labels + gap + 1, old_labels + gap, old_n - gap );
+        }
+
+        deallocate( old_nodes, old_arena );
+        set_block( new_block, n, cap, new_arena );
+    }
+};
+
+
+} // namespace prefix_tree
+
+#endif // CHILD_NODES_H
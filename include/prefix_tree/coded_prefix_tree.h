@@ -0,0 +1,308 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef CODED_PREFIX_TREE_H
+#define CODED_PREFIX_TREE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "prefix_tree.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * Codecs map every byte of key to a short sequence of edge labels. Codes of
+ * bytes are monotonic and prefix free, so order of keys, prefixes and
+ * ranges are kept. Labels are never 0, coded keys are C strings, so keys
+ * have no 0 bytes as keys of prefix_tree.
+ */
+
+
+/**
+ * @brief The nibble_codec class    Byte is split to two 4-bit edges, every
+ *                                  node has at most 16 children.
+ */
+class nibble_codec
+{
+public:
+    static constexpr size_t                 FAN_OUT = 16;
+
+    inline void encode( std::string_view key, std::string &out ) const
+    {
+        out.clear();
+        out.reserve( key.size() * 2 );
+        for ( unsigned char c : key )
+        {
+            out.push_back( static_cast<char>( ( c >> 4 ) + 1 ) );
+            out.push_back( static_cast<char>( ( c & 0xf ) + 1 ) );
+        }
+    }
+
+
+    inline void decode( std::string_view coded, std::string &out ) const
+    {
+        out.clear();
+        out.reserve( coded.size() / 2 );
+        for ( size_t i = 0; i + 1 < coded.size(); i += 2 )
+            out.push_back( static_cast<char>( ( ( coded[ i ] - 1 ) << 4 ) | ( coded[ i + 1 ] - 1 ) ) );
+    }
+};
+
+
+/**
+ * @brief The alphabet_codec class  Bytes of alphabet chosen when tree is
+ *                                  built are mapped to dense codes, fan-out
+ *                                  of nodes is bound by size of alphabet.
+ *
+ * Alphabet a[0] < ... < a[K-1] gets even codes 2i+2. Other bytes are kept:
+ * escape code 2g+1 of gap g (count of symbols less than byte) is followed
+ * by the byte itself.
+ */
+class alphabet_codec
+{
+public:
+    /// @brief MAX_ALPHABET     Codes of symbols and gaps fit one byte.
+    static constexpr size_t                 MAX_ALPHABET = 127;
+
+private:
+    /// @brief codes    Code of byte, odd for escaped bytes.
+    std::array<uint8_t, 256>                codes;
+    /// @brief symbols  Byte of even code.
+    std::array<uint8_t, 256>                symbols;
+    size_t                                  count;
+
+public:
+    /// @brief alphabet_codec   Empty alphabet, every byte is escaped.
+    alphabet_codec() : alphabet_codec( std::string_view() ) {}
+
+
+    /**
+     * @brief alphabet_codec    Build codes.
+     * @param alphabet          Bytes of alphabet in any order, 0 is ignored.
+     *                          Throws std::invalid_argument if there are
+     *                          more than MAX_ALPHABET distinct bytes.
+     */
+    explicit alphabet_codec( std::string_view alphabet );
+
+
+    /**
+     * @brief from_keys     Alphabet of keys, the most frequent bytes are
+     *                      taken if there are more than MAX_ALPHABET.
+     * @param first         First key.
+     * @param last          End of keys.
+     */
+    template <typename iterator_t>
+    static alphabet_codec from_keys( iterator_t first, iterator_t last )
+    {
+        std::array<size_t, 256> frequency = {};
+        for ( ; first != last; ++first )
+        {
+            for ( unsigned char c : std::string_view( *first ) )
+                ++frequency[ c ];
+        }
+        return from_frequency( frequency );
+    }
+
+
+    /// @brief alphabet_size    Count of bytes of alphabet.
+    inline size_t alphabet_size() const { return count; }
+
+
+    inline void encode( std::string_view key, std::string &out ) const
+    {
+        out.clear();
+        out.reserve( key.size() );
+        for ( unsigned char c : key )
+        {
+            uint8_t code = codes[ c ];
+            out.push_back( static_cast<char>( code ) );
+            if ( code & 1 )
+                out.push_back( static_cast<char>( c ) );
+        }
+    }
+
+
+    inline void decode( std::string_view coded, std::string &out ) const
+    {
+        out.clear();
+        out.reserve( coded.size() );
+        for ( size_t i = 0; i < coded.size(); ++i )
+        {
+            uint8_t code = static_cast<uint8_t>( coded[ i ] );
+            out.push_back( code & 1 ? coded[ ++i ] : static_cast<char>( symbols[ code ] ) );
+        }
+    }
+
+private:
+    static alphabet_codec from_frequency( const std::array<size_t, 256> &frequency );
+};
+
+
+/**
+ * @brief The coded_prefix_tree class   Set of keys kept in prefix_tree
+ *                                      under codec. API and order of keys
+ *                                      are the same as of prefix_tree,
+ *                                      iterators visit keys only.
+ * @param codec_t                       nibble_codec or alphabet_codec.
+ */
+template <typename codec_t>
+class coded_prefix_tree
+{
+public:
+    class iterator
+    {
+        friend class coded_prefix_tree;
+
+    private:
+        prefix_tree::iterator               it;
+        const codec_t                      *codec;
+
+        iterator( prefix_tree::iterator &&it_, const codec_t *codec_ ) : it( std::move( it_ ) ), codec( codec_ ) {}
+
+    public:
+        iterator() : it(), codec( nullptr ) {}
+
+        inline iterator& operator++() { ++it; return *this; }
+        inline iterator& operator--() { --it; return *this; }
+        inline bool operator==( const iterator &right ) const { return it == right.it; }
+        inline bool operator!=( const iterator &right ) const { return it != right.it; }
+        inline operator bool() const { return static_cast<bool>( it ); }
+
+        /**
+         * @brief get_key
+         * @return          Decoded key of current node.
+         */
+        std::string get_key() const
+        {
+            std::string key;
+            codec->decode( it.get_key(), key );
+            return key;
+        }
+    };
+
+private:
+    codec_t                                 codec_;
+    prefix_tree                             tree;
+
+public:
+    explicit coded_prefix_tree( codec_t codec = codec_t() ) : codec_( std::move( codec ) ), tree() {}
+
+
+    /// @brief codec    Codec chosen when the tree was built.
+    inline const codec_t& codec() const { return codec_; }
+
+
+    /**
+     * @brief append    Append key.
+     * @return          true if append is successful.
+     */
+    inline bool append( const std::string &key )
+    {
+        return tree.append( encode( key ) );
+    }
+
+
+    /**
+     * @brief append_sorted     Append keys sorted in ascending order.
+     * @return                  Count of keys appended.
+     */
+    template <typename iterator_t>
+    size_t append_sorted( iterator_t first, iterator_t last )
+    {
+        std::vector<std::string> coded;
+        for ( ; first != last; ++first )
+        {
+            coded.emplace_back();
+            codec_.encode( std::string_view( *first ), coded.back() );
+        }
+        return tree.append_sorted( coded.begin(), coded.end() );
+    }
+
+
+    inline void remove( const std::string &key )
+    {
+        tree.remove( encode( key ) );
+    }
+
+
+    inline void remove_prefix( const std::string &prefix )
+    {
+        tree.remove_prefix( encode( prefix ) );
+    }
+
+
+    /**
+     * @brief exists        Check key is exist.
+     * @param finite_node   false to check key is prefix of any key.
+     */
+    inline bool exists( const std::string &key, bool finite_node = true ) const
+    {
+        return tree.exists( encode( key ), finite_node );
+    }
+
+
+    inline iterator find( const std::string &key )
+    {
+        return iterator( tree.find( encode( key ) ), &codec_ );
+    }
+
+
+    inline iterator lower_bound( const std::string &key )
+    {
+        return iterator( tree.lower_bound( encode( key ) ), &codec_ );
+    }
+
+
+    inline iterator upper_bound( const std::string &key )
+    {
+        return iterator( tree.upper_bound( encode( key ) ), &codec_ );
+    }
+
+
+    /// @brief range    Keys in [ from, to ).
+    inline std::pair<iterator, iterator> range( const std::string &from, const std::string &to )
+    {
+        auto r = tree.range( encode( from ), encode( to ) );
+        return { iterator( std::move( r.first ), &codec_ ), iterator( std::move( r.second ), &codec_ ) };
+    }
+
+
+    inline iterator begin() { return iterator( tree.begin( true ), &codec_ ); }
+    inline iterator end() { return iterator( tree.end(), &codec_ ); }
+
+
+    /// @brief memory_usage     Memory of underlying tree.
+    inline prefix_tree::memory_usage_info memory_usage() const
+    {
+        return tree.memory_usage();
+    }
+
+private:
+    inline std::string encode( std::string_view key ) const
+    {
+        std::string coded;
+        codec_.encode( key, coded );
+        return coded;
+    }
+};
+
+
+typedef coded_prefix_tree<nibble_codec>     nibble_prefix_tree;
+typedef coded_prefix_tree<alphabet_codec>   alphabet_prefix_tree;
+
+
+} // namespace prefix_tree
+
+#endif // CODED_PREFIX_TREE_H
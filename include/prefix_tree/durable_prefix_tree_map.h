@@ -0,0 +1,278 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef DURABLE_PREFIX_TREE_MAP_H
+#define DURABLE_PREFIX_TREE_MAP_H
+
+#include <cstring>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "prefix_tree_map.h"
+#include "write_ahead_log.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The value_codec struct    Encoding of values for log and snapshots.
+ *                                  Specialize it for own types.
+ */
+template <typename value_type, typename enable_t = void>
+struct value_codec;
+
+
+/**
+ * @brief The value_codec struct    Trivially copyable values are kept as bytes.
+ */
+template <typename value_type>
+struct value_codec<value_type, typename std::enable_if<std::is_trivially_copyable<value_type>::value>::type>
+{
+    static inline void encode( const value_type &value, std::string &out )
+    {
+        out.assign( reinterpret_cast<const char*>( &value ), sizeof( value ) );
+    }
+
+    static inline bool decode( const std::string &in, value_type &value )
+    {
+        if ( in.size() != sizeof( value ) )
+            return false;
+        std::memcpy( static_cast<void*>( &value ), in.data(), sizeof( value ) );
+        return true;
+    }
+};
+
+
+template <>
+struct value_codec<std::string>
+{
+    static inline void encode( const std::string &value, std::string &out ) { out = value; }
+    static inline bool decode( const std::string &in, std::string &value ) { value = in; return true; }
+};
+
+
+/**
+ * @brief The durable_prefix_tree_map class     prefix_tree_map which survives
+ *                                              restart of process.
+ *
+ * Every append and remove is written to write-ahead log before it is
+ * applied, log is synced by group commit (see durable_storage::options).
+ * Snapshot of the map is taken periodically or by snapshot(), constructor
+ * loads the last snapshot and replays log after it.
+ *
+ * All functions are thread safe. Writers are serialized, readers share
+ * lock. Snapshot, periodic or by snapshot(), holds exclusive lock while it
+ * is written, so it blocks readers as well as writers.
+ *
+ * Record of every write is in the log file before the write returns, so
+ * acknowledged writes survive kill of process. With default options
+ * (sync_every_operation is false) up to group_commit_records of them may
+ * be lost on power loss; call flush() or set sync_every_operation to make
+ * every acknowledged write durable against it too.
+ *
+ * @param value_type    Type of value, default constructible.
+ * @param codec_t       Encoding of value, see value_codec.
+ */
+template <typename value_type, typename codec_t = value_codec<value_type> >
+class durable_prefix_tree_map
+{
+public:
+    typedef durable_storage::options                    options;
+    typedef durable_storage::recovery_info              recovery_info;
+    typedef typename prefix_tree_map<value_type>::memory_usage_info memory_usage_info;
+
+private:
+    mutable std::shared_mutex                           lock;
+    prefix_tree_map<value_type>                         map;
+    durable_storage                                     storage;
+    recovery_info                                       recovered;
+
+public:
+    /**
+     * @brief durable_prefix_tree_map   Open directory and recover the map.
+     * @param directory                 Directory of snapshots and logs.
+     * @param opts                      Durability options.
+     */
+    explicit durable_prefix_tree_map( const std::string &directory, const options &opts = options() )
+        : lock(), map(), storage( directory, opts ), recovered()
+    {
+        value_type value;
+        recovered = storage.recover(
+                    [&] ( const log_record &record )
+                    {
+                        if ( record.op == log_op::REMOVE )
+                        {
+                            map.remove( record.key );
+                            return;
+                        }
+
+                        if ( !codec_t::decode( record.value, value ) )
+                            throw std::runtime_error( "durable_prefix_tree_map: invalid value of key " + record.key );
+                        map.insert_or_assign( record.key, std::move( value ) );
+                    }
+        );
+    }
+
+    ~durable_prefix_tree_map() = default;
+
+    durable_prefix_tree_map( const durable_prefix_tree_map & ) = delete;
+    durable_prefix_tree_map& operator=( const durable_prefix_tree_map & ) = delete;
+
+
+    /**
+     * @brief append    Set value of key.
+     * @param key       Key.
+     * @param value_    Value.
+     * @return          true if key has been appended.
+     */
+    bool append( const std::string &key, const value_type &value_ )
+    {
+        std::string encoded;
+        codec_t::encode( value_, encoded );
+
+        bool        appended;
+        uint64_t    lsn;
+        {
+            std::unique_lock<std::shared_mutex> guard( lock );
+            lsn      = storage.append( log_op::APPEND, key.data(), key.size(), encoded.data(), encoded.size() );
+            appended = map.insert_or_assign( key, value_ ).second;
+        }
+
+        after_write( lsn );
+        return appended;
+    }
+
+
+    /**
+     * @brief remove    Remove key.
+     * @param key       Key.
+     * @return          true if key has existed.
+     */
+    bool remove( const std::string &key )
+    {
+        uint64_t lsn;
+        {
+            std::unique_lock<std::shared_mutex> guard( lock );
+            if ( !map.exists( key ) )
+                return false;
+
+            lsn = storage.append( log_op::REMOVE, key.data(), key.size(), nullptr, 0 );
+            map.remove( key );
+        }
+
+        after_write( lsn );
+        return true;
+    }
+
+
+    /**
+     * @brief find      Copy value of key.
+     * @param key       Key.
+     * @param value_    Value of key if it is found.
+     * @return          true if key is found.
+     */
+    bool find( const std::string &key, value_type &value_ ) const
+    {
+        std::shared_lock<std::shared_mutex> guard( lock );
+
+        const value_type *found = const_cast<prefix_tree_map<value_type>&>( map ).get_value( key );
+        if ( !found )
+            return false;
+
+        value_ = *found;
+        return true;
+    }
+
+
+    /// @brief exists   Check key is exist.
+    bool exists( const std::string &key ) const
+    {
+        std::shared_lock<std::shared_mutex> guard( lock );
+        return map.exists( key );
+    }
+
+
+    /**
+     * @brief for_each      Visit all keys in order under shared lock.
+     * @param callback      Function( const std::string &key, const value_type &value ).
+     */
+    template <typename callback_t>
+    void for_each( callback_t &&callback ) const
+    {
+        std::shared_lock<std::shared_mutex> guard( lock );
+
+        auto &m = const_cast<prefix_tree_map<value_type>&>( map );
+        for ( auto it = m.begin(); it != m.end(); ++it )
+            callback( it.get_key(), static_cast<const value_type&>( it.get_value() ) );
+    }
+
+
+    /// @brief flush    Make all done operations durable.
+    inline void flush() { storage.sync(); }
+
+
+    /// @brief snapshot     Write snapshot and remove logs covered by it.
+    void snapshot()
+    {
+        std::unique_lock<std::shared_mutex> guard( lock );
+        write_snapshot();
+    }
+
+
+    /// @brief recovery     What has been loaded on open.
+    inline const recovery_info& recovery() const { return recovered; }
+
+
+    /// @brief memory_usage     Memory used by the map.
+    memory_usage_info memory_usage() const
+    {
+        std::shared_lock<std::shared_mutex> guard( lock );
+        return map.memory_usage();
+    }
+
+private:
+    void after_write( uint64_t lsn )
+    {
+        storage.commit_if_needed( lsn );
+
+        if ( storage.snapshot_due() )
+        {
+            std::unique_lock<std::shared_mutex> guard( lock );
+            if ( storage.snapshot_due() )
+                write_snapshot();
+        }
+    }
+
+
+    void write_snapshot()
+    {
+        auto it  = map.begin();
+        auto end = map.end();
+
+        storage.snapshot(
+                    [&] ( log_record &record )
+                    {
+                        if ( it == end )
+                            return false;
+
+                        record.key = it.get_key();
+                        codec_t::encode( it.get_value(), record.value );
+                        ++it;
+                        return true;
+                    }
+        );
+    }
+};
+
+
+} // namespace prefix_tree
+
+#endif // DURABLE_PREFIX_TREE_MAP_H
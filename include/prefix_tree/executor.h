@@ -0,0 +1,142 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The executor class    Work-stealing thread pool.
+ *
+ * Every worker has own deque of tasks. Worker takes the newest task of its
+ * deque (depth first), idle worker steals the oldest task of other deque
+ * (usually the largest one). Tasks submitted by threads out of the pool go
+ * to shared queue. Threads waiting for task_group run tasks meanwhile, so
+ * tasks may spawn and wait nested groups.
+ */
+class executor
+{
+public:
+    class task_group;
+
+private:
+    struct task
+    {
+        std::function<void()>               function;
+        task_group                         *group;
+    };
+
+
+    struct task_queue
+    {
+        std::mutex                          lock;
+        std::deque<task>                    tasks;
+    };
+
+
+    /// @brief count        Count of workers, set before workers start.
+    size_t                                      count;
+    /// @brief queues       Deques of workers and shared queue at the end.
+    std::vector<std::unique_ptr<task_queue> >   queues;
+    std::vector<std::thread>                    workers;
+    std::mutex                                  sleep_lock;
+    std::condition_variable                     wake;
+    std::atomic<size_t>                         queued;
+    std::atomic<bool>                           stopping;
+
+public:
+    /**
+     * @brief The task_group class  Set of tasks to wait for.
+     */
+    class task_group
+    {
+        friend class executor;
+
+    private:
+        executor                           &owner;
+        std::atomic<size_t>                 pending;
+        std::mutex                          error_lock;
+        std::exception_ptr                  error;
+
+    public:
+        explicit task_group( executor &owner_ ) : owner( owner_ ), pending( 0 ), error_lock(), error() {}
+
+        /// @brief ~task_group  Waits for tasks, exceptions are dropped.
+        ~task_group();
+
+        task_group( const task_group & ) = delete;
+        task_group& operator=( const task_group & ) = delete;
+
+
+        /**
+         * @brief run       Submit task.
+         * @param function  Task.
+         */
+        void run( std::function<void()> function );
+
+
+        /**
+         * @brief wait      Run tasks of pool until all tasks of group are
+         *                  done. First exception of tasks is rethrown.
+         */
+        void wait();
+    };
+
+
+    /**
+     * @brief executor      Start workers.
+     * @param threads       Count of workers, 0 is hardware concurrency.
+     */
+    explicit executor( size_t threads = 0 );
+    ~executor();
+
+    executor( const executor & ) = delete;
+    executor& operator=( const executor & ) = delete;
+
+
+    /// @brief size     Count of workers.
+    inline size_t size() const { return count; }
+
+
+    /// @brief instance     Shared executor of hardware concurrency workers.
+    static executor& instance();
+
+private:
+    void push( task &&t );
+
+    /**
+     * @brief run_one   Run one task: own newest, shared or stolen oldest.
+     * @param self      Index of queue of current worker or size() for
+     *                  thread out of pool.
+     * @return          false if no task has been found.
+     */
+    bool run_one( size_t self );
+
+    /// @brief pop      Take newest or oldest task of queue.
+    static bool pop( task_queue &q, task &t, bool newest );
+
+    void work( size_t self );
+};
+
+
+} // namespace prefix_tree
+
+#endif // EXECUTOR_H
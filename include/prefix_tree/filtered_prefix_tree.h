@@ -0,0 +1,307 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef FILTERED_PREFIX_TREE_H
+#define FILTERED_PREFIX_TREE_H
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "bloom_filter.h"
+#include "prefix_tree.h"
+#include "prefix_tree_map.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The filtered_tree class   prefix_tree or prefix_tree_map with
+ *                                  Bloom filter in front of lookups: most
+ *                                  of absent keys are rejected by one
+ *                                  cache line of filter instead of walk
+ *                                  over nodes.
+ *
+ * Filter is kept by append, try_emplace, emplace, insert_or_assign,
+ * operator[] and append_sorted and grows twice when it is full. Removed
+ * keys stay in filter until compact() finishes or rebuild() is called, so
+ * they cost false positives only.
+ *
+ * Filter lives in the root only, nodes below are of tree_t. Base is
+ * protected: the tree can not be changed as tree_t past the filter.
+ *
+ * @param tree_t                    prefix_tree or prefix_tree_map.
+ */
+template <typename tree_t>
+class filtered_tree : protected tree_t
+{
+public:
+    typedef typename tree_t::iterator       iterator;
+
+    using typename tree_t::memory_usage_info;
+    using typename tree_t::statistics;
+    using tree_t::operator new;
+    using tree_t::operator delete;
+
+    using tree_t::remove;
+    using tree_t::remove_prefix;
+    using tree_t::remove_lazy;
+    using tree_t::lower_bound;
+    using tree_t::upper_bound;
+    using tree_t::range;
+    using tree_t::begin;
+    using tree_t::end;
+    using tree_t::memory_usage;
+    using tree_t::stats;
+    using tree_t::relayout;
+
+    /// @brief The filter_info struct   Report of filter.
+    struct filter_info
+    {
+        size_t                              keys;
+        size_t                              memory;
+        double                              key_false_positive_rate;
+        double                              prefix_false_positive_rate;
+    };
+
+private:
+    /// @brief IS_SET   tree_t is prefix_tree, not map.
+    static constexpr bool                   IS_SET = std::is_same<tree_t, prefix_tree>::value;
+
+    key_filter                              filter;
+
+public:
+    /**
+     * @brief filtered_tree     Empty tree.
+     * @param expected_keys     Count of keys filter is sized for first.
+     * @param opts              Options of filter.
+     */
+    explicit filtered_tree( size_t expected_keys = 1024, key_filter::options opts = key_filter::options() )
+        : tree_t(), filter( expected_keys, std::move( opts ) ) {}
+
+    virtual ~filtered_tree() = default;
+
+
+    /**
+     * @brief append        Append key, value of map is replaced.
+     * @param key           Key.
+     * @param args          Value of map, nothing for prefix_tree.
+     * @return              true if append is successful.
+     */
+    template <typename... args_t>
+    inline bool append( const std::string &key, args_t&&... args )
+    {
+        bool appended = tree_t::append( key, std::forward<args_t>( args )... );
+        if ( appended )
+            add( key );
+        return appended;
+    }
+
+
+    template <typename... args_t>
+    inline auto try_emplace( const std::string &key, args_t&&... args )
+    {
+        auto result = tree_t::try_emplace( key, std::forward<args_t>( args )... );
+        if ( result.second )
+            add( key );
+        return result;
+    }
+
+
+    template <typename... args_t>
+    inline auto emplace( const std::string &key, args_t&&... args )
+    {
+        return try_emplace( key, std::forward<args_t>( args )... );
+    }
+
+
+    template <typename arg_t>
+    inline auto insert_or_assign( const std::string &key, arg_t &&value_ )
+    {
+        auto result = tree_t::insert_or_assign( key, std::forward<arg_t>( value_ ) );
+        if ( result.second )
+            add( key );
+        return result;
+    }
+
+
+    /**
+     * @brief operator[]    Value of key of map, absent key is appended
+     *                      with default constructed value.
+     */
+    inline auto& operator[]( const std::string &key )
+    {
+        return try_emplace( key ).first;
+    }
+
+
+    inline auto& operator[]( const char *key )
+    {
+        return try_emplace( key ).first;
+    }
+
+
+    /**
+     * @brief append_sorted     Append keys, see prefix_tree::append_sorted().
+     *                          Values of map are default constructed, keys
+     *                          are appended one by one then. Range is
+     *                          walked twice: iterator_t must be a forward
+     *                          iterator.
+     * @return                  Count of keys which were absent.
+     */
+    template <typename iterator_t>
+    size_t append_sorted( iterator_t first, iterator_t last )
+    {
+        size_t appended = 0;
+        if constexpr ( IS_SET )
+        {
+            appended = tree_t::append_sorted( first, last );
+        }
+        else
+        {
+            // prefix_tree::append_sorted() does not construct values.
+            for ( iterator_t it = first; it != last; ++it )
+                appended += tree_t::try_emplace( std::string( std::string_view( *it ) ) ).second;
+        }
+
+        for ( ; first != last; ++first )
+            filter.insert( std::string_view( *first ) );
+        if ( filter.key_bits().size() > filter.key_bits().capacity() )
+            rebuild();
+        return appended;
+    }
+
+
+    /**
+     * @brief exists        Check key or prefix is exist.
+     * @param key           Key or prefix.
+     * @param finite_node   If true looking for finite node only else
+     *                      prefix or finite node.
+     * @return              true if key or prefix is exist.
+     */
+    inline bool exists( const std::string &key, bool finite_node = true ) const
+    {
+        if ( !may_contain( key, finite_node ) )
+            return false;
+        return tree_t::exists( key, finite_node );
+    }
+
+
+    /**
+     * @brief find          Find key in tree.
+     * @param key           Key.
+     * @param finite_node   If true find finite node only, prefix_tree only.
+     * @return              Iterator of found node or end().
+     */
+    inline iterator find( const std::string &key, bool finite_node = true )
+    {
+        if ( !may_contain( key, finite_node ) )
+            return tree_t::end();
+
+        if constexpr ( IS_SET )
+            return tree_t::find( key, finite_node );
+        else
+            return tree_t::find( key );
+    }
+
+
+    /**
+     * @brief get_value     Value of key of map.
+     * @return              Pointer to value or nullptr if key is absent.
+     */
+    inline auto get_value( const std::string &key )
+    {
+        typedef decltype( tree_t::get_value( key ) ) pointer;
+        if ( !filter.may_contain( key ) )
+            return pointer( nullptr );
+        return tree_t::get_value( key );
+    }
+
+
+    /**
+     * @brief compact       Free nodes left by remove_lazy() step by step,
+     *                      filter is rebuilt when all nodes are freed.
+     * @param step_budget   Count of nodes to visit and free.
+     * @return              true if work is left for next call.
+     */
+    inline bool compact( size_t step_budget )
+    {
+        bool left = tree_t::compact( step_budget );
+        if ( !left )
+            rebuild();
+        return left;
+    }
+
+
+    /**
+     * @brief rebuild   Forget removed keys and size filter for twice the
+     *                  current count of keys.
+     */
+    void rebuild()
+    {
+        size_t count = 0;
+        for ( auto it = first(); it != tree_t::end(); ++it )
+            ++count;
+
+        filter.reset( std::max<size_t>( count * 2, filter.key_bits().capacity() ) );
+        for ( auto it = first(); it != tree_t::end(); ++it )
+            filter.insert( it.get_key() );
+    }
+
+
+    /// @brief get_filter   Filter of keys.
+    inline const key_filter& get_filter() const { return filter; }
+
+
+    /// @brief filter_stats     Keys, memory and estimated false positive rate.
+    inline filter_info filter_stats() const
+    {
+        return filter_info{
+            filter.key_bits().size(),
+            filter.memory_usage(),
+            filter.key_bits().estimated_false_positive_rate(),
+            filter.get_options().prefix_lengths.empty() ? 1.0 : filter.prefix_bits().estimated_false_positive_rate()
+        };
+    }
+
+private:
+    inline bool may_contain( const std::string &key, bool finite_node ) const
+    {
+        return finite_node ? filter.may_contain( key ) : filter.may_contain_prefix( key );
+    }
+
+
+    inline void add( const std::string &key )
+    {
+        filter.insert( key );
+        if ( filter.key_bits().size() > filter.key_bits().capacity() )
+            rebuild();
+    }
+
+
+    inline iterator first()
+    {
+        if constexpr ( IS_SET )
+            return tree_t::begin( true );
+        else
+            return tree_t::begin();
+    }
+};
+
+
+typedef filtered_tree<prefix_tree>          filtered_prefix_tree;
+
+template <typename value_type>
+using filtered_prefix_tree_map = filtered_tree<prefix_tree_map<value_type>>;
+
+
+} // namespace prefix_tree
+
+#endif // FILTERED_PREFIX_TREE_H
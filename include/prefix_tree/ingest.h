@@ -0,0 +1,179 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "prefix_tree.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The bounded_queue class   Blocking FIFO of limited size between
+ *                                  stages of pipeline.
+ * @param value_type                Type of item.
+ */
+template <typename value_type>
+class bounded_queue
+{
+private:
+    std::mutex                              lock;
+    std::condition_variable                 not_empty;
+    std::condition_variable                 not_full;
+    std::deque<value_type>                  items;
+    size_t                                  capacity;
+    bool                                    closed;
+
+public:
+    explicit bounded_queue( size_t capacity_ ) : lock(), not_empty(), not_full(), items(), capacity( capacity_ ), closed( false ) {}
+
+    bounded_queue( const bounded_queue & ) = delete;
+    bounded_queue& operator=( const bounded_queue & ) = delete;
+
+
+    /**
+     * @brief push      Wait for free place and add item.
+     * @return          false if queue is closed.
+     */
+    bool push( value_type &&item )
+    {
+        std::unique_lock<std::mutex> guard( lock );
+        not_full.wait( guard, [this] () { return closed || items.size() < capacity; } );
+        if ( closed )
+            return false;
+
+        items.push_back( std::move( item ) );
+        not_empty.notify_one();
+        return true;
+    }
+
+
+    /**
+     * @brief pop       Wait for item.
+     * @return          false if queue is closed and empty.
+     */
+    bool pop( value_type &item )
+    {
+        std::unique_lock<std::mutex> guard( lock );
+        not_empty.wait( guard, [this] () { return closed || !items.empty(); } );
+        if ( items.empty() )
+            return false;
+
+        item = std::move( items.front() );
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+
+    /// @brief close    Wake all waiters, items left are still popped.
+    void close()
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+};
+
+
+/**
+ * @brief The ingest_options struct     Options of ingest().
+ */
+struct ingest_options
+{
+    /// @brief chunk_bytes      Size of chunk read from input.
+    size_t                                  chunk_bytes;
+    /// @brief parse_threads    Count of threads parsing and sorting chunks,
+    ///                         0 is count of CPU less one.
+    size_t                                  parse_threads;
+    /// @brief queue_depth      Capacity of queues between stages in chunks.
+    size_t                                  queue_depth;
+
+    ingest_options() : chunk_bytes( 4 << 20 ), parse_threads( 0 ), queue_depth( 4 ) {}
+};
+
+
+/**
+ * @brief The ingest_stats struct   Result of ingest().
+ */
+struct ingest_stats
+{
+    /**
+     * @brief The stage struct      Work of stage.
+     */
+    struct stage
+    {
+        const char                         *name;
+        size_t                              threads;
+        /// @brief busy_seconds     Time of work summed over threads, waits
+        ///                         on queues are excluded.
+        double                              busy_seconds;
+
+        /// @brief utilization      Share of wall time threads of stage were busy.
+        inline double utilization( double wall_seconds ) const
+        {
+            return wall_seconds > 0 && threads ? busy_seconds / ( wall_seconds * threads ) : 0;
+        }
+    };
+
+    size_t                                  bytes;
+    size_t                                  chunks;
+    /// @brief keys         Count of non empty lines.
+    size_t                                  keys;
+    /// @brief appended     Count of keys which were absent in tree.
+    size_t                                  appended;
+    double                                  seconds;
+
+    stage                                   read;
+    stage                                   parse;
+    stage                                   insert;
+
+    /**
+     * @brief write     Export as text: totals, keys/s and utilization of stages.
+     * @param out       Output stream.
+     */
+    void write( std::ostream &out ) const;
+};
+
+
+/**
+ * @brief ingest    Load newline delimited keys to tree. Stages are
+ *                  connected by bounded queues and work in parallel:
+ *                  chunked read of input, parse and sort of every chunk
+ *                  by pool of threads, insert of sorted chunks to the
+ *                  tree by append_sorted() in one thread. Trailing '\r'
+ *                  of line is dropped, empty lines are skipped.
+ *                  Errors of I/O are thrown as std::system_error.
+ * @param tree      Tree, it is not accessed by other threads meanwhile.
+ * @param fd        Input file descriptor.
+ * @param opts      Options.
+ * @return          Statistics.
+ */
+ingest_stats ingest( prefix_tree &tree, int fd, const ingest_options &opts = ingest_options() );
+
+
+/**
+ * @brief ingest    Load newline delimited keys from file to tree.
+ * @param path      Path of file, "-" is standard input.
+ */
+ingest_stats ingest( prefix_tree &tree, const std::string &path, const ingest_options &opts = ingest_options() );
+
+
+} // namespace prefix_tree
+
+#endif // INGEST_H
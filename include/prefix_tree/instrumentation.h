@@ -0,0 +1,273 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The operation enum   Instrumented operations of tree.
+ */
+enum class operation : uint8_t
+{
+    FIND = 0,
+    APPEND,
+    REMOVE,
+    COUNT
+};
+
+
+/*
+ * Instrumentation policy is a template parameter of prefix_tree_map and
+ * instrumented_prefix_tree. Policy provides class probe constructed for
+ * every operation; tree calls probe.visit() for every node on the way and
+ * probe.allocate() for every new node. Internals of tree which take probe
+ * are templates of prefix_tree.h, so user defined policies work as the
+ * ones declared here.
+ */
+
+
+/**
+ * @brief The no_instrumentation struct     Default policy. Probe does nothing
+ *                                          and is optimized out.
+ */
+struct no_instrumentation
+{
+    class probe
+    {
+    public:
+        explicit probe( operation ) {}
+
+        /// @brief visit        Node is visited.
+        inline void visit() {}
+        /// @brief allocate     Node is allocated.
+        inline void allocate() {}
+    };
+};
+
+
+/**
+ * @brief The latency_histogram class   Log-linear histogram of nanoseconds
+ *                                      (HDR style, 16 sub-buckets per power
+ *                                      of two, relative error below 6.25%).
+ */
+class latency_histogram
+{
+public:
+    static constexpr unsigned int           SUB_BITS = 4;
+    static constexpr unsigned int           SUB      = 1u << SUB_BITS;
+    static constexpr unsigned int           MAX_EXP  = 48;
+    static constexpr unsigned int           BUCKETS  = SUB + ( MAX_EXP - SUB_BITS + 1 ) * SUB;
+
+private:
+    std::array<uint64_t, BUCKETS>           counts;
+    uint64_t                                total;
+    uint64_t                                max_value;
+
+public:
+    latency_histogram() : counts(), total( 0 ), max_value( 0 ) {}
+
+
+    /// @brief bucket   Index of bucket of value.
+    static inline unsigned int bucket( uint64_t value )
+    {
+        if ( value < SUB )
+            return static_cast<unsigned int>( value );
+
+        unsigned int e = 63 - static_cast<unsigned int>( __builtin_clzll( value ) );
+        if ( e > MAX_EXP )
+            return BUCKETS - 1;
+
+        unsigned int mantissa = static_cast<unsigned int>( value >> ( e - SUB_BITS ) ) - SUB;
+        return SUB + ( e - SUB_BITS ) * SUB + mantissa;
+    }
+
+
+    /// @brief lower_bound  Lowest value of bucket.
+    static inline uint64_t lower_bound( unsigned int index )
+    {
+        if ( index < SUB )
+            return index;
+
+        unsigned int e        = ( index - SUB ) / SUB + SUB_BITS;
+        unsigned int mantissa = ( index - SUB ) % SUB;
+        return static_cast<uint64_t>( SUB + mantissa ) << ( e - SUB_BITS );
+    }
+
+
+    /**
+     * @brief add       Add count to bucket.
+     * @param index     Bucket.
+     * @param count     Count of values.
+     */
+    inline void add( unsigned int index, uint64_t count )
+    {
+        counts[ index ] += count;
+        total           += count;
+    }
+
+
+    /// @brief record   Add value.
+    inline void record( uint64_t value )
+    {
+        add( bucket( value ), 1 );
+        if ( value > max_value )
+            max_value = value;
+    }
+
+
+    /// @brief merge    Add values of other histogram.
+    void merge( const latency_histogram &other );
+
+
+    /// @brief count    Count of values.
+    inline uint64_t count() const { return total; }
+
+
+    /// @brief max      Maximal value.
+    inline uint64_t max() const { return max_value; }
+
+
+    /// @brief set_max  Set maximal value (used on aggregation).
+    inline void set_max( uint64_t value ) { max_value = value; }
+
+
+    /**
+     * @brief percentile    Value at percentile.
+     * @param p             Percentile in [0, 100].
+     * @return              Lowest value of bucket with the percentile.
+     */
+    uint64_t percentile( double p ) const;
+};
+
+
+/**
+ * @brief The latency_instrumentation struct    Policy counting operations,
+ *                                              visited nodes, allocations,
+ *                                              depth and latency.
+ *
+ * Every thread writes to its own counters. snapshot() aggregates counters
+ * of all threads including finished ones.
+ */
+struct latency_instrumentation
+{
+    /**
+     * @brief The counters struct   Counters of one operation of one thread.
+     *                              Written by owner thread only.
+     */
+    struct counters
+    {
+        std::atomic<uint64_t>                                   operations;
+        std::atomic<uint64_t>                                   nodes_visited;
+        std::atomic<uint64_t>                                   allocations;
+        std::atomic<uint64_t>                                   max_depth;
+        std::atomic<uint64_t>                                   max_latency;
+        std::array<std::atomic<uint64_t>, latency_histogram::BUCKETS> latency;
+
+        counters();
+    };
+
+
+    /**
+     * @brief The operation_stats struct    Aggregated counters of operation.
+     */
+    struct operation_stats
+    {
+        uint64_t                            operations;
+        uint64_t                            nodes_visited;
+        uint64_t                            allocations;
+        uint64_t                            max_depth;
+        latency_histogram                   latency;
+
+        operation_stats() : operations( 0 ), nodes_visited( 0 ), allocations( 0 ), max_depth( 0 ), latency() {}
+    };
+
+
+    /**
+     * @brief The snapshot struct   Aggregated counters of all operations.
+     */
+    struct snapshot
+    {
+        std::array<operation_stats, static_cast<size_t>( operation::COUNT )> operations;
+
+        inline const operation_stats& operator[]( operation op ) const
+        {
+            return operations[ static_cast<size_t>( op ) ];
+        }
+
+        /**
+         * @brief write     Export as text, one line per operation.
+         * @param out       Output stream.
+         */
+        void write( std::ostream &out ) const;
+    };
+
+
+    class probe
+    {
+    private:
+        std::chrono::steady_clock::time_point   started;
+        uint64_t                                visited;
+        uint64_t                                allocated;
+        operation                               op;
+
+    public:
+        explicit probe( operation op_ )
+            : started( std::chrono::steady_clock::now() ), visited( 0 ), allocated( 0 ), op( op_ )
+        {
+        }
+
+        probe( const probe & ) = delete;
+        probe& operator=( const probe & ) = delete;
+
+        ~probe()
+        {
+            uint64_t ns = static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - started
+                        ).count()
+            );
+            latency_instrumentation::record( op, visited, allocated, ns );
+        }
+
+        inline void visit() { ++visited; }
+        inline void allocate() { ++allocated; }
+    };
+
+
+    /**
+     * @brief record        Add operation to counters of current thread.
+     * @param op            Operation.
+     * @param visited       Count of visited nodes (depth reached).
+     * @param allocated     Count of allocated nodes.
+     * @param ns            Latency.
+     */
+    static void record( operation op, uint64_t visited, uint64_t allocated, uint64_t ns );
+
+
+    /// @brief take_snapshot    Aggregate counters of all threads.
+    static snapshot take_snapshot();
+
+
+    /// @brief reset    Reset counters of all threads.
+    static void reset();
+};
+
+
+} // namespace prefix_tree
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,130 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef INSTRUMENTED_PREFIX_TREE_H
+#define INSTRUMENTED_PREFIX_TREE_H
+
+#include "prefix_tree.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The instrumented_prefix_tree class    prefix_tree with append,
+ *                                              find, exists and remove
+ *                                              measured by policy.
+ * @param instrumentation_t                     Instrumentation policy
+ *                                              (see instrumentation.h).
+ */
+template <typename instrumentation_t>
+class instrumented_prefix_tree : public prefix_tree
+{
+public:
+    instrumented_prefix_tree() : prefix_tree() {}
+    virtual ~instrumented_prefix_tree() = default;
+
+
+    /**
+     * @brief append        Append new chain to prefix tree.
+     * @param key           Key to append.
+     * @return              true if append is successful.
+     */
+    inline bool append( const char *key )
+    {
+        typename instrumentation_t::probe probe( operation::APPEND );
+        return append_node( key, probe ).second;
+    }
+
+
+    /**
+     * @brief append        Append new chain to prefix tree.
+     * @param key           Key to append.
+     * @return              true if append is successful.
+     */
+    inline bool append( const std::string &key )
+    {
+        return append( key.c_str() );
+    }
+
+
+    /**
+     * @brief remove        Remove key from the prefix tree.
+     * @param key           Key of node.
+     */
+    inline void remove( const char *key )
+    {
+        typename instrumentation_t::probe probe( operation::REMOVE );
+        remove_key( key, probe );
+    }
+
+
+    /**
+     * @brief remove        Remove key from the prefix tree.
+     * @param key           Key of node.
+     */
+    inline void remove( const std::string &key )
+    {
+        remove( key.c_str() );
+    }
+
+
+    /**
+     * @brief exists        Check key or prefix is exist.
+     * @param key           Key ot prefix.
+     * @param finite_node   If true looking for finite node only else prefix or finite node.
+     * @return              true if key or prefix is exist.
+     */
+    inline bool exists( const char *key, bool finite_node = true ) const
+    {
+        typename instrumentation_t::probe probe( operation::FIND );
+        return find_node( key, finite_node, probe ) != nullptr;
+    }
+
+
+    /**
+     * @brief exists        Check key or prefix is exist.
+     * @param key           Key ot prefix.
+     * @param finite_node   If true looking for finite node only else prefix or finite node.
+     * @return              true if key or prefix is exist.
+     */
+    inline bool exists( const std::string &key, bool finite_node = true ) const
+    {
+        return exists( key.c_str(), finite_node );
+    }
+
+
+    /**
+     * @brief find          Find key in tree.
+     * @param key           Key whose looking for.
+     * @param finite_node   If true find finite node only.
+     * @return              Iterator of found node or end().
+     */
+    inline iterator find( const char *key, bool finite_node = true )
+    {
+        typename instrumentation_t::probe probe( operation::FIND );
+        return prefix_tree::find( key, finite_node, probe );
+    }
+
+
+    /**
+     * @brief find          Find key in tree.
+     * @param key           Key whose looking for.
+     * @param finite_node   If true find finite node only.
+     * @return              Iterator of found node or end().
+     */
+    inline iterator find( const std::string &key, bool finite_node = true )
+    {
+        return find( key.c_str(), finite_node );
+    }
+};
+
+
+} // namespace prefix_tree
+
+#endif // INSTRUMENTED_PREFIX_TREE_H
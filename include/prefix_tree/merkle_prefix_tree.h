@@ -0,0 +1,248 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef MERKLE_PREFIX_TREE_H
+#define MERKLE_PREFIX_TREE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "prefix_tree.h"
+#include "write_ahead_log.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The merkle_prefix_tree class  prefix_tree whose every node keeps
+ *                                      hash of its subtree, so equal
+ *                                      subtrees of two trees are detected
+ *                                      without visiting them.
+ *
+ * Hash of node is sum of FINITE_HASH if node is finite and of mixed label
+ * and hash of every child. Sum does not depend on order of children, so
+ * change of key updates hashes of nodes of its path only: O( length of
+ * key ). Hash of subtree does not depend on its position in tree. Hashes
+ * are not cryptographic, they detect changes, not forgeries.
+ *
+ * Hashes are kept by append, remove and remove_prefix. Operations which
+ * move nodes in bulk (relayout) rehash the tree.
+ */
+class merkle_prefix_tree : protected prefix_tree
+{
+public:
+    using prefix_tree::iterator;
+    using prefix_tree::memory_usage_info;
+    using prefix_tree::statistics;
+    using prefix_tree::operator new;
+    using prefix_tree::operator delete;
+
+    using prefix_tree::exists;
+    using prefix_tree::lower_bound;
+    using prefix_tree::upper_bound;
+    using prefix_tree::range;
+    using prefix_tree::begin;
+    using prefix_tree::end;
+    using prefix_tree::memory_usage;
+    using prefix_tree::stats;
+
+    /// @brief callback     Function( const std::string &key, log_op op ) of diff().
+    typedef std::function<void( const std::string&, log_op )> diff_callback;
+
+private:
+    /// @brief FINITE_HASH  Share of key ending in node.
+    static constexpr uint64_t               FINITE_HASH = 0x6A09E667F3BCC909ull;
+
+    uint64_t                                hash;
+
+public:
+    merkle_prefix_tree() : prefix_tree(), hash( 0 ) {}
+    virtual ~merkle_prefix_tree() = default;
+
+
+    /**
+     * @brief append        Append key.
+     * @param key           Key.
+     * @return              true if append is successful.
+     */
+    bool append( const char *key );
+
+
+    /**
+     * @brief append        Append key.
+     * @param key           Key.
+     * @return              true if append is successful.
+     */
+    inline bool append( const std::string &key )
+    {
+        return append( key.c_str() );
+    }
+
+
+    /**
+     * @brief remove        Remove key.
+     * @param key           Key.
+     */
+    void remove( const char *key );
+
+
+    /**
+     * @brief remove        Remove key.
+     * @param key           Key.
+     */
+    inline void remove( const std::string &key )
+    {
+        remove( key.c_str() );
+    }
+
+
+    /**
+     * @brief remove_prefix Remove all keys started with prefix.
+     * @param prefix        Prefix.
+     */
+    void remove_prefix( const char *prefix );
+
+
+    /**
+     * @brief remove_prefix Remove all keys started with prefix.
+     * @param prefix        Prefix.
+     */
+    inline void remove_prefix( const std::string &prefix )
+    {
+        remove_prefix( prefix.c_str() );
+    }
+
+
+    /**
+     * @brief find          Find key in tree.
+     * @param key           Key whose looking for.
+     * @param finite_node   If true find finite node only.
+     * @return              Iterator of found node or end().
+     */
+    inline iterator find( const std::string &key, bool finite_node = true )
+    {
+        return prefix_tree::find( key, finite_node );
+    }
+
+
+    /// @brief relayout     See prefix_tree::relayout(), tree is rehashed.
+    void relayout();
+
+
+    /// @brief root_hash    Hash of all keys, equal trees have equal hashes.
+    inline uint64_t root_hash() const { return hash; }
+
+
+    /**
+     * @brief subtree_hash  Hash of keys started with prefix, relative to
+     *                      prefix.
+     * @param prefix        Prefix.
+     * @return              Hash or 0 if there are no such keys.
+     */
+    uint64_t subtree_hash( const std::string &prefix ) const;
+
+
+    /// @brief rehash   Compute hashes of all nodes again.
+    void rehash();
+
+
+    /**
+     * @brief diff      Keys to append to and remove from one tree to get
+     *                  other. Subtrees with equal hashes are skipped, so
+     *                  cost is bound by count of changed keys, their
+     *                  length and fan-out of their paths.
+     * @param from      Source tree.
+     * @param to        Target tree.
+     * @param callback  Called with log_op::APPEND for keys of target only
+     *                  and log_op::REMOVE for keys of source only, in
+     *                  order of keys.
+     * @return          Count of pairs of nodes compared.
+     */
+    static size_t diff( const merkle_prefix_tree &from, const merkle_prefix_tree &to, const diff_callback &callback );
+
+
+    /**
+     * @brief encode_delta  Encode diff() of trees to apply to copy of source.
+     *
+     * Delta: u64 hash of source, u64 hash of target, u32 CRC-32C of
+     * records, records of u8 operation, u32 size of key and key. Integers
+     * are little endian.
+     *
+     * @param from          Source tree.
+     * @param to            Target tree.
+     * @return              Delta.
+     */
+    static std::string encode_delta( const merkle_prefix_tree &from, const merkle_prefix_tree &to );
+
+
+    /**
+     * @brief apply_delta   Apply delta of encode_delta() to tree equal to
+     *                      its source. Structure and CRC of delta are
+     *                      checked before the tree is changed, changes
+     *                      are undone if result is not the target.
+     * @param delta         Delta.
+     * @return              false if tree is not the source of delta or
+     *                      delta is corrupted, tree is not changed then.
+     */
+    bool apply_delta( const std::string &delta );
+
+protected:
+    virtual prefix_tree *new_node() override;
+    virtual size_t node_size() const override;
+
+private:
+    static inline merkle_prefix_tree* cast( prefix_tree *node )
+    {
+        return static_cast<merkle_prefix_tree*>( node );
+    }
+
+
+    static inline const merkle_prefix_tree* cast( const prefix_tree *node )
+    {
+        return static_cast<const merkle_prefix_tree*>( node );
+    }
+
+
+    /// @brief edge_hash    Share of child in hash of parent, 0 for empty child.
+    static inline uint64_t edge_hash( unsigned char label, uint64_t child )
+    {
+        if ( !child )
+            return 0;
+
+        uint64_t h = child ^ ( ( label + 1ull ) * 0x9E3779B97F4A7C15ull );
+        h = ( h ^ ( h >> 30 ) ) * 0xBF58476D1CE4E5B9ull;
+        h = ( h ^ ( h >> 27 ) ) * 0x94D049BB133111EBull;
+        return ( h ^ ( h >> 31 ) ) | 1;
+    }
+
+
+    /**
+     * @brief update_path   Set hash of last node of path and update hashes
+     *                      of its ancestors.
+     * @param path          Nodes of prefixes of key, path[ i ] is node of
+     *                      prefix of length i.
+     * @param key           Key.
+     * @param hash_         New hash of last node.
+     */
+    static void update_path( const std::vector<merkle_prefix_tree*> &path, const char *key, uint64_t hash_ );
+
+
+    /**
+     * @brief find_path     Nodes of prefixes of key.
+     * @return              false if there is no node of key.
+     */
+    bool find_path( const char *key, std::vector<merkle_prefix_tree*> &path );
+};
+
+
+} // namespace prefix_tree
+
+#endif // MERKLE_PREFIX_TREE_H
@@ -0,0 +1,127 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The node_arena class      Contiguous buffer for nodes and blocks of
+ *                                  children laid out by prefix_tree::relayout().
+ *
+ * Memory is taken by bump pointer while arena is current in thread (see
+ * scope). Memory of single allocation is not reused: freed slots stay
+ * taken until all allocations of arena are deallocated and its owner has
+ * released it, then the whole arena is freed.
+ * Arenas are registered so deallocate() finds owner of any pointer. The
+ * search takes shared lock, so callers flag memory of arena (see
+ * child_nodes) and call deallocate() for flagged memory only.
+ */
+class node_arena
+{
+public:
+    /// @brief ALIGN        Alignment of allocations.
+    static constexpr size_t                 ALIGN = alignof( void* );
+
+private:
+    char                                   *begin;
+    char                                   *end;
+    char                                   *top;
+    /// @brief live         Count of allocations plus reference of owner.
+    std::atomic<size_t>                     live;
+
+    explicit node_arena( size_t bytes );
+    ~node_arena();
+
+public:
+    node_arena( const node_arena & ) = delete;
+    node_arena& operator=( const node_arena & ) = delete;
+
+
+    /**
+     * @brief The scope class   Makes arena current in thread for lifetime
+     *                          of scope.
+     */
+    class scope
+    {
+    private:
+        node_arena     *previous;
+
+    public:
+        explicit scope( node_arena *arena );
+        ~scope();
+
+        scope( const scope & ) = delete;
+        scope& operator=( const scope & ) = delete;
+    };
+
+
+    /// @brief align        Size rounded up to ALIGN.
+    static inline size_t align( size_t bytes )
+    {
+        return ( bytes + ALIGN - 1 ) & ~( ALIGN - 1 );
+    }
+
+
+    /**
+     * @brief create        Create and register arena.
+     * @param bytes         Size of buffer.
+     * @return              Arena owned by caller (see release()).
+     */
+    static node_arena* create( size_t bytes );
+
+
+    /**
+     * @brief release       Drop reference of owner. Arena is freed when
+     *                      all its allocations are deallocated.
+     */
+    void release();
+
+
+    /// @brief used         Bytes taken from arena.
+    inline size_t used() const { return static_cast<size_t>( top - begin ); }
+
+
+    /**
+     * @brief allocate      Take memory from current arena of thread.
+     * @param bytes         Size.
+     * @return              Memory or nullptr if there is no current
+     *                      arena or it is exhausted.
+     */
+    static void* allocate( size_t bytes );
+
+
+    /**
+     * @brief deallocate    Return memory to its arena.
+     * @param p             Memory.
+     * @return              false if memory does not belong to any arena.
+     */
+    static bool deallocate( void *p );
+
+
+    /**
+     * @brief in_current    Check memory is taken from current arena of thread.
+     * @param p             Memory.
+     */
+    static bool in_current( const void *p );
+
+private:
+    /// @brief unref        Drop one reference, free arena if it was last.
+    void unref();
+};
+
+
+} // namespace prefix_tree
+
+#endif // NODE_ARENA_H
@@ -0,0 +1,454 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef PERSISTENT_PREFIX_TREE_MAP_H
+#define PERSISTENT_PREFIX_TREE_MAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The persistent_prefix_tree_map class  Versioned key => value
+ *                                              container implemented as
+ *                                              prefix tree with shared nodes.
+ *
+ * Object of the class is a version of map. snapshot() returns other version
+ * sharing all nodes in O(1). Update copies only nodes on the path from root
+ * to the key which are shared with other versions, nodes owned by the
+ * version only are changed in place. Values are shared between versions
+ * and never copied by update of other keys.
+ *
+ * Versions may be used from different threads without locking: shared
+ * nodes are immutable and reference counters are atomic. One version must
+ * not be changed and used from different threads at the same time.
+ *
+ * @param value_type            Type of value.
+ */
+template <typename value_type>
+class persistent_prefix_tree_map
+{
+private:
+    struct node;
+
+    struct edge
+    {
+        unsigned char                       label;
+        node                               *child;
+    };
+
+
+    /**
+     * @brief The node struct   Node with reference counter. Every edge holds
+     *                          one reference of its child.
+     */
+    struct node
+    {
+        std::atomic<size_t>                 refs;
+        /// @brief value    Value of finite node or nullptr.
+        std::shared_ptr<const value_type>   value;
+        /// @brief next     Edges sorted by label.
+        std::vector<edge>                   next;
+
+        node() : refs( 1 ), value(), next() {}
+
+        /// @brief node     Copy of other node sharing its children and value.
+        node( const node &other ) : refs( 1 ), value( other.value ), next( other.next )
+        {
+            for ( const edge &e : next )
+                acquire( e.child );
+        }
+
+        node& operator=( const node & ) = delete;
+
+
+        /// @brief lower_bound  Index of first edge with label not less than c.
+        inline size_t lower_bound( unsigned char c ) const
+        {
+            return static_cast<size_t>(
+                        std::lower_bound(
+                            next.begin(),
+                            next.end(),
+                            c,
+                            [] ( const edge &e, unsigned char l ) { return e.label < l; }
+                        ) - next.begin()
+            );
+        }
+
+
+        /// @brief get          Child with label c or nullptr.
+        inline node* get( unsigned char c ) const
+        {
+            size_t i = lower_bound( c );
+            return i < next.size() && next[ i ].label == c ? next[ i ].child : nullptr;
+        }
+    };
+
+
+    node                                   *root;
+    size_t                                  count;
+
+public:
+    persistent_prefix_tree_map() : root( new node() ), count( 0 ) {}
+
+    persistent_prefix_tree_map( const persistent_prefix_tree_map &other ) : root( other.root ), count( other.count )
+    {
+        acquire( root );
+    }
+
+    persistent_prefix_tree_map( persistent_prefix_tree_map &&other ) : root( new node() ), count( 0 )
+    {
+        swap( other );
+    }
+
+    ~persistent_prefix_tree_map()
+    {
+        release( root );
+    }
+
+
+    inline persistent_prefix_tree_map& operator=( persistent_prefix_tree_map other )
+    {
+        swap( other );
+        return *this;
+    }
+
+
+    inline void swap( persistent_prefix_tree_map &other )
+    {
+        std::swap( root, other.root );
+        std::swap( count, other.count );
+    }
+
+
+    /**
+     * @brief snapshot      O(1) version which is not affected by following
+     *                      updates of the map.
+     */
+    inline persistent_prefix_tree_map snapshot() const
+    {
+        return persistent_prefix_tree_map( *this );
+    }
+
+
+    /// @brief size     Count of keys.
+    inline size_t size() const { return count; }
+
+
+    inline bool empty() const { return !count; }
+
+
+    /**
+     * @brief find      Find value by key.
+     * @param key       Key.
+     * @return          Pointer to value or nullptr. Value lives while
+     *                  any version keeps it.
+     */
+    const value_type* find( const char *key ) const
+    {
+        const node *n = find_node( key );
+        return n ? n->value.get() : nullptr;
+    }
+
+
+    inline const value_type* find( const std::string &key ) const
+    {
+        return find( key.c_str() );
+    }
+
+
+    /**
+     * @brief exists        Check key or prefix is exist.
+     * @param key           Key ot prefix.
+     * @param finite_node   If true looking for key only else prefix or key.
+     */
+    inline bool exists( const char *key, bool finite_node = true ) const
+    {
+        const node *n = find_node( key );
+        return n && ( !finite_node || n->value );
+    }
+
+
+    inline bool exists( const std::string &key, bool finite_node = true ) const
+    {
+        return exists( key.c_str(), finite_node );
+    }
+
+
+    /**
+     * @brief insert_or_assign  Set value of key.
+     * @param key               Key.
+     * @param value_            Value.
+     * @return                  true if key has been appended.
+     */
+    template <typename arg_t>
+    inline bool insert_or_assign( const char *key, arg_t &&value_ )
+    {
+        return key && set_value( key, std::make_shared<const value_type>( std::forward<arg_t>( value_ ) ) );
+    }
+
+
+    template <typename arg_t>
+    inline bool insert_or_assign( const std::string &key, arg_t &&value_ )
+    {
+        return insert_or_assign( key.c_str(), std::forward<arg_t>( value_ ) );
+    }
+
+
+    /**
+     * @brief try_emplace   Append key with value constructed from args if
+     *                      key is absent. Nothing is copied if key is present.
+     * @return              true if key has been appended.
+     */
+    template <typename... args_t>
+    bool try_emplace( const char *key, args_t&&... args )
+    {
+        if ( !key || exists( key ) )
+            return false;
+
+        return set_value( key, std::make_shared<const value_type>( std::forward<args_t>( args )... ) );
+    }
+
+
+    template <typename... args_t>
+    inline bool try_emplace( const std::string &key, args_t&&... args )
+    {
+        return try_emplace( key.c_str(), std::forward<args_t>( args )... );
+    }
+
+
+    /**
+     * @brief remove    Remove key. Nothing is copied if key is absent.
+     * @param key       Key.
+     * @return          true if key has been removed.
+     */
+    bool remove( const char *key )
+    {
+        if ( !key || !*key )
+            return false;
+
+        // Deepest node which stays (root, key or branch) and its depth.
+        size_t      keep_pos = 0;
+        const node *cur      = root;
+        size_t      len      = 0;
+
+        for ( ; key[ len ]; ++len )
+        {
+            if ( cur->value || cur->next.size() > 1 )
+                keep_pos = len;
+
+            cur = cur->get( static_cast<unsigned char>( key[ len ] ) );
+            if ( !cur )
+                return false;
+        }
+
+        if ( !cur->value )
+            return false;
+
+        bool   leaf  = cur->next.empty();
+        size_t depth = leaf ? keep_pos : len;
+
+        node *w = writable( root );
+        for ( size_t pos = 0; pos < depth; ++pos )
+            w = writable( w->next[ w->lower_bound( static_cast<unsigned char>( key[ pos ] ) ) ].child );
+
+        if ( leaf )
+        {
+            size_t i     = w->lower_bound( static_cast<unsigned char>( key[ keep_pos ] ) );
+            node  *chain = w->next[ i ].child;
+            w->next.erase( w->next.begin() + i );
+            release( chain );
+        }
+        else
+            w->value.reset();
+
+        --count;
+        return true;
+    }
+
+
+    inline bool remove( const std::string &key )
+    {
+        return remove( key.c_str() );
+    }
+
+
+    /**
+     * @brief for_each      Visit keys started with prefix in order.
+     * @param prefix        Prefix.
+     * @param callback      Function( const std::string &key, const value_type &value ).
+     */
+    template <typename callback_t>
+    void for_each( const char *prefix, callback_t &&callback ) const
+    {
+        const node *start = find_node( prefix );
+        if ( !start )
+            return;
+
+        // Stack of nodes with depth, key is restored from symbols.
+        std::vector<std::pair<const node*, size_t> >    stack( 1, std::make_pair( start, size_t( 0 ) ) );
+        std::vector<unsigned char>                      labels( 1, 0 );
+        std::string                                     key( prefix );
+        size_t                                          base = key.size();
+
+        while ( !stack.empty() )
+        {
+            const node     *n     = stack.back().first;
+            size_t          depth = stack.back().second;
+            unsigned char   label = labels.back();
+            stack.pop_back();
+            labels.pop_back();
+
+            key.resize( base + depth );
+            if ( depth )
+                key[ base + depth - 1 ] = static_cast<char>( label );
+
+            if ( n->value )
+                callback( static_cast<const std::string&>( key ), *n->value );
+
+            for ( size_t i = n->next.size(); i-- > 0; )
+            {
+                stack.emplace_back( n->next[ i ].child, depth + 1 );
+                labels.push_back( n->next[ i ].label );
+            }
+        }
+    }
+
+
+    template <typename callback_t>
+    inline void for_each( callback_t &&callback ) const
+    {
+        for_each( "", std::forward<callback_t>( callback ) );
+    }
+
+
+    /**
+     * @brief unshared_nodes    Count nodes of the version which are not
+     *                          shared with other version, i.e. memory added
+     *                          by updates since snapshot. Shared subtrees
+     *                          are skipped.
+     * @param base              Other version.
+     */
+    size_t unshared_nodes( const persistent_prefix_tree_map &base ) const
+    {
+        size_t result = 0;
+
+        std::vector<std::pair<const node*, const node*> > stack( 1, std::make_pair( root, base.root ) );
+        while ( !stack.empty() )
+        {
+            const node *mine   = stack.back().first;
+            const node *theirs = stack.back().second;
+            stack.pop_back();
+
+            if ( mine == theirs )
+                continue;
+
+            ++result;
+            for ( const edge &e : mine->next )
+                stack.emplace_back( e.child, theirs ? theirs->get( e.label ) : nullptr );
+        }
+
+        return result;
+    }
+
+private:
+    static inline void acquire( node *n )
+    {
+        n->refs.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+
+    /// @brief release  Drop reference, delete nodes without references iteratively.
+    static void release( node *n )
+    {
+        std::vector<node*> stack( 1, n );
+        while ( !stack.empty() )
+        {
+            node *cur = stack.back();
+            stack.pop_back();
+
+            if ( cur->refs.fetch_sub( 1, std::memory_order_acq_rel ) != 1 )
+                continue;
+
+            for ( const edge &e : cur->next )
+                stack.push_back( e.child );
+            delete cur;
+        }
+    }
+
+
+    /**
+     * @brief writable  Node of slot owned by the version only. Shared node
+     *                  is replaced by its copy. Parent of slot must be
+     *                  writable already.
+     * @param slot      Reference to pointer of node.
+     */
+    static node* writable( node *&slot )
+    {
+        if ( slot->refs.load( std::memory_order_acquire ) == 1 )
+            return slot;
+
+        node *copy = new node( *slot );
+        release( slot );
+        slot = copy;
+        return copy;
+    }
+
+
+    /**
+     * @brief set_value     Set value of key copying shared nodes of path.
+     * @return              true if key has been appended.
+     */
+    bool set_value( const char *key, std::shared_ptr<const value_type> &&value )
+    {
+        node *cur = writable( root );
+        for ( ; *key; ++key )
+        {
+            unsigned char c = static_cast<unsigned char>( *key );
+            size_t        i = cur->lower_bound( c );
+
+            if ( i < cur->next.size() && cur->next[ i ].label == c )
+                cur = writable( cur->next[ i ].child );
+            else
+            {
+                node *child = new node();
+                cur->next.insert( cur->next.begin() + i, edge{ c, child } );
+                cur = child;
+            }
+        }
+
+        bool appended = !cur->value;
+        cur->value    = std::move( value );
+        count        += appended;
+        return appended;
+    }
+
+
+    const node* find_node( const char *key ) const
+    {
+        if ( !key )
+            return nullptr;
+
+        const node *cur = root;
+        for ( ; *key && cur; ++key )
+            cur = cur->get( static_cast<unsigned char>( *key ) );
+        return cur;
+    }
+};
+
+
+} // namespace prefix_tree
+
+#endif // PERSISTENT_PREFIX_TREE_MAP_H
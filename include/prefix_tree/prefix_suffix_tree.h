@@ -0,0 +1,193 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef PREFIX_SUFFIX_TREE_H
+#define PREFIX_SUFFIX_TREE_H
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "prefix_tree.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The prefix_suffix_tree class  Set of keys kept twice: as is and
+ *                                      reversed, so keys which end with
+ *                                      suffix are a subtree of reversed
+ *                                      keys instead of full scan.
+ *
+ * Memory is about twice memory of prefix_tree of the same keys.
+ */
+class prefix_suffix_tree
+{
+public:
+    /**
+     * @brief The suffix_iterator class     Iterator of reversed keys,
+     *                                      get_key() returns key in
+     *                                      original order. Keys are
+     *                                      ordered by reversed key.
+     */
+    class suffix_iterator
+    {
+        friend class prefix_suffix_tree;
+
+    private:
+        prefix_tree::iterator               it;
+
+        explicit suffix_iterator( prefix_tree::iterator &&it_ ) : it( std::move( it_ ) ) {}
+
+    public:
+        suffix_iterator() : it() {}
+
+        inline suffix_iterator& operator++() { ++it; return *this; }
+        inline suffix_iterator& operator--() { --it; return *this; }
+        inline bool operator==( const suffix_iterator &right ) const { return it == right.it; }
+        inline bool operator!=( const suffix_iterator &right ) const { return it != right.it; }
+        inline operator bool() const { return static_cast<bool>( it ); }
+
+        /**
+         * @brief get_key
+         * @return          Key of current node in original order.
+         */
+        inline std::string get_key() const
+        {
+            std::string key = it.get_key();
+            std::reverse( key.begin(), key.end() );
+            return key;
+        }
+    };
+
+private:
+    prefix_tree                             forward;
+    prefix_tree                             backward;
+
+public:
+    prefix_suffix_tree() : forward(), backward() {}
+
+
+    /**
+     * @brief append    Append key.
+     * @return          true if append is successful.
+     */
+    bool append( const std::string &key );
+
+
+    /**
+     * @brief remove    Remove key.
+     */
+    void remove( const std::string &key );
+
+
+    /// @brief exists   Check key is exist.
+    inline bool exists( const std::string &key ) const
+    {
+        return forward.exists( key );
+    }
+
+
+    /// @brief begin    Iterator of keys in order.
+    inline prefix_tree::iterator begin() { return forward.begin( true ); }
+    inline prefix_tree::iterator end() { return forward.end(); }
+
+
+    /**
+     * @brief ends_with     Keys which end with suffix.
+     * @param suffix        Suffix, empty for all keys.
+     * @return              Pair of iterators to loop from first to second.
+     */
+    std::pair<suffix_iterator, suffix_iterator> ends_with( const std::string &suffix );
+
+
+    /**
+     * @brief ends_with     Call function for every key which ends with
+     *                      suffix, in order of reversed keys.
+     * @param suffix        Suffix.
+     * @param function      Function( const std::string &key ).
+     * @return              Count of keys.
+     */
+    template <typename function_t>
+    size_t ends_with( const std::string &suffix, function_t &&function )
+    {
+        size_t count = 0;
+        auto   r     = ends_with( suffix );
+        for ( auto it = r.first; it != r.second; ++it, ++count )
+            function( it.get_key() );
+        return count;
+    }
+
+
+    /**
+     * @brief starts_with   Call function for every key which starts with
+     *                      prefix, in order of keys.
+     * @param prefix        Prefix.
+     * @param function      Function( const std::string &key ).
+     * @return              Count of keys.
+     */
+    template <typename function_t>
+    size_t starts_with( const std::string &prefix, function_t &&function )
+    {
+        size_t count = 0;
+        for ( auto it = forward.lower_bound( prefix ); it; ++it, ++count )
+        {
+            std::string key = it.get_key();
+            if ( key.compare( 0, prefix.size(), prefix ) )
+                break;
+            function( key );
+        }
+        return count;
+    }
+
+
+    /**
+     * @brief match     Call function for every key which starts with prefix
+     *                  and ends with suffix (they may overlap), in order of
+     *                  keys. Keys of prefix and keys of suffix are walked
+     *                  by turns: the smaller side is exhausted first and
+     *                  is the result, so cost is about twice the smaller
+     *                  side, not the larger one.
+     * @param prefix    Prefix.
+     * @param suffix    Suffix.
+     * @param function  Function( const std::string &key ).
+     * @return          Count of keys.
+     */
+    template <typename function_t>
+    size_t match( const std::string &prefix, const std::string &suffix, function_t &&function )
+    {
+        std::vector<std::string> keys;
+        matching_keys( prefix, suffix, keys );
+
+        for ( const auto &key : keys )
+            function( key );
+        return keys.size();
+    }
+
+
+    /// @brief memory_usage     Memory of both trees.
+    prefix_tree::memory_usage_info memory_usage() const;
+
+private:
+    /// @brief reversed     Key in reverse order.
+    static inline std::string reversed( const std::string &key )
+    {
+        return std::string( key.rbegin(), key.rend() );
+    }
+
+
+    /// @brief matching_keys    Keys of match() in order of keys.
+    void matching_keys( const std::string &prefix, const std::string &suffix, std::vector<std::string> &keys );
+};
+
+
+} // namespace prefix_tree
+
+#endif // PREFIX_SUFFIX_TREE_H
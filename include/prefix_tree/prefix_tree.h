@@ -8,29 +8,98 @@
 #ifndef PREFIX_TREE_H
 #define PREFIX_TREE_H
 
+#include <algorithm>
+#include <cstddef>
 #include <memory>
-#include <map>
-#include <stack>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <iostream>
 
+#include "child_nodes.h"
+#include "executor.h"
+#include "instrumentation.h"
+
 namespace prefix_tree
 {
 
 
 /**
  * @brief The prefix_tree class
+ *
+ * Node is 16 bytes: vptr, which new_node() and node_size() dispatch needs,
+ * and the word of child_nodes. It is the floor while nodes are virtual, a
+ * leaf does not go below it. Leaf and node with single child allocate
+ * nothing else, wider nodes add block of children: 100000 keys
+ * "/usr/lib/<n>" take 100010 nodes, memory_usage() reports 1600160 bytes
+ * of nodes and 1440000 bytes of blocks, 30.4 bytes per node.
  */
 class prefix_tree
 {
+    friend class aho_corasick;
+
 public:
     /// @brief ptr          Pointer to prefix_tree (unique_ptr).
     typedef std::unique_ptr<prefix_tree>    ptr;
 
-    typedef std::map<char, ptr>             next_nodes_container;
+    /// @brief next_nodes_container     Children sorted by label (unsigned char).
+    typedef child_nodes<prefix_tree>        next_nodes_container;
+
+
+    /**
+     * @brief The memory_usage_info struct  Memory used by tree.
+     */
+    struct memory_usage_info
+    {
+        /// @brief nodes            Count of nodes including root.
+        size_t                              nodes;
+        /// @brief leaves           Count of nodes without children.
+        size_t                              leaves;
+        /// @brief node_bytes       Size of node objects.
+        size_t                              node_bytes;
+        /// @brief container_bytes  Size of blocks of children.
+        size_t                              container_bytes;
+        /// @brief value_bytes      Size of values kept out of nodes.
+        size_t                              value_bytes;
+
+        /// @brief total            Total bytes.
+        inline size_t total() const { return node_bytes + container_bytes + value_bytes; }
+    };
+
+
+    /**
+     * @brief The statistics struct     Shape and memory of tree.
+     */
+    struct statistics
+    {
+        /// @brief nodes                Count of nodes including root.
+        size_t                              nodes;
+        /// @brief finite_nodes         Count of finite nodes (keys).
+        size_t                              finite_nodes;
+        /// @brief non_finite_nodes     Count of non finite nodes.
+        size_t                              non_finite_nodes;
+        /// @brief node_bytes           Size of node objects.
+        size_t                              node_bytes;
+        /// @brief container_bytes      Size of blocks of children.
+        size_t                              container_bytes;
+        /// @brief value_bytes          Size of values kept out of nodes.
+        size_t                              value_bytes;
+        /// @brief depth                depth[ d ] is count of nodes of depth d.
+        std::vector<size_t>                 depth;
+        /// @brief fan_out              fan_out[ n ] is count of nodes with n children.
+        std::vector<size_t>                 fan_out;
+        /// @brief chain_length         chain_length[ n ] is count of chains of n
+        ///                             non finite nodes with single child.
+        std::vector<size_t>                 chain_length;
+
+        /// @brief total_bytes          Total bytes.
+        inline size_t total_bytes() const { return node_bytes + container_bytes + value_bytes; }
+    };
 
 protected:
     /// @brief NODE_FLAG    Enumeration for describe kind of node (finite or note).
+    ///                     Stored in tag bits of next.
     enum NODE_FLAG : uint8_t
     {
         NO_FLAGS = 0,
@@ -38,34 +107,52 @@ protected:
     };
 
 protected:
-    /// @brief next         Pointers to next nodes.
-    std::map<char, ptr>                     next;
-    /// @brief flag         Kind of node.
-    NODE_FLAG                               flag;
-    /// Parent node.
-    prefix_tree                             *parent;
+    /// @brief next         Pointers to next nodes and flag of node.
+    next_nodes_container                    next;
 
 
 public:
     class iterator
     {
+        friend class prefix_tree;
+
     protected:
         prefix_tree                 *node;
     private:
         bool                        finite_nodes_only;
-        std::deque<unsigned char>   symbols;
+        /// @brief path         Ancestors of node from root.
+        std::vector<prefix_tree*>   path;
+        /// @brief symbols      Key of node.
+        std::string                 symbols;
 
     public:
         /// @brief iterator      Default constructor
-        iterator() : node( nullptr ), finite_nodes_only( false), symbols() {}
+        iterator() : node( nullptr ), finite_nodes_only( false), path(), symbols() {}
+
+        /**
+         * @brief iterator              Constructor.
+         * @param root                  Root of prefix tree.
+         * @param finite_nodes_only_    Iterate via finite nodes only.
+         * @param key                   Key of current node. If it is nullptr
+         *                              current node is root. If key is not
+         *                              found iterator is equal to end().
+         */
+        iterator( const prefix_tree *root, bool finite_nodes_only_, const char *key );
+
 
         /**
          * @brief iterator              Constructor.
-         * @param node_                 Current node of prefix tree.
+         * @param root                  Root of prefix tree.
          * @param finite_nodes_only_    Iterate via finite nodes only.
-         * @param key                   Key of node_.
+         * @param key                   Key of current node.
+         * @param probe                 Instrumentation probe.
          */
-        iterator( const prefix_tree *node_, bool finite_nodes_only_, const char *key );
+        template <typename probe_t>
+        iterator( const prefix_tree *root, bool finite_nodes_only_, const char *key, probe_t &probe )
+            : node( const_cast<prefix_tree*>( root ) ), finite_nodes_only( finite_nodes_only_ ), path(), symbols()
+        {
+            descend( key, probe );
+        }
 
         iterator( const iterator &_ ) = default;
 
@@ -89,45 +176,64 @@ public:
     protected:
         prefix_tree* operator->();
     private:
-        void shift_iterator( bool forward );
+        void increment();
+        void decrement();
+        void reset();
 
-        void increment_via_next(
-                next_nodes_container::iterator it,
-                next_nodes_container::iterator it_end,
-                prefix_tree *cur
-        );
 
-        void increment_via_parent();
-        void decrement_via_parent();
+        /**
+         * @brief skip_subtree  Move to next node after all descendants of
+         *                      current node in pre-order.
+         */
+        void skip_subtree();
 
-        void increment_via_parent(
-                next_nodes_container::iterator it,
-                next_nodes_container::iterator it_end,
-                prefix_tree *cur
-        );
 
+        /**
+         * @brief seek      Move from root to first node with key not less
+         *                  (or greater if upper) than key in one descent.
+         * @param key       Key.
+         * @param upper     Skip node equal to key.
+         */
+        void seek( const char *key, bool upper );
 
-        void decrement_via_next(
-                next_nodes_container::reverse_iterator it,
-                next_nodes_container::reverse_iterator it_end,
-                prefix_tree *cur
-        );
 
-        void decrement_via_parent(
-                next_nodes_container::reverse_iterator it,
-                next_nodes_container::reverse_iterator it_end,
-                prefix_tree *cur
-        );
+        /**
+         * @brief descend   Move from current node to node of key.
+         * @param key       Key relative to current node or nullptr.
+         * @param probe     Instrumentation probe.
+         */
+        template <typename probe_t>
+        void descend( const char *key, probe_t &probe )
+        {
+            if ( !key )
+                return;
 
-    };
+            probe.visit();
+            for ( ; *key && node; ++key )
+            {
+                path.push_back( node );
+                symbols.push_back( *key );
+                node = node->next.get( static_cast<unsigned char>( *key ) );
+                probe.visit();
+            }
 
+            if ( !node )
+                reset();
+        }
+    };
 
-protected:
-    prefix_tree( prefix_tree *parent_ );
 
 public:
     prefix_tree();
-    virtual ~prefix_tree() = default;
+    virtual ~prefix_tree();
+
+
+    /**
+     * @brief operator new      Nodes are taken from current node_arena
+     *                          (see relayout()) or from heap.
+     */
+    static void* operator new( size_t size );
+    static void operator delete( void *p );
 
 
     /**
@@ -152,6 +258,48 @@ public:
     }
 
 
+    /**
+     * @brief append_sorted     Append keys reusing nodes of common prefix
+     *                          with previous key, new children of sorted
+     *                          keys are added after last child without
+     *                          search. Unsorted keys are appended correctly
+     *                          but slower.
+     * @param first             Iterator of first key, keys are convertible
+     *                          to std::string_view and alive until return.
+     * @param last              Iterator after last key.
+     * @return                  Count of keys which were absent.
+     */
+    template <typename iterator_t>
+    size_t append_sorted( iterator_t first, iterator_t last )
+    {
+        std::vector<prefix_tree*> path( 1, this );
+        std::string_view          prev;
+        size_t                    appended = 0;
+
+        for ( ; first != last; ++first )
+        {
+            std::string_view key( *first );
+
+            size_t common = simd::mismatch(
+                        reinterpret_cast<const unsigned char*>( prev.data() ),
+                        reinterpret_cast<const unsigned char*>( key.data() ),
+                        std::min( prev.size(), key.size() )
+            );
+
+            prefix_tree *node = append_next( path, common, key.data(), key.size() );
+            if ( !node->is_finite_node() )
+            {
+                node->set_flag( NODE_FLAG::FINITE_NODE );
+                ++appended;
+            }
+
+            prev = key;
+        }
+
+        return appended;
+    }
+
+
     /**
      * @brief remove        Remove key from the prefix tree.
      * @param key           Key of node. If a node of key if not finite
@@ -170,11 +318,108 @@ public:
      */
     inline void remove( const char *key )
     {
-        if ( !key )
-            return;
+        no_instrumentation::probe probe( operation::REMOVE );
+        remove_key( key, probe );
+    }
+
+
+    /**
+     * @brief remove_lazy   Remove key without freeing nodes: finite flag is
+     *                      cleared and path of key is marked by tombstone
+     *                      bit. Nodes left without keys are freed later by
+     *                      compact(). Keys, values and prefixes behave as
+     *                      after remove(): lookups and iteration of all
+     *                      nodes skip subtrees left without keys, at cost
+     *                      of walk over marked nodes of the subtree.
+     * @param key           Key.
+     * @return              true if key has existed.
+     */
+    bool remove_lazy( const char *key );
+
+
+    /**
+     * @brief remove_lazy   Remove key without freeing nodes.
+     * @param key           Key.
+     * @return              true if key has existed.
+     */
+    inline bool remove_lazy( const std::string &key )
+    {
+        return remove_lazy( key.c_str() );
+    }
+
+
+    /**
+     * @brief compact       Free nodes left by remove_lazy() step by step:
+     *                      marked subtrees are walked depth first and dead
+     *                      leaves are freed when their children are done.
+     *                      Call may exceed budget by depth of one key to
+     *                      finish at least one node.
+     * @param step_budget   Count of nodes to visit and free.
+     * @return              true if work is left for next call.
+     */
+    bool compact( size_t step_budget );
+
+
+    /**
+     * @brief remove_prefix Remove all keys started with prefix. Subtree of
+     *                      prefix is unlinked in one step and freed in bulk.
+     *                      To free it in other place (e.g. other thread)
+     *                      use extract_subtree().
+     * @param prefix        Prefix. Empty prefix clears the tree.
+     */
+    void remove_prefix( const char *prefix );
+
+
+    /**
+     * @brief remove_prefix Remove all keys started with prefix.
+     * @param prefix        Prefix. Empty prefix clears the tree.
+     */
+    inline void remove_prefix( const std::string &prefix )
+    {
+        remove_prefix( prefix.c_str() );
+    }
+
+
+    /**
+     * @brief extract_subtree   Unlink subtree of prefix from the tree.
+     * @param prefix            Prefix.
+     * @return                  Subtree as separate tree, keys of it are
+     *                          relative to prefix. nullptr if prefix is not found.
+     */
+    ptr extract_subtree( const char *prefix );
+
+
+    /**
+     * @brief extract_subtree   Unlink subtree of prefix from the tree.
+     * @param prefix            Prefix.
+     * @return                  Subtree as separate tree or nullptr.
+     */
+    inline ptr extract_subtree( const std::string &prefix )
+    {
+        return extract_subtree( prefix.c_str() );
+    }
+
+
+    /**
+     * @brief insert_subtree    Link tree as subtree of prefix without copying.
+     *                          If prefix is exist the tree is merged to it.
+     * @param prefix            Prefix.
+     * @param subtree           Tree of the same type as nodes of the tree
+     *                          (e.g. returned by extract_subtree()).
+     * @return                  true if success.
+     */
+    bool insert_subtree( const char *prefix, ptr &&subtree );
 
-        if ( remove_node( key, 0 ) )
-            next.erase( *key );
+
+    /**
+     * @brief insert_subtree    Link tree as subtree of prefix without copying.
+     * @param prefix            Prefix.
+     * @param subtree           Tree of the same type as nodes of the tree.
+     * @return                  true if success.
+     */
+    inline bool insert_subtree( const std::string &prefix, ptr &&subtree )
+    {
+        return insert_subtree( prefix.c_str(), std::move( subtree ) );
     }
 
 
@@ -186,7 +431,7 @@ public:
      */
     inline bool exists( const char *key, bool finite_node = true ) const
     {
-        return find_node( key ) != nullptr;
+        return find_node( key, finite_node ) != nullptr;
     }
     
     
@@ -209,7 +454,11 @@ public:
      * @return              Iterator of found node. If not found return iterator equal to
      *                      iterator returned by end().
      */
-    iterator find( const char *key, bool finite_node );
+    inline iterator find( const char *key, bool finite_node = true )
+    {
+        no_instrumentation::probe probe( operation::FIND );
+        return find( key, finite_node, probe );
+    }
 
 
     /**
@@ -219,12 +468,60 @@ public:
      * @return              Iterator of found node. If not found return iterator equal to
      *                      iterator returned by end().
      */
-    inline iterator find( const std::string &key )
+    inline iterator find( const std::string &key, bool finite_node = true )
+    {
+        return find( key.c_str(), finite_node );
+    }
+
+
+    /**
+     * @brief lower_bound           Find first key not less than key. Keys
+     *                              are ordered as strings of unsigned bytes.
+     * @param key                   Key, it may be absent in the tree.
+     * @param finite_nodes_only     Iterate finite nodes only.
+     * @return                      Iterator or end() if all keys are less.
+     */
+    iterator lower_bound( const char *key, bool finite_nodes_only = true );
+
+
+    /**
+     * @brief lower_bound           Find first key not less than key.
+     */
+    inline iterator lower_bound( const std::string &key, bool finite_nodes_only = true )
+    {
+        return lower_bound( key.c_str(), finite_nodes_only );
+    }
+
+
+    /**
+     * @brief upper_bound           Find first key greater than key.
+     * @param key                   Key, it may be absent in the tree.
+     * @param finite_nodes_only     Iterate finite nodes only.
+     * @return                      Iterator or end() if no key is greater.
+     */
+    iterator upper_bound( const char *key, bool finite_nodes_only = true );
+
+
+    /**
+     * @brief upper_bound           Find first key greater than key.
+     */
+    inline iterator upper_bound( const std::string &key, bool finite_nodes_only = true )
     {
-        return find( key.c_str() );
+        return upper_bound( key.c_str(), finite_nodes_only );
     }
 
 
+    /**
+     * @brief range                 Keys in [ from, to ).
+     * @param from                  First key of range, it may be absent.
+     * @param to                    Key after range, it may be absent.
+     * @param finite_nodes_only     Iterate finite nodes only.
+     * @return                      Pair of iterators to loop from first to
+     *                              second, they are equal if range is empty.
+     */
+    std::pair<iterator, iterator> range( const std::string &from, const std::string &to, bool finite_nodes_only = true );
+
+
     /**
      * @brief begin                 Get iterator to first node.
      * @param finite_nodes_only     Iterate finite nodes only.
@@ -239,10 +536,278 @@ public:
      */
     iterator end();
 
+
+    /**
+     * @brief memory_usage  Count memory used by the tree.
+     * @return              Report of memory usage.
+     */
+    memory_usage_info memory_usage() const;
+
+
+    /**
+     * @brief stats         Collect statistics of the tree in one traversal.
+     * @return              Statistics.
+     */
+    statistics stats() const;
+
+
+    /**
+     * @brief merge         Append all keys of other tree.
+     *                      Subtrees which are absent in the tree are moved
+     *                      from other tree without copying.
+     * @param other         Tree to merge. It is empty after merge.
+     * @param parallel      Process children of root in parallel.
+     */
+    void merge( prefix_tree &&other, bool parallel = false );
+
+
+    /**
+     * @brief intersect     Remove keys which are absent in other tree.
+     * @param other         Other tree.
+     * @param parallel      Process children of root in parallel.
+     */
+    void intersect( const prefix_tree &other, bool parallel = false );
+
+
+    /**
+     * @brief difference    Remove keys which are present in other tree.
+     * @param other         Other tree.
+     * @param parallel      Process children of root in parallel.
+     */
+    void difference( const prefix_tree &other, bool parallel = false );
+
+
+    /**
+     * @brief relayout      Copy nodes of the tree to one contiguous arena
+     *                      in cache friendly order: top levels in BFS order,
+     *                      subtrees below them in DFS order with siblings
+     *                      and their block of children side by side.
+     *                      Values are moved to the new nodes.
+     *                      Slots of nodes removed later are not reused:
+     *                      memory of arena is freed when all its nodes
+     *                      are freed, call relayout() again after heavy
+     *                      removal.
+     *                      NOTE! All iterators of the tree are invalidated.
+     */
+    void relayout();
+
+
+    /**
+     * @brief parallel_for_each     Call function for every key of prefix
+     *                              (including prefix itself) on executor.
+     *                              Order of calls is not defined.
+     * @param prefix                Prefix, empty for all keys.
+     * @param function              Thread safe function( const std::string &key ).
+     * @param ex                    Executor.
+     */
+    template <typename function_t>
+    void parallel_for_each( const std::string &prefix, function_t &&function, executor &ex = executor::instance() )
+    {
+        struct none {};
+        reduce_subtrees(
+                    prefix.c_str(), ex, none(),
+                    [&] ( const std::string &key, prefix_tree & ) { function( key ); return none(); },
+                    [] ( none &&, none && ) { return none(); }
+        );
+    }
+
+
+    /**
+     * @brief parallel_reduce       Map every key of prefix on executor and
+     *                              reduce results in key order. The result
+     *                              is equal to left fold of mapped keys in
+     *                              order starting with init.
+     * @param prefix                Prefix, empty for all keys.
+     * @param init                  Identity of reduce.
+     * @param map                   Thread safe function( const std::string &key ) -> result_t.
+     * @param reduce                Associative function( result_t &&left, result_t &&right ) -> result_t.
+     * @param ex                    Executor.
+     * @return                      Result.
+     */
+    template <typename result_t, typename map_t, typename reduce_t>
+    result_t parallel_reduce( const std::string &prefix, result_t init, map_t &&map, reduce_t &&reduce, executor &ex = executor::instance() )
+    {
+        return reduce_subtrees(
+                    prefix.c_str(), ex, std::move( init ),
+                    [&] ( const std::string &key, prefix_tree & ) { return map( key ); },
+                    reduce
+        );
+    }
+
+protected:
+    /// @brief TASKS_PER_THREAD     Limit of subtree tasks of parallel traversal.
+    static constexpr size_t                 TASKS_PER_THREAD = 64;
+
+
+    /**
+     * @brief reduce_subtrees   Parallel traversal of subtree of prefix.
+     *                          Task of subtree follows chain of single
+     *                          children and spawns task for every child of
+     *                          first branch while limit of tasks allows, the
+     *                          rest is visited in the task in pre-order.
+     *                          Results of tasks form tree which is reduced
+     *                          in key order after all tasks are done.
+     * @param prefix            Prefix.
+     * @param ex                Executor.
+     * @param init              Identity of reduce.
+     * @param visit             Function( const std::string &key, prefix_tree &node ) -> result_t
+     *                          called for finite nodes.
+     * @param reduce            Function( result_t &&left, result_t &&right ) -> result_t.
+     * @return                  Result.
+     */
+    template <typename result_t, typename visit_t, typename reduce_t>
+    result_t reduce_subtrees( const char *prefix, executor &ex, result_t init, visit_t &&visit, reduce_t &&reduce )
+    {
+        struct partial
+        {
+            result_t                                value;
+            std::vector<std::unique_ptr<partial> >  children;
+
+            explicit partial( const result_t &init_ ) : value( init_ ), children() {}
+        };
+
+        prefix_tree *start = const_cast<prefix_tree*>( find_node( prefix, false ) );
+        if ( !start )
+            return init;
+
+        std::atomic<size_t>     budget( ex.size() * TASKS_PER_THREAD );
+        executor::task_group    group( ex );
+        partial                 root( init );
+
+        auto accumulate = [&] ( partial &out, const std::string &key, prefix_tree &node )
+        {
+            // Root is not an element of the tree, as in iteration.
+            if ( node.is_finite_node() && &node != this )
+                out.value = reduce( std::move( out.value ), visit( key, node ) );
+        };
+
+        std::function<void( prefix_tree*, std::string, partial* )> task =
+                [&] ( prefix_tree *node, std::string key, partial *out )
+        {
+            for ( ;; )
+            {
+                accumulate( *out, key, *node );
+
+                size_t n = node->next.size();
+                if ( n != 1 )
+                    break;
+
+                key.push_back( static_cast<char>( node->next.label( 0 ) ) );
+                node = node->next.node( 0 );
+            }
+
+            size_t n     = node->next.size();
+            size_t taken = budget.load( std::memory_order_relaxed );
+            while ( n && taken >= n && !budget.compare_exchange_weak( taken, taken - n, std::memory_order_relaxed ) )
+                ;
+
+            if ( n && taken >= n )
+            {
+                for ( size_t i = 0; i < n; ++i )
+                {
+                    out->children.emplace_back( new partial( init ) );
+
+                    prefix_tree *child  = node->next.node( i );
+                    partial     *result = out->children.back().get();
+                    std::string  child_key = key;
+                    child_key.push_back( static_cast<char>( node->next.label( i ) ) );
+
+                    group.run( [&task, child, result, child_key] () { task( child, child_key, result ); } );
+                }
+                return;
+            }
+
+            // Limit is reached: the rest of subtree in pre-order.
+            std::vector<std::pair<prefix_tree*, size_t> > stack;
+            stack.emplace_back( node, 0 );
+
+            while ( !stack.empty() )
+            {
+                auto &top = stack.back();
+                if ( top.second == top.first->next.size() )
+                {
+                    stack.pop_back();
+                    if ( !stack.empty() )
+                        key.pop_back();
+                    continue;
+                }
+
+                prefix_tree *child = top.first->next.node( top.second );
+                key.push_back( static_cast<char>( top.first->next.label( top.second ) ) );
+                ++top.second;
+
+                accumulate( *out, key, *child );
+                stack.emplace_back( child, 0 );
+            }
+        };
+
+        task( start, prefix, &root );
+        group.wait();
+
+        // Fold in key order: value of task holds keys before its children.
+        std::function<result_t( partial& )> fold = [&] ( partial &p ) -> result_t
+        {
+            result_t result = std::move( p.value );
+            for ( auto &child : p.children )
+                result = reduce( std::move( result ), fold( *child ) );
+            return result;
+        };
+
+        return fold( root );
+    }
+
 protected:
     inline bool is_finite_node() const
     {
-        return flag == NODE_FLAG::FINITE_NODE;
+        return next.tag() & NODE_FLAG::FINITE_NODE;
+    }
+
+
+    inline void set_flag( NODE_FLAG flag )
+    {
+        next.set_tag( ( next.tag() & ~uintptr_t( NODE_FLAG::FINITE_NODE ) ) | flag );
+    }
+
+
+    /// @brief TOMBSTONE    Bit of tag: subtree has keys of remove_lazy()
+    ///                     not compacted yet.
+    static constexpr uintptr_t              TOMBSTONE = 4;
+
+
+    inline bool has_tombstone() const
+    {
+        return next.tag() & TOMBSTONE;
+    }
+
+
+    inline void set_tombstone( bool on )
+    {
+        next.set_tag( on ? next.tag() | TOMBSTONE : next.tag() & ~TOMBSTONE );
+    }
+
+
+    /**
+     * @brief is_dead   Subtree of node has no keys, it waits for compact().
+     *                  Marked nodes are walked only: subtree of node
+     *                  without tombstone always has a key.
+     */
+    bool is_dead() const;
+
+
+    /// @brief REFERENCED   Bit of tag: finite node was accessed since clock
+    ///                     hand of cache passed it (see prefix_tree_cache).
+    static constexpr uintptr_t              REFERENCED = 2;
+
+
+    inline bool is_referenced() const
+    {
+        return next.tag() & REFERENCED;
+    }
+
+
+    inline void set_referenced( bool on )
+    {
+        next.set_tag( on ? next.tag() | REFERENCED : next.tag() & ~REFERENCED );
     }
 
 
@@ -252,17 +817,87 @@ protected:
      *                      because all nodes in the tree have to equal type.
      * @return              Raw pointer to new object of prefix_tree type or derived.
      */
-    virtual prefix_tree *new_node( prefix_tree *parent_ );
+    virtual prefix_tree *new_node();
+
+
+    /**
+     * @brief node_size     Size of node object.
+     *                      NOTE! The function must be overload in derived class.
+     */
+    virtual size_t node_size() const;
+
+
+    /**
+     * @brief value_size    Size of value kept by node out of node object.
+     *                      NOTE! The function must be overload in derived class
+     *                      which keeps values out of node.
+     */
+    virtual size_t value_size() const;
+
+
+    /**
+     * @brief move_value    Construct value of the node from value of other
+     *                      finite node before the node becomes finite (merge,
+     *                      extract). Value of other stays alive moved from.
+     *                      Derived class which keeps values in nodes must
+     *                      overload the function.
+     * @param other         Node of the same type.
+     */
+    virtual void move_value( prefix_tree &other );
+
+
+    /**
+     * @brief destroy_value Destroy value of finite node before the node
+     *                      stops to be finite. Derived class which keeps
+     *                      values in nodes must overload the function.
+     */
+    virtual void destroy_value();
+
+
+    /**
+     * @brief clear_finite  Mark node as non finite and destroy its value.
+     */
+    inline void clear_finite()
+    {
+        if ( !is_finite_node() )
+            return;
+
+        destroy_value();
+        set_flag( NODE_FLAG::NO_FLAGS );
+    }
+
+
+    /**
+     * @brief append_node   Append node to prefix tree.
+     * @param key           Key.
+     * @return              Pair where first is reference to new node second is
+     *                      flag append has been successful.
+     */
+    inline std::pair<prefix_tree&, bool> append_node( const char *key )
+    {
+        no_instrumentation::probe probe( operation::APPEND );
+        return append_node( key, probe );
+    }
 
 
     /**
      * @brief append_node   Append node to prefix tree.
      * @param key           Key.
+     * @param probe         Instrumentation probe (see instrumentation.h).
      * @return              Pair where first is reference to new node second is
      *                      flag append has been successful.
      */
-    std::pair<prefix_tree&, bool> append_node( const char *key );
-    
+    template <typename probe_t>
+    std::pair<prefix_tree&, bool> append_node( const char *key, probe_t &probe )
+    {
+        prefix_tree *node = append_path( key, probe );
+        if ( !node )
+            return std::pair<prefix_tree&, bool>( *this, false );
+
+        node->set_flag( NODE_FLAG::FINITE_NODE );
+        return std::pair<prefix_tree&, bool>( *node, true );
+    }
+
 
     /**
      * @brief append_node   Append node to prefix tree.
@@ -277,14 +912,137 @@ protected:
 
 
     /**
-     * @brief remove_node   Remove node.
+     * @brief append_path   Create nodes of key. Flag of last node is not changed.
+     * @param key           Key.
+     * @param len           Length of key.
+     * @return              Node of key.
+     */
+    prefix_tree& append_path( const char *key, size_t len );
+
+
+    /**
+     * @brief append_path   Create nodes of key. Flag of last node is not changed.
+     * @param key           Null terminated key.
+     * @param probe         Instrumentation probe.
+     * @return              Node of key or nullptr if key is nullptr.
+     */
+    template <typename probe_t>
+    prefix_tree* append_path( const char *key, probe_t &probe )
+    {
+        if ( !key )
+            return nullptr;
+
+        prefix_tree *cur = this;
+        probe.visit();
+
+        for ( ; *key; ++key )
+        {
+            unsigned char c   = static_cast<unsigned char>( *key );
+            size_t        pos = cur->next.lower_bound( c );
+
+            if ( pos < cur->next.size() && cur->next.label( pos ) == c )
+                cur = cur->next.node( pos );
+            else
+            {
+                probe.allocate();
+                cur = cur->next.insert( pos, c, ptr( cur->new_node() ) );
+            }
+
+            probe.visit();
+        }
+
+        return cur;
+    }
+
+
+    /**
+     * @brief append_next   Create nodes of key starting from node of common
+     *                      prefix with previous key (see append_sorted()).
+     * @param path          Nodes of prefixes of previous key, path[ i ] is
+     *                      node of prefix of length i. Replaced by nodes of key.
+     * @param common        Length of common prefix of key and previous key.
+     * @param key           Key.
+     * @param len           Length of key.
+     * @return              Node of key.
+     */
+    prefix_tree* append_next( std::vector<prefix_tree*> &path, size_t common, const char *key, size_t len );
+
+
+    /**
+     * @brief detach_node   Unlink node of key from its parent and remove
+     *                      non finite ancestors which became leaves.
+     * @param key           Non empty key.
+     * @return              Unlinked node or nullptr if key is not found.
+     */
+    ptr detach_node( const char *key );
+
+
+    /**
+     * @brief remove_key    Remove key from the prefix tree.
+     * @param key           Key of node.
+     * @param probe         Instrumentation probe.
+     */
+    template <typename probe_t>
+    void remove_key( const char *key, probe_t &probe )
+    {
+        if ( !key || !*key )
+            return;
+
+        // Deepest node on the way which must be kept (root, finite node or
+        // branch) and position of key symbol leading from it. If the node of
+        // key is leaf the whole chain below that node is removed.
+        prefix_tree *keep     = this;
+        size_t       keep_pos = 0;
+
+        prefix_tree *cur = this;
+        probe.visit();
+
+        for ( size_t pos = 0; key[ pos ]; ++pos )
+        {
+            if ( cur->is_finite_node() || cur->next.size() > 1 )
+            {
+                keep     = cur;
+                keep_pos = pos;
+            }
+
+            cur = cur->next.get( static_cast<unsigned char>( key[ pos ] ) );
+            if ( !cur )
+                return;
+
+            probe.visit();
+        }
+
+        if ( !cur->is_finite_node() )
+            return;
+
+        if ( !cur->next.empty() )
+        {
+            cur->clear_finite();
+            return;
+        }
+
+        keep->next.erase( keep->next.find( static_cast<unsigned char>( key[ keep_pos ] ) ) );
+    }
+
+
+    /**
+     * @brief prune         Remove node of key if it is not finite leaf,
+     *                      with chain of its ancestors left without keys
+     *                      and other children. Used to drop path appended
+     *                      for key whose value has failed to construct.
      * @param key           Key of node.
-     * @param pos           Current symbol position in key.
-     * @return              true if node must be removed.
-     *                      If returned false node marked as non finite but
-     *                      not removed.
      */
-    bool remove_node( const char *key, unsigned int pos );
+    void prune( const char *key );
+
+
+    /**
+     * @brief path_bytes    Size of nodes on the way to key and their blocks
+     *                      of children, values are not counted. Difference
+     *                      around insert or remove of key is its cost in
+     *                      nodes (see prefix_tree_cache).
+     * @param key           Key, the way ends at first missing node.
+     */
+    size_t path_bytes( const char *key ) const;
 
 
     /**
@@ -293,7 +1051,95 @@ protected:
      * @param finite_node   If true looking for finite node only else prefix or finite node.
      * @return              Raw const pointer to found node or nullptr.
      */
-    const prefix_tree* find_node( const char *key, bool finite_node = true ) const;
+    inline const prefix_tree* find_node( const char *key, bool finite_node = true ) const
+    {
+        no_instrumentation::probe probe( operation::FIND );
+        return find_node( key, finite_node, probe );
+    }
+
+
+    /**
+     * @brief find_node     Find node by key.
+     * @param key           Key ot prefix.
+     * @param finite_node   If true looking for finite node only else prefix or finite node.
+     * @param probe         Instrumentation probe.
+     * @return              Raw const pointer to found node or nullptr.
+     */
+    template <typename probe_t>
+    const prefix_tree* find_node( const char *key, bool finite_node, probe_t &probe ) const
+    {
+        if ( !key )
+            return nullptr;
+
+        const prefix_tree *cur = this;
+        probe.visit();
+
+        for ( ; *key; ++key )
+        {
+            cur = cur->next.get( static_cast<unsigned char>( *key ) );
+            if ( !cur )
+                return nullptr;
+
+            probe.visit();
+        }
+
+        if ( finite_node && !cur->is_finite_node() )
+            return nullptr;
+
+        // Prefix of keys removed by remove_lazy().
+        if ( !finite_node && cur != this && cur->is_dead() )
+            return nullptr;
+
+        return cur;
+    }
+
+
+    /**
+     * @brief find          Find key in tree.
+     * @param key           Key whose looking for.
+     * @param finite_node   If true find finite node only.
+     * @param probe         Instrumentation probe.
+     * @return              Iterator of found node or end().
+     */
+    template <typename probe_t>
+    iterator find( const char *key, bool finite_node, probe_t &probe )
+    {
+        if ( !key )
+            return iterator();
+
+        iterator it( this, finite_node, key, probe );
+        if ( it && finite_node && !it.node->is_finite_node() )
+            return iterator();
+
+        // Prefix of keys removed by remove_lazy().
+        if ( it && !finite_node && it.node != this && it.node->is_dead() )
+            return iterator();
+
+        return it;
+    }
+
+
+    /**
+     * @brief merge_node    Merge subtree of other node to the node.
+     * @param other         Node of other tree with the same key.
+     */
+    void merge_node( prefix_tree &other );
+
+
+    /**
+     * @brief intersect_node    Keep only keys present in subtree of other node.
+     * @param other             Node of other tree with the same key.
+     * @return                  true if the node became empty and must be removed.
+     */
+    bool intersect_node( const prefix_tree &other );
+
+
+    /**
+     * @brief difference_node   Remove keys present in subtree of other node.
+     * @param other             Node of other tree with the same key.
+     * @return                  true if the node became empty and must be removed.
+     */
+    bool difference_node( const prefix_tree &other );
 };
 
 
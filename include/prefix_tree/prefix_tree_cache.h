@@ -0,0 +1,296 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef PREFIX_TREE_CACHE_H
+#define PREFIX_TREE_CACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "prefix_tree_map.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The prefix_tree_cache class   prefix_tree_map bounded by count of
+ *                                      entries or bytes, entries are
+ *                                      evicted by CLOCK.
+ *
+ * Access bit of entry is REFERENCED bit of its finite node: hit sets the
+ * bit in place, there is no list to relink. Clock hand is a key, it walks
+ * keys in order and wraps around: referenced entry loses its bit, entry
+ * without the bit is evicted by remove() of the map, so nodes are pruned
+ * as by any remove. New entry has no bit, so entries read once are the
+ * first to go.
+ *
+ * Bytes of entry are nodes and blocks of children created for its key,
+ * measured by path_bytes() around insert and remove, and bytes of value
+ * reported by options::value_bytes. Nodes shared by keys are charged to
+ * the entry which has created them, in total bytes of cache are
+ * memory_usage() of nodes and blocks without root node plus bytes of
+ * values.
+ *
+ * As prefix_tree_map, the cache is not thread safe.
+ *
+ * @param value_type                    Type of value.
+ * @param instrumentation_t             Instrumentation policy
+ *                                      (see instrumentation.h).
+ */
+template <typename value_type, typename instrumentation_t = no_instrumentation>
+class prefix_tree_cache : protected prefix_tree_map<value_type, instrumentation_t>
+{
+private:
+    typedef prefix_tree_map<value_type, instrumentation_t> map_type;
+
+public:
+    using typename map_type::iterator;
+    using typename map_type::memory_usage_info;
+    using map_type::begin;
+    using map_type::end;
+    using map_type::memory_usage;
+
+
+    /**
+     * @brief The options struct    Budget of cache, 0 is no limit.
+     */
+    struct options
+    {
+        /// @brief max_entries  Count of entries.
+        size_t                              max_entries;
+        /// @brief max_bytes    Bytes of nodes and values.
+        size_t                              max_bytes;
+        /// @brief value_bytes  Bytes of value including memory it owns,
+        ///                     sizeof( value_type ) by default.
+        std::function<size_t( const value_type& )> value_bytes;
+
+        options() :
+            max_entries( 0 ),
+            max_bytes( 0 ),
+            value_bytes( [] ( const value_type& ) { return sizeof( value_type ); } )
+        {
+        }
+    };
+
+
+    /**
+     * @brief The cache_stats struct    Counters of cache.
+     */
+    struct cache_stats
+    {
+        uint64_t                            hits;
+        uint64_t                            misses;
+        uint64_t                            evictions;
+        size_t                              entries;
+        size_t                              bytes;
+
+        /// @brief hit_rate     Share of hits among lookups.
+        inline double hit_rate() const
+        {
+            return hits + misses ? static_cast<double>( hits ) / ( hits + misses ) : 0;
+        }
+    };
+
+private:
+    /**
+     * @brief The clock_iterator class  Iterator with access to its node.
+     */
+    class clock_iterator : public prefix_tree::iterator
+    {
+    public:
+        clock_iterator( const prefix_tree::iterator &it ) : prefix_tree::iterator( it ) {}
+
+        inline prefix_tree* current() const { return node; }
+    };
+
+    options                                 opts;
+    cache_stats                             counters;
+    /// @brief hand     Key which clock hand points to, empty for first key.
+    std::string                             hand;
+
+public:
+    explicit prefix_tree_cache( options opts_ = options() ) : map_type(), opts( opts_ ), counters(), hand() {}
+    virtual ~prefix_tree_cache() = default;
+
+
+    /**
+     * @brief get       Look up value and mark entry as accessed.
+     * @param key       Key.
+     * @return          Pointer to value or nullptr if key is absent. Valid
+     *                  until next put() or remove().
+     */
+    value_type* get( const std::string &key )
+    {
+        typename instrumentation_t::probe probe( operation::FIND );
+
+        prefix_tree *node = const_cast<prefix_tree*>( this->find_node( key.c_str(), true, probe ) );
+        if ( !node || node == this )
+        {
+            ++counters.misses;
+            return nullptr;
+        }
+
+        ++counters.hits;
+
+        // Hot entries are only read.
+        if ( !map_type::node_referenced( node ) )
+            map_type::set_node_referenced( node, true );
+
+        return &map_type::node_value( node );
+    }
+
+
+    /**
+     * @brief put       Insert or assign value. Other entries are evicted
+     *                  until the cache fits the budget, entry larger than
+     *                  budget is kept alone.
+     * @param key       Non empty key, root of the map is not an entry.
+     * @param value_    Value.
+     * @return          Value of key.
+     * @throw           std::invalid_argument if key is empty.
+     */
+    template <typename arg_t>
+    value_type& put( const std::string &key, arg_t &&value_ )
+    {
+        if ( key.empty() )
+            throw std::invalid_argument( "prefix_tree_cache: empty key" );
+
+        prefix_tree *node = const_cast<prefix_tree*>( this->find_node( key.c_str(), true ) );
+        if ( node && node != this )
+        {
+            value_type &value = map_type::node_value( node );
+            map_type::set_node_referenced( node, true );
+
+            size_t before = opts.value_bytes( value );
+            value = std::forward<arg_t>( value_ );
+            counters.bytes += opts.value_bytes( value ) - before;
+
+            make_room( node );
+            return value;
+        }
+
+        size_t before = this->path_bytes( key.c_str() );
+        value_type &value = map_type::try_emplace( key.c_str(), std::forward<arg_t>( value_ ) ).first;
+
+        ++counters.entries;
+        counters.bytes += this->path_bytes( key.c_str() ) - before + opts.value_bytes( value );
+
+        make_room( const_cast<prefix_tree*>( this->find_node( key.c_str(), true ) ) );
+        return value;
+    }
+
+
+    /**
+     * @brief remove    Remove key.
+     * @param key       Key.
+     * @return          true if key has existed.
+     */
+    bool remove( const std::string &key )
+    {
+        prefix_tree *node = const_cast<prefix_tree*>( this->find_node( key.c_str(), true ) );
+        if ( !node || node == this )
+            return false;
+
+        erase( key, node );
+        return true;
+    }
+
+
+    /// @brief size     Count of entries.
+    inline size_t size() const { return counters.entries; }
+
+
+    /// @brief stats    Hits, misses, evictions, entries and bytes.
+    inline cache_stats stats() const { return counters; }
+
+
+    /// @brief reset_stats  Reset hits, misses and evictions.
+    inline void reset_stats()
+    {
+        counters.hits = counters.misses = counters.evictions = 0;
+    }
+
+
+    inline const options& get_options() const { return opts; }
+
+private:
+    inline bool fits() const
+    {
+        return ( !opts.max_entries || counters.entries <= opts.max_entries ) &&
+               ( !opts.max_bytes || counters.bytes <= opts.max_bytes );
+    }
+
+
+    /**
+     * @brief erase     Remove entry by remove() of the map. Access bit is
+     *                  cleared first: the node may stay as inner node.
+     */
+    void erase( const std::string &key, prefix_tree *node )
+    {
+        size_t before = this->path_bytes( key.c_str() ) + opts.value_bytes( map_type::node_value( node ) );
+
+        map_type::set_node_referenced( node, false );
+        map_type::remove( key.c_str() );
+
+        --counters.entries;
+        counters.bytes -= before - this->path_bytes( key.c_str() );
+    }
+
+
+    /**
+     * @brief make_room     Evict entries by CLOCK until the cache fits the
+     *                      budget. Every pass of hand clears bits it meets,
+     *                      so the second pass evicts at the latest.
+     * @param keep          Node of entry which has been put, it is skipped.
+     */
+    void make_room( prefix_tree *keep )
+    {
+        while ( counters.entries > 1 && !fits() )
+        {
+            clock_iterator it( map_type::lower_bound( hand ) );
+
+            for ( ;; )
+            {
+                if ( !it )
+                    it = clock_iterator( map_type::begin() );
+
+                prefix_tree *node = it.current();
+                if ( node == keep )
+                {
+                    ++it;
+                    continue;
+                }
+
+                if ( !map_type::node_referenced( node ) )
+                    break;
+
+                map_type::set_node_referenced( node, false );
+                ++it;
+            }
+
+            std::string victim = it.get_key();
+            prefix_tree *node  = it.current();
+
+            // Removal invalidates iterator, hand keeps key of next entry.
+            ++it;
+            hand = it ? it.get_key() : std::string();
+
+            erase( victim, node );
+            ++counters.evictions;
+        }
+    }
+};
+
+
+} // namespace prefix_tree
+
+#endif // PREFIX_TREE_CACHE_H
@@ -8,7 +8,11 @@
 #ifndef PREFIX_TREE_MAP_H
 #define PREFIX_TREE_MAP_H
 
+#include <new>
+#include <utility>
+
 #include "prefix_tree.h"
+#include "value_slab.h"
 
 
 namespace prefix_tree
@@ -17,21 +21,63 @@ namespace prefix_tree
 /**
  * @brief prefix_tree_map       key => value container
  *                              implemented as prefix tree.
+ *                              Value is constructed in place when node
+ *                              becomes finite and destroyed when it stops
+ *                              to be finite.
+ *
+ * Every node has one pointer sized slot whatever value_type is. Value
+ * which fits the slot is kept inline, larger value is kept in value_slab
+ * and the slot points to it.
+ * @param value_type            Type of value.
+ * @param instrumentation_t     Instrumentation policy of append, find and
+ *                              remove (see instrumentation.h).
  */
-template <typename value_type>
+template <typename value_type, typename instrumentation_t = no_instrumentation>
 class prefix_tree_map : protected prefix_tree
 {
+    friend class aho_corasick;
+
+public:
+    using prefix_tree::memory_usage_info;
+    using prefix_tree::statistics;
+    using prefix_tree::operator new;
+    using prefix_tree::operator delete;
+
 private:
-    value_type                              value;
+    /// @brief INLINE_VALUE     Value is kept in slot, not in value_slab.
+    static constexpr bool                   INLINE_VALUE =
+            sizeof( value_type ) <= sizeof( void* ) && alignof( value_type ) <= alignof( void* );
+
+    /**
+     * @brief The value_slot union  Storage of inline value or pointer to
+     *                              value in value_slab. Valid in finite
+     *                              node only.
+     */
+    union value_slot
+    {
+        alignas( void* ) unsigned char      bytes[ sizeof( void* ) ];
+        void                               *pointer;
+    };
+
+    value_slot                              slot;
 
 
 public:
+    /// @brief map_ptr      Pointer to prefix_tree_map (unique_ptr).
+    typedef std::unique_ptr<prefix_tree_map>    map_ptr;
+
+
     class iterator : public prefix_tree::iterator
     {
+        friend class prefix_tree_map;
+
+    private:
+        iterator( const prefix_tree::iterator &_ ) : prefix_tree::iterator( _ ) {}
+
     public:
         iterator() : prefix_tree::iterator() {}
-        iterator( prefix_tree_map *node_, const char *key )
-            : prefix_tree::iterator( node_, true, key ) {}
+        iterator( prefix_tree_map *root, const char *key )
+            : prefix_tree::iterator( root, true, key ) {}
         iterator( const iterator & ) = default;
 
         ~iterator() = default;
@@ -47,9 +93,9 @@ public:
          * @brief get_value
          * @return              Value of node.
          */
-        inline const value_type& get_value()
+        inline value_type& get_value()
         {
-            return static_cast<prefix_tree_map*>( node )->value;
+            return static_cast<prefix_tree_map*>( node )->value();
         }
 
     protected:
@@ -61,62 +107,62 @@ public:
 
     
 
-protected:
-    prefix_tree_map( prefix_tree *parent_ ) : prefix_tree( parent_ ), value() {}
-
 public:
-    prefix_tree_map() : prefix_tree(), value() {}
-    virtual ~prefix_tree_map() = default;
+    prefix_tree_map() : prefix_tree() {}
+
+    virtual ~prefix_tree_map()
+    {
+        if ( is_finite_node() )
+            destroy_value();
+    }
 
 
     /**
-     * @brief append    Append node to the tree.
+     * @brief append    Append node to the tree. Value of existing key is replaced.
      * @param key       Key.
      * @param value_    Value.
      * @return          true if success
      */
     inline bool append( const char *key, value_type &&value_ )
     {
-        auto appended = append_node( key );
-        if ( !appended.second )
+        if ( !key )
             return false;
 
-        static_cast<prefix_tree_map&>( appended.first ).value = std::move( value_ );
+        insert_or_assign( key, std::move( value_ ) );
         return true;
     }
 
 
     /**
-     * @brief append    Append node to the tree.
+     * @brief append    Append node to the tree. Value of existing key is replaced.
      * @param key       Key.
      * @param value_    Value.
      * @return          true if success
      */
     inline bool append( const std::string &key, value_type &&value_ )
     {
-        return append( key.c_str(), value_ );
+        return append( key.c_str(), std::move( value_ ) );
     }
 
 
     /**
-     * @brief append    Append node to the tree.
+     * @brief append    Append node to the tree. Value of existing key is replaced.
      * @param key       Key.
      * @param value_    Value.
      * @return          true if success
      */
     inline bool append( const char *key, const value_type &value_ )
     {
-        auto appended = append_node( key );
-        if ( !appended.second )
+        if ( !key )
             return false;
 
-        static_cast<prefix_tree_map&>( appended.first ).value = value_;
+        insert_or_assign( key, value_ );
         return true;
     }
 
 
     /**
-     * @brief append    Append node to the tree.
+     * @brief append    Append node to the tree. Value of existing key is replaced.
      * @param key       Key.
      * @param value_    Value.
      * @return          true if success
@@ -127,6 +173,291 @@ public:
     }
 
 
+    /**
+     * @brief try_emplace   Construct value in place if key is absent.
+     *                      Arguments are not touched if key is present.
+     *                      If constructor throws, the map is unchanged.
+     * @param key           Key (not nullptr).
+     * @param args          Arguments of constructor of value.
+     * @return              Pair where first is value of key second is
+     *                      flag value has been constructed.
+     */
+    template <typename... args_t>
+    std::pair<value_type&, bool> try_emplace( const char *key, args_t&&... args )
+    {
+        typename instrumentation_t::probe probe( operation::APPEND );
+
+        prefix_tree_map &node = static_cast<prefix_tree_map&>( *append_path( key, probe ) );
+        if ( node.is_finite_node() )
+            return std::pair<value_type&, bool>( node.value(), false );
+
+        try
+        {
+            node.construct_value( std::forward<args_t>( args )... );
+        }
+        catch ( ... )
+        {
+            // Nodes appended for the key are not left behind.
+            prune( key );
+            throw;
+        }
+        node.set_flag( NODE_FLAG::FINITE_NODE );
+        return std::pair<value_type&, bool>( node.value(), true );
+    }
+
+
+    /**
+     * @brief try_emplace   Construct value in place if key is absent.
+     * @param key           Key.
+     * @param args          Arguments of constructor of value.
+     * @return              Pair where first is value of key second is
+     *                      flag value has been constructed.
+     */
+    template <typename... args_t>
+    inline std::pair<value_type&, bool> try_emplace( const std::string &key, args_t&&... args )
+    {
+        return try_emplace( key.c_str(), std::forward<args_t>( args )... );
+    }
+
+
+    /**
+     * @brief emplace       Construct value in place if key is absent.
+     *                      Same as try_emplace().
+     * @param key           Key (not nullptr).
+     * @param args          Arguments of constructor of value.
+     * @return              Pair where first is value of key second is
+     *                      flag value has been constructed.
+     */
+    template <typename... args_t>
+    inline std::pair<value_type&, bool> emplace( const char *key, args_t&&... args )
+    {
+        return try_emplace( key, std::forward<args_t>( args )... );
+    }
+
+
+    /**
+     * @brief emplace       Construct value in place if key is absent.
+     * @param key           Key.
+     * @param args          Arguments of constructor of value.
+     * @return              Pair where first is value of key second is
+     *                      flag value has been constructed.
+     */
+    template <typename... args_t>
+    inline std::pair<value_type&, bool> emplace( const std::string &key, args_t&&... args )
+    {
+        return try_emplace( key.c_str(), std::forward<args_t>( args )... );
+    }
+
+
+    /**
+     * @brief insert_or_assign  Assign value of present key or construct
+     *                          value of absent key.
+     * @param key               Key (not nullptr).
+     * @param value_            Value, forwarded to assignment or constructor.
+     * @return                  Pair where first is value of key second is
+     *                          flag value has been constructed.
+     */
+    template <typename arg_t>
+    std::pair<value_type&, bool> insert_or_assign( const char *key, arg_t &&value_ )
+    {
+        typename instrumentation_t::probe probe( operation::APPEND );
+
+        prefix_tree_map &node = static_cast<prefix_tree_map&>( *append_path( key, probe ) );
+        if ( node.is_finite_node() )
+        {
+            node.value() = std::forward<arg_t>( value_ );
+            return std::pair<value_type&, bool>( node.value(), false );
+        }
+
+        try
+        {
+            node.construct_value( std::forward<arg_t>( value_ ) );
+        }
+        catch ( ... )
+        {
+            prune( key );
+            throw;
+        }
+        node.set_flag( NODE_FLAG::FINITE_NODE );
+        return std::pair<value_type&, bool>( node.value(), true );
+    }
+
+
+    /**
+     * @brief insert_or_assign  Assign value of present key or construct
+     *                          value of absent key.
+     * @param key               Key.
+     * @param value_            Value.
+     * @return                  Pair where first is value of key second is
+     *                          flag value has been constructed.
+     */
+    template <typename arg_t>
+    inline std::pair<value_type&, bool> insert_or_assign( const std::string &key, arg_t &&value_ )
+    {
+        return insert_or_assign( key.c_str(), std::forward<arg_t>( value_ ) );
+    }
+
+
+    /**
+     * @brief operator[]    Value of key. Absent key is appended with
+     *                      default constructed value.
+     * @param key           Key (not nullptr).
+     */
+    inline value_type& operator[]( const char *key )
+    {
+        return try_emplace( key ).first;
+    }
+
+
+    /**
+     * @brief operator[]    Value of key. Absent key is appended with
+     *                      default constructed value.
+     * @param key           Key.
+     */
+    inline value_type& operator[]( const std::string &key )
+    {
+        return try_emplace( key.c_str() ).first;
+    }
+
+
+    /**
+     * @brief get_value     Value of key without iterator.
+     * @param key           Key.
+     * @return              Pointer to value or nullptr if key is absent.
+     */
+    inline value_type* get_value( const char *key )
+    {
+        typename instrumentation_t::probe probe( operation::FIND );
+
+        const prefix_tree *node = find_node( key, true, probe );
+        return node ? &const_cast<prefix_tree_map*>( static_cast<const prefix_tree_map*>( node ) )->value() : nullptr;
+    }
+
+
+    /**
+     * @brief get_value     Value of key without iterator.
+     * @param key           Key.
+     * @return              Pointer to value or nullptr if key is absent.
+     */
+    inline value_type* get_value( const std::string &key )
+    {
+        return get_value( key.c_str() );
+    }
+
+
+    /**
+     * @brief remove    Remove key from the map.
+     * @param key       Key.
+     */
+    inline void remove( const char *key )
+    {
+        typename instrumentation_t::probe probe( operation::REMOVE );
+        remove_key( key, probe );
+    }
+
+
+    /**
+     * @brief remove    Remove key from the map.
+     * @param key       Key.
+     */
+    inline void remove( const std::string &key )
+    {
+        remove( key.c_str() );
+    }
+
+
+    /**
+     * @brief remove_lazy   Remove key, value is destroyed at once, nodes
+     *                      are freed by compact() later.
+     * @param key           Key.
+     * @return              true if key has existed.
+     */
+    inline bool remove_lazy( const std::string &key )
+    {
+        return prefix_tree::remove_lazy( key.c_str() );
+    }
+
+
+    /**
+     * @brief compact       Free nodes left by remove_lazy() step by step.
+     * @param step_budget   Count of nodes to visit and free.
+     * @return              true if work is left for next call.
+     */
+    inline bool compact( size_t step_budget )
+    {
+        return prefix_tree::compact( step_budget );
+    }
+
+
+    /**
+     * @brief remove_prefix Remove all keys started with prefix.
+     *                      Subtree of prefix is unlinked in one step.
+     * @param prefix        Prefix. Empty prefix clears the map.
+     */
+    inline void remove_prefix( const char *prefix )
+    {
+        prefix_tree::remove_prefix( prefix );
+    }
+
+
+    /**
+     * @brief remove_prefix Remove all keys started with prefix.
+     * @param prefix        Prefix. Empty prefix clears the map.
+     */
+    inline void remove_prefix( const std::string &prefix )
+    {
+        prefix_tree::remove_prefix( prefix );
+    }
+
+
+    /**
+     * @brief extract_subtree   Unlink subtree of prefix from the map.
+     * @param prefix            Prefix.
+     * @return                  Subtree as separate map, keys of it are
+     *                          relative to prefix. nullptr if prefix is not found.
+     */
+    inline map_ptr extract_subtree( const char *prefix )
+    {
+        return map_ptr( static_cast<prefix_tree_map*>( prefix_tree::extract_subtree( prefix ).release() ) );
+    }
+
+
+    /**
+     * @brief extract_subtree   Unlink subtree of prefix from the map.
+     * @param prefix            Prefix.
+     * @return                  Subtree as separate map or nullptr.
+     */
+    inline map_ptr extract_subtree( const std::string &prefix )
+    {
+        return extract_subtree( prefix.c_str() );
+    }
+
+
+    /**
+     * @brief insert_subtree    Link map as subtree of prefix without copying.
+     *                          If prefix is exist the map is merged to it.
+     * @param prefix            Prefix.
+     * @param subtree           Map.
+     * @return                  true if success.
+     */
+    inline bool insert_subtree( const char *prefix, map_ptr &&subtree )
+    {
+        return prefix_tree::insert_subtree( prefix, ptr( subtree.release() ) );
+    }
+
+
+    /**
+     * @brief insert_subtree    Link map as subtree of prefix without copying.
+     * @param prefix            Prefix.
+     * @param subtree           Map.
+     * @return                  true if success.
+     */
+    inline bool insert_subtree( const std::string &prefix, map_ptr &&subtree )
+    {
+        return insert_subtree( prefix.c_str(), std::move( subtree ) );
+    }
+
+
     /**
      * @brief find      Find node by key.
      * @param key       Key.
@@ -135,11 +466,8 @@ public:
      */
     iterator find( const char *key )
     {
-        prefix_tree *found = (prefix_tree*)( find_node( key ) );
-        return found ?
-                    iterator( static_cast<prefix_tree_map*>( found ), key ) :
-                    iterator()
-        ;
+        typename instrumentation_t::probe probe( operation::FIND );
+        return iterator( prefix_tree::find( key, true, probe ) );
     }
 
 
@@ -163,7 +491,8 @@ public:
      */
     inline bool exists( const char *key, bool finite_node = true ) const
     {
-        return prefix_tree::exists(key, finite_node);
+        typename instrumentation_t::probe probe( operation::FIND );
+        return find_node( key, finite_node, probe ) != nullptr;
     }
 
 
@@ -175,7 +504,52 @@ public:
      */
     inline bool exists( const std::string &key, bool finite_node = true ) const
     {
-        return prefix_tree::exists(key, finite_node);
+        return exists( key.c_str(), finite_node );
+    }
+
+
+    /**
+     * @brief lower_bound   Find first key not less than key.
+     * @param key           Key, it may be absent in the map.
+     * @return              Iterator or end() if all keys are less.
+     */
+    inline iterator lower_bound( const char *key )
+    {
+        return iterator( prefix_tree::lower_bound( key, true ) );
+    }
+
+
+    inline iterator lower_bound( const std::string &key )
+    {
+        return lower_bound( key.c_str() );
+    }
+
+
+    /**
+     * @brief upper_bound   Find first key greater than key.
+     * @param key           Key, it may be absent in the map.
+     * @return              Iterator or end() if no key is greater.
+     */
+    inline iterator upper_bound( const char *key )
+    {
+        return iterator( prefix_tree::upper_bound( key, true ) );
+    }
+
+
+    inline iterator upper_bound( const std::string &key )
+    {
+        return upper_bound( key.c_str() );
+    }
+
+
+    /**
+     * @brief range         Keys in [ from, to ).
+     * @return              Pair of iterators to loop from first to second.
+     */
+    std::pair<iterator, iterator> range( const std::string &from, const std::string &to )
+    {
+        auto r = prefix_tree::range( from, to, true );
+        return std::make_pair( iterator( r.first ), iterator( r.second ) );
     }
 
 
@@ -198,10 +572,209 @@ public:
      */
     iterator end() { return iterator(); }
 
+
+    /**
+     * @brief memory_usage  Count memory used by the map.
+     * @return              Report of memory usage.
+     */
+    inline memory_usage_info memory_usage() const
+    {
+        return prefix_tree::memory_usage();
+    }
+
+
+    /**
+     * @brief stats         Collect statistics of the map in one traversal.
+     * @return              Statistics.
+     */
+    inline statistics stats() const
+    {
+        return prefix_tree::stats();
+    }
+
+
+    /**
+     * @brief merge         Append all keys of other map. If key is present
+     *                      in both maps value of the map is kept.
+     *                      Subtrees which are absent in the map are moved
+     *                      from other map without copying.
+     * @param other         Map to merge. It is empty after merge.
+     * @param parallel      Process children of root in parallel.
+     */
+    inline void merge( prefix_tree_map &&other, bool parallel = false )
+    {
+        prefix_tree::merge( std::move( other ), parallel );
+    }
+
+
+    /**
+     * @brief intersect     Remove keys which are absent in other map.
+     * @param other         Other map.
+     * @param parallel      Process children of root in parallel.
+     */
+    inline void intersect( const prefix_tree_map &other, bool parallel = false )
+    {
+        prefix_tree::intersect( other, parallel );
+    }
+
+
+    /**
+     * @brief difference    Remove keys which are present in other map.
+     * @param other         Other map.
+     * @param parallel      Process children of root in parallel.
+     */
+    inline void difference( const prefix_tree_map &other, bool parallel = false )
+    {
+        prefix_tree::difference( other, parallel );
+    }
+
+
+    /**
+     * @brief relayout      Copy nodes of the map to one contiguous arena
+     *                      in cache friendly order (see prefix_tree::relayout()).
+     *                      NOTE! All iterators of the map are invalidated.
+     */
+    inline void relayout()
+    {
+        prefix_tree::relayout();
+    }
+
+
+    /**
+     * @brief parallel_for_each     Call function for every key of prefix on
+     *                              executor (see prefix_tree::parallel_for_each()).
+     * @param prefix                Prefix, empty for all keys.
+     * @param function              Thread safe function( const std::string &key, value_type &value ).
+     * @param ex                    Executor.
+     */
+    template <typename function_t>
+    void parallel_for_each( const std::string &prefix, function_t &&function, executor &ex = executor::instance() )
+    {
+        struct none {};
+        reduce_subtrees(
+                    prefix.c_str(), ex, none(),
+                    [&] ( const std::string &key, prefix_tree &node )
+                    {
+                        function( key, static_cast<prefix_tree_map&>( node ).value() );
+                        return none();
+                    },
+                    [] ( none &&, none && ) { return none(); }
+        );
+    }
+
+
+    /**
+     * @brief parallel_reduce       Map every key and value of prefix on
+     *                              executor and reduce results in key order
+     *                              (see prefix_tree::parallel_reduce()).
+     * @param prefix                Prefix, empty for all keys.
+     * @param init                  Identity of reduce.
+     * @param map                   Thread safe function( const std::string &key, value_type &value ) -> result_t.
+     * @param reduce                Associative function( result_t &&left, result_t &&right ) -> result_t.
+     * @param ex                    Executor.
+     * @return                      Result.
+     */
+    template <typename result_t, typename map_t, typename reduce_t>
+    result_t parallel_reduce( const std::string &prefix, result_t init, map_t &&map, reduce_t &&reduce, executor &ex = executor::instance() )
+    {
+        return reduce_subtrees(
+                    prefix.c_str(), ex, std::move( init ),
+                    [&] ( const std::string &key, prefix_tree &node ) { return map( key, static_cast<prefix_tree_map&>( node ).value() ); },
+                    reduce
+        );
+    }
+
 protected:
-    virtual prefix_tree *new_node( prefix_tree *parent_ ) override
+    virtual prefix_tree *new_node() override
+    {
+        return new prefix_tree_map();
+    }
+
+
+    virtual size_t node_size() const override
+    {
+        return sizeof( prefix_tree_map );
+    }
+
+
+    virtual size_t value_size() const override
+    {
+        return is_finite_node() && !INLINE_VALUE ? sizeof( value_type ) : 0;
+    }
+
+
+    virtual void move_value( prefix_tree &other ) override
+    {
+        construct_value( std::move( static_cast<prefix_tree_map&>( other ).value() ) );
+    }
+
+
+    virtual void destroy_value() override
+    {
+        value().~value_type();
+
+        if ( !INLINE_VALUE )
+            value_slab<value_type>::deallocate( slot.pointer );
+    }
+
+
+    /**
+     * Nodes of the map for classes derived at the root (see
+     * prefix_tree_cache): they have no access to protected members of
+     * nodes which are not of their type.
+     */
+
+    /// @brief node_value   Value of finite node.
+    static inline value_type& node_value( prefix_tree *node )
+    {
+        return static_cast<prefix_tree_map*>( node )->value();
+    }
+
+
+    static inline bool node_referenced( const prefix_tree *node )
+    {
+        return static_cast<const prefix_tree_map*>( node )->is_referenced();
+    }
+
+
+    static inline void set_node_referenced( prefix_tree *node, bool on )
     {
-        return new prefix_tree_map<value_type>( parent_ );
+        static_cast<prefix_tree_map*>( node )->set_referenced( on );
+    }
+
+private:
+    /// @brief value    Value of finite node.
+    inline value_type& value()
+    {
+        void *storage = INLINE_VALUE ? static_cast<void*>( slot.bytes ) : slot.pointer;
+        return *std::launder( static_cast<value_type*>( storage ) );
+    }
+
+
+    /**
+     * @brief construct_value   Construct value of node which is not finite yet.
+     * @param args              Arguments of constructor of value.
+     */
+    template <typename... args_t>
+    void construct_value( args_t&&... args )
+    {
+        if ( INLINE_VALUE )
+        {
+            ::new ( static_cast<void*>( slot.bytes ) ) value_type( std::forward<args_t>( args )... );
+            return;
+        }
+
+        void *storage = value_slab<value_type>::allocate();
+        try
+        {
+            ::new ( storage ) value_type( std::forward<args_t>( args )... );
+        }
+        catch ( ... )
+        {
+            value_slab<value_type>::deallocate( storage );
+            throw;
+        }
+        slot.pointer = storage;
     }
 };
 
@@ -209,4 +782,4 @@ protected:
 } // namespace prefix_tree
 
 
-#endif // PREFIX_TREE_H
+#endif // PREFIX_TREE_MAP_H
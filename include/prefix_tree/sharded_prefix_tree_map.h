@@ -0,0 +1,346 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef SHARDED_PREFIX_TREE_MAP_H
+#define SHARDED_PREFIX_TREE_MAP_H
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <vector>
+
+#include "executor.h"
+#include "prefix_tree_map.h"
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The leading_byte_shard struct     Shard by first byte of key. Shards
+ *                                          keep contiguous ranges of keys.
+ */
+struct leading_byte_shard
+{
+    inline size_t operator()( const char *key, size_t shards ) const
+    {
+        return static_cast<size_t>( static_cast<unsigned char>( *key ) ) * shards / 256;
+    }
+};
+
+
+/**
+ * @brief The prefix_hash_shard struct      Shard by FNV-1a hash of first
+ *                                          prefix_len bytes of key. Spreads
+ *                                          skewed first bytes.
+ * @param prefix_len                        Length of hashed prefix.
+ */
+template <size_t prefix_len = 2>
+struct prefix_hash_shard
+{
+    inline size_t operator()( const char *key, size_t shards ) const
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for ( size_t i = 0; i < prefix_len && key[ i ]; ++i )
+        {
+            hash ^= static_cast<unsigned char>( key[ i ] );
+            hash *= 1099511628211ull;
+        }
+        return static_cast<size_t>( hash % shards );
+    }
+};
+
+
+/**
+ * @brief The sharded_prefix_tree_map class     key => value container split
+ *                                              to N prefix_tree_map shards,
+ *                                              every shard is guarded by own
+ *                                              shared mutex.
+ * @param value_type                            Type of value.
+ * @param N                                     Count of shards.
+ * @param shard_t                               Function of key and N returning
+ *                                              shard of key.
+ */
+template <typename value_type, size_t N, typename shard_t = leading_byte_shard>
+class sharded_prefix_tree_map
+{
+    static_assert( N > 0, "at least one shard is required" );
+
+private:
+    typedef prefix_tree_map<value_type>         shard_map;
+
+    struct shard
+    {
+        mutable std::shared_mutex               lock;
+        shard_map                               map;
+    };
+
+    std::array<shard, N>                        shards;
+    shard_t                                     shard_of;
+
+public:
+    sharded_prefix_tree_map() : shards(), shard_of() {}
+
+    sharded_prefix_tree_map( const sharded_prefix_tree_map & ) = delete;
+    sharded_prefix_tree_map& operator=( const sharded_prefix_tree_map & ) = delete;
+
+
+    /**
+     * @brief insert_or_assign  Set value of key.
+     * @param key               Key.
+     * @param value_            Value.
+     * @return                  true if key has been appended.
+     */
+    template <typename arg_t>
+    bool insert_or_assign( const char *key, arg_t &&value_ )
+    {
+        if ( !key )
+            return false;
+
+        shard &s = get_shard( key );
+        std::unique_lock<std::shared_mutex> guard( s.lock );
+        return s.map.insert_or_assign( key, std::forward<arg_t>( value_ ) ).second;
+    }
+
+
+    template <typename arg_t>
+    inline bool insert_or_assign( const std::string &key, arg_t &&value_ )
+    {
+        return insert_or_assign( key.c_str(), std::forward<arg_t>( value_ ) );
+    }
+
+
+    /**
+     * @brief try_emplace   Construct value in place if key is absent.
+     * @return              true if key has been appended.
+     */
+    template <typename... args_t>
+    bool try_emplace( const char *key, args_t&&... args )
+    {
+        if ( !key )
+            return false;
+
+        shard &s = get_shard( key );
+        std::unique_lock<std::shared_mutex> guard( s.lock );
+        return s.map.try_emplace( key, std::forward<args_t>( args )... ).second;
+    }
+
+
+    template <typename... args_t>
+    inline bool try_emplace( const std::string &key, args_t&&... args )
+    {
+        return try_emplace( key.c_str(), std::forward<args_t>( args )... );
+    }
+
+
+    /**
+     * @brief remove    Remove key.
+     * @param key       Key, nullptr is ignored.
+     */
+    void remove( const char *key )
+    {
+        if ( !key )
+            return;
+
+        shard &s = get_shard( key );
+        std::unique_lock<std::shared_mutex> guard( s.lock );
+        s.map.remove( key );
+    }
+
+
+    inline void remove( const std::string &key )
+    {
+        remove( key.c_str() );
+    }
+
+
+    /**
+     * @brief exists    Check key is exist.
+     * @param key       Key, nullptr is ignored.
+     */
+    bool exists( const char *key ) const
+    {
+        if ( !key )
+            return false;
+
+        const shard &s = get_shard( key );
+        std::shared_lock<std::shared_mutex> guard( s.lock );
+        return s.map.exists( key );
+    }
+
+
+    inline bool exists( const std::string &key ) const
+    {
+        return exists( key.c_str() );
+    }
+
+
+    /**
+     * @brief find      Copy value of key.
+     * @param key       Key.
+     * @param value_    Value of key if it is found.
+     * @return          true if key is found.
+     */
+    bool find( const char *key, value_type &value_ ) const
+    {
+        if ( !key )
+            return false;
+
+        const shard &s = get_shard( key );
+        std::shared_lock<std::shared_mutex> guard( s.lock );
+
+        const value_type *found = const_cast<shard_map&>( s.map ).get_value( key );
+        if ( !found )
+            return false;
+
+        value_ = *found;
+        return true;
+    }
+
+
+    inline bool find( const std::string &key, value_type &value_ ) const
+    {
+        return find( key.c_str(), value_ );
+    }
+
+
+    /**
+     * @brief update    Call function for value of key under exclusive lock of shard.
+     * @param key       Key.
+     * @param f         Function( value_type &value ).
+     * @return          true if key is found.
+     */
+    template <typename function_t>
+    bool update( const char *key, function_t &&f )
+    {
+        if ( !key )
+            return false;
+
+        shard &s = get_shard( key );
+        std::unique_lock<std::shared_mutex> guard( s.lock );
+
+        value_type *found = s.map.get_value( key );
+        if ( !found )
+            return false;
+
+        f( *found );
+        return true;
+    }
+
+
+    template <typename function_t>
+    inline bool update( const std::string &key, function_t &&f )
+    {
+        return update( key.c_str(), std::forward<function_t>( f ) );
+    }
+
+
+    /**
+     * @brief for_each      Visit all keys in order. Shards are merged by
+     *                      k-way heap under shared locks of all shards.
+     * @param callback      Function( const std::string &key, const value_type &value ).
+     */
+    template <typename callback_t>
+    void for_each( callback_t &&callback ) const
+    {
+        std::array<std::shared_lock<std::shared_mutex>, N> guards;
+        for ( size_t i = 0; i < N; ++i )
+            guards[ i ] = std::shared_lock<std::shared_mutex>( shards[ i ].lock );
+
+        typedef typename shard_map::iterator        shard_iterator;
+        typedef std::pair<std::string, size_t>      head;
+
+        std::array<shard_iterator, N>                                       its;
+        std::priority_queue<head, std::vector<head>, std::greater<head> >  heap;
+
+        for ( size_t i = 0; i < N; ++i )
+        {
+            its[ i ] = const_cast<shard_map&>( shards[ i ].map ).begin();
+            if ( its[ i ] != shard_iterator() )
+                heap.emplace( its[ i ].get_key(), i );
+        }
+
+        while ( !heap.empty() )
+        {
+            size_t i = heap.top().second;
+            callback( heap.top().first, static_cast<const value_type&>( its[ i ].get_value() ) );
+            heap.pop();
+
+            if ( ++its[ i ] != shard_iterator() )
+                heap.emplace( its[ i ].get_key(), i );
+        }
+    }
+
+
+    /**
+     * @brief parallel_for_each     Visit all keys, every shard is a task of
+     *                              executor and is visited under shared
+     *                              lock. Order of keys is kept inside shard
+     *                              only.
+     * @param callback              Thread safe function( const std::string &key, const value_type &value ).
+     * @param ex                    Executor.
+     */
+    template <typename callback_t>
+    void parallel_for_each( callback_t &&callback, executor &ex = executor::instance() ) const
+    {
+        executor::task_group group( ex );
+        for ( size_t i = 0; i < N; ++i )
+        {
+            group.run( [this, &callback, i] ()
+            {
+                std::shared_lock<std::shared_mutex> guard( shards[ i ].lock );
+
+                shard_map &map = const_cast<shard_map&>( shards[ i ].map );
+                for ( auto it = map.begin(); it != map.end(); ++it )
+                    callback( it.get_key(), static_cast<const value_type&>( it.get_value() ) );
+            } );
+        }
+        group.wait();
+    }
+
+
+    /**
+     * @brief memory_usage  Memory used by all shards.
+     */
+    typename shard_map::memory_usage_info memory_usage() const
+    {
+        typename shard_map::memory_usage_info info = { 0, 0, 0, 0, 0 };
+        for ( const shard &s : shards )
+        {
+            std::shared_lock<std::shared_mutex> guard( s.lock );
+            auto usage = s.map.memory_usage();
+
+            info.nodes           += usage.nodes;
+            info.leaves          += usage.leaves;
+            info.node_bytes      += usage.node_bytes;
+            info.container_bytes += usage.container_bytes;
+            info.value_bytes     += usage.value_bytes;
+        }
+        return info;
+    }
+
+private:
+    inline shard& get_shard( const char *key )
+    {
+        return shards[ shard_of( key, N ) % N ];
+    }
+
+
+    inline const shard& get_shard( const char *key ) const
+    {
+        return shards[ shard_of( key, N ) % N ];
+    }
+};
+
+
+} // namespace prefix_tree
+
+#endif // SHARDED_PREFIX_TREE_MAP_H
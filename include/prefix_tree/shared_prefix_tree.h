@@ -0,0 +1,169 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef SHARED_PREFIX_TREE_H
+#define SHARED_PREFIX_TREE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The self_relative_ptr class   Pointer kept as distance from its own
+ *                                      address, valid in any process which
+ *                                      maps the segment at any address.
+ * @param type                          Type of target.
+ */
+template <typename type>
+class self_relative_ptr
+{
+private:
+    std::atomic<int64_t>                    diff;
+
+public:
+    self_relative_ptr() : diff( 0 ) {}
+
+    self_relative_ptr( const self_relative_ptr & ) = delete;
+    self_relative_ptr& operator=( const self_relative_ptr & ) = delete;
+
+
+    inline type* load( std::memory_order order = std::memory_order_acquire ) const
+    {
+        int64_t d = diff.load( order );
+        return d ? reinterpret_cast<type*>( const_cast<char*>( reinterpret_cast<const char*>( this ) ) + d ) : nullptr;
+    }
+
+
+    inline void store( type *target, std::memory_order order = std::memory_order_release )
+    {
+        diff.store( target ? reinterpret_cast<char*>( target ) - reinterpret_cast<char*>( this ) : 0, order );
+    }
+};
+
+
+/**
+ * @brief The shared_prefix_tree class  key => uint64_t index in named shared
+ *                                      memory segment, shared by processes.
+ *
+ * Nodes and blocks of children live in the segment and refer each other by
+ * self_relative_ptr. Writers of all processes are serialized by robust
+ * process shared mutex. Readers take no lock: blocks of children are
+ * immutable, writer publishes new block by one atomic store, so a crash
+ * of writer never leaves the tree inconsistent (its allocations may leak).
+ * Replaced nodes and blocks are reclaimed by epochs: reader announces
+ * epoch in slot of the segment, memory retired before epoch of all active
+ * readers is reused. Slots of dead processes are released by writers.
+ * There are 256 reader slots in segment: at most 256 threads of all
+ * processes read at once, reader which finds no free slot for a second
+ * throws std::system_error( ETIMEDOUT ).
+ *
+ * Segment has fixed size, append() throws std::bad_alloc if it is full,
+ * small reserve at the end is left for remove().
+ * Errors of system calls are thrown as std::system_error.
+ */
+class shared_prefix_tree
+{
+public:
+    /// @brief DEFAULT_SIZE     Default size of segment.
+    static constexpr size_t                 DEFAULT_SIZE = 64 << 20;
+
+private:
+    struct segment;
+
+    segment                                *seg;
+    size_t                                  mapped;
+
+public:
+    /**
+     * @brief shared_prefix_tree    Open segment, create and initialize it
+     *                              if it does not exist.
+     * @param name                  Name of segment for shm_open(), "/name".
+     * @param size                  Size of new segment.
+     */
+    explicit shared_prefix_tree( const std::string &name, size_t size = DEFAULT_SIZE );
+    ~shared_prefix_tree();
+
+    shared_prefix_tree( const shared_prefix_tree & ) = delete;
+    shared_prefix_tree& operator=( const shared_prefix_tree & ) = delete;
+
+
+    /**
+     * @brief unlink    Remove name of segment, mapped segments stay valid.
+     * @param name      Name of segment.
+     */
+    static void unlink( const std::string &name );
+
+
+    /**
+     * @brief append    Set value of key under writer lock.
+     * @param key       Key.
+     * @param value     Value.
+     * @return          true if key has been appended.
+     */
+    bool append( const std::string &key, uint64_t value = 0 );
+
+
+    /**
+     * @brief remove    Remove key under writer lock.
+     * @param key       Key.
+     * @return          true if key has existed.
+     */
+    bool remove( const std::string &key );
+
+
+    /**
+     * @brief find      Find value of key without lock.
+     * @param key       Key.
+     * @param value     Value of key if it is found.
+     * @return          true if key is found.
+     * @throw           std::system_error if no reader slot is free.
+     */
+    bool find( const std::string &key, uint64_t &value ) const;
+
+
+    /// @brief exists   Check key is exist without lock.
+    inline bool exists( const std::string &key ) const
+    {
+        uint64_t value;
+        return find( key, value );
+    }
+
+
+    /**
+     * @brief for_each      Visit keys of prefix in order without lock. Keys
+     *                      changed meanwhile may be visited or not.
+     * @param prefix        Prefix, empty for all keys.
+     * @param callback      Function( const std::string &key, uint64_t value ).
+     */
+    void for_each( const std::string &prefix, const std::function<void( const std::string&, uint64_t )> &callback ) const;
+
+
+    /// @brief size     Count of keys.
+    size_t size() const;
+
+
+    /// @brief used_bytes   Bytes of segment allocated by nodes, blocks
+    ///                     and retired memory not reclaimed yet.
+    size_t used_bytes() const;
+
+
+    /// @brief reclaim      Reuse retired memory not visible to readers.
+    ///                     Writers call it after every change.
+    void reclaim();
+};
+
+
+} // namespace prefix_tree
+
+#endif // SHARED_PREFIX_TREE_H
@@ -0,0 +1,97 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * Byte kernels with implementation selected at run time by CPU features.
+ * SSE2 is baseline of x86_64, AVX2 is used if CPU supports it. Other
+ * platforms use scalar code.
+ */
+namespace simd
+{
+
+
+/**
+ * @brief The level enum    Instruction set of kernels.
+ */
+enum class level
+{
+    SCALAR = 0,
+    SSE2,
+    AVX2
+};
+
+
+/// @brief lower_bound_fn   See lower_bound().
+typedef size_t ( *lower_bound_fn )( const unsigned char *labels, size_t n, unsigned char c );
+/// @brief mismatch_fn      See mismatch().
+typedef size_t ( *mismatch_fn )( const unsigned char *a, const unsigned char *b, size_t n );
+
+
+/**
+ * @brief The kernels struct    Kernels of one level.
+ */
+struct kernels
+{
+    lower_bound_fn                          lower_bound;
+    mismatch_fn                             mismatch;
+};
+
+
+/**
+ * @brief supported     Check CPU supports level.
+ */
+bool supported( level l );
+
+
+/**
+ * @brief best_level    Highest level supported by CPU.
+ */
+level best_level();
+
+
+/**
+ * @brief get_kernels   Kernels of level (for tests and benchmarks).
+ * @param l             Level, must be supported.
+ */
+kernels get_kernels( level l );
+
+
+/**
+ * @brief lower_bound   Index of first label not less than c.
+ * @param labels        Labels sorted as unsigned char.
+ * @param n             Count of labels.
+ * @param c             Label to look for.
+ * @return              Index in [0, n].
+ */
+size_t lower_bound( const unsigned char *labels, size_t n, unsigned char c );
+
+
+/**
+ * @brief mismatch      Index of first different byte.
+ * @param a             First string.
+ * @param b             Second string.
+ * @param n             Length of strings.
+ * @return              Index in [0, n], n if strings are equal.
+ */
+size_t mismatch( const unsigned char *a, const unsigned char *b, size_t n );
+
+
+} // namespace simd
+
+} // namespace prefix_tree
+
+#endif // SIMD_H
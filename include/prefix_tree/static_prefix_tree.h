@@ -0,0 +1,231 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef STATIC_PREFIX_TREE_H
+#define STATIC_PREFIX_TREE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The static_prefix_tree class  Fixed set of keys compiled to flat
+ *                                      table of transitions, no heap and
+ *                                      no startup cost.
+ *
+ * Bytes used by keys are mapped to classes 1..CLASSES-1, other bytes to 0.
+ * State 0 is dead and loops to itself, state 1 is root, so lookup is one
+ * table load per byte of key without branches on content.
+ *
+ * Usually built by make_static_prefix_tree<keys>().
+ *
+ * @param KEYS                          Count of keys.
+ * @param STATES                        Count of states: dead, root and one
+ *                                      per distinct non empty prefix.
+ * @param CLASSES                       Count of byte classes.
+ */
+template <size_t KEYS, size_t STATES, size_t CLASSES>
+class static_prefix_tree
+{
+public:
+    /// @brief state_type   Smallest type of state index.
+    typedef typename std::conditional<STATES <= 0x100, uint8_t,
+            typename std::conditional<STATES <= 0x10000, uint16_t, uint32_t>::type>::type state_type;
+
+    static constexpr int                    NOT_FOUND = -1;
+
+private:
+    std::array<uint8_t, 256>                classes;
+    std::array<state_type, STATES * CLASSES> next;
+    /// @brief index    Index of key of state or NOT_FOUND.
+    std::array<int32_t, STATES>             index;
+
+public:
+    /**
+     * @brief static_prefix_tree    Build tables.
+     * @param keys                  Keys, index of duplicate is the first one.
+     */
+    template <typename keys_type>
+    constexpr explicit static_prefix_tree( const keys_type &keys ) : classes(), next(), index()
+    {
+        for ( size_t i = 0; i < KEYS; ++i )
+        {
+            for ( unsigned char c : std::string_view( keys[ i ] ) )
+                classes[ c ] = 1;
+        }
+
+        size_t used = 0;
+        for ( auto &c : classes )
+            c = c ? static_cast<uint8_t>( ++used ) : 0;
+
+        for ( auto &i : index )
+            i = NOT_FOUND;
+
+        size_t states = 2;
+        for ( size_t i = 0; i < KEYS; ++i )
+        {
+            size_t s = 1;
+            for ( unsigned char c : std::string_view( keys[ i ] ) )
+            {
+                state_type &t = next[ s * CLASSES + classes[ c ] ];
+                if ( !t )
+                    t = static_cast<state_type>( states++ );
+                s = t;
+            }
+
+            if ( index[ s ] == NOT_FOUND )
+                index[ s ] = static_cast<int32_t>( i );
+        }
+    }
+
+
+    /**
+     * @brief find      Look up key.
+     * @param key       Key.
+     * @return          Index of key in keys of tree or NOT_FOUND.
+     */
+    constexpr int find( std::string_view key ) const
+    {
+        size_t s = 1;
+        for ( unsigned char c : key )
+            s = next[ s * CLASSES + classes[ c ] ];
+        return index[ s ];
+    }
+
+
+    /// @brief exists   Check key is exist.
+    constexpr bool exists( std::string_view key ) const
+    {
+        return find( key ) != NOT_FOUND;
+    }
+
+
+    /**
+     * @brief longest_prefix    Find the longest key which is prefix of text.
+     * @param text              Text.
+     * @param length            Length of key found.
+     * @return                  Index of key or NOT_FOUND.
+     */
+    constexpr int longest_prefix( std::string_view text, size_t &length ) const
+    {
+        size_t  s     = 1;
+        int     found = index[ s ];
+
+        length = 0;
+        for ( size_t i = 0; i < text.size() && s; ++i )
+        {
+            s = next[ s * CLASSES + classes[ static_cast<unsigned char>( text[ i ] ) ] ];
+            if ( index[ s ] != NOT_FOUND )
+            {
+                found  = index[ s ];
+                length = i + 1;
+            }
+        }
+        return found;
+    }
+
+
+    /// @brief size     Count of keys, duplicates included.
+    static constexpr size_t size() { return KEYS; }
+
+
+    /// @brief memory_usage     Size of tables.
+    static constexpr size_t memory_usage() { return sizeof( static_prefix_tree ); }
+};
+
+
+namespace static_prefix_tree_detail
+{
+
+
+/// @brief count_states     Dead state, root and every distinct non empty prefix.
+template <typename keys_type>
+constexpr size_t count_states( const keys_type &keys )
+{
+    size_t states = 2;
+
+    for ( size_t i = 0; i < std::size( keys ); ++i )
+    {
+        std::string_view   key    = keys[ i ];
+        size_t             shared = 0;
+
+        for ( size_t j = 0; j < i; ++j )
+        {
+            std::string_view   other = keys[ j ];
+            size_t             l     = 0;
+            while ( l < key.size() && l < other.size() && key[ l ] == other[ l ] )
+                ++l;
+            if ( l > shared )
+                shared = l;
+        }
+
+        states += key.size() - shared;
+    }
+
+    return states;
+}
+
+
+/// @brief count_classes    Distinct bytes of keys and class of other bytes.
+template <typename keys_type>
+constexpr size_t count_classes( const keys_type &keys )
+{
+    bool    used[ 256 ] = {};
+    size_t  classes     = 1;
+
+    for ( size_t i = 0; i < std::size( keys ); ++i )
+    {
+        for ( unsigned char c : std::string_view( keys[ i ] ) )
+        {
+            if ( !used[ c ] )
+            {
+                used[ c ] = true;
+                ++classes;
+            }
+        }
+    }
+
+    return classes;
+}
+
+
+} // namespace static_prefix_tree_detail
+
+
+/**
+ * @brief make_static_prefix_tree   Build tree of constexpr array of keys at
+ *                                  compile time:
+ *
+ *     static constexpr std::string_view METHODS[] = { "GET", "HEAD", "POST" };
+ *     static constexpr auto methods = make_static_prefix_tree<METHODS>();
+ *     static_assert( methods.find( "HEAD" ) == 1 );
+ *
+ * @param keys                      Array of std::string_view or const char*
+ *                                  of static storage duration.
+ */
+template <const auto &keys>
+constexpr auto make_static_prefix_tree()
+{
+    return static_prefix_tree<
+        std::size( keys ),
+        static_prefix_tree_detail::count_states( keys ),
+        static_prefix_tree_detail::count_classes( keys )
+    >( keys );
+}
+
+
+} // namespace prefix_tree
+
+#endif // STATIC_PREFIX_TREE_H
@@ -0,0 +1,190 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef VALUE_SLAB_H
+#define VALUE_SLAB_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief The value_slab class      Pool of storage for values too large to
+ *                                  be kept inline in node. Storage is taken
+ *                                  from chunks of CHUNK_BYTES and reused
+ *                                  through free list, so values of one type
+ *                                  are packed densely.
+ *
+ * One pool per value type is shared by all maps and threads. Every thread
+ * keeps its own free list and moves BATCH slots to or from the pool under
+ * one lock, so maps of different threads do not contend on every value.
+ * Free list of thread is returned to the pool when the thread exits.
+ *
+ * Chunks are kept until process exit: memory of values is reused by maps
+ * of the same value type but is never returned to the system.
+ */
+template <typename value_type>
+class value_slab
+{
+public:
+    /// @brief CHUNK_BYTES  Approximate size of chunk.
+    static constexpr size_t                 CHUNK_BYTES = 64 * 1024;
+    /// @brief BATCH        Count of slots moved between thread and pool.
+    static constexpr size_t                 BATCH       = 64;
+
+private:
+    union slot
+    {
+        slot                               *next;
+        alignas( value_type ) unsigned char storage[ sizeof( value_type ) ];
+    };
+
+    static constexpr size_t                 CHUNK_SLOTS =
+            CHUNK_BYTES / sizeof( slot ) > 16 ? CHUNK_BYTES / sizeof( slot ) : 16;
+
+    struct pool
+    {
+        std::mutex                              lock;
+        slot                                   *free = nullptr;
+        std::vector<std::unique_ptr<slot[]> >   chunks;
+    };
+
+    /// @brief The local struct     Free list of thread.
+    struct local
+    {
+        slot                                   *free   = nullptr;
+        size_t                                  count  = 0;
+        /// @brief closed   Thread exits, slots go to pool one by one.
+        bool                                    closed = false;
+    };
+
+    /// @brief The flusher struct   Returns free list of thread to pool.
+    struct flusher
+    {
+        ~flusher()
+        {
+            local &l = cache();
+            l.closed = true;
+            release( l, l.count );
+        }
+    };
+
+public:
+    /**
+     * @brief allocate      Take storage for one value.
+     * @return              Uninitialized storage.
+     */
+    static void* allocate()
+    {
+        local &l = cache();
+        if ( !l.free )
+            refill( l, l.closed ? 1 : BATCH );
+
+        slot *s = l.free;
+        l.free  = s->next;
+        --l.count;
+        return s->storage;
+    }
+
+
+    /**
+     * @brief deallocate    Return storage of destroyed value.
+     * @param storage       Storage returned by allocate().
+     */
+    static void deallocate( void *storage )
+    {
+        local &l = cache();
+
+        slot *s = static_cast<slot*>( storage );
+        s->next = l.free;
+        l.free  = s;
+        ++l.count;
+
+        if ( l.closed )
+            release( l, l.count );
+        else if ( l.count > 2 * BATCH )
+            release( l, BATCH );
+    }
+
+private:
+    static pool& instance()
+    {
+        // Never destroyed: static maps may release values after
+        // destruction of function local statics.
+        static pool *p = new pool();
+        return *p;
+    }
+
+
+    static local& cache()
+    {
+        // local is trivially destructible, so it stays usable for values
+        // released after flusher of thread is destroyed.
+        static thread_local local   l;
+        static thread_local flusher f;
+        return l;
+    }
+
+
+    /// @brief refill   Move n slots from pool to free list of thread.
+    static void refill( local &l, size_t n )
+    {
+        pool &p = instance();
+        std::lock_guard<std::mutex> guard( p.lock );
+
+        for ( size_t i = 0; i < n; ++i )
+        {
+            if ( !p.free )
+            {
+                p.chunks.emplace_back( new slot[ CHUNK_SLOTS ] );
+
+                slot *chunk = p.chunks.back().get();
+                for ( size_t j = 0; j < CHUNK_SLOTS; ++j )
+                    chunk[ j ].next = j + 1 < CHUNK_SLOTS ? chunk + j + 1 : nullptr;
+                p.free = chunk;
+            }
+
+            slot *s = p.free;
+            p.free  = s->next;
+            s->next = l.free;
+            l.free  = s;
+        }
+
+        l.count += n;
+    }
+
+
+    /// @brief release  Move first n slots of free list of thread to pool.
+    static void release( local &l, size_t n )
+    {
+        if ( !n )
+            return;
+
+        slot *first = l.free;
+        slot *last  = first;
+        for ( size_t i = 1; i < n; ++i )
+            last = last->next;
+
+        l.free   = last->next;
+        l.count -= n;
+
+        pool &p = instance();
+        std::lock_guard<std::mutex> guard( p.lock );
+        last->next = p.free;
+        p.free     = first;
+    }
+};
+
+
+} // namespace prefix_tree
+
+#endif // VALUE_SLAB_H
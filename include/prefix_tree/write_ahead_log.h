@@ -0,0 +1,291 @@
+/**
+ * Prefix tree library.
+ *
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+
+namespace prefix_tree
+{
+
+
+/**
+ * @brief crc32c    CRC-32C (Castagnoli) of buffer.
+ * @param data      Buffer.
+ * @param size      Size of buffer.
+ * @param crc       CRC of previous data to continue.
+ * @return          CRC.
+ */
+uint32_t crc32c( const void *data, size_t size, uint32_t crc = 0 );
+
+
+/**
+ * @brief The log_op enum   Operation of log record.
+ */
+enum class log_op : uint8_t
+{
+    APPEND = 1,
+    REMOVE = 2
+};
+
+
+/**
+ * @brief The log_record struct     Record of log or snapshot.
+ */
+struct log_record
+{
+    log_op                                  op;
+    std::string                             key;
+    /// @brief value    Encoded value, empty for REMOVE.
+    std::string                             value;
+};
+
+
+/**
+ * @brief The write_ahead_log class     Append only log file.
+ *
+ * Record: u32 size of payload, u32 CRC-32C of payload, payload is u8
+ * operation, u32 size of key, key, value. Integers are little endian.
+ *
+ * Records get log sequence numbers (LSN) and are written to file by
+ * append(), so they survive kill of process. commit() makes records
+ * durable against power loss by group commit: one thread calls
+ * fdatasync() for all records appended so far, concurrent committers wait
+ * for it instead of calling own fdatasync().
+ *
+ * Errors of I/O are thrown as std::system_error.
+ */
+class write_ahead_log
+{
+private:
+    int                                     fd;
+    std::mutex                              lock;
+    std::condition_variable                 synced;
+    std::string                             buffer;
+    uint64_t                                appended_lsn;
+    uint64_t                                durable_lsn;
+    bool                                    syncing;
+    std::atomic<uint64_t>                   pending_records;
+
+public:
+    write_ahead_log();
+    ~write_ahead_log();
+
+    write_ahead_log( const write_ahead_log & ) = delete;
+    write_ahead_log& operator=( const write_ahead_log & ) = delete;
+
+
+    /**
+     * @brief open      Open or create log file to append records.
+     * @param path      Path of file.
+     */
+    void open( const std::string &path );
+
+
+    /// @brief close    Make all records durable and close file.
+    void close();
+
+
+    /**
+     * @brief rotate    Make all records durable and continue in new file.
+     *                  LSN are continued, safe with concurrent commit().
+     * @param path      Path of new file.
+     */
+    void rotate( const std::string &path );
+
+
+    /// @brief is_open  Log file is open.
+    inline bool is_open() const { return fd >= 0; }
+
+
+    /**
+     * @brief append    Write record to file, it is not synced yet.
+     * @param op        Operation.
+     * @param key       Key.
+     * @param key_size  Size of key.
+     * @param value     Encoded value.
+     * @param value_size Size of value.
+     * @return          LSN of record.
+     */
+    uint64_t append( log_op op, const char *key, size_t key_size, const char *value, size_t value_size );
+
+
+    /**
+     * @brief commit    Wait until record and all records before it are durable.
+     * @param lsn       LSN of record.
+     */
+    void commit( uint64_t lsn );
+
+
+    /// @brief sync     Make all appended records durable.
+    void sync();
+
+
+    /// @brief pending  Count of records appended but not durable yet.
+    inline uint64_t pending() const { return pending_records.load( std::memory_order_relaxed ); }
+
+
+    /**
+     * @brief replay    Read records of log file. Reading stops at first torn
+     *                  or corrupted record, the file is truncated there.
+     * @param path      Path of file.
+     * @param callback  Function( const log_record &record ).
+     * @return          Count of valid records.
+     */
+    static size_t replay( const std::string &path, const std::function<void( const log_record& )> &callback );
+
+private:
+    /// @brief write_buffer     Write buffer to file, lock must be held.
+    void write_buffer();
+};
+
+
+/**
+ * @brief The durable_storage class     Directory of snapshots and logs.
+ *
+ * Files of directory are "snapshot-<seq>" and "log-<seq>". Snapshot with
+ * sequence S holds state of all logs with sequence below S, so state is
+ * the last valid snapshot and logs from its sequence on. snapshot()
+ * switches to new log first, then writes snapshot to temporary file and
+ * renames it, so the directory is consistent at any point of crash.
+ */
+class durable_storage
+{
+public:
+    /**
+     * @brief The options struct    Durability options.
+     */
+    struct options
+    {
+        /// @brief sync_every_operation     Every operation waits for group commit.
+        ///                                 If false, records which are not
+        ///                                 committed yet are in page cache:
+        ///                                 they survive kill of process but
+        ///                                 may be lost on power loss.
+        bool                                sync_every_operation;
+        /// @brief group_commit_records     Log is synced when count of not durable
+        ///                                 records reaches the value.
+        size_t                              group_commit_records;
+        /// @brief snapshot_records         Snapshot is taken when count of records
+        ///                                 logged after last snapshot reaches the
+        ///                                 value, 0 disables periodic snapshots.
+        size_t                              snapshot_records;
+        /// @brief failpoint                Called at named steps of snapshot
+        ///                                 ("snapshot.rotated", "snapshot.written",
+        ///                                 "snapshot.renamed"). For crash injection.
+        std::function<void( const char* )>  failpoint;
+
+        options() : sync_every_operation( false ), group_commit_records( 256 ), snapshot_records( 1 << 20 ), failpoint() {}
+    };
+
+
+    /**
+     * @brief The recovery_info struct  Result of recover().
+     */
+    struct recovery_info
+    {
+        /// @brief snapshot_sequence    Sequence of loaded snapshot, 0 if none.
+        uint64_t                            snapshot_sequence;
+        /// @brief snapshot_records     Count of records of snapshot.
+        size_t                              snapshot_records;
+        /// @brief logs                 Count of replayed logs.
+        size_t                              logs;
+        /// @brief log_records          Count of replayed records of logs.
+        size_t                              log_records;
+    };
+
+private:
+    std::string                             directory;
+    options                                 opts;
+    write_ahead_log                         log;
+    uint64_t                                sequence;
+    std::atomic<uint64_t>                   records_since_snapshot;
+
+public:
+    /**
+     * @brief durable_storage   Create directory if it does not exist.
+     * @param directory_        Path of directory.
+     * @param opts_             Options.
+     */
+    durable_storage( const std::string &directory_, const options &opts_ );
+    ~durable_storage() = default;
+
+    durable_storage( const durable_storage & ) = delete;
+    durable_storage& operator=( const durable_storage & ) = delete;
+
+
+    /**
+     * @brief recover   Load last snapshot and replay logs, then start new log.
+     * @param apply     Function( const log_record &record ). Records of
+     *                  snapshot are passed as APPEND.
+     * @return          What has been loaded.
+     */
+    recovery_info recover( const std::function<void( const log_record& )> &apply );
+
+
+    /**
+     * @brief append    Log operation, see write_ahead_log::append().
+     * @return          LSN of record.
+     */
+    uint64_t append( log_op op, const char *key, size_t key_size, const char *value, size_t value_size );
+
+
+    /**
+     * @brief commit_if_needed  Commit record according to options. Must be
+     *                          called without locks of caller so commits
+     *                          of threads are grouped.
+     * @param lsn               LSN of record.
+     */
+    void commit_if_needed( uint64_t lsn );
+
+
+    /// @brief sync     Make all logged records durable.
+    inline void sync() { log.sync(); }
+
+
+    /// @brief snapshot_due     Periodic snapshot should be taken.
+    inline bool snapshot_due() const
+    {
+        return opts.snapshot_records && records_since_snapshot.load( std::memory_order_relaxed ) >= opts.snapshot_records;
+    }
+
+
+    /**
+     * @brief snapshot  Write snapshot, remove files covered by it. Caller
+     *                  must block appends until it returns.
+     * @param next      Function( log_record &record ) filling next record
+     *                  of state, returns false at end.
+     */
+    void snapshot( const std::function<bool( log_record& )> &next );
+
+private:
+    std::string file_path( const char *kind, uint64_t seq ) const;
+
+    inline void failpoint( const char *name ) const
+    {
+        if ( opts.failpoint )
+            opts.failpoint( name );
+    }
+
+    /// @brief sync_directory   Make entries of directory durable.
+    void sync_directory() const;
+
+    /// @brief remove_obsolete  Remove files with sequence below seq and temporary files.
+    void remove_obsolete( uint64_t seq ) const;
+};
+
+
+} // namespace prefix_tree
+
+#endif // WRITE_AHEAD_LOG_H
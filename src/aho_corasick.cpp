@@ -0,0 +1,139 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <utility>
+
+#include "prefix_tree/aho_corasick.h"
+
+
+namespace prefix_tree
+{
+
+
+aho_corasick::aho_corasick( const prefix_tree &tree )
+: states(), edge_labels(), edge_targets(), dense(), dense_count( 0 ), patterns()
+{
+    build( tree );
+}
+
+
+
+void aho_corasick::build( const prefix_tree &tree )
+{
+    // BFS over the tree. Parents and labels are kept to restore keys of patterns.
+    std::vector<const prefix_tree*>  nodes( 1, &tree );
+    std::vector<state_id>            parents( 1, 0 );
+    std::vector<unsigned char>       labels( 1, 0 );
+    std::vector<unsigned int>        depths( 1, 0 );
+
+    std::vector<std::pair<unsigned char, const prefix_tree*> > children;
+
+    for ( size_t cur = 0; cur < nodes.size(); ++cur )
+    {
+        const prefix_tree::next_nodes_container &next = nodes[ cur ]->next;
+
+        children.clear();
+        for ( size_t i = 0; i < next.size(); ++i )
+            children.emplace_back( next.label( i ), next.node( i ) );
+
+        state_info info;
+        info.edges        = static_cast<uint32_t>( edge_labels.size() );
+        info.edges_count  = static_cast<uint32_t>( children.size() );
+        info.fail         = 0;
+        info.first_output = 0;
+        info.output       = 0;
+        info.pattern      = NO_PATTERN;
+
+        if ( cur && nodes[ cur ]->is_finite_node() )
+        {
+            info.pattern      = static_cast<pattern_id>( patterns.size() );
+            info.first_output = static_cast<state_id>( cur );
+            patterns.emplace_back();
+        }
+
+        states.push_back( info );
+
+        for ( const auto &child : children )
+        {
+            edge_labels.push_back( child.first );
+            edge_targets.push_back( static_cast<state_id>( nodes.size() ) );
+
+            nodes.push_back( child.second );
+            parents.push_back( static_cast<state_id>( cur ) );
+            labels.push_back( child.first );
+            depths.push_back( depths[ cur ] + 1 );
+        }
+    }
+
+    // Restore keys of patterns.
+    for ( state_id s = 1; s < states.size(); ++s )
+    {
+        if ( states[ s ].pattern == NO_PATTERN )
+            continue;
+
+        std::string &key = patterns[ states[ s ].pattern ];
+        key.resize( depths[ s ] );
+        for ( state_id p = s; p; p = parents[ p ] )
+            key[ depths[ p ] - 1 ] = static_cast<char>( labels[ p ] );
+    }
+
+    // Failure and output links. Failure link of state leads to lower depth
+    // so in BFS order it is always computed before the state.
+    for ( state_id s = 1; s < states.size(); ++s )
+    {
+        state_id p = parents[ s ];
+        state_id f = 0;
+
+        if ( p )
+        {
+            for ( f = states[ p ].fail; ; f = states[ f ].fail )
+            {
+                state_id target = find_edge( f, labels[ s ] );
+                if ( target )
+                {
+                    f = target;
+                    break;
+                }
+                if ( !f )
+                    break;
+            }
+        }
+
+        state_info &info = states[ s ];
+        info.fail   = f;
+        info.output = states[ f ].first_output;
+        if ( info.pattern == NO_PATTERN )
+            info.first_output = info.output;
+    }
+
+    // Dense rows for top levels. Any BFS prefix of states is closed
+    // under failure links so rows may be limited by count.
+    while (
+            dense_count < states.size()         &&
+            dense_count < DENSE_STATES          &&
+            depths[ dense_count ] < DENSE_DEPTH
+    )
+        ++dense_count;
+
+    dense.assign( static_cast<size_t>( dense_count ) * ALPHABET, 0 );
+    for ( state_id s = 0; s < dense_count; ++s )
+    {
+        state_id *row      = dense.data() + static_cast<size_t>( s ) * ALPHABET;
+        state_id *fail_row = dense.data() + static_cast<size_t>( states[ s ].fail ) * ALPHABET;
+
+        for ( unsigned int c = 0; c < ALPHABET; ++c )
+        {
+            state_id target = find_edge( s, static_cast<unsigned char>( c ) );
+            if ( target )
+                row[ c ] = target;
+            else if ( s )
+                row[ c ] = fail_row[ c ];
+        }
+    }
+}
+
+
+
+} // namespace prefix_tree
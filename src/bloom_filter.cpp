@@ -0,0 +1,101 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "prefix_tree/bloom_filter.h"
+
+
+namespace prefix_tree
+{
+
+
+
+blocked_bloom_filter::blocked_bloom_filter( size_t expected_keys, size_t bits_per_key )
+: blocks(), probes( 1 ), capacity_( expected_keys ), count( 0 )
+{
+    bits_per_key = std::max<size_t>( bits_per_key, 1 );
+
+    size_t bits = std::max<size_t>( expected_keys * bits_per_key, 512 );
+    blocks.resize( ( bits + 511 ) / 512, block{} );
+
+    // Optimal count of probes is bits per key * ln 2.
+    probes = static_cast<unsigned int>( std::lround( bits_per_key * 0.693 ) );
+    probes = std::min( std::max( probes, 1u ), MAX_PROBES );
+}
+
+
+void blocked_bloom_filter::clear()
+{
+    std::fill( blocks.begin(), blocks.end(), block{} );
+    count = 0;
+}
+
+
+double blocked_bloom_filter::estimated_false_positive_rate() const
+{
+    // Absent key is accepted if all probes hit set bits of its block.
+    double sum = 0;
+    for ( const block &b : blocks )
+    {
+        size_t set = 0;
+        for ( uint64_t w : b.words )
+            set += static_cast<size_t>( __builtin_popcountll( w ) );
+        sum += std::pow( set / 512.0, probes );
+    }
+    return blocks.empty() ? 0 : sum / blocks.size();
+}
+
+
+
+key_filter::key_filter( size_t expected_keys, options opts_ )
+: opts( std::move( opts_ ) ), keys(), prefixes()
+{
+    std::sort( opts.prefix_lengths.begin(), opts.prefix_lengths.end() );
+    opts.prefix_lengths.erase( std::unique( opts.prefix_lengths.begin(), opts.prefix_lengths.end() ), opts.prefix_lengths.end() );
+    opts.prefix_lengths.erase( std::remove( opts.prefix_lengths.begin(), opts.prefix_lengths.end(), size_t( 0 ) ), opts.prefix_lengths.end() );
+
+    reset( expected_keys );
+}
+
+
+void key_filter::insert( std::string_view key )
+{
+    keys.insert( key );
+
+    for ( size_t len : opts.prefix_lengths )
+    {
+        if ( len > key.size() )
+            break;
+        prefixes.insert( key.substr( 0, len ) );
+    }
+}
+
+
+bool key_filter::may_contain_prefix( std::string_view prefix ) const
+{
+    // Longest filtered length not exceeding prefix: every key which starts
+    // with prefix has inserted prefix of that length.
+    auto it = std::upper_bound( opts.prefix_lengths.begin(), opts.prefix_lengths.end(), prefix.size() );
+    if ( it == opts.prefix_lengths.begin() )
+        return true;
+
+    return prefixes.may_contain( prefix.substr( 0, *--it ) );
+}
+
+
+void key_filter::reset( size_t expected_keys )
+{
+    keys = blocked_bloom_filter( expected_keys, opts.bits_per_key );
+
+    // Distinct prefixes are not more than keys times lengths.
+    size_t prefix_keys = opts.prefix_lengths.empty() ? 0 : expected_keys * opts.prefix_lengths.size();
+    prefixes = blocked_bloom_filter( prefix_keys, opts.bits_per_key );
+}
+
+
+
+} // namespace prefix_tree
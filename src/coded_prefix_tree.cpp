@@ -0,0 +1,63 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "prefix_tree/coded_prefix_tree.h"
+
+
+namespace prefix_tree
+{
+
+
+
+alphabet_codec::alphabet_codec( std::string_view alphabet ) : codes(), symbols(), count( 0 )
+{
+    std::array<bool, 256> used = {};
+    for ( unsigned char c : alphabet )
+        used[ c ] = c != 0;
+
+    for ( size_t c = 0; c < 256; ++c )
+    {
+        if ( used[ c ] )
+        {
+            if ( count == MAX_ALPHABET )
+                throw std::invalid_argument( "alphabet_codec: too many symbols" );
+
+            codes[ c ] = static_cast<uint8_t>( 2 * count + 2 );
+            symbols[ codes[ c ] ] = static_cast<uint8_t>( c );
+            ++count;
+        }
+        else
+        {
+            // Escape of gap before next symbol.
+            codes[ c ] = static_cast<uint8_t>( 2 * count + 1 );
+        }
+    }
+}
+
+
+alphabet_codec alphabet_codec::from_frequency( const std::array<size_t, 256> &frequency )
+{
+    std::vector<unsigned char> bytes;
+    for ( size_t c = 1; c < 256; ++c )
+    {
+        if ( frequency[ c ] )
+            bytes.push_back( static_cast<unsigned char>( c ) );
+    }
+
+    if ( bytes.size() > MAX_ALPHABET )
+    {
+        std::stable_sort( bytes.begin(), bytes.end(), [&] ( unsigned char a, unsigned char b ) { return frequency[ a ] > frequency[ b ]; } );
+        bytes.resize( MAX_ALPHABET );
+    }
+
+    return alphabet_codec( std::string_view( reinterpret_cast<const char*>( bytes.data() ), bytes.size() ) );
+}
+
+
+
+} // namespace prefix_tree
@@ -0,0 +1,196 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <algorithm>
+
+#include "prefix_tree/executor.h"
+
+
+namespace prefix_tree
+{
+
+
+namespace
+{
+
+
+/// @brief current_executor     Executor of current worker thread.
+thread_local const executor    *current_executor = nullptr;
+/// @brief current_index        Index of queue of current worker thread.
+thread_local size_t             current_index    = 0;
+
+
+} // namespace
+
+
+
+executor::task_group::~task_group()
+{
+    try
+    {
+        wait();
+    }
+    catch ( ... )
+    {
+    }
+}
+
+
+void executor::task_group::run( std::function<void()> function )
+{
+    pending.fetch_add( 1, std::memory_order_relaxed );
+    owner.push( task{ std::move( function ), this } );
+}
+
+
+void executor::task_group::wait()
+{
+    size_t self = current_executor == &owner ? current_index : owner.size();
+
+    while ( pending.load( std::memory_order_acquire ) )
+    {
+        if ( !owner.run_one( self ) )
+            std::this_thread::yield();
+    }
+
+    std::lock_guard<std::mutex> guard( error_lock );
+    if ( error )
+    {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception( e );
+    }
+}
+
+
+
+executor::executor( size_t threads )
+: count( threads ? threads : std::max( 1u, std::thread::hardware_concurrency() ) ),
+  queues(), workers(), sleep_lock(), wake(), queued( 0 ), stopping( false )
+{
+    threads = count;
+
+    for ( size_t i = 0; i <= threads; ++i )
+        queues.emplace_back( new task_queue() );
+
+    for ( size_t i = 0; i < threads; ++i )
+        workers.emplace_back( [this, i] () { work( i ); } );
+}
+
+
+executor::~executor()
+{
+    {
+        std::lock_guard<std::mutex> guard( sleep_lock );
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for ( auto &t : workers )
+        t.join();
+}
+
+
+executor& executor::instance()
+{
+    static executor shared;
+    return shared;
+}
+
+
+void executor::push( task &&t )
+{
+    task_queue &q = *queues[ current_executor == this ? current_index : size() ];
+    {
+        std::lock_guard<std::mutex> guard( q.lock );
+        q.tasks.push_back( std::move( t ) );
+    }
+
+    queued.fetch_add( 1, std::memory_order_release );
+    {
+        // Worker checks count under the lock before sleeping.
+        std::lock_guard<std::mutex> guard( sleep_lock );
+    }
+    wake.notify_one();
+}
+
+
+bool executor::run_one( size_t self )
+{
+    task    t;
+    size_t  n = size();
+
+    // Own newest task, then shared queue, then oldest task of other worker.
+    bool found = ( self < n && pop( *queues[ self ], t, true ) ) || pop( *queues[ n ], t, false );
+
+    for ( size_t i = 1; i <= n && !found; ++i )
+    {
+        size_t victim = ( self + i ) % n;
+        if ( victim != self )
+            found = pop( *queues[ victim ], t, false );
+    }
+
+    if ( !found )
+        return false;
+
+    queued.fetch_sub( 1, std::memory_order_relaxed );
+
+    try
+    {
+        t.function();
+    }
+    catch ( ... )
+    {
+        std::lock_guard<std::mutex> guard( t.group->error_lock );
+        if ( !t.group->error )
+            t.group->error = std::current_exception();
+    }
+
+    t.group->pending.fetch_sub( 1, std::memory_order_release );
+    return true;
+}
+
+
+bool executor::pop( task_queue &q, task &t, bool newest )
+{
+    std::lock_guard<std::mutex> guard( q.lock );
+    if ( q.tasks.empty() )
+        return false;
+
+    if ( newest )
+    {
+        t = std::move( q.tasks.back() );
+        q.tasks.pop_back();
+    }
+    else
+    {
+        t = std::move( q.tasks.front() );
+        q.tasks.pop_front();
+    }
+    return true;
+}
+
+
+void executor::work( size_t self )
+{
+    current_executor = this;
+    current_index    = self;
+
+    while ( true )
+    {
+        if ( run_one( self ) )
+            continue;
+
+        std::unique_lock<std::mutex> guard( sleep_lock );
+        wake.wait( guard, [this] () { return stopping || queued.load( std::memory_order_acquire ); } );
+
+        if ( stopping && !queued.load( std::memory_order_acquire ) )
+            return;
+    }
+}
+
+
+
+} // namespace prefix_tree
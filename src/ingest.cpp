@@ -0,0 +1,332 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "prefix_tree/ingest.h"
+
+
+namespace prefix_tree
+{
+
+
+namespace
+{
+
+
+typedef std::chrono::steady_clock   clock;
+
+
+/**
+ * @brief The batch struct  Chunk of whole lines and its sorted keys.
+ */
+struct batch
+{
+    std::string                     data;
+    std::vector<std::string_view>   keys;
+};
+
+
+inline double seconds_since( clock::time_point started )
+{
+    return std::chrono::duration<double>( clock::now() - started ).count();
+}
+
+
+/**
+ * @brief The failure class     First exception of threads of pipeline.
+ */
+class failure
+{
+private:
+    std::mutex                      lock;
+    std::exception_ptr              error;
+
+public:
+    void set( std::exception_ptr e )
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        if ( !error )
+            error = e;
+    }
+
+    void rethrow()
+    {
+        if ( error )
+            std::rethrow_exception( error );
+    }
+};
+
+
+/**
+ * @brief read_chunks   Read stage: chunks end at line boundary.
+ */
+void read_chunks( int fd, size_t chunk_bytes, bounded_queue<batch> &out, ingest_stats &stats )
+{
+    std::string carry;
+
+    for ( bool eof = false; !eof; )
+    {
+        batch b;
+        b.data = std::move( carry );
+        carry.clear();
+
+        clock::time_point started = clock::now();
+
+        size_t filled = b.data.size();
+        b.data.resize( filled + chunk_bytes );
+
+        while ( filled < b.data.size() )
+        {
+            ssize_t n = ::read( fd, &b.data[ filled ], b.data.size() - filled );
+            if ( n < 0 )
+            {
+                if ( errno == EINTR )
+                    continue;
+                throw std::system_error( errno, std::generic_category(), "read" );
+            }
+            if ( !n )
+            {
+                eof = true;
+                break;
+            }
+
+            filled        += static_cast<size_t>( n );
+            stats.bytes   += static_cast<size_t>( n );
+        }
+        b.data.resize( filled );
+
+        // Incomplete last line goes to next chunk.
+        if ( !eof )
+        {
+            size_t end = b.data.rfind( '\n' );
+            if ( end != std::string::npos )
+            {
+                carry.assign( b.data, end + 1, std::string::npos );
+                b.data.resize( end + 1 );
+            }
+            else
+            {
+                carry = std::move( b.data );
+                b.data.clear();
+            }
+        }
+
+        stats.read.busy_seconds += seconds_since( started );
+
+        if ( b.data.empty() )
+            continue;
+
+        ++stats.chunks;
+        if ( !out.push( std::move( b ) ) )
+            return;
+    }
+}
+
+
+/**
+ * @brief parse_chunk   Parse stage: split chunk to keys and sort them.
+ */
+void parse_chunk( batch &b )
+{
+    const char *cur = b.data.data();
+    const char *end = cur + b.data.size();
+
+    while ( cur < end )
+    {
+        const char *eol  = static_cast<const char*>( std::memchr( cur, '\n', static_cast<size_t>( end - cur ) ) );
+        const char *next = eol ? eol + 1 : end;
+        if ( !eol )
+            eol = end;
+
+        if ( eol > cur && eol[ -1 ] == '\r' )
+            --eol;
+        if ( eol > cur )
+            b.keys.emplace_back( cur, static_cast<size_t>( eol - cur ) );
+
+        cur = next;
+    }
+
+    std::sort( b.keys.begin(), b.keys.end() );
+}
+
+
+} // namespace
+
+
+
+void ingest_stats::write( std::ostream &out ) const
+{
+    out
+        << "bytes="     << bytes
+        << " chunks="   << chunks
+        << " keys="     << keys
+        << " appended=" << appended
+        << " seconds="  << seconds
+        << " keys/s="   << ( seconds > 0 ? static_cast<uint64_t>( keys / seconds ) : 0 )
+        << std::endl
+    ;
+
+    for ( const stage *s : { &read, &parse, &insert } )
+    {
+        out
+            << s->name
+            << " threads="      << s->threads
+            << " busy_seconds=" << s->busy_seconds
+            << " utilization="  << s->utilization( seconds )
+            << std::endl
+        ;
+    }
+}
+
+
+
+ingest_stats ingest( prefix_tree &tree, int fd, const ingest_options &opts )
+{
+    size_t parse_threads = opts.parse_threads;
+    if ( !parse_threads )
+    {
+        unsigned int cpus = std::thread::hardware_concurrency();
+        parse_threads = cpus > 1 ? cpus - 1 : 1;
+    }
+
+    ingest_stats stats;
+    stats.bytes    = 0;
+    stats.chunks   = 0;
+    stats.keys     = 0;
+    stats.appended = 0;
+    stats.read     = { "read", 1, 0 };
+    stats.parse    = { "parse", parse_threads, 0 };
+    stats.insert   = { "insert", 1, 0 };
+
+    size_t depth = std::max<size_t>( opts.queue_depth, 1 );
+
+    bounded_queue<batch>    chunks( depth );
+    bounded_queue<batch>    sorted( depth );
+    failure                 error;
+    clock::time_point       started = clock::now();
+
+    std::thread reader(
+        [&] ()
+        {
+            try
+            {
+                read_chunks( fd, std::max<size_t>( opts.chunk_bytes, 1 ), chunks, stats );
+            }
+            catch ( ... )
+            {
+                error.set( std::current_exception() );
+                sorted.close();
+            }
+            chunks.close();
+        }
+    );
+
+    std::vector<double>         parse_busy( parse_threads, 0 );
+    std::atomic<size_t>         parsers_left( parse_threads );
+    std::vector<std::thread>    parsers;
+
+    for ( size_t t = 0; t < parse_threads; ++t )
+    {
+        parsers.emplace_back(
+            [&, t] ()
+            {
+                try
+                {
+                    batch b;
+                    while ( chunks.pop( b ) )
+                    {
+                        clock::time_point parse_started = clock::now();
+                        parse_chunk( b );
+                        parse_busy[ t ] += seconds_since( parse_started );
+
+                        if ( !sorted.push( std::move( b ) ) )
+                            break;
+                        b = batch();
+                    }
+                }
+                catch ( ... )
+                {
+                    error.set( std::current_exception() );
+                    chunks.close();
+                }
+
+                if ( !--parsers_left )
+                    sorted.close();
+            }
+        );
+    }
+
+    // Insert stage in calling thread, the tree is not thread safe.
+    try
+    {
+        batch b;
+        while ( sorted.pop( b ) )
+        {
+            clock::time_point insert_started = clock::now();
+            stats.keys     += b.keys.size();
+            stats.appended += tree.append_sorted( b.keys.begin(), b.keys.end() );
+            stats.insert.busy_seconds += seconds_since( insert_started );
+        }
+    }
+    catch ( ... )
+    {
+        error.set( std::current_exception() );
+        chunks.close();
+        sorted.close();
+    }
+
+    reader.join();
+    for ( auto &t : parsers )
+        t.join();
+
+    error.rethrow();
+
+    for ( double busy : parse_busy )
+        stats.parse.busy_seconds += busy;
+    stats.seconds = seconds_since( started );
+
+    return stats;
+}
+
+
+ingest_stats ingest( prefix_tree &tree, const std::string &path, const ingest_options &opts )
+{
+    if ( path == "-" )
+        return ingest( tree, STDIN_FILENO, opts );
+
+    int fd = ::open( path.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+        throw std::system_error( errno, std::generic_category(), "open " + path );
+
+    ::posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+
+    try
+    {
+        ingest_stats stats = ingest( tree, fd, opts );
+        ::close( fd );
+        return stats;
+    }
+    catch ( ... )
+    {
+        ::close( fd );
+        throw;
+    }
+}
+
+
+
+} // namespace prefix_tree
@@ -0,0 +1,270 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "prefix_tree/instrumentation.h"
+
+
+namespace prefix_tree
+{
+
+
+namespace
+{
+
+
+static constexpr size_t OPERATIONS = static_cast<size_t>( operation::COUNT );
+
+static const char *OPERATION_NAMES[ OPERATIONS ] = { "find", "append", "remove" };
+
+
+/**
+ * @brief The thread_block struct   Counters of all operations of one thread.
+ */
+struct thread_block
+{
+    std::array<latency_instrumentation::counters, OPERATIONS> ops;
+};
+
+
+/**
+ * @brief The registry struct   Counters of live threads and sum of finished ones.
+ */
+struct registry
+{
+    std::mutex                                      lock;
+    std::vector<std::shared_ptr<thread_block> >     blocks;
+    thread_block                                    retired;
+};
+
+
+registry& get_registry()
+{
+    static registry instance;
+    return instance;
+}
+
+
+void add_counters( latency_instrumentation::counters &to, const latency_instrumentation::counters &from )
+{
+    to.operations    += from.operations.load( std::memory_order_relaxed );
+    to.nodes_visited += from.nodes_visited.load( std::memory_order_relaxed );
+    to.allocations   += from.allocations.load( std::memory_order_relaxed );
+
+    if ( from.max_depth.load( std::memory_order_relaxed ) > to.max_depth.load( std::memory_order_relaxed ) )
+        to.max_depth.store( from.max_depth.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+
+    if ( from.max_latency.load( std::memory_order_relaxed ) > to.max_latency.load( std::memory_order_relaxed ) )
+        to.max_latency.store( from.max_latency.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+
+    for ( unsigned int i = 0; i < latency_histogram::BUCKETS; ++i )
+        to.latency[ i ] += from.latency[ i ].load( std::memory_order_relaxed );
+}
+
+
+void add_stats( latency_instrumentation::operation_stats &to, const latency_instrumentation::counters &from )
+{
+    to.operations    += from.operations.load( std::memory_order_relaxed );
+    to.nodes_visited += from.nodes_visited.load( std::memory_order_relaxed );
+    to.allocations   += from.allocations.load( std::memory_order_relaxed );
+    to.max_depth      = std::max( to.max_depth, from.max_depth.load( std::memory_order_relaxed ) );
+
+    for ( unsigned int i = 0; i < latency_histogram::BUCKETS; ++i )
+    {
+        uint64_t count = from.latency[ i ].load( std::memory_order_relaxed );
+        if ( count )
+            to.latency.add( i, count );
+    }
+
+    to.latency.set_max( std::max( to.latency.max(), from.max_latency.load( std::memory_order_relaxed ) ) );
+}
+
+
+void clear_counters( latency_instrumentation::counters &c )
+{
+    c.operations.store( 0, std::memory_order_relaxed );
+    c.nodes_visited.store( 0, std::memory_order_relaxed );
+    c.allocations.store( 0, std::memory_order_relaxed );
+    c.max_depth.store( 0, std::memory_order_relaxed );
+    c.max_latency.store( 0, std::memory_order_relaxed );
+
+    for ( auto &bucket : c.latency )
+        bucket.store( 0, std::memory_order_relaxed );
+}
+
+
+/**
+ * @brief The thread_slot struct    Registers counters of thread and moves
+ *                                  them to retired on thread exit.
+ */
+struct thread_slot
+{
+    std::shared_ptr<thread_block>   block;
+
+    thread_slot() : block( std::make_shared<thread_block>() )
+    {
+        registry &r = get_registry();
+        std::lock_guard<std::mutex> guard( r.lock );
+        r.blocks.push_back( block );
+    }
+
+    ~thread_slot()
+    {
+        registry &r = get_registry();
+        std::lock_guard<std::mutex> guard( r.lock );
+
+        for ( size_t i = 0; i < OPERATIONS; ++i )
+            add_counters( r.retired.ops[ i ], block->ops[ i ] );
+
+        for ( auto it = r.blocks.begin(); it != r.blocks.end(); ++it )
+        {
+            if ( *it == block )
+            {
+                r.blocks.erase( it );
+                break;
+            }
+        }
+    }
+};
+
+
+thread_block& local_block()
+{
+    thread_local thread_slot slot;
+    return *slot.block;
+}
+
+
+void update_max( std::atomic<uint64_t> &max, uint64_t value )
+{
+    if ( value > max.load( std::memory_order_relaxed ) )
+        max.store( value, std::memory_order_relaxed );
+}
+
+
+} // namespace
+
+
+
+void latency_histogram::merge( const latency_histogram &other )
+{
+    for ( unsigned int i = 0; i < BUCKETS; ++i )
+        counts[ i ] += other.counts[ i ];
+
+    total     += other.total;
+    max_value  = std::max( max_value, other.max_value );
+}
+
+
+uint64_t latency_histogram::percentile( double p ) const
+{
+    if ( !total )
+        return 0;
+    if ( p >= 100.0 )
+        return max_value;
+
+    uint64_t target = static_cast<uint64_t>( std::ceil( p / 100.0 * total ) );
+    if ( !target )
+        target = 1;
+
+    uint64_t cumulative = 0;
+    for ( unsigned int i = 0; i < BUCKETS; ++i )
+    {
+        cumulative += counts[ i ];
+        if ( cumulative >= target )
+            return std::min( lower_bound( i ), max_value );
+    }
+
+    return max_value;
+}
+
+
+
+latency_instrumentation::counters::counters()
+: operations( 0 ), nodes_visited( 0 ), allocations( 0 ), max_depth( 0 ), max_latency( 0 ), latency()
+{
+    for ( auto &bucket : latency )
+        bucket.store( 0, std::memory_order_relaxed );
+}
+
+
+void latency_instrumentation::record( operation op, uint64_t visited, uint64_t allocated, uint64_t ns )
+{
+    // Counters are written by owner thread only, relaxed fetch_add is
+    // uncontended and keeps reset() from other thread consistent.
+    counters &c = local_block().ops[ static_cast<size_t>( op ) ];
+
+    c.operations.fetch_add( 1, std::memory_order_relaxed );
+    c.nodes_visited.fetch_add( visited, std::memory_order_relaxed );
+    c.allocations.fetch_add( allocated, std::memory_order_relaxed );
+    c.latency[ latency_histogram::bucket( ns ) ].fetch_add( 1, std::memory_order_relaxed );
+
+    update_max( c.max_depth, visited );
+    update_max( c.max_latency, ns );
+}
+
+
+latency_instrumentation::snapshot latency_instrumentation::take_snapshot()
+{
+    snapshot result;
+
+    registry &r = get_registry();
+    std::lock_guard<std::mutex> guard( r.lock );
+
+    for ( size_t i = 0; i < OPERATIONS; ++i )
+    {
+        add_stats( result.operations[ i ], r.retired.ops[ i ] );
+        for ( const auto &block : r.blocks )
+            add_stats( result.operations[ i ], block->ops[ i ] );
+    }
+
+    return result;
+}
+
+
+void latency_instrumentation::reset()
+{
+    registry &r = get_registry();
+    std::lock_guard<std::mutex> guard( r.lock );
+
+    for ( size_t i = 0; i < OPERATIONS; ++i )
+    {
+        clear_counters( r.retired.ops[ i ] );
+        for ( const auto &block : r.blocks )
+            clear_counters( block->ops[ i ] );
+    }
+}
+
+
+void latency_instrumentation::snapshot::write( std::ostream &out ) const
+{
+    for ( size_t i = 0; i < OPERATIONS; ++i )
+    {
+        const operation_stats &s = operations[ i ];
+
+        out
+            << OPERATION_NAMES[ i ]
+            << " operations="       << s.operations
+            << " nodes_visited="    << s.nodes_visited
+            << " allocations="      << s.allocations
+            << " max_depth="        << s.max_depth
+            << " p50_ns="           << s.latency.percentile( 50 )
+            << " p90_ns="           << s.latency.percentile( 90 )
+            << " p99_ns="           << s.latency.percentile( 99 )
+            << " p999_ns="          << s.latency.percentile( 99.9 )
+            << " max_ns="           << s.latency.max()
+            << std::endl
+        ;
+    }
+}
+
+
+
+} // namespace prefix_tree
@@ -0,0 +1,417 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include "prefix_tree/merkle_prefix_tree.h"
+
+
+namespace prefix_tree
+{
+
+
+namespace
+{
+
+
+/// @brief DELTA_HEADER     Hashes of source and target, CRC of records.
+constexpr size_t DELTA_HEADER = 2 * sizeof( uint64_t ) + sizeof( uint32_t );
+
+/// @brief RECORD_HEADER    Operation and size of key.
+constexpr size_t RECORD_HEADER = 1 + sizeof( uint32_t );
+
+
+inline void put_u32( std::string &out, uint32_t value )
+{
+    for ( int i = 0; i < 4; ++i )
+        out.push_back( static_cast<char>( value >> ( 8 * i ) ) );
+}
+
+
+inline uint32_t get_u32( const char *in )
+{
+    uint32_t value = 0;
+    for ( int i = 0; i < 4; ++i )
+        value |= static_cast<uint32_t>( static_cast<unsigned char>( in[ i ] ) ) << ( 8 * i );
+    return value;
+}
+
+
+inline void put_u64( std::string &out, uint64_t value )
+{
+    put_u32( out, static_cast<uint32_t>( value ) );
+    put_u32( out, static_cast<uint32_t>( value >> 32 ) );
+}
+
+
+inline uint64_t get_u64( const char *in )
+{
+    return get_u32( in ) | static_cast<uint64_t>( get_u32( in + sizeof( uint32_t ) ) ) << 32;
+}
+
+
+} // namespace
+
+
+
+prefix_tree *merkle_prefix_tree::new_node()
+{
+    return new merkle_prefix_tree();
+}
+
+
+size_t merkle_prefix_tree::node_size() const
+{
+    return sizeof( merkle_prefix_tree );
+}
+
+
+
+bool merkle_prefix_tree::append( const char *key )
+{
+    if ( !key )
+        return false;
+
+    std::vector<merkle_prefix_tree*> path( 1, this );
+    for ( const char *p = key; *p; ++p )
+    {
+        merkle_prefix_tree *cur = path.back();
+        unsigned char       c   = static_cast<unsigned char>( *p );
+        size_t              pos = cur->next.lower_bound( c );
+
+        if ( pos < cur->next.size() && cur->next.label( pos ) == c )
+            path.push_back( cast( cur->next.node( pos ) ) );
+        else
+            path.push_back( cast( cur->next.insert( pos, c, ptr( cur->new_node() ) ) ) );
+    }
+
+    merkle_prefix_tree *node = path.back();
+    if ( !node->is_finite_node() )
+    {
+        node->set_flag( NODE_FLAG::FINITE_NODE );
+        update_path( path, key, node->hash + FINITE_HASH );
+    }
+
+    return true;
+}
+
+
+void merkle_prefix_tree::remove( const char *key )
+{
+    std::vector<merkle_prefix_tree*> path;
+    if ( !find_path( key, path ) || !path.back()->is_finite_node() )
+        return;
+
+    update_path( path, key, path.back()->hash - FINITE_HASH );
+
+    // prefix_tree::remove() keeps empty key.
+    if ( *key )
+        prefix_tree::remove( key );
+    else
+        clear_finite();
+}
+
+
+void merkle_prefix_tree::remove_prefix( const char *prefix )
+{
+    std::vector<merkle_prefix_tree*> path;
+    if ( !find_path( prefix, path ) )
+        return;
+
+    update_path( path, prefix, 0 );
+    prefix_tree::remove_prefix( prefix );
+}
+
+
+void merkle_prefix_tree::relayout()
+{
+    prefix_tree::relayout();
+    rehash();
+}
+
+
+uint64_t merkle_prefix_tree::subtree_hash( const std::string &prefix ) const
+{
+    const prefix_tree *node = find_node( prefix.c_str(), false );
+    return node ? cast( node )->hash : 0;
+}
+
+
+void merkle_prefix_tree::rehash()
+{
+    // Post-order: hash of node is computed after hashes of its children.
+    std::vector<std::pair<merkle_prefix_tree*, size_t> > stack;
+    stack.emplace_back( this, 0 );
+
+    while ( !stack.empty() )
+    {
+        merkle_prefix_tree *node = stack.back().first;
+        size_t              i    = stack.back().second;
+
+        if ( i < node->next.size() )
+        {
+            ++stack.back().second;
+            stack.emplace_back( cast( node->next.node( i ) ), 0 );
+            continue;
+        }
+
+        node->hash = node->is_finite_node() ? FINITE_HASH : 0;
+        for ( size_t j = 0; j < node->next.size(); ++j )
+            node->hash += edge_hash( node->next.label( j ), cast( node->next.node( j ) )->hash );
+
+        stack.pop_back();
+    }
+}
+
+
+
+size_t merkle_prefix_tree::diff( const merkle_prefix_tree &from, const merkle_prefix_tree &to, const diff_callback &callback )
+{
+    // Pair of nodes of the same key, one of them is nullptr if key is
+    // present in one tree only.
+    struct item
+    {
+        const merkle_prefix_tree           *from;
+        const merkle_prefix_tree           *to;
+        std::string                         key;
+    };
+
+    size_t visited = 0;
+
+    // Every key of subtree in pre-order.
+    auto report = [&] ( const merkle_prefix_tree *node, std::string key, log_op op )
+    {
+        std::vector<std::pair<const merkle_prefix_tree*, size_t> > stack;
+        stack.emplace_back( node, 0 );
+        ++visited;
+
+        if ( node->is_finite_node() )
+            callback( key, op );
+
+        while ( !stack.empty() )
+        {
+            auto &top = stack.back();
+            if ( top.second == top.first->next.size() )
+            {
+                stack.pop_back();
+                if ( !stack.empty() )
+                    key.pop_back();
+                continue;
+            }
+
+            const merkle_prefix_tree *child = cast( top.first->next.node( top.second ) );
+            key.push_back( static_cast<char>( top.first->next.label( top.second ) ) );
+            ++top.second;
+            ++visited;
+
+            if ( child->is_finite_node() )
+                callback( key, op );
+            stack.emplace_back( child, 0 );
+        }
+    };
+
+    std::vector<item> stack;
+    std::vector<item> children;
+    stack.push_back( item{ &from, &to, std::string() } );
+
+    while ( !stack.empty() )
+    {
+        item cur = std::move( stack.back() );
+        stack.pop_back();
+
+        if ( !cur.to )
+        {
+            report( cur.from, std::move( cur.key ), log_op::REMOVE );
+            continue;
+        }
+
+        if ( !cur.from )
+        {
+            report( cur.to, std::move( cur.key ), log_op::APPEND );
+            continue;
+        }
+
+        visited += 2;
+        if ( cur.from->hash == cur.to->hash )
+            continue;
+
+        if ( cur.from->is_finite_node() != cur.to->is_finite_node() )
+            callback( cur.key, cur.from->is_finite_node() ? log_op::REMOVE : log_op::APPEND );
+
+        // Lockstep over sorted children.
+        children.clear();
+        size_t i = 0, j = 0;
+        size_t n = cur.from->next.size(), m = cur.to->next.size();
+        while ( i < n || j < m )
+        {
+            unsigned char a = i < n ? cur.from->next.label( i ) : 0;
+            unsigned char b = j < m ? cur.to->next.label( j ) : 0;
+
+            item child{ nullptr, nullptr, cur.key };
+            if ( j == m || ( i < n && a < b ) )
+            {
+                child.from = cast( cur.from->next.node( i++ ) );
+                child.key.push_back( static_cast<char>( a ) );
+            }
+            else if ( i == n || b < a )
+            {
+                child.to = cast( cur.to->next.node( j++ ) );
+                child.key.push_back( static_cast<char>( b ) );
+            }
+            else
+            {
+                child.from = cast( cur.from->next.node( i++ ) );
+                child.to   = cast( cur.to->next.node( j++ ) );
+                child.key.push_back( static_cast<char>( a ) );
+            }
+
+            // Equal subtrees are dropped before their keys are copied.
+            if ( !child.from || !child.to || child.from->hash != child.to->hash )
+                children.push_back( std::move( child ) );
+            else
+                visited += 2;
+        }
+
+        // Stack is LIFO: first child is popped first.
+        for ( auto it = children.rbegin(); it != children.rend(); ++it )
+            stack.push_back( std::move( *it ) );
+    }
+
+    return visited;
+}
+
+
+std::string merkle_prefix_tree::encode_delta( const merkle_prefix_tree &from, const merkle_prefix_tree &to )
+{
+    std::string delta;
+    put_u64( delta, from.hash );
+    put_u64( delta, to.hash );
+    put_u32( delta, 0 );
+
+    diff( from, to, [&] ( const std::string &key, log_op op )
+    {
+        delta.push_back( static_cast<char>( op ) );
+        put_u32( delta, static_cast<uint32_t>( key.size() ) );
+        delta += key;
+    } );
+
+    uint32_t crc = crc32c( delta.data() + DELTA_HEADER, delta.size() - DELTA_HEADER );
+    for ( int i = 0; i < 4; ++i )
+        delta[ 2 * sizeof( uint64_t ) + i ] = static_cast<char>( crc >> ( 8 * i ) );
+
+    return delta;
+}
+
+
+bool merkle_prefix_tree::apply_delta( const std::string &delta )
+{
+    if ( delta.size() < DELTA_HEADER || get_u64( delta.data() ) != hash )
+        return false;
+
+    uint32_t crc = get_u32( delta.data() + 2 * sizeof( uint64_t ) );
+    if ( crc != crc32c( delta.data() + DELTA_HEADER, delta.size() - DELTA_HEADER ) )
+        return false;
+
+    // All records are checked before the tree is changed.
+    std::vector<std::pair<log_op, size_t> > records;
+    for ( size_t pos = DELTA_HEADER; pos < delta.size(); )
+    {
+        if ( delta.size() - pos < RECORD_HEADER )
+            return false;
+
+        log_op op   = static_cast<log_op>( delta[ pos ] );
+        size_t size = get_u32( delta.data() + pos + 1 );
+        pos += RECORD_HEADER;
+
+        if ( ( op != log_op::APPEND && op != log_op::REMOVE ) || delta.size() - pos < size )
+            return false;
+
+        // Keys are C strings.
+        if ( std::memchr( delta.data() + pos, 0, size ) )
+            return false;
+
+        records.emplace_back( op, pos - RECORD_HEADER );
+        pos += size;
+    }
+
+    // Records which have changed the tree, to undo on mismatch.
+    std::vector<std::pair<log_op, size_t> > applied;
+
+    std::string key;
+    for ( const auto &record : records )
+    {
+        const char *data = delta.data() + record.second;
+        key.assign( data + RECORD_HEADER, get_u32( data + 1 ) );
+
+        if ( exists( key ) == ( record.first == log_op::APPEND ) )
+            continue;
+
+        if ( record.first == log_op::APPEND )
+            append( key );
+        else
+            remove( key );
+        applied.push_back( record );
+    }
+
+    if ( hash == get_u64( delta.data() + sizeof( uint64_t ) ) )
+        return true;
+
+    // Source hash has matched by collision or records are forged: hashes
+    // depend on keys only, so reverse operations restore the tree.
+    for ( auto it = applied.rbegin(); it != applied.rend(); ++it )
+    {
+        const char *data = delta.data() + it->second;
+        key.assign( data + RECORD_HEADER, get_u32( data + 1 ) );
+
+        if ( it->first == log_op::APPEND )
+            remove( key );
+        else
+            append( key );
+    }
+
+    return false;
+}
+
+
+
+void merkle_prefix_tree::update_path( const std::vector<merkle_prefix_tree*> &path, const char *key, uint64_t hash_ )
+{
+    size_t   i   = path.size() - 1;
+    uint64_t old = path[ i ]->hash;
+
+    path[ i ]->hash = hash_;
+    while ( i-- )
+    {
+        unsigned char c      = static_cast<unsigned char>( key[ i ] );
+        uint64_t      parent = path[ i ]->hash;
+
+        path[ i ]->hash += edge_hash( c, path[ i + 1 ]->hash ) - edge_hash( c, old );
+        old = parent;
+    }
+}
+
+
+bool merkle_prefix_tree::find_path( const char *key, std::vector<merkle_prefix_tree*> &path )
+{
+    if ( !key )
+        return false;
+
+    path.assign( 1, this );
+    for ( ; *key; ++key )
+    {
+        prefix_tree *child = path.back()->next.get( static_cast<unsigned char>( *key ) );
+        if ( !child )
+            return false;
+        path.push_back( cast( child ) );
+    }
+
+    return true;
+}
+
+
+
+} // namespace prefix_tree
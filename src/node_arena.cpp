@@ -0,0 +1,178 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <vector>
+
+#include "prefix_tree/node_arena.h"
+
+
+namespace prefix_tree
+{
+
+
+namespace
+{
+
+
+/**
+ * @brief The registry struct   Live arenas sorted by address.
+ */
+struct registry
+{
+    std::shared_mutex                       lock;
+    std::vector<node_arena*>                arenas;
+    /// @brief count    Count of arenas, checked without lock on deallocation.
+    std::atomic<size_t>                     count{ 0 };
+};
+
+
+registry& get_registry()
+{
+    // Never destroyed: nodes of static trees are deallocated after
+    // destruction of function local statics.
+    static registry *instance = new registry();
+    return *instance;
+}
+
+
+thread_local node_arena *current = nullptr;
+
+
+} // namespace
+
+
+
+node_arena::node_arena( size_t bytes )
+: begin( static_cast<char*>( ::operator new( bytes ) ) ), end( begin + bytes ), top( begin ), live( 1 )
+{
+}
+
+
+node_arena::~node_arena()
+{
+    ::operator delete( begin );
+}
+
+
+
+node_arena* node_arena::create( size_t bytes )
+{
+    node_arena *arena = new node_arena( align( bytes ) );
+
+    registry &r = get_registry();
+    std::unique_lock<std::shared_mutex> guard( r.lock );
+
+    auto pos = std::upper_bound(
+                r.arenas.begin(),
+                r.arenas.end(),
+                arena,
+                [] ( const node_arena *a, const node_arena *b ) { return a->begin < b->begin; }
+    );
+    r.arenas.insert( pos, arena );
+    r.count.fetch_add( 1, std::memory_order_release );
+
+    return arena;
+}
+
+
+
+void node_arena::release()
+{
+    unref();
+}
+
+
+
+void node_arena::unref()
+{
+    if ( live.fetch_sub( 1, std::memory_order_acq_rel ) != 1 )
+        return;
+
+    registry &r = get_registry();
+    {
+        std::unique_lock<std::shared_mutex> guard( r.lock );
+        r.arenas.erase( std::find( r.arenas.begin(), r.arenas.end(), this ) );
+        r.count.fetch_sub( 1, std::memory_order_release );
+    }
+
+    delete this;
+}
+
+
+
+void* node_arena::allocate( size_t bytes )
+{
+    node_arena *arena = current;
+    if ( !arena )
+        return nullptr;
+
+    bytes = align( bytes );
+    if ( static_cast<size_t>( arena->end - arena->top ) < bytes )
+        return nullptr;
+
+    void *p = arena->top;
+    arena->top += bytes;
+    arena->live.fetch_add( 1, std::memory_order_relaxed );
+    return p;
+}
+
+
+
+bool node_arena::deallocate( void *p )
+{
+    registry &r = get_registry();
+    if ( !p || !r.count.load( std::memory_order_acquire ) )
+        return false;
+
+    node_arena *owner = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> guard( r.lock );
+
+        auto pos = std::upper_bound(
+                    r.arenas.begin(),
+                    r.arenas.end(),
+                    static_cast<char*>( p ),
+                    [] ( const char *a, const node_arena *b ) { return a < b->begin; }
+        );
+        if ( pos != r.arenas.begin() && static_cast<char*>( p ) < ( *--pos )->end )
+            owner = *pos;
+    }
+
+    if ( !owner )
+        return false;
+
+    owner->unref();
+    return true;
+}
+
+
+
+bool node_arena::in_current( const void *p )
+{
+    const node_arena *arena = current;
+    const char       *c     = static_cast<const char*>( p );
+    return arena && c >= arena->begin && c < arena->end;
+}
+
+
+
+node_arena::scope::scope( node_arena *arena ) : previous( current )
+{
+    current = arena;
+}
+
+
+node_arena::scope::~scope()
+{
+    current = previous;
+}
+
+
+
+} // namespace prefix_tree
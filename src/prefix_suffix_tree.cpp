@@ -0,0 +1,120 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include "prefix_tree/prefix_suffix_tree.h"
+
+
+namespace prefix_tree
+{
+
+
+namespace
+{
+
+
+inline bool has_prefix( const std::string &key, const std::string &prefix )
+{
+    return key.compare( 0, prefix.size(), prefix ) == 0;
+}
+
+
+inline bool has_suffix( const std::string &key, const std::string &suffix )
+{
+    return key.size() >= suffix.size() && key.compare( key.size() - suffix.size(), suffix.size(), suffix ) == 0;
+}
+
+
+} // namespace
+
+
+
+bool prefix_suffix_tree::append( const std::string &key )
+{
+    return forward.append( key ) && backward.append( reversed( key ) );
+}
+
+
+void prefix_suffix_tree::remove( const std::string &key )
+{
+    forward.remove( key );
+    backward.remove( reversed( key ) );
+}
+
+
+std::pair<prefix_suffix_tree::suffix_iterator, prefix_suffix_tree::suffix_iterator> prefix_suffix_tree::ends_with( const std::string &suffix )
+{
+    // Reversed keys of suffix are in [ from, to ), to is from with last
+    // byte below 0xff incremented and the rest dropped.
+    std::string from = reversed( suffix );
+    std::string to   = from;
+
+    while ( !to.empty() && static_cast<unsigned char>( to.back() ) == 0xff )
+        to.pop_back();
+
+    if ( to.empty() )
+        return { suffix_iterator( backward.lower_bound( from ) ), suffix_iterator( backward.end() ) };
+
+    to.back() = static_cast<char>( static_cast<unsigned char>( to.back() ) + 1 );
+
+    auto r = backward.range( from, to );
+    return { suffix_iterator( std::move( r.first ) ), suffix_iterator( std::move( r.second ) ) };
+}
+
+
+prefix_tree::memory_usage_info prefix_suffix_tree::memory_usage() const
+{
+    prefix_tree::memory_usage_info info  = forward.memory_usage();
+    prefix_tree::memory_usage_info other = backward.memory_usage();
+
+    info.nodes           += other.nodes;
+    info.leaves          += other.leaves;
+    info.node_bytes      += other.node_bytes;
+    info.container_bytes += other.container_bytes;
+    info.value_bytes     += other.value_bytes;
+    return info;
+}
+
+
+
+void prefix_suffix_tree::matching_keys( const std::string &prefix, const std::string &suffix, std::vector<std::string> &keys )
+{
+    std::string tail = reversed( suffix );
+
+    auto by_prefix = forward.lower_bound( prefix );
+    auto by_suffix = backward.lower_bound( tail );
+
+    // Candidates of each side which match the other side too.
+    std::vector<std::string> prefix_keys, suffix_keys;
+
+    for ( ;; )
+    {
+        std::string key;
+
+        if ( !by_prefix || !has_prefix( key = by_prefix.get_key(), prefix ) )
+        {
+            keys.swap( prefix_keys );
+            return;
+        }
+        if ( has_suffix( key, suffix ) )
+            prefix_keys.push_back( std::move( key ) );
+        ++by_prefix;
+
+        if ( !by_suffix || !has_prefix( key = by_suffix.get_key(), tail ) )
+        {
+            // Order of reversed keys is not order of keys.
+            std::sort( suffix_keys.begin(), suffix_keys.end() );
+            keys.swap( suffix_keys );
+            return;
+        }
+        key = reversed( key );
+        if ( has_prefix( key, prefix ) )
+            suffix_keys.push_back( std::move( key ) );
+        ++by_suffix;
+    }
+}
+
+
+
+} // namespace prefix_tree
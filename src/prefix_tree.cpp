@@ -3,7 +3,12 @@
  * BSD 2-clause license.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <deque>
+#include <functional>
+#include <vector>
+
 #include "prefix_tree/prefix_tree.h"
 
 
@@ -11,355 +16,1056 @@ namespace prefix_tree
 {
 
 
-prefix_tree::prefix_tree() : next(), flag( NODE_FLAG::NO_FLAGS ), parent( nullptr )
+namespace
+{
+
+
+/**
+ * @brief run_tasks     Run tasks [0, count) on shared executor, caller
+ *                      runs tasks too while it waits.
+ * @param count         Count of tasks.
+ * @param task          Task function, argument is index of task.
+ */
+void run_tasks( size_t count, const std::function<void( size_t )> &task )
+{
+    if ( count <= 1 )
+    {
+        for ( size_t i = 0; i < count; ++i )
+            task( i );
+        return;
+    }
+
+    executor::task_group group( executor::instance() );
+    for ( size_t i = 0; i < count; ++i )
+        group.run( [&task, i] () { task( i ); } );
+    group.wait();
+}
+
+
+/**
+ * @brief deleting_arena_node  Destructor of node taken from node_arena has
+ *                             finished, operator delete returns memory to
+ *                             arena. Nodes of heap skip registry of arenas.
+ */
+thread_local bool deleting_arena_node = false;
+
+
+} // namespace
+
+
+prefix_tree::prefix_tree() : next()
+{
+    if ( node_arena::in_current( this ) )
+        next.set_owner_in_arena();
+}
+
+
+prefix_tree::~prefix_tree()
+{
+    if ( !next.empty() )
+    {
+        // Descendants are unlinked before deletion, so deletion of deep
+        // tree does not recurse.
+        std::vector<prefix_tree*> stack;
+        next.release_all( stack );
+
+        while ( !stack.empty() )
+        {
+            prefix_tree *node = stack.back();
+            stack.pop_back();
+
+            node->next.release_all( stack );
+            delete node;
+        }
+    }
+
+    // Base destructor is the last one before operator delete.
+    deleting_arena_node = next.owner_in_arena();
+}
+
+
+void* prefix_tree::operator new( size_t size )
 {
+    void *p = node_arena::allocate( size );
+    return p ? p : ::operator new( size );
 }
 
 
-prefix_tree::prefix_tree( prefix_tree *parent_ )
-: next(), flag( NODE_FLAG::NO_FLAGS ), parent( parent_ )
+void prefix_tree::operator delete( void *p )
 {
+    bool in_arena = deleting_arena_node;
+    deleting_arena_node = false;
+
+    if ( !in_arena || !node_arena::deallocate( p ) )
+        ::operator delete( p );
 }
 
 
-prefix_tree *prefix_tree::new_node( prefix_tree *parent_ )
+prefix_tree *prefix_tree::new_node()
 {
-    return new prefix_tree( parent_ );
+    return new prefix_tree();
 };
 
 
-std::pair<prefix_tree&, bool> prefix_tree::append_node( const char *key )
+size_t prefix_tree::node_size() const
 {
-    if ( !key  )
-        return std::pair<prefix_tree&, bool>( *this, false );
+    return sizeof( prefix_tree );
+}
 
-    if ( !*key )
-    {
-        this->flag = NODE_FLAG::FINITE_NODE;
-        return std::pair<prefix_tree&, bool>( *this, true );
-    }
-    
-    auto it = next.find( *key );
-    if ( it != next.end() && it->second )
-        return it->second->append_node( key + 1 );
-        
-    auto appened_node = next.insert_or_assign( *key, ptr( new_node( this ) ) );
-    if ( !appened_node.second )
-        return std::pair<prefix_tree&, bool>( *this, false );
 
-    return appened_node.first->second->append_node( key + 1 );
+size_t prefix_tree::value_size() const
+{
+    return 0;
 }
 
 
+void prefix_tree::move_value( prefix_tree & )
+{
+}
+
 
-bool prefix_tree::remove_node( const char *key, unsigned int pos )
+void prefix_tree::destroy_value()
 {
-    if ( !key[ pos ] )
+}
+
+
+void prefix_tree::prune( const char *key )
+{
+    if ( !key || !*key )
+        return;
+
+    prefix_tree *keep     = this;
+    size_t       keep_pos = 0;
+    prefix_tree *cur      = this;
+
+    for ( size_t pos = 0; key[ pos ]; ++pos )
     {
-        if ( !pos )
-            return false;
+        if ( cur->is_finite_node() || cur->next.size() > 1 )
+        {
+            keep     = cur;
+            keep_pos = pos;
+        }
 
-        if ( is_finite_node() && next.empty() )
-            return true;
+        cur = cur->next.get( static_cast<unsigned char>( key[ pos ] ) );
+        if ( !cur )
+            return;
+    }
 
-        flag = NODE_FLAG::NO_FLAGS;
-        return false;
+    if ( cur->is_finite_node() || !cur->next.empty() )
+        return;
+
+    keep->next.erase( keep->next.find( static_cast<unsigned char>( key[ keep_pos ] ) ) );
+}
+
+
+size_t prefix_tree::path_bytes( const char *key ) const
+{
+    const prefix_tree *cur = this;
+    size_t bytes = 0;
+
+    for ( ;; )
+    {
+        bytes += cur->node_size() + cur->next.allocated_bytes();
+        if ( !key || !*key )
+            return bytes;
+
+        cur = cur->next.get( static_cast<unsigned char>( *key++ ) );
+        if ( !cur )
+            return bytes;
     }
+}
+
 
-    auto it = next.find( key[ pos ] );
-    if ( it == next.end() )
+
+bool prefix_tree::remove_lazy( const char *key )
+{
+    if ( !key || !*key )
         return false;
 
-    if ( !it->second->remove_node( key, ++pos ) )
+    prefix_tree *node = const_cast<prefix_tree*>( find_node( key ) );
+    if ( !node )
         return false;
 
-    if ( next.size() <= 1 && !is_finite_node() )
+    node->clear_finite();
+    if ( !node->next.empty() )
         return true;
 
-    next.erase( it );
+    // Leaf became dead: mark path so compact() finds it.
+    prefix_tree *cur = this;
+    cur->set_tombstone( true );
+    for ( const char *c = key; *c; ++c )
+    {
+        cur = cur->next.get( static_cast<unsigned char>( *c ) );
+        cur->set_tombstone( true );
+    }
+
+    return true;
+}
+
+
+bool prefix_tree::compact( size_t step_budget )
+{
+    if ( !has_tombstone() )
+        return false;
+
+    struct frame
+    {
+        prefix_tree            *node;
+        size_t                  pos;
+    };
+
+    std::vector<frame>  stack( 1, frame{ this, 0 } );
+    size_t              steps = 0;
+    size_t              done  = 0;
+
+    while ( !stack.empty() )
+    {
+        frame  &top = stack.back();
+        size_t  n   = top.node->next.size();
+
+        while ( top.pos < n && !top.node->next.node( top.pos )->has_tombstone() )
+            ++top.pos;
+
+        if ( top.pos < n )
+        {
+            if ( steps >= step_budget && done )
+                return true;
+
+            ++steps;
+            stack.push_back( frame{ top.node->next.node( top.pos ), 0 } );
+            continue;
+        }
+
+        // All marked children are done.
+        prefix_tree *node = top.node;
+        node->set_tombstone( false );
+        stack.pop_back();
+        ++done;
+
+        if ( stack.empty() )
+            break;
+
+        frame &parent = stack.back();
+        if ( !node->is_finite_node() && node->next.empty() )
+        {
+            parent.node->next.erase( parent.pos );
+            ++steps;
+        }
+        else
+        {
+            ++parent.pos;
+        }
+    }
+
     return false;
 }
 
 
 
-const prefix_tree* prefix_tree::find_node( const char *key, bool finite_node ) const
+bool prefix_tree::is_dead() const
 {
-    if ( !key )
-        return nullptr;
-        
-    if ( !*key )
+    if ( !has_tombstone() )
+        return false;
+
+    std::vector<const prefix_tree*> stack( 1, this );
+    while ( !stack.empty() )
     {
-        if ( finite_node )
-            return is_finite_node() ? this : nullptr;
-        return this;
+        const prefix_tree *cur = stack.back();
+        stack.pop_back();
+
+        if ( cur->is_finite_node() )
+            return false;
+
+        for ( size_t i = 0; i < cur->next.size(); ++i )
+        {
+            const prefix_tree *child = cur->next.node( i );
+            if ( !child->has_tombstone() )
+                return false;
+            stack.push_back( child );
+        }
     }
-    
-    auto it = next.find( *key );
-    if ( it != next.end() && it->second )
-        return it->second->find_node( key + 1, finite_node );
-        
-    return nullptr;
+
+    return true;
 }
 
 
 
-prefix_tree::iterator::iterator( const prefix_tree *node_, bool finite_nodes_only_, const char *key )
-: node( (prefix_tree*)node_ ), finite_nodes_only( finite_nodes_only_ ), symbols()
+prefix_tree& prefix_tree::append_path( const char *key, size_t len )
 {
-    if ( key )
+    prefix_tree *cur = this;
+
+    for ( size_t i = 0; i < len; ++i )
     {
-        int i = 0;
-        while ( key[ i ] )
-            symbols.push_back( static_cast<unsigned char>( key[ ++i ] ) );
+        unsigned char c   = static_cast<unsigned char>( key[ i ] );
+        size_t        pos = cur->next.lower_bound( c );
+
+        if ( pos < cur->next.size() && cur->next.label( pos ) == c )
+            cur = cur->next.node( pos );
+        else
+            cur = cur->next.insert( pos, c, ptr( cur->new_node() ) );
     }
+
+    return *cur;
 }
 
 
-prefix_tree::iterator& prefix_tree::iterator::operator++()
+
+prefix_tree* prefix_tree::append_next( std::vector<prefix_tree*> &path, size_t common, const char *key, size_t len )
 {
-    shift_iterator( true );
-    return *this;
+    path.resize( common + 1 );
+    prefix_tree *cur = path.back();
+
+    for ( size_t i = common; i < len; ++i )
+    {
+        unsigned char c = static_cast<unsigned char>( key[ i ] );
+        size_t        n = cur->next.size();
+
+        // Symbol of sorted key is greater than all children of its branch point.
+        if ( !n || cur->next.label( n - 1 ) < c )
+            cur = cur->next.insert( n, c, ptr( cur->new_node() ) );
+        else
+        {
+            size_t pos = cur->next.lower_bound( c );
+            if ( cur->next.label( pos ) == c )
+                cur = cur->next.node( pos );
+            else
+                cur = cur->next.insert( pos, c, ptr( cur->new_node() ) );
+        }
+
+        path.push_back( cur );
+    }
+
+    return cur;
 }
 
 
-prefix_tree::iterator& prefix_tree::iterator::operator++( int unused )
+
+prefix_tree::ptr prefix_tree::detach_node( const char *key )
 {
-    shift_iterator( true );
-    return *this;
+    std::vector<prefix_tree*> path( 1, this );
+
+    for ( const char *k = key; *k; ++k )
+    {
+        prefix_tree *child = path.back()->next.get( static_cast<unsigned char>( *k ) );
+        if ( !child )
+            return ptr();
+
+        path.push_back( child );
+    }
+
+    size_t len = path.size() - 1;
+    if ( !len )
+        return ptr();
+
+    next_nodes_container &parent_next = path[ len - 1 ]->next;
+    ptr detached = parent_next.release( parent_next.find( static_cast<unsigned char>( key[ len - 1 ] ) ) );
+
+    for ( size_t i = len - 1; i > 0; --i )
+    {
+        if ( path[ i ]->is_finite_node() || !path[ i ]->next.empty() )
+            break;
+
+        next_nodes_container &prev = path[ i - 1 ]->next;
+        prev.erase( prev.find( static_cast<unsigned char>( key[ i - 1 ] ) ) );
+    }
+
+    return detached;
 }
 
 
 
-void prefix_tree::iterator::shift_iterator( bool forward )
+void prefix_tree::remove_prefix( const char *prefix )
 {
-    if ( !node )
+    if ( !prefix )
         return;
 
-    prefix_tree *cur = node;
+    if ( !*prefix )
+    {
+        next.clear();
+        clear_finite();
+        return;
+    }
 
-    if ( !node->next.empty() && forward )
-        increment_via_next( node->next.begin(), node->next.end(), node );
-    else
-        node = nullptr;
+    detach_node( prefix );
+}
 
-    if ( !node )
+
+
+prefix_tree::ptr prefix_tree::extract_subtree( const char *prefix )
+{
+    if ( !prefix )
+        return ptr();
+
+    if ( *prefix )
+        return detach_node( prefix );
+
+    ptr root( new_node() );
+    root->next.swap( next );
+
+    if ( is_finite_node() )
     {
-        node = cur;
-        if ( forward )
-            increment_via_parent();
-        else
-            decrement_via_parent();
+        root->move_value( *this );
+        root->set_flag( NODE_FLAG::FINITE_NODE );
+        clear_finite();
     }
+
+    return root;
 }
 
 
-void prefix_tree::iterator::increment_via_next(
-        next_nodes_container::iterator it,
-        next_nodes_container::iterator it_end,
-        prefix_tree *cur
-)
+
+bool prefix_tree::insert_subtree( const char *prefix, ptr &&subtree )
 {
-    auto setup_node = [&] ()
+    if ( !prefix || !subtree )
+        return false;
+
+    if ( !subtree->is_finite_node() && subtree->next.empty() )
+    {
+        subtree.reset();
+        return true;
+    }
+
+    size_t len = std::char_traits<char>::length( prefix );
+    if ( !len )
     {
-        symbols.push_back( static_cast<unsigned char>( it->first ) );
-        node = it->second.get();
+        merge_node( *subtree );
+        subtree.reset();
+        return true;
+    }
+
+    prefix_tree   &parent_node = append_path( prefix, len - 1 );
+    unsigned char  c           = static_cast<unsigned char>( prefix[ len - 1 ] );
+    size_t         pos         = parent_node.next.lower_bound( c );
+
+    if ( pos < parent_node.next.size() && parent_node.next.label( pos ) == c )
+    {
+        parent_node.next.node( pos )->merge_node( *subtree );
+        subtree.reset();
+        return true;
+    }
+
+    parent_node.next.insert( pos, c, std::move( subtree ) );
+    return true;
+}
+
+
+
+prefix_tree::memory_usage_info prefix_tree::memory_usage() const
+{
+    memory_usage_info info = { 0, 0, 0, 0, 0 };
+
+    std::vector<const prefix_tree*> stack( 1, this );
+    while ( !stack.empty() )
+    {
+        const prefix_tree *cur = stack.back();
+        stack.pop_back();
+
+        ++info.nodes;
+        info.node_bytes      += cur->node_size();
+        info.container_bytes += cur->next.allocated_bytes();
+        info.value_bytes     += cur->value_size();
+
+        size_t n = cur->next.size();
+        if ( !n )
+            ++info.leaves;
+
+        for ( size_t i = 0; i < n; ++i )
+            stack.push_back( cur->next.node( i ) );
+    }
+
+    return info;
+}
+
+
+
+prefix_tree::statistics prefix_tree::stats() const
+{
+    statistics info = { 0, 0, 0, 0, 0, 0, {}, {}, {} };
+
+    auto count = [] ( std::vector<size_t> &histogram, size_t value )
+    {
+        if ( histogram.size() <= value )
+            histogram.resize( value + 1, 0 );
+        ++histogram[ value ];
     };
 
-    if ( !finite_nodes_only )
+    struct item
     {
-        setup_node();
-        return;
+        const prefix_tree  *node;
+        size_t              depth;
+        /// @brief chain    Length of chain of single child nodes above the node.
+        size_t              chain;
+    };
+
+    std::vector<item> stack( 1, item{ this, 0, 0 } );
+    while ( !stack.empty() )
+    {
+        item cur = stack.back();
+        stack.pop_back();
+
+        const prefix_tree *node  = cur.node;
+        size_t             value = node->value_size();
+        size_t             n     = node->next.size();
+
+        ++info.nodes;
+        if ( node->is_finite_node() )
+            ++info.finite_nodes;
+        else
+            ++info.non_finite_nodes;
+
+        info.node_bytes      += node->node_size();
+        info.value_bytes     += value;
+        info.container_bytes += node->next.allocated_bytes();
+
+        count( info.depth, cur.depth );
+        count( info.fan_out, n );
+
+        size_t chain = 0;
+        if ( cur.depth && n == 1 && !node->is_finite_node() )
+            chain = cur.chain + 1;
+        else if ( cur.chain )
+            count( info.chain_length, cur.chain );
+
+        for ( size_t i = 0; i < n; ++i )
+            stack.push_back( item{ node->next.node( i ), cur.depth + 1, chain } );
     }
 
-    while ( it != it_end )
+    return info;
+}
+
+
+
+void prefix_tree::merge_node( prefix_tree &other )
+{
+    if ( other.is_finite_node() && !is_finite_node() )
     {
-        node = cur; // node may be setup to nullptr in previous iteration.
+        move_value( other );
+        set_flag( NODE_FLAG::FINITE_NODE );
+    }
 
-        setup_node();
-        if ( it->second->is_finite_node() )
-            return;
+    // Lockstep over sorted children. Unmatched subtrees of other are moved
+    // after the loop to keep positions in both containers valid.
+    std::vector<std::pair<unsigned char, ptr> > moved;
 
-        if ( !it->second->next.empty() )
-        {
-            increment_via_next( it->second->next.begin(), it->second->next.end(), it->second.get() );
+    size_t pos = 0;
+    for ( size_t other_pos = 0; other_pos < other.next.size(); ++other_pos )
+    {
+        unsigned char c = other.next.label( other_pos );
 
-            if ( node )
-                return;
-            else if ( !symbols.empty() )
-                symbols.pop_back();
-        }
+        while ( pos < next.size() && next.label( pos ) < c )
+            ++pos;
+
+        if ( pos < next.size() && next.label( pos ) == c )
+            next.node( pos++ )->merge_node( *other.next.node( other_pos ) );
+        else
+            moved.emplace_back( c, ptr() );
     }
 
-    node = nullptr;
+    for ( auto &it : moved )
+    {
+        it.second = other.next.release( other.next.find( it.first ) );
+        next.insert( it.first, std::move( it.second ) );
+    }
+
+    other.next.clear();
 }
 
 
 
-void prefix_tree::iterator::increment_via_parent()
+bool prefix_tree::intersect_node( const prefix_tree &other )
 {
-    if ( !node->parent )
+    if ( !other.is_finite_node() )
+        clear_finite();
+
+    size_t other_pos = 0;
+    for ( size_t pos = 0; pos < next.size(); )
     {
-        node = nullptr;
-        return;
+        unsigned char c = next.label( pos );
+
+        while ( other_pos < other.next.size() && other.next.label( other_pos ) < c )
+            ++other_pos;
+
+        bool matched = other_pos < other.next.size() && other.next.label( other_pos ) == c;
+
+        if ( !matched || next.node( pos )->intersect_node( *other.next.node( other_pos ) ) )
+            next.erase( pos );
+        else
+            ++pos;
     }
 
-    prefix_tree *cur = node->parent;
-    char c = static_cast<char>( symbols.back() );
-    symbols.pop_back();
+    return !is_finite_node() && next.empty();
+}
+
 
-    auto next_it = cur->next.find( c );
-    auto next_it_end = cur->next.end();
 
-    ++next_it;
+bool prefix_tree::difference_node( const prefix_tree &other )
+{
+    if ( other.is_finite_node() )
+        clear_finite();
 
-    if ( next_it != next_it_end )
-        increment_via_parent( next_it, next_it_end, cur );
-    else
+    size_t other_pos = 0;
+    for ( size_t pos = 0; pos < next.size(); )
     {
-        node = cur;
-        increment_via_parent();
+        unsigned char c = next.label( pos );
+
+        while ( other_pos < other.next.size() && other.next.label( other_pos ) < c )
+            ++other_pos;
+
+        bool matched = other_pos < other.next.size() && other.next.label( other_pos ) == c;
+
+        if ( matched && next.node( pos )->difference_node( *other.next.node( other_pos ) ) )
+            next.erase( pos );
+        else
+            ++pos;
     }
+
+    return !is_finite_node() && next.empty();
 }
 
 
-void prefix_tree::iterator::increment_via_parent(
-        next_nodes_container::iterator it,
-        next_nodes_container::iterator it_end,
-        prefix_tree *cur
-)
+
+void prefix_tree::merge( prefix_tree &&other, bool parallel )
 {
-    if ( !finite_nodes_only )
+    if ( &other == this )
+        return;
+
+    if ( !parallel )
     {
-        node = it != it_end ? it->second.get() : nullptr;
-        symbols.push_back( static_cast<unsigned char>( it->first )   );
+        merge_node( other );
+
+        // Value of root is moved or left, other is empty anyway.
+        other.clear_finite();
         return;
     }
 
-    increment_via_next( it, it_end, cur );
-    if ( !node )
+    if ( other.is_finite_node() && !is_finite_node() )
     {
-        node = cur;
-        increment_via_parent();
+        move_value( other );
+        set_flag( NODE_FLAG::FINITE_NODE );
+    }
+
+    // Subtrees present in both trees are merged in parallel,
+    // others are moved after that.
+    std::vector<std::pair<prefix_tree*, prefix_tree*> > matched;
+    std::vector<unsigned char>                          moved;
+
+    size_t pos = 0;
+    for ( size_t other_pos = 0; other_pos < other.next.size(); ++other_pos )
+    {
+        unsigned char c = other.next.label( other_pos );
+
+        while ( pos < next.size() && next.label( pos ) < c )
+            ++pos;
+
+        if ( pos < next.size() && next.label( pos ) == c )
+            matched.emplace_back( next.node( pos++ ), other.next.node( other_pos ) );
+        else
+            moved.push_back( c );
     }
+
+    run_tasks(
+                matched.size(),
+                [&] ( size_t i ) { matched[ i ].first->merge_node( *matched[ i ].second ); }
+    );
+
+    for ( unsigned char c : moved )
+        next.insert( c, other.next.release( other.next.find( c ) ) );
+
+    other.next.clear();
+    other.clear_finite();
 }
 
 
 
-void prefix_tree::iterator::decrement_via_parent()
+void prefix_tree::intersect( const prefix_tree &other, bool parallel )
 {
-    if ( !node->parent )
+    if ( &other == this )
+        return;
+
+    if ( !parallel )
     {
-        node = nullptr;
+        intersect_node( other );
         return;
     }
 
-    prefix_tree *cur = node->parent;
-    char c = static_cast<char>( symbols.back() );
-    symbols.pop_back();
+    if ( !other.is_finite_node() )
+        clear_finite();
 
-    next_nodes_container::iterator found_it = cur->next.find( c );
+    std::vector<std::pair<prefix_tree*, const prefix_tree*> > matched;
 
-    if ( found_it == cur->next.begin() )
+    size_t other_pos = 0;
+    for ( size_t pos = 0; pos < next.size(); )
     {
-        node = cur;
-        if ( !finite_nodes_only || cur->is_finite_node() )
-        {
-            if ( symbols.empty() )
-                node = nullptr;
-            return;
-        }
-        decrement_via_parent();
+        unsigned char c = next.label( pos );
+
+        while ( other_pos < other.next.size() && other.next.label( other_pos ) < c )
+            ++other_pos;
+
+        if ( other_pos < other.next.size() && other.next.label( other_pos ) == c )
+            matched.emplace_back( next.node( pos++ ), other.next.node( other_pos ) );
+        else
+            next.erase( pos );
     }
-    else
+
+    std::vector<char> empty( matched.size(), 0 );
+    run_tasks(
+                matched.size(),
+                [&] ( size_t i ) { empty[ i ] = matched[ i ].first->intersect_node( *matched[ i ].second ); }
+    );
+
+    for ( size_t i = next.size(); i-- > 0; )
+        if ( empty[ i ] )
+            next.erase( i );
+}
+
+
+
+void prefix_tree::difference( const prefix_tree &other, bool parallel )
+{
+    if ( &other == this )
     {
-        decrement_via_parent(
-                    next_nodes_container::reverse_iterator( found_it ),
-                    cur->next.rend(),
-                    cur
-        );
+        next.clear();
+        clear_finite();
+        return;
     }
+
+    if ( !parallel )
+    {
+        difference_node( other );
+        return;
+    }
+
+    if ( other.is_finite_node() )
+        clear_finite();
+
+    std::vector<std::pair<size_t, const prefix_tree*> > matched;
+
+    size_t other_pos = 0;
+    for ( size_t pos = 0; pos < next.size(); ++pos )
+    {
+        unsigned char c = next.label( pos );
+
+        while ( other_pos < other.next.size() && other.next.label( other_pos ) < c )
+            ++other_pos;
+
+        if ( other_pos < other.next.size() && other.next.label( other_pos ) == c )
+            matched.emplace_back( pos, other.next.node( other_pos ) );
+    }
+
+    std::vector<char> empty( matched.size(), 0 );
+    run_tasks(
+                matched.size(),
+                [&] ( size_t i )
+                {
+                    empty[ i ] = next.node( matched[ i ].first )->difference_node( *matched[ i ].second );
+                }
+    );
+
+    for ( size_t i = matched.size(); i-- > 0; )
+        if ( empty[ i ] )
+            next.erase( matched[ i ].first );
 }
 
 
-void prefix_tree::iterator::decrement_via_parent(
-        next_nodes_container::reverse_iterator it,
-        next_nodes_container::reverse_iterator it_end,
-        prefix_tree *cur
-)
+
+void prefix_tree::relayout()
 {
-    if ( !cur->next.empty() )
-        decrement_via_next( it, it_end, cur );
-    else
-        node = nullptr;
+    // Count of top nodes laid out in BFS order, they fit to L1/L2 cache.
+    static constexpr size_t BFS_NODES = 4096;
 
-    if ( !node )
+    size_t bytes = 0;
+    std::vector<const prefix_tree*> stack( 1, this );
+    while ( !stack.empty() )
     {
-        if ( !finite_nodes_only || cur->is_finite_node() )
-            node = cur;
-        else
-            decrement_via_parent();
+        const prefix_tree *cur = stack.back();
+        stack.pop_back();
+
+        size_t n = cur->next.size();
+        if ( cur != this )
+            bytes += node_arena::align( cur->node_size() );
+        bytes += node_arena::align( next_nodes_container::allocated_bytes_for( n ) );
+
+        for ( size_t i = 0; i < n; ++i )
+            stack.push_back( cur->next.node( i ) );
     }
 
+    if ( next.empty() )
+        return;
+
+    struct item
+    {
+        prefix_tree            *from;
+        next_nodes_container   *to;
+    };
+
+    std::vector<unsigned char>  labels;
+    std::vector<ptr>            children;
+
+    // Children of node are allocated together followed by their block.
+    auto copy_children = [&] ( const item &cur, auto &&push )
+    {
+        size_t n = cur.from->next.size();
+
+        labels.resize( n );
+        children.resize( n );
+        for ( size_t i = 0; i < n; ++i )
+        {
+            prefix_tree *child = cur.from->next.node( i );
+
+            labels[ i ] = cur.from->next.label( i );
+            children[ i ].reset( new_node() );
+            if ( child->is_finite_node() )
+            {
+                children[ i ]->move_value( *child );
+                children[ i ]->set_flag( NODE_FLAG::FINITE_NODE );
+            }
+            children[ i ]->set_tombstone( child->has_tombstone() );
+        }
+
+        cur.to->assign( n, labels.data(), children.data() );
+
+        for ( size_t i = 0; i < n; ++i )
+            push( item{ cur.from->next.node( i ), &cur.to->node( i )->next } );
+    };
+
+    next_nodes_container copy;
+    node_arena *arena = node_arena::create( bytes );
+    {
+        node_arena::scope scope( arena );
+
+        std::deque<item> queue( 1, item{ this, &copy } );
+        size_t           laid  = 0;
+
+        while ( !queue.empty() && laid < BFS_NODES )
+        {
+            item cur = queue.front();
+            queue.pop_front();
+
+            laid += cur.from->next.size();
+            copy_children( cur, [&] ( const item &child ) { queue.push_back( child ); } );
+        }
+
+        std::vector<item> dfs;
+        for ( const item &top : queue )
+        {
+            dfs.push_back( top );
+            while ( !dfs.empty() )
+            {
+                item cur = dfs.back();
+                dfs.pop_back();
+
+                size_t first = dfs.size();
+                copy_children( cur, [&] ( const item &child ) { dfs.push_back( child ); } );
+                std::reverse( dfs.begin() + first, dfs.end() );
+            }
+        }
+    }
+    arena->release();
+
+    next.swap( copy );
+}
+
+
+
+prefix_tree::iterator::iterator( const prefix_tree *root, bool finite_nodes_only_, const char *key )
+: node( const_cast<prefix_tree*>( root ) ), finite_nodes_only( finite_nodes_only_ ), path(), symbols()
+{
+    no_instrumentation::probe probe( operation::FIND );
+    descend( key, probe );
+}
+
+
+void prefix_tree::iterator::reset()
+{
+    node = nullptr;
+    path.clear();
+    symbols.clear();
+}
+
+
+prefix_tree::iterator& prefix_tree::iterator::operator++()
+{
+    increment();
+    return *this;
 }
 
 
+prefix_tree::iterator& prefix_tree::iterator::operator++( int unused )
+{
+    increment();
+    return *this;
+}
+
 
 prefix_tree::iterator& prefix_tree::iterator::operator--()
 {
-    shift_iterator( false );
+    decrement();
     return *this;
 }
 
 
-void prefix_tree::iterator::decrement_via_next(
-        next_nodes_container::reverse_iterator it,
-        next_nodes_container::reverse_iterator it_end,
-        prefix_tree *cur
-)
+prefix_tree::iterator& prefix_tree::iterator::operator--( int unused )
 {
-    while ( true )
+    decrement();
+    return *this;
+}
+
+
+void prefix_tree::iterator::increment()
+{
+    if ( !node )
+        return;
+
+    // Pre-order: first child or next sibling of the nearest ancestor.
+    // Iteration of all nodes skips dead subtrees of remove_lazy() whole.
+    bool dead = false;
+    do
     {
-        if ( it->second->next.empty() )
+        if ( !node->next.empty() && !dead )
         {
-            if ( it->second->is_finite_node() || !finite_nodes_only )
-            {
-                node = it->second.get();
-                symbols.push_back( static_cast<unsigned char>( it->first ) );
-                return;
-            }
-            else
-                node = nullptr;
+            path.push_back( node );
+            symbols.push_back( static_cast<char>( node->next.label( 0 ) ) );
+            node = node->next.node( 0 );
         }
         else
         {
-            symbols.push_back( static_cast<unsigned char>( it->first ) );
-            decrement_via_next( it->second->next.rbegin(), it->second->next.rend(), it->second.get() );
-
-            if ( node )
-            {
+            skip_subtree();
+            if ( !node )
                 return;
-            }
+        }
 
-            node = cur;
-            symbols.pop_back();
+        dead = !finite_nodes_only && node->is_dead();
+    }
+    while ( finite_nodes_only ? !node->is_finite_node() : dead );
+}
+
+
+void prefix_tree::iterator::skip_subtree()
+{
+    // Next sibling of the node or of the nearest ancestor.
+    while ( true )
+    {
+        if ( path.empty() )
+        {
+            reset();
+            return;
         }
 
-        if ( it == it_end )
+        prefix_tree *parent = path.back();
+        size_t       pos    = parent->next.upper_bound( static_cast<unsigned char>( symbols.back() ) );
+
+        if ( pos < parent->next.size() )
         {
-            node = nullptr;
+            symbols.back() = static_cast<char>( parent->next.label( pos ) );
+            node           = parent->next.node( pos );
             return;
         }
 
-        ++it;
+        node = parent;
+        path.pop_back();
+        symbols.pop_back();
     }
 }
 
 
+void prefix_tree::iterator::seek( const char *key, bool upper )
+{
+    for ( ; *key; ++key )
+    {
+        unsigned char c   = static_cast<unsigned char>( *key );
+        size_t        pos = node->next.lower_bound( c );
 
-prefix_tree::iterator& prefix_tree::iterator::operator--( int unused )
+        if ( pos < node->next.size() && node->next.label( pos ) == c )
+        {
+            path.push_back( node );
+            symbols.push_back( *key );
+            node = node->next.node( pos );
+            continue;
+        }
+
+        if ( pos < node->next.size() )
+        {
+            // Subtree of greater child is right after the key.
+            path.push_back( node );
+            symbols.push_back( static_cast<char>( node->next.label( pos ) ) );
+            node = node->next.node( pos );
+        }
+        else
+        {
+            // Node and its subtree are less than the key.
+            skip_subtree();
+        }
+
+        if ( node && ( finite_nodes_only ? !node->is_finite_node() : node->is_dead() ) )
+            increment();
+        return;
+    }
+
+    // Node of key. Root is not an element of iteration.
+    if ( upper || path.empty() || ( finite_nodes_only ? !node->is_finite_node() : node->is_dead() ) )
+        increment();
+}
+
+
+void prefix_tree::iterator::decrement()
 {
-    shift_iterator( false );
-    return *this;
+    if ( !node )
+        return;
+
+    // Pre-order back: last descendant of previous sibling or parent.
+    // Root is not reachable. Parent is an ancestor of start node, so it is
+    // never dead.
+    bool dead = false;
+    do
+    {
+        if ( path.empty() )
+        {
+            reset();
+            return;
+        }
+
+        prefix_tree *parent = path.back();
+        size_t       pos    = parent->next.lower_bound( static_cast<unsigned char>( symbols.back() ) );
+
+        if ( !pos )
+        {
+            node = parent;
+            path.pop_back();
+            symbols.pop_back();
+
+            if ( path.empty() )
+            {
+                reset();
+                return;
+            }
+
+            dead = false;
+            continue;
+        }
+
+        symbols.back() = static_cast<char>( parent->next.label( pos - 1 ) );
+        node           = parent->next.node( pos - 1 );
+
+        dead = !finite_nodes_only && node->is_dead();
+        if ( dead )
+            continue;
+
+        while ( !node->next.empty() )
+        {
+            size_t last = node->next.size();
+            while ( last && !finite_nodes_only && node->next.node( last - 1 )->is_dead() )
+                --last;
+
+            // Finite node with dead children only.
+            if ( !last-- )
+                break;
+
+            path.push_back( node );
+            symbols.push_back( static_cast<char>( node->next.label( last ) ) );
+            node = node->next.node( last );
+        }
+    }
+    while ( finite_nodes_only ? !node->is_finite_node() : dead );
 }
 
 
@@ -381,29 +1087,53 @@ bool prefix_tree::iterator::operator==( const iterator &right ) const
 
 std::string prefix_tree::iterator::get_key() const
 {
-    return std::string( symbols.begin(), symbols.end() );
+    return symbols;
 }
 
 
-prefix_tree::iterator prefix_tree::find( const char *key, bool finite_node )
+prefix_tree::iterator prefix_tree::begin( bool finite_nodes_only )
 {
-    const prefix_tree *found = find_node( key, finite_node );
-    return found ?
-                iterator( found, finite_node, key ) :
-                iterator()
-    ;
+    iterator it( this, finite_nodes_only, nullptr );
+    ++it;
+
+    return it;
 }
 
 
-prefix_tree::iterator prefix_tree::begin( bool finite_nodes_only )
+prefix_tree::iterator prefix_tree::lower_bound( const char *key, bool finite_nodes_only )
 {
+    if ( !key )
+        return iterator();
+
     iterator it( this, finite_nodes_only, nullptr );
-    ++it;
+    it.seek( key, false );
+
+    return it;
+}
+
+
+prefix_tree::iterator prefix_tree::upper_bound( const char *key, bool finite_nodes_only )
+{
+    if ( !key )
+        return iterator();
+
+    iterator it( this, finite_nodes_only, nullptr );
+    it.seek( key, true );
 
     return it;
 }
 
 
+std::pair<prefix_tree::iterator, prefix_tree::iterator> prefix_tree::range( const std::string &from, const std::string &to, bool finite_nodes_only )
+{
+    iterator last = lower_bound( to, finite_nodes_only );
+    if ( !( from < to ) )
+        return std::make_pair( last, last );
+
+    return std::make_pair( lower_bound( from, finite_nodes_only ), last );
+}
+
+
 prefix_tree::iterator prefix_tree::end()
 {
     return iterator();
@@ -0,0 +1,778 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "prefix_tree/shared_prefix_tree.h"
+#include "prefix_tree/simd.h"
+
+
+namespace prefix_tree
+{
+
+
+namespace
+{
+
+
+constexpr uint64_t  SEGMENT_MAGIC   = 0x3145455254534650ull;    // "PFSTREE1"
+constexpr size_t    READER_SLOTS    = 256;
+constexpr size_t    SIZE_CLASSES    = 10;                       // 16 bytes .. 8 KB
+constexpr size_t    MIN_CHUNK       = 16;
+constexpr uint32_t  FINITE          = 1;
+/// @brief RESERVE      End of segment kept for remove(), so full tree shrinks.
+constexpr size_t    RESERVE         = 8 << 10;
+/// @brief PID_BITS     Reader slot keeps epoch << PID_BITS | pid, pid_max <= 2^22.
+constexpr unsigned  PID_BITS        = 22;
+constexpr uint64_t  PID_MASK        = ( 1ull << PID_BITS ) - 1;
+/// @brief OPEN_TIMEOUT     Time to wait for creator to initialize segment.
+constexpr auto      OPEN_TIMEOUT    = std::chrono::seconds( 5 );
+/// @brief READ_TIMEOUT     Time to wait for free reader slot.
+constexpr auto      READ_TIMEOUT    = std::chrono::seconds( 1 );
+
+
+struct block;
+
+
+/**
+ * @brief The node struct   Node of tree. Flags and value are changed in place,
+ *                          children are replaced as a whole block.
+ */
+struct node
+{
+    std::atomic<uint64_t>                   value;
+    std::atomic<uint32_t>                   flags;
+    uint32_t                                reserved;
+    self_relative_ptr<block>                children;
+
+    node() : value( 0 ), flags( 0 ), reserved( 0 ), children() {}
+};
+
+
+/**
+ * @brief The block struct  Immutable sorted children of node: header, labels
+ *                          padded to 8 bytes, pointers to nodes.
+ */
+struct block
+{
+    uint32_t                                count;
+    uint32_t                                size_class;
+
+
+    static inline size_t labels_size( size_t count ) { return ( count + 7 ) & ~size_t( 7 ); }
+
+    static inline size_t bytes( size_t count )
+    {
+        return sizeof( block ) + labels_size( count ) + count * sizeof( self_relative_ptr<node> );
+    }
+
+
+    inline unsigned char* labels()
+    {
+        return reinterpret_cast<unsigned char*>( this + 1 );
+    }
+
+
+    inline self_relative_ptr<node>* nodes()
+    {
+        return reinterpret_cast<self_relative_ptr<node>*>( labels() + labels_size( count ) );
+    }
+
+
+    inline node* find( unsigned char c )
+    {
+        size_t i = simd::lower_bound( labels(), count, c );
+        return i < count && labels()[ i ] == c ? nodes()[ i ].load() : nullptr;
+    }
+};
+
+
+/**
+ * @brief The retired struct    Memory unlinked by writer at epoch, reused
+ *                              when all readers have announced later epoch.
+ */
+struct retired
+{
+    uint64_t                                next;
+    uint64_t                                offset;
+    uint64_t                                epoch;
+    uint64_t                                size_class;
+};
+
+
+/**
+ * @brief The segment_header struct     Layout of segment, memory of nodes
+ *                                      follows it.
+ */
+struct segment_header
+{
+    std::atomic<uint64_t>                   magic;
+    uint64_t                                size;
+    pthread_mutex_t                         writer;
+
+    // Allocator and retired list are changed under writer lock only.
+    uint64_t                                top;
+    uint64_t                                free_lists[ SIZE_CLASSES ];
+    uint64_t                                retired_head;
+    uint64_t                                retired_tail;
+
+    std::atomic<uint64_t>                   epoch;
+    std::atomic<uint64_t>                   keys;
+    std::atomic<uint64_t>                   used;
+    std::atomic<uint64_t>                   readers[ READER_SLOTS ];
+
+    node                                    root;
+
+
+    inline char* base() { return reinterpret_cast<char*>( this ); }
+
+    inline uint64_t offset_of( const void *p ) { return static_cast<uint64_t>( static_cast<const char*>( p ) - base() ); }
+
+
+    static size_t class_of( size_t bytes )
+    {
+        size_t c = 0;
+        while ( ( MIN_CHUNK << c ) < bytes )
+            ++c;
+        return c;
+    }
+
+
+    void* allocate( size_t size_class, bool reserve = false )
+    {
+        size_t      bytes = MIN_CHUNK << size_class;
+        uint64_t    off   = free_lists[ size_class ];
+
+        if ( off )
+        {
+            std::memcpy( &free_lists[ size_class ], base() + off, sizeof( uint64_t ) );
+        }
+        else
+        {
+            if ( top + bytes + ( reserve ? 0 : RESERVE ) > size )
+                throw std::bad_alloc();
+            off  = top;
+            top += bytes;
+        }
+
+        used.fetch_add( bytes, std::memory_order_relaxed );
+        return base() + off;
+    }
+
+
+    void deallocate( uint64_t off, size_t size_class )
+    {
+        std::memcpy( base() + off, &free_lists[ size_class ], sizeof( uint64_t ) );
+        free_lists[ size_class ] = off;
+        used.fetch_sub( MIN_CHUNK << size_class, std::memory_order_relaxed );
+    }
+
+
+    node* new_node()
+    {
+        return new ( allocate( class_of( sizeof( node ) ) ) ) node();
+    }
+
+
+    block* new_block( size_t count, bool reserve = false )
+    {
+        size_t  size_class = class_of( block::bytes( count ) );
+        block  *b          = static_cast<block*>( allocate( size_class, reserve ) );
+
+        b->count      = static_cast<uint32_t>( count );
+        b->size_class = static_cast<uint32_t>( size_class );
+        for ( size_t i = 0; i < count; ++i )
+            new ( &b->nodes()[ i ] ) self_relative_ptr<node>();
+        return b;
+    }
+
+
+    /**
+     * @brief copy_children     Copy children of block skipping one and leaving
+     *                          one gap, pointers are relative so they are reset.
+     */
+    void copy_children( block *from, block *to, size_t skip, size_t gap )
+    {
+        for ( size_t i = 0, j = 0; from && i < from->count; ++i )
+        {
+            if ( i == skip )
+                continue;
+            if ( j == gap )
+                ++j;
+            to->labels()[ j ] = from->labels()[ i ];
+            to->nodes()[ j ].store( from->nodes()[ i ].load( std::memory_order_relaxed ), std::memory_order_relaxed );
+            ++j;
+        }
+    }
+
+
+    /**
+     * @brief retire    Link preallocated records of unlinked memory to the end
+     *                  of retired list, tagged by current epoch.
+     */
+    void retire( const std::vector<std::pair<void*, size_t> > &items, std::vector<retired*> &records )
+    {
+        uint64_t e = epoch.fetch_add( 1 );
+
+        for ( size_t i = 0; i < items.size(); ++i )
+        {
+            retired *r    = records[ i ];
+            r->next       = 0;
+            r->offset     = offset_of( items[ i ].first );
+            r->epoch      = e;
+            r->size_class = items[ i ].second;
+
+            uint64_t off = offset_of( r );
+            if ( retired_tail )
+                reinterpret_cast<retired*>( base() + retired_tail )->next = off;
+            else
+                retired_head = off;
+            retired_tail = off;
+        }
+        records.clear();
+    }
+
+
+    /// @brief recount  Count keys again after crash of writer.
+    void recount()
+    {
+        std::vector<node*>  stack( 1, &root );
+        uint64_t            count = 0;
+
+        while ( !stack.empty() )
+        {
+            node *n = stack.back();
+            stack.pop_back();
+
+            count += n->flags.load( std::memory_order_relaxed ) & FINITE;
+
+            block *b = n->children.load( std::memory_order_relaxed );
+            for ( size_t i = 0; b && i < b->count; ++i )
+                stack.push_back( b->nodes()[ i ].load( std::memory_order_relaxed ) );
+        }
+
+        keys.store( count, std::memory_order_relaxed );
+    }
+
+
+    /// @brief reclaim  Reuse retired memory older than epochs of readers.
+    void reclaim()
+    {
+        if ( !retired_head )
+            return;
+
+        uint64_t oldest = reinterpret_cast<retired*>( base() + retired_head )->epoch;
+        uint64_t min    = epoch.load();
+
+        for ( auto &slot : readers )
+        {
+            uint64_t announced = slot.load();
+            if ( !announced )
+                continue;
+
+            uint64_t e = announced >> PID_BITS;
+            if ( e <= oldest )
+            {
+                // Blocking slot of dead process is released.
+                pid_t pid = static_cast<pid_t>( announced & PID_MASK );
+                if ( ::kill( pid, 0 ) < 0 && errno == ESRCH )
+                {
+                    slot.compare_exchange_strong( announced, 0 );
+                    continue;
+                }
+            }
+            if ( e < min )
+                min = e;
+        }
+
+        while ( retired_head )
+        {
+            retired *r = reinterpret_cast<retired*>( base() + retired_head );
+            if ( r->epoch >= min )
+                break;
+
+            // List is advanced first: crash of writer here leaks, not reuses twice.
+            retired_head = r->next;
+            if ( !retired_head )
+                retired_tail = 0;
+
+            deallocate( r->offset, r->size_class );
+            deallocate( offset_of( r ), class_of( sizeof( retired ) ) );
+        }
+    }
+};
+
+
+/**
+ * @brief The writer_guard class    Robust process shared lock of writers.
+ *                                  Tree is consistent after crash of owner,
+ *                                  only count of keys is restored.
+ */
+class writer_guard
+{
+private:
+    pthread_mutex_t                        &lock;
+
+public:
+    explicit writer_guard( segment_header &h ) : lock( h.writer )
+    {
+        int rc = ::pthread_mutex_lock( &lock );
+        if ( rc == EOWNERDEAD )
+        {
+            h.recount();
+            rc = ::pthread_mutex_consistent( &lock );
+        }
+        if ( rc )
+            throw std::system_error( rc, std::generic_category(), "pthread_mutex_lock" );
+    }
+
+    ~writer_guard()
+    {
+        ::pthread_mutex_unlock( &lock );
+    }
+
+    writer_guard( const writer_guard & ) = delete;
+    writer_guard& operator=( const writer_guard & ) = delete;
+};
+
+
+/**
+ * @brief The read_guard class  Announce epoch of reader in free slot.
+ *                              If all slots stay taken for READ_TIMEOUT
+ *                              std::system_error( ETIMEDOUT ) is thrown.
+ */
+class read_guard
+{
+private:
+    std::atomic<uint64_t>                  *slot;
+
+public:
+    explicit read_guard( segment_header &h ) : slot( nullptr )
+    {
+        static thread_local size_t hint = std::hash<std::thread::id>()( std::this_thread::get_id() );
+
+        uint64_t pid = static_cast<uint64_t>( ::getpid() ) & PID_MASK;
+
+        // Clock is read after first full pass only.
+        std::chrono::steady_clock::time_point deadline;
+
+        for ( size_t i = 0; !slot; ++i )
+        {
+            std::atomic<uint64_t> &s = h.readers[ ( hint + i ) % READER_SLOTS ];
+            uint64_t e        = h.epoch.load();
+            uint64_t expected = 0;
+
+            if ( !s.load( std::memory_order_relaxed ) && s.compare_exchange_strong( expected, e << PID_BITS | pid ) )
+            {
+                slot = &s;
+                hint = ( hint + i ) % READER_SLOTS;
+
+                // Writer may have advanced epoch before slot became visible.
+                for ( uint64_t g; ( g = h.epoch.load() ) != e; e = g )
+                    s.store( g << PID_BITS | pid );
+            }
+            else if ( i % READER_SLOTS == READER_SLOTS - 1 )
+            {
+                if ( i == READER_SLOTS - 1 )
+                    deadline = std::chrono::steady_clock::now() + READ_TIMEOUT;
+                else if ( std::chrono::steady_clock::now() > deadline )
+                    throw std::system_error( ETIMEDOUT, std::generic_category(), "shared_prefix_tree: no free reader slot" );
+
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    ~read_guard()
+    {
+        slot->store( 0, std::memory_order_release );
+    }
+
+    read_guard( const read_guard & ) = delete;
+    read_guard& operator=( const read_guard & ) = delete;
+};
+
+
+} // namespace
+
+
+
+struct shared_prefix_tree::segment : segment_header
+{
+};
+
+
+
+shared_prefix_tree::shared_prefix_tree( const std::string &name, size_t size )
+: seg( nullptr ), mapped( 0 )
+{
+    bool created = true;
+    int  fd      = ::shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600 );
+
+    if ( fd < 0 && errno == EEXIST )
+    {
+        created = false;
+        fd      = ::shm_open( name.c_str(), O_RDWR | O_CLOEXEC, 0 );
+    }
+    if ( fd < 0 )
+        throw std::system_error( errno, std::generic_category(), "shm_open " + name );
+
+    auto deadline = std::chrono::steady_clock::now() + OPEN_TIMEOUT;
+
+    if ( created )
+    {
+        if ( size < sizeof( segment ) + 2 * RESERVE )
+        {
+            ::close( fd );
+            ::shm_unlink( name.c_str() );
+            throw std::invalid_argument( "shared_prefix_tree: segment is too small" );
+        }
+        if ( ::ftruncate( fd, static_cast<off_t>( size ) ) < 0 )
+        {
+            int e = errno;
+            ::close( fd );
+            ::shm_unlink( name.c_str() );
+            throw std::system_error( e, std::generic_category(), "ftruncate " + name );
+        }
+    }
+    else
+    {
+        // Creator may not have set size yet.
+        struct stat st;
+        while ( true )
+        {
+            if ( ::fstat( fd, &st ) < 0 )
+            {
+                int e = errno;
+                ::close( fd );
+                throw std::system_error( e, std::generic_category(), "fstat " + name );
+            }
+            if ( static_cast<size_t>( st.st_size ) >= sizeof( segment ) )
+                break;
+            if ( std::chrono::steady_clock::now() > deadline )
+            {
+                ::close( fd );
+                throw std::system_error( ETIMEDOUT, std::generic_category(), "shared_prefix_tree " + name );
+            }
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+        size = static_cast<size_t>( st.st_size );
+    }
+
+    void *p = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    int   e = errno;
+    ::close( fd );
+    if ( p == MAP_FAILED )
+        throw std::system_error( e, std::generic_category(), "mmap " + name );
+
+    seg    = static_cast<segment*>( p );
+    mapped = size;
+
+    if ( created )
+    {
+        new ( seg ) segment();
+        seg->size  = size;
+        seg->top   = ( sizeof( segment ) + MIN_CHUNK - 1 ) & ~( MIN_CHUNK - 1 );
+        seg->epoch = 1;
+
+        pthread_mutexattr_t attr;
+        ::pthread_mutexattr_init( &attr );
+        ::pthread_mutexattr_setpshared( &attr, PTHREAD_PROCESS_SHARED );
+        ::pthread_mutexattr_setrobust( &attr, PTHREAD_MUTEX_ROBUST );
+        ::pthread_mutex_init( &seg->writer, &attr );
+        ::pthread_mutexattr_destroy( &attr );
+
+        seg->magic.store( SEGMENT_MAGIC, std::memory_order_release );
+        return;
+    }
+
+    while ( seg->magic.load( std::memory_order_acquire ) != SEGMENT_MAGIC )
+    {
+        if ( std::chrono::steady_clock::now() > deadline )
+        {
+            ::munmap( seg, mapped );
+            throw std::system_error( ETIMEDOUT, std::generic_category(), "shared_prefix_tree " + name );
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+}
+
+
+shared_prefix_tree::~shared_prefix_tree()
+{
+    ::munmap( seg, mapped );
+}
+
+
+void shared_prefix_tree::unlink( const std::string &name )
+{
+    if ( ::shm_unlink( name.c_str() ) < 0 && errno != ENOENT )
+        throw std::system_error( errno, std::generic_category(), "shm_unlink " + name );
+}
+
+
+bool shared_prefix_tree::append( const std::string &key, uint64_t value )
+{
+    writer_guard    guard( *seg );
+    node           *cur = &seg->root;
+    size_t          i   = 0;
+
+    for ( ; i < key.size(); ++i )
+    {
+        block *b    = cur->children.load( std::memory_order_relaxed );
+        node  *next = b ? b->find( static_cast<unsigned char>( key[ i ] ) ) : nullptr;
+        if ( !next )
+            break;
+        cur = next;
+    }
+
+    if ( i == key.size() )
+    {
+        cur->value.store( value, std::memory_order_relaxed );
+        if ( cur->flags.load( std::memory_order_relaxed ) & FINITE )
+            return false;
+
+        cur->flags.store( FINITE, std::memory_order_release );
+        seg->keys.fetch_add( 1, std::memory_order_relaxed );
+        return true;
+    }
+
+    // New chain and block are built aside and published by one store.
+    std::vector<std::pair<void*, size_t> >  fresh;
+    std::vector<retired*>                   records;
+    block                                  *old = cur->children.load( std::memory_order_relaxed );
+    block                                  *b;
+
+    try
+    {
+        node *tail = seg->new_node();
+        fresh.emplace_back( tail, segment_header::class_of( sizeof( node ) ) );
+        tail->value.store( value, std::memory_order_relaxed );
+        tail->flags.store( FINITE, std::memory_order_relaxed );
+
+        for ( size_t j = key.size() - 1; j > i; --j )
+        {
+            node *n = seg->new_node();
+            fresh.emplace_back( n, segment_header::class_of( sizeof( node ) ) );
+            block *single = seg->new_block( 1 );
+            fresh.emplace_back( single, single->size_class );
+
+            single->labels()[ 0 ] = static_cast<unsigned char>( key[ j ] );
+            single->nodes()[ 0 ].store( tail, std::memory_order_relaxed );
+            n->children.store( single, std::memory_order_relaxed );
+            tail = n;
+        }
+
+        unsigned char   c     = static_cast<unsigned char>( key[ i ] );
+        size_t          count = old ? old->count : 0;
+        size_t          pos   = old ? simd::lower_bound( old->labels(), count, c ) : 0;
+
+        b = seg->new_block( count + 1 );
+        fresh.emplace_back( b, b->size_class );
+        seg->copy_children( old, b, count, pos );
+        b->labels()[ pos ] = c;
+        b->nodes()[ pos ].store( tail, std::memory_order_relaxed );
+
+        if ( old )
+        {
+            records.push_back( static_cast<retired*>( seg->allocate( segment_header::class_of( sizeof( retired ) ) ) ) );
+        }
+    }
+    catch ( ... )
+    {
+        for ( auto &f : fresh )
+            seg->deallocate( seg->offset_of( f.first ), f.second );
+        throw;
+    }
+
+    cur->children.store( b, std::memory_order_release );
+    seg->keys.fetch_add( 1, std::memory_order_relaxed );
+
+    if ( old )
+        seg->retire( { { old, old->size_class } }, records );
+    seg->reclaim();
+    return true;
+}
+
+
+bool shared_prefix_tree::remove( const std::string &key )
+{
+    writer_guard        guard( *seg );
+    std::vector<node*>  path( 1, &seg->root );
+
+    for ( char c : key )
+    {
+        block *b    = path.back()->children.load( std::memory_order_relaxed );
+        node  *next = b ? b->find( static_cast<unsigned char>( c ) ) : nullptr;
+        if ( !next )
+            return false;
+        path.push_back( next );
+    }
+
+    node *target = path.back();
+    if ( !( target->flags.load( std::memory_order_relaxed ) & FINITE ) )
+        return false;
+
+    if ( path.size() == 1 || target->children.load( std::memory_order_relaxed ) )
+    {
+        target->flags.store( 0, std::memory_order_release );
+        seg->keys.fetch_sub( 1, std::memory_order_relaxed );
+        return true;
+    }
+
+    // Deepest node to keep: root, key or fork, the chain below it is unlinked.
+    size_t keep = path.size() - 2;
+    while ( keep > 0
+        && !( path[ keep ]->flags.load( std::memory_order_relaxed ) & FINITE )
+        && path[ keep ]->children.load( std::memory_order_relaxed )->count == 1 )
+    {
+        --keep;
+    }
+
+    std::vector<std::pair<void*, size_t> > items;
+    block *old = path[ keep ]->children.load( std::memory_order_relaxed );
+    items.emplace_back( old, old->size_class );
+    for ( size_t j = keep + 1; j < path.size(); ++j )
+    {
+        items.emplace_back( path[ j ], segment_header::class_of( sizeof( node ) ) );
+        block *b = path[ j ]->children.load( std::memory_order_relaxed );
+        if ( b )
+            items.emplace_back( b, b->size_class );
+    }
+
+    std::vector<retired*>   records;
+    block                  *b = nullptr;
+
+    try
+    {
+        if ( old->count > 1 )
+        {
+            b = seg->new_block( old->count - 1, true );
+            seg->copy_children( old, b, simd::lower_bound( old->labels(), old->count, static_cast<unsigned char>( key[ keep ] ) ), old->count );
+        }
+        for ( size_t j = 0; j < items.size(); ++j )
+            records.push_back( static_cast<retired*>( seg->allocate( segment_header::class_of( sizeof( retired ) ), true ) ) );
+    }
+    catch ( ... )
+    {
+        for ( retired *r : records )
+            seg->deallocate( seg->offset_of( r ), segment_header::class_of( sizeof( retired ) ) );
+        if ( b )
+            seg->deallocate( seg->offset_of( b ), b->size_class );
+        throw;
+    }
+
+    target->flags.store( 0, std::memory_order_release );
+    path[ keep ]->children.store( b, std::memory_order_release );
+    seg->keys.fetch_sub( 1, std::memory_order_relaxed );
+
+    seg->retire( items, records );
+    seg->reclaim();
+    return true;
+}
+
+
+bool shared_prefix_tree::find( const std::string &key, uint64_t &value ) const
+{
+    read_guard  guard( *seg );
+    node       *cur = &seg->root;
+
+    for ( char c : key )
+    {
+        block *b = cur->children.load();
+        if ( !b || !( cur = b->find( static_cast<unsigned char>( c ) ) ) )
+            return false;
+    }
+
+    if ( !( cur->flags.load( std::memory_order_acquire ) & FINITE ) )
+        return false;
+
+    value = cur->value.load( std::memory_order_relaxed );
+    return true;
+}
+
+
+void shared_prefix_tree::for_each( const std::string &prefix, const std::function<void( const std::string&, uint64_t )> &callback ) const
+{
+    read_guard  guard( *seg );
+    node       *cur = &seg->root;
+
+    for ( char c : prefix )
+    {
+        block *b = cur->children.load();
+        if ( !b || !( cur = b->find( static_cast<unsigned char>( c ) ) ) )
+            return;
+    }
+
+    struct frame
+    {
+        node           *n;
+        size_t          depth;
+        unsigned char   label;
+    };
+
+    // Pre-order walk, key is cut to depth of frame.
+    std::vector<frame>  stack;
+    std::string         key = prefix;
+
+    stack.push_back( { cur, prefix.size(), 0 } );
+    while ( !stack.empty() )
+    {
+        frame f = stack.back();
+        stack.pop_back();
+
+        if ( f.depth > prefix.size() )
+        {
+            key.resize( f.depth - 1 );
+            key.push_back( static_cast<char>( f.label ) );
+        }
+
+        if ( f.n->flags.load( std::memory_order_acquire ) & FINITE )
+            callback( key, f.n->value.load( std::memory_order_relaxed ) );
+
+        block *b = f.n->children.load();
+        for ( size_t i = b ? b->count : 0; i > 0; --i )
+            stack.push_back( { b->nodes()[ i - 1 ].load(), f.depth + 1, b->labels()[ i - 1 ] } );
+    }
+}
+
+
+size_t shared_prefix_tree::size() const
+{
+    return seg->keys.load( std::memory_order_relaxed );
+}
+
+
+size_t shared_prefix_tree::used_bytes() const
+{
+    return seg->used.load( std::memory_order_relaxed );
+}
+
+
+void shared_prefix_tree::reclaim()
+{
+    writer_guard guard( *seg );
+    seg->reclaim();
+}
+
+
+
+} // namespace prefix_tree
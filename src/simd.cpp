@@ -0,0 +1,228 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <atomic>
+
+#include "prefix_tree/simd.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define PREFIX_TREE_X86
+#include <immintrin.h>
+#endif
+
+
+namespace prefix_tree
+{
+
+namespace simd
+{
+
+
+namespace
+{
+
+
+size_t lower_bound_scalar( const unsigned char *labels, size_t n, unsigned char c )
+{
+    size_t lo = 0;
+    size_t hi = n;
+    while ( lo < hi )
+    {
+        size_t mid = ( lo + hi ) / 2;
+        if ( labels[ mid ] < c )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+
+size_t mismatch_scalar( const unsigned char *a, const unsigned char *b, size_t n )
+{
+    size_t i = 0;
+    while ( i < n && a[ i ] == b[ i ] )
+        ++i;
+    return i;
+}
+
+
+#ifdef PREFIX_TREE_X86
+
+// Unsigned bytes are compared as signed after flipping of high bit.
+
+size_t lower_bound_sse2( const unsigned char *labels, size_t n, unsigned char c )
+{
+    const __m128i bias   = _mm_set1_epi8( static_cast<char>( 0x80 ) );
+    const __m128i needle = _mm_set1_epi8( static_cast<char>( c ^ 0x80 ) );
+
+    size_t i = 0;
+    for ( ; i + 16 <= n; i += 16 )
+    {
+        __m128i  v    = _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( labels + i ) ), bias );
+        unsigned less = static_cast<unsigned>( _mm_movemask_epi8( _mm_cmplt_epi8( v, needle ) ) );
+        if ( less != 0xffff )
+            return i + static_cast<size_t>( __builtin_ctz( ~less ) );
+    }
+
+    while ( i < n && labels[ i ] < c )
+        ++i;
+    return i;
+}
+
+
+size_t mismatch_sse2( const unsigned char *a, const unsigned char *b, size_t n )
+{
+    size_t i = 0;
+    for ( ; i + 16 <= n; i += 16 )
+    {
+        __m128i  va    = _mm_loadu_si128( reinterpret_cast<const __m128i*>( a + i ) );
+        __m128i  vb    = _mm_loadu_si128( reinterpret_cast<const __m128i*>( b + i ) );
+        unsigned equal = static_cast<unsigned>( _mm_movemask_epi8( _mm_cmpeq_epi8( va, vb ) ) );
+        if ( equal != 0xffff )
+            return i + static_cast<size_t>( __builtin_ctz( ~equal ) );
+    }
+
+    return i + mismatch_scalar( a + i, b + i, n - i );
+}
+
+
+__attribute__(( target( "avx2" ) ))
+size_t lower_bound_avx2( const unsigned char *labels, size_t n, unsigned char c )
+{
+    const __m256i bias   = _mm256_set1_epi8( static_cast<char>( 0x80 ) );
+    const __m256i needle = _mm256_set1_epi8( static_cast<char>( c ^ 0x80 ) );
+
+    size_t i = 0;
+    for ( ; i + 32 <= n; i += 32 )
+    {
+        __m256i  v    = _mm256_xor_si256( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( labels + i ) ), bias );
+        unsigned less = static_cast<unsigned>( _mm256_movemask_epi8( _mm256_cmpgt_epi8( needle, v ) ) );
+        if ( less != 0xffffffffu )
+            return i + static_cast<size_t>( __builtin_ctz( ~less ) );
+    }
+
+    return i + lower_bound_sse2( labels + i, n - i, c );
+}
+
+
+__attribute__(( target( "avx2" ) ))
+size_t mismatch_avx2( const unsigned char *a, const unsigned char *b, size_t n )
+{
+    size_t i = 0;
+    for ( ; i + 32 <= n; i += 32 )
+    {
+        __m256i  va    = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( a + i ) );
+        __m256i  vb    = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( b + i ) );
+        unsigned equal = static_cast<unsigned>( _mm256_movemask_epi8( _mm256_cmpeq_epi8( va, vb ) ) );
+        if ( equal != 0xffffffffu )
+            return i + static_cast<size_t>( __builtin_ctz( ~equal ) );
+    }
+
+    return i + mismatch_sse2( a + i, b + i, n - i );
+}
+
+#endif // PREFIX_TREE_X86
+
+
+// Pointers are constant initialized to resolvers, so kernels may be used
+// during static initialization. Resolver selects kernel on first call,
+// supported() initializes CPU model itself as it may run before libgcc
+// constructor does.
+
+size_t lower_bound_resolve( const unsigned char *labels, size_t n, unsigned char c );
+size_t mismatch_resolve( const unsigned char *a, const unsigned char *b, size_t n );
+
+std::atomic<lower_bound_fn>     lower_bound_impl( lower_bound_resolve );
+std::atomic<mismatch_fn>        mismatch_impl( mismatch_resolve );
+
+
+size_t lower_bound_resolve( const unsigned char *labels, size_t n, unsigned char c )
+{
+    lower_bound_fn fn = get_kernels( best_level() ).lower_bound;
+    lower_bound_impl.store( fn, std::memory_order_relaxed );
+    return fn( labels, n, c );
+}
+
+
+size_t mismatch_resolve( const unsigned char *a, const unsigned char *b, size_t n )
+{
+    mismatch_fn fn = get_kernels( best_level() ).mismatch;
+    mismatch_impl.store( fn, std::memory_order_relaxed );
+    return fn( a, b, n );
+}
+
+
+} // namespace
+
+
+
+bool supported( level l )
+{
+#ifdef PREFIX_TREE_X86
+    __builtin_cpu_init();
+#endif
+
+    switch ( l )
+    {
+    case level::SCALAR:
+        return true;
+#ifdef PREFIX_TREE_X86
+    case level::SSE2:
+        return __builtin_cpu_supports( "sse2" );
+    case level::AVX2:
+        return __builtin_cpu_supports( "avx2" );
+#endif
+    default:
+        return false;
+    }
+}
+
+
+
+level best_level()
+{
+    if ( supported( level::AVX2 ) )
+        return level::AVX2;
+    if ( supported( level::SSE2 ) )
+        return level::SSE2;
+    return level::SCALAR;
+}
+
+
+
+kernels get_kernels( level l )
+{
+    switch ( l )
+    {
+#ifdef PREFIX_TREE_X86
+    case level::SSE2:
+        return kernels{ lower_bound_sse2, mismatch_sse2 };
+    case level::AVX2:
+        return kernels{ lower_bound_avx2, mismatch_avx2 };
+#endif
+    default:
+        return kernels{ lower_bound_scalar, mismatch_scalar };
+    }
+}
+
+
+
+size_t lower_bound( const unsigned char *labels, size_t n, unsigned char c )
+{
+    return lower_bound_impl.load( std::memory_order_relaxed )( labels, n, c );
+}
+
+
+
+size_t mismatch( const unsigned char *a, const unsigned char *b, size_t n )
+{
+    return mismatch_impl.load( std::memory_order_relaxed )( a, b, n );
+}
+
+
+} // namespace simd
+
+} // namespace prefix_tree
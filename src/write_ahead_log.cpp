@@ -0,0 +1,662 @@
+/**
+ * (c) 2021 Alexander Napylov
+ * BSD 2-clause license.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined( __x86_64__ )
+#include <nmmintrin.h>
+#endif
+
+#include "prefix_tree/write_ahead_log.h"
+
+
+namespace prefix_tree
+{
+
+
+namespace
+{
+
+
+static constexpr size_t     RECORD_HEADER   = 2 * sizeof( uint32_t );
+static constexpr size_t     PAYLOAD_HEADER  = 1 + sizeof( uint32_t );
+static const char           SNAPSHOT_MAGIC[ 8 ] = { 'P', 'T', 'S', 'N', 'A', 'P', '0', '1' };
+static constexpr uint32_t   SNAPSHOT_END    = 0xFFFFFFFFu;
+
+
+[[noreturn]] void throw_errno( const std::string &what )
+{
+    throw std::system_error( errno, std::generic_category(), what );
+}
+
+
+inline void put_u32( std::string &out, uint32_t value )
+{
+    char bytes[ sizeof( value ) ];
+    for ( size_t i = 0; i < sizeof( value ); ++i )
+        bytes[ i ] = static_cast<char>( value >> ( 8 * i ) );
+    out.append( bytes, sizeof( bytes ) );
+}
+
+
+inline uint32_t get_u32( const char *in )
+{
+    uint32_t value = 0;
+    for ( size_t i = 0; i < sizeof( value ); ++i )
+        value |= static_cast<uint32_t>( static_cast<unsigned char>( in[ i ] ) ) << ( 8 * i );
+    return value;
+}
+
+
+inline void put_u64( std::string &out, uint64_t value )
+{
+    put_u32( out, static_cast<uint32_t>( value ) );
+    put_u32( out, static_cast<uint32_t>( value >> 32 ) );
+}
+
+
+inline uint64_t get_u64( const char *in )
+{
+    return get_u32( in ) | static_cast<uint64_t>( get_u32( in + sizeof( uint32_t ) ) ) << 32;
+}
+
+
+std::array<uint32_t, 256> make_crc_table()
+{
+    std::array<uint32_t, 256> table;
+    for ( uint32_t i = 0; i < 256; ++i )
+    {
+        uint32_t crc = i;
+        for ( int bit = 0; bit < 8; ++bit )
+            crc = ( crc >> 1 ) ^ ( ( crc & 1 ) ? 0x82F63B78u : 0 );
+        table[ i ] = crc;
+    }
+    return table;
+}
+
+
+uint32_t crc32c_scalar( const unsigned char *data, size_t size, uint32_t crc )
+{
+    static const std::array<uint32_t, 256> table = make_crc_table();
+
+    for ( size_t i = 0; i < size; ++i )
+        crc = table[ ( crc ^ data[ i ] ) & 0xFF ] ^ ( crc >> 8 );
+    return crc;
+}
+
+
+#if defined( __x86_64__ )
+
+__attribute__(( target( "sse4.2" ) ))
+uint32_t crc32c_sse42( const unsigned char *data, size_t size, uint32_t crc )
+{
+    uint64_t crc64 = crc;
+    for ( ; size >= sizeof( uint64_t ); size -= sizeof( uint64_t ), data += sizeof( uint64_t ) )
+    {
+        uint64_t word;
+        std::memcpy( &word, data, sizeof( word ) );
+        crc64 = _mm_crc32_u64( crc64, word );
+    }
+
+    crc = static_cast<uint32_t>( crc64 );
+    for ( ; size; --size, ++data )
+        crc = _mm_crc32_u8( crc, *data );
+    return crc;
+}
+
+#endif
+
+
+/**
+ * @brief The file class    FILE guard for snapshots.
+ */
+class file
+{
+private:
+    std::FILE      *handle;
+
+public:
+    file( const std::string &path, const char *mode ) : handle( std::fopen( path.c_str(), mode ) ) {}
+    ~file()
+    {
+        if ( handle )
+            std::fclose( handle );
+    }
+
+    file( const file & ) = delete;
+    file& operator=( const file & ) = delete;
+
+    inline std::FILE* get() { return handle; }
+
+    inline bool read( char *to, size_t size )
+    {
+        return std::fread( to, 1, size, handle ) == size;
+    }
+
+    inline void write( const std::string &data, const std::string &path )
+    {
+        if ( std::fwrite( data.data(), 1, data.size(), handle ) != data.size() )
+            throw_errno( "write " + path );
+    }
+};
+
+
+/**
+ * @brief read_snapshot     Read records of snapshot.
+ * @param path              Path of file.
+ * @param callback          Called for every record if not null.
+ * @return                  false if file is not complete or corrupted.
+ */
+bool read_snapshot( const std::string &path, const std::function<void( const log_record& )> *callback )
+{
+    file in( path, "rb" );
+    if ( !in.get() )
+        return false;
+
+    char header[ sizeof( SNAPSHOT_MAGIC ) ];
+    if ( !in.read( header, sizeof( header ) ) || std::memcmp( header, SNAPSHOT_MAGIC, sizeof( header ) ) )
+        return false;
+
+    uint32_t    crc   = crc32c( header, sizeof( header ) );
+    uint64_t    count = 0;
+    log_record  record;
+    record.op = log_op::APPEND;
+
+    for ( ;; )
+    {
+        char sizes[ 2 * sizeof( uint32_t ) ];
+        if ( !in.read( sizes, sizeof( uint32_t ) ) )
+            return false;
+
+        if ( get_u32( sizes ) == SNAPSHOT_END )
+        {
+            crc = crc32c( sizes, sizeof( uint32_t ), crc );
+
+            char trailer[ sizeof( uint64_t ) + sizeof( uint32_t ) ];
+            if ( !in.read( trailer, sizeof( trailer ) ) )
+                return false;
+
+            crc = crc32c( trailer, sizeof( uint64_t ), crc );
+            return get_u64( trailer ) == count && get_u32( trailer + sizeof( uint64_t ) ) == crc;
+        }
+
+        if ( !in.read( sizes + sizeof( uint32_t ), sizeof( uint32_t ) ) )
+            return false;
+
+        record.key.resize( get_u32( sizes ) );
+        record.value.resize( get_u32( sizes + sizeof( uint32_t ) ) );
+        if ( !in.read( &record.key[ 0 ], record.key.size() ) || !in.read( &record.value[ 0 ], record.value.size() ) )
+            return false;
+
+        crc = crc32c( sizes, sizeof( sizes ), crc );
+        crc = crc32c( record.key.data(), record.key.size(), crc );
+        crc = crc32c( record.value.data(), record.value.size(), crc );
+        ++count;
+
+        if ( callback )
+            ( *callback )( record );
+    }
+}
+
+
+/**
+ * @brief parse_name    Parse "<kind>-<seq>" file name.
+ * @return              false if name is not of the kind.
+ */
+bool parse_name( const std::string &name, const char *kind, uint64_t &seq )
+{
+    size_t prefix = std::strlen( kind );
+    if ( name.size() <= prefix + 1 || name.compare( 0, prefix, kind ) || name[ prefix ] != '-' )
+        return false;
+
+    seq = 0;
+    for ( size_t i = prefix + 1; i < name.size(); ++i )
+    {
+        if ( name[ i ] < '0' || name[ i ] > '9' )
+            return false;
+        seq = seq * 10 + static_cast<uint64_t>( name[ i ] - '0' );
+    }
+    return true;
+}
+
+
+} // namespace
+
+
+
+uint32_t crc32c( const void *data, size_t size, uint32_t crc )
+{
+#if defined( __x86_64__ )
+    static const bool hardware = __builtin_cpu_supports( "sse4.2" );
+    if ( hardware )
+        return ~crc32c_sse42( static_cast<const unsigned char*>( data ), size, ~crc );
+#endif
+    return ~crc32c_scalar( static_cast<const unsigned char*>( data ), size, ~crc );
+}
+
+
+
+write_ahead_log::write_ahead_log()
+: fd( -1 ), lock(), synced(), buffer(), appended_lsn( 0 ), durable_lsn( 0 ), syncing( false ), pending_records( 0 )
+{
+}
+
+
+write_ahead_log::~write_ahead_log()
+{
+    try
+    {
+        close();
+    }
+    catch ( ... )
+    {
+    }
+}
+
+
+void write_ahead_log::open( const std::string &path )
+{
+    close();
+
+    fd = ::open( path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644 );
+    if ( fd < 0 )
+        throw_errno( "open " + path );
+}
+
+
+void write_ahead_log::close()
+{
+    if ( fd < 0 )
+        return;
+
+    sync();
+    ::close( fd );
+    fd = -1;
+}
+
+
+void write_ahead_log::rotate( const std::string &path )
+{
+    int next = ::open( path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644 );
+    if ( next < 0 )
+        throw_errno( "open " + path );
+
+    std::unique_lock<std::mutex> guard( lock );
+    synced.wait( guard, [this] () { return !syncing; } );
+
+    // Committers wait while lock is held, sync is not grouped here.
+    write_buffer();
+    if ( ::fdatasync( fd ) )
+    {
+        int error = errno;
+        ::close( next );
+        errno = error;
+        throw_errno( "fdatasync" );
+    }
+
+    ::close( fd );
+    fd = next;
+
+    pending_records.fetch_sub( appended_lsn - durable_lsn, std::memory_order_relaxed );
+    durable_lsn = appended_lsn;
+    synced.notify_all();
+}
+
+
+uint64_t write_ahead_log::append( log_op op, const char *key, size_t key_size, const char *value, size_t value_size )
+{
+    std::lock_guard<std::mutex> guard( lock );
+
+    size_t start = buffer.size();
+    put_u32( buffer, static_cast<uint32_t>( PAYLOAD_HEADER + key_size + value_size ) );
+    put_u32( buffer, 0 );
+
+    buffer.push_back( static_cast<char>( op ) );
+    put_u32( buffer, static_cast<uint32_t>( key_size ) );
+    buffer.append( key, key_size );
+    buffer.append( value, value_size );
+
+    uint32_t crc = crc32c( buffer.data() + start + RECORD_HEADER, buffer.size() - start - RECORD_HEADER );
+    for ( size_t i = 0; i < sizeof( crc ); ++i )
+        buffer[ start + sizeof( uint32_t ) + i ] = static_cast<char>( crc >> ( 8 * i ) );
+
+    // Record leaves process before it is acknowledged, fdatasync() is left
+    // to group commit.
+    write_buffer();
+
+    pending_records.fetch_add( 1, std::memory_order_relaxed );
+    return ++appended_lsn;
+}
+
+
+void write_ahead_log::commit( uint64_t lsn )
+{
+    std::unique_lock<std::mutex> guard( lock );
+
+    while ( durable_lsn < lsn )
+    {
+        if ( syncing )
+        {
+            synced.wait( guard );
+            continue;
+        }
+
+        // Leader: write records of all threads and sync them at once.
+        write_buffer();
+
+        uint64_t target = appended_lsn;
+        syncing = true;
+        guard.unlock();
+
+        int result = ::fdatasync( fd );
+        int error  = errno;
+
+        guard.lock();
+        syncing = false;
+        if ( result )
+        {
+            synced.notify_all();
+            errno = error;
+            throw_errno( "fdatasync" );
+        }
+
+        pending_records.fetch_sub( target - durable_lsn, std::memory_order_relaxed );
+        durable_lsn = target;
+        synced.notify_all();
+    }
+}
+
+
+void write_ahead_log::sync()
+{
+    uint64_t lsn;
+    {
+        std::lock_guard<std::mutex> guard( lock );
+        lsn = appended_lsn;
+    }
+    commit( lsn );
+}
+
+
+void write_ahead_log::write_buffer()
+{
+    for ( size_t written = 0; written < buffer.size(); )
+    {
+        ssize_t result = ::write( fd, buffer.data() + written, buffer.size() - written );
+        if ( result < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            throw_errno( "write log" );
+        }
+        written += static_cast<size_t>( result );
+    }
+    buffer.clear();
+}
+
+
+size_t write_ahead_log::replay( const std::string &path, const std::function<void( const log_record& )> &callback )
+{
+    std::string data;
+    {
+        file in( path, "rb" );
+        if ( !in.get() )
+            return 0;
+
+        char chunk[ 1 << 16 ];
+        for ( size_t n; ( n = std::fread( chunk, 1, sizeof( chunk ), in.get() ) ) > 0; )
+            data.append( chunk, n );
+    }
+
+    size_t      count = 0;
+    size_t      pos   = 0;
+    log_record  record;
+
+    while ( data.size() - pos >= RECORD_HEADER )
+    {
+        uint32_t size = get_u32( data.data() + pos );
+        uint32_t crc  = get_u32( data.data() + pos + sizeof( uint32_t ) );
+
+        if ( size < PAYLOAD_HEADER || size > data.size() - pos - RECORD_HEADER )
+            break;
+
+        const char *payload = data.data() + pos + RECORD_HEADER;
+        if ( crc32c( payload, size ) != crc )
+            break;
+
+        uint32_t key_size = get_u32( payload + 1 );
+        if ( key_size > size - PAYLOAD_HEADER )
+            break;
+
+        record.op = static_cast<log_op>( payload[ 0 ] );
+        record.key.assign( payload + PAYLOAD_HEADER, key_size );
+        record.value.assign( payload + PAYLOAD_HEADER + key_size, size - PAYLOAD_HEADER - key_size );
+
+        callback( record );
+        ++count;
+        pos += RECORD_HEADER + size;
+    }
+
+    // Torn tail is left by crash, cut it so new records are not lost after it.
+    if ( pos < data.size() && ::truncate( path.c_str(), static_cast<off_t>( pos ) ) )
+        throw_errno( "truncate " + path );
+
+    return count;
+}
+
+
+
+durable_storage::durable_storage( const std::string &directory_, const options &opts_ )
+: directory( directory_ ), opts( opts_ ), log(), sequence( 0 ), records_since_snapshot( 0 )
+{
+    std::error_code error;
+    std::filesystem::create_directories( directory, error );
+    if ( error )
+        throw std::system_error( error, "create " + directory );
+}
+
+
+durable_storage::recovery_info durable_storage::recover( const std::function<void( const log_record& )> &apply )
+{
+    recovery_info info = { 0, 0, 0, 0 };
+
+    std::vector<uint64_t>   snapshots;
+    std::vector<uint64_t>   logs;
+    uint64_t                last = 0;
+
+    for ( const auto &entry : std::filesystem::directory_iterator( directory ) )
+    {
+        std::string name = entry.path().filename().string();
+        uint64_t    seq;
+
+        if ( parse_name( name, "snapshot", seq ) )
+            snapshots.push_back( seq );
+        else if ( parse_name( name, "log", seq ) )
+            logs.push_back( seq );
+        else
+            continue;
+
+        last = std::max( last, seq );
+    }
+
+    std::sort( snapshots.rbegin(), snapshots.rend() );
+    std::sort( logs.begin(), logs.end() );
+
+    // Last complete snapshot, it is verified before any record is applied.
+    for ( uint64_t seq : snapshots )
+    {
+        if ( read_snapshot( file_path( "snapshot", seq ), nullptr ) )
+        {
+            info.snapshot_sequence = seq;
+            break;
+        }
+    }
+
+    if ( info.snapshot_sequence )
+    {
+        std::function<void( const log_record& )> load =
+                [&] ( const log_record &record )
+                {
+                    apply( record );
+                    ++info.snapshot_records;
+                };
+
+        read_snapshot( file_path( "snapshot", info.snapshot_sequence ), &load );
+    }
+
+    for ( uint64_t seq : logs )
+    {
+        if ( seq < info.snapshot_sequence )
+            continue;
+
+        info.log_records += write_ahead_log::replay( file_path( "log", seq ), apply );
+        ++info.logs;
+    }
+
+    sequence = last + 1;
+    log.open( file_path( "log", sequence ) );
+    sync_directory();
+
+    records_since_snapshot.store( info.log_records, std::memory_order_relaxed );
+    remove_obsolete( info.snapshot_sequence );
+
+    return info;
+}
+
+
+uint64_t durable_storage::append( log_op op, const char *key, size_t key_size, const char *value, size_t value_size )
+{
+    records_since_snapshot.fetch_add( 1, std::memory_order_relaxed );
+    return log.append( op, key, key_size, value, value_size );
+}
+
+
+void durable_storage::commit_if_needed( uint64_t lsn )
+{
+    if ( opts.sync_every_operation || log.pending() >= opts.group_commit_records )
+        log.commit( lsn );
+}
+
+
+void durable_storage::snapshot( const std::function<bool( log_record& )> &next )
+{
+    uint64_t seq = sequence + 1;
+
+    // New records go to new log, the snapshot covers all older logs.
+    log.rotate( file_path( "log", seq ) );
+    sequence = seq;
+    sync_directory();
+    failpoint( "snapshot.rotated" );
+
+    std::string path = file_path( "snapshot", seq );
+    std::string temp = path + ".tmp";
+    {
+        file out( temp, "wb" );
+        if ( !out.get() )
+            throw_errno( "open " + temp );
+
+        std::string chunk( SNAPSHOT_MAGIC, sizeof( SNAPSHOT_MAGIC ) );
+        uint32_t    crc   = 0;
+        uint64_t    count = 0;
+        log_record  record;
+
+        while ( next( record ) )
+        {
+            put_u32( chunk, static_cast<uint32_t>( record.key.size() ) );
+            put_u32( chunk, static_cast<uint32_t>( record.value.size() ) );
+            chunk += record.key;
+            chunk += record.value;
+            ++count;
+
+            if ( chunk.size() >= ( 1 << 20 ) )
+            {
+                crc = crc32c( chunk.data(), chunk.size(), crc );
+                out.write( chunk, temp );
+                chunk.clear();
+            }
+        }
+
+        put_u32( chunk, SNAPSHOT_END );
+        put_u64( chunk, count );
+        crc = crc32c( chunk.data(), chunk.size(), crc );
+        put_u32( chunk, crc );
+        out.write( chunk, temp );
+
+        if ( std::fflush( out.get() ) || ::fsync( fileno( out.get() ) ) )
+            throw_errno( "sync " + temp );
+    }
+    failpoint( "snapshot.written" );
+
+    if ( std::rename( temp.c_str(), path.c_str() ) )
+        throw_errno( "rename " + temp );
+    sync_directory();
+    failpoint( "snapshot.renamed" );
+
+    records_since_snapshot.store( 0, std::memory_order_relaxed );
+    remove_obsolete( seq );
+}
+
+
+std::string durable_storage::file_path( const char *kind, uint64_t seq ) const
+{
+    char name[ 64 ];
+    std::snprintf( name, sizeof( name ), "%s-%020llu", kind, static_cast<unsigned long long>( seq ) );
+    return ( std::filesystem::path( directory ) / name ).string();
+}
+
+
+void durable_storage::sync_directory() const
+{
+    int dir = ::open( directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+    if ( dir < 0 )
+        throw_errno( "open " + directory );
+
+    int result = ::fsync( dir );
+    ::close( dir );
+
+    if ( result )
+        throw_errno( "fsync " + directory );
+}
+
+
+void durable_storage::remove_obsolete( uint64_t seq ) const
+{
+    std::vector<std::filesystem::path> obsolete;
+
+    for ( const auto &entry : std::filesystem::directory_iterator( directory ) )
+    {
+        std::string name = entry.path().filename().string();
+        uint64_t    file_seq;
+
+        bool remove =
+                ( name.size() > 4 && !name.compare( name.size() - 4, 4, ".tmp" ) )     ||
+                ( parse_name( name, "snapshot", file_seq ) && file_seq != seq )         ||
+                ( parse_name( name, "log", file_seq ) && file_seq < seq )
+        ;
+
+        if ( remove )
+            obsolete.push_back( entry.path() );
+    }
+
+    for ( const auto &path : obsolete )
+    {
+        std::error_code error;
+        std::filesystem::remove( path, error );
+    }
+}
+
+
+
+} // namespace prefix_tree
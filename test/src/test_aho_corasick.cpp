@@ -0,0 +1,115 @@
+#include "test_aho_corasick.h"
+#include "prefix_tree/aho_corasick.h"
+
+
+
+void test_aho_corasick::SetUp()
+{
+    tree.reset( new prefix_tree::prefix_tree() );
+}
+
+
+void test_aho_corasick::TearDown()
+{
+    tree.reset();
+}
+
+
+std::vector<std::string> test_aho_corasick::scan(
+        const prefix_tree::aho_corasick &ac,
+        const std::string &text,
+        size_t chunk_size
+)
+{
+    std::vector<std::string> result;
+    prefix_tree::aho_corasick::stream s;
+
+    for ( size_t pos = 0; pos < text.size(); pos += chunk_size )
+    {
+        ac.scan(
+                    s,
+                    text.data() + pos,
+                    std::min( chunk_size, text.size() - pos ),
+                    [&] ( const prefix_tree::aho_corasick::match &m )
+                    {
+                        result.push_back( std::to_string( m.end ) + ":" + ac.get_pattern( m.pattern ) );
+                    }
+        );
+    }
+
+    return result;
+}
+
+
+TEST_F( test_aho_corasick, test_scan )
+{
+    ASSERT_TRUE( tree->append( "he" ) );
+    ASSERT_TRUE( tree->append( "she" ) );
+    ASSERT_TRUE( tree->append( "his" ) );
+    ASSERT_TRUE( tree->append( "hers" ) );
+
+    prefix_tree::aho_corasick ac( *tree );
+    ASSERT_EQ( ac.patterns_count(), 4 );
+
+    std::vector<std::string> expected = { "4:she", "4:he", "6:hers" };
+    ASSERT_EQ( scan( ac, "ushers", 6 ), expected );
+}
+
+
+TEST_F( test_aho_corasick, test_stream_chunks )
+{
+    static const std::string TEXT = "abcabcdxbcdabcd";
+
+    ASSERT_TRUE( tree->append( "abcd" ) );
+    ASSERT_TRUE( tree->append( "bcd" ) );
+    ASSERT_TRUE( tree->append( "c" ) );
+    ASSERT_TRUE( tree->append( "xbcda" ) );
+
+    prefix_tree::aho_corasick ac( *tree );
+
+    std::vector<std::string> whole = scan( ac, TEXT, TEXT.size() );
+    std::vector<std::string> expected = {
+        "3:c", "6:c", "7:abcd", "7:bcd", "10:c", "11:bcd", "12:xbcda", "14:c", "15:abcd", "15:bcd"
+    };
+    ASSERT_EQ( whole, expected );
+
+    for ( size_t chunk = 1; chunk < TEXT.size(); ++chunk )
+        ASSERT_EQ( scan( ac, TEXT, chunk ), expected );
+}
+
+
+TEST_F( test_aho_corasick, test_binary_symbols )
+{
+    static const std::string KEY  = "\x80\xff";
+    static const std::string KEY1 = "a\xfe";
+
+    ASSERT_TRUE( tree->append( KEY ) );
+    ASSERT_TRUE( tree->append( KEY1 ) );
+
+    prefix_tree::aho_corasick ac( *tree );
+
+    std::vector<std::string> expected = { "3:" + KEY, "6:" + KEY1 };
+    ASSERT_EQ( scan( ac, "x" + KEY + "z" + KEY1, 2 ), expected );
+}
+
+
+TEST_F( test_aho_corasick, test_map )
+{
+    prefix_tree::prefix_tree_map<int> map;
+    ASSERT_TRUE( map.append( "error", 1 ) );
+    ASSERT_TRUE( map.append( "warn", 2 ) );
+
+    prefix_tree::aho_corasick ac( map );
+
+    std::vector<int> values;
+    ac.scan(
+                std::string( "[warn] disk error" ),
+                [&] ( const prefix_tree::aho_corasick::match &m )
+                {
+                    values.push_back( map.find( ac.get_pattern( m.pattern ) ).get_value() );
+                }
+    );
+
+    std::vector<int> expected = { 2, 1 };
+    ASSERT_EQ( values, expected );
+}
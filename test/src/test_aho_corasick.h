@@ -0,0 +1,28 @@
+#ifndef TEST_AHO_CORASICK_H
+#define TEST_AHO_CORASICK_H
+
+#include <gtest/gtest.h>
+#include "prefix_tree/aho_corasick.h"
+
+class test_aho_corasick : public testing::Test
+{
+public:
+    std::unique_ptr<prefix_tree::prefix_tree>   tree;
+
+public:
+    test_aho_corasick() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+    /**
+     * @brief scan      Scan text by chunks and collect matches as "<end>:<pattern>".
+     */
+    std::vector<std::string> scan(
+            const prefix_tree::aho_corasick &ac,
+            const std::string &text,
+            size_t chunk_size
+    );
+};
+
+#endif // TEST_AHO_CORASICK_H
@@ -0,0 +1,133 @@
+#include <random>
+
+#include "test_coded_prefix_tree.h"
+
+
+
+void test_coded_prefix_tree::SetUp()
+{
+    std::mt19937_64 rnd( 42 );
+    const char      alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789-";
+
+    for ( size_t i = 0; i < 3000; ++i )
+    {
+        std::string name;
+        for ( size_t labels = 1 + rnd() % 3; labels; --labels )
+        {
+            for ( size_t n = 1 + rnd() % 6; n; --n )
+                name.push_back( alphabet[ rnd() % ( sizeof( alphabet ) - 1 ) ] );
+            name.push_back( '.' );
+        }
+        name += i % 2 ? "com" : "org";
+        keys.push_back( name );
+    }
+
+    // Bytes out of alphabet: escaped by alphabet_codec.
+    for ( size_t i = 0; i < 300; ++i )
+    {
+        std::string key( 1 + rnd() % 8, ' ' );
+        for ( auto &c : key )
+            c = static_cast<char>( 1 + rnd() % 255 );
+        keys.push_back( key );
+    }
+}
+
+
+void test_coded_prefix_tree::TearDown()
+{
+    keys.clear();
+}
+
+
+template <typename tree_t>
+void test_coded_prefix_tree::check( tree_t &tree )
+{
+    std::set<std::string> model;
+    for ( const auto &key : keys )
+    {
+        EXPECT_TRUE( tree.append( key ) );
+        model.insert( key );
+    }
+
+    std::vector<std::string> visited;
+    for ( auto it = tree.begin(); it != tree.end(); ++it )
+        visited.push_back( it.get_key() );
+    EXPECT_EQ( visited, std::vector<std::string>( model.begin(), model.end() ) );
+
+    EXPECT_TRUE( tree.exists( keys[ 0 ] ) );
+    EXPECT_TRUE( tree.exists( keys[ 0 ].substr( 0, 1 ), false ) );
+    EXPECT_FALSE( tree.exists( keys[ 0 ] + "\x01" ) );
+    EXPECT_EQ( tree.find( keys[ 1 ] ).get_key(), keys[ 1 ] );
+
+    // Ranges of codes are ranges of keys.
+    for ( const char *from : { "a", "m.", "zz", "\x80" } )
+    {
+        auto it = tree.lower_bound( from );
+        auto expected = model.lower_bound( from );
+        if ( expected == model.end() )
+            EXPECT_EQ( it, tree.end() );
+        else
+            EXPECT_EQ( it.get_key(), *expected ) << from;
+    }
+
+    size_t count = 0;
+    auto r = tree.range( "b", "d" );
+    for ( auto it = r.first; it != r.second; ++it )
+        ++count;
+    EXPECT_EQ( count, std::distance( model.lower_bound( "b" ), model.lower_bound( "d" ) ) );
+
+    tree.remove_prefix( "c" );
+    model.erase( model.lower_bound( "c" ), model.lower_bound( "d" ) );
+    for ( size_t i = 0; i < keys.size(); i += 3 )
+    {
+        tree.remove( keys[ i ] );
+        model.erase( keys[ i ] );
+    }
+
+    visited.clear();
+    for ( auto it = tree.begin(); it != tree.end(); ++it )
+        visited.push_back( it.get_key() );
+    EXPECT_EQ( visited, std::vector<std::string>( model.begin(), model.end() ) );
+}
+
+
+
+TEST_F( test_coded_prefix_tree, test_nibble )
+{
+    prefix_tree::nibble_prefix_tree tree;
+    check( tree );
+}
+
+
+TEST_F( test_coded_prefix_tree, test_alphabet )
+{
+    prefix_tree::alphabet_codec codec = prefix_tree::alphabet_codec::from_keys( keys.begin(), keys.begin() + 3000 );
+    EXPECT_EQ( codec.alphabet_size(), 38 );
+
+    prefix_tree::alphabet_prefix_tree tree( codec );
+    check( tree );
+
+    std::string too_many;
+    for ( int c = 1; c <= 128; ++c )
+        too_many.push_back( static_cast<char>( c ) );
+    EXPECT_THROW( prefix_tree::alphabet_codec codec( too_many ), std::invalid_argument );
+    EXPECT_EQ( prefix_tree::alphabet_codec( "abca" ).alphabet_size(), 3 );
+}
+
+
+TEST_F( test_coded_prefix_tree, test_append_sorted )
+{
+    std::set<std::string> sorted( keys.begin(), keys.end() );
+
+    prefix_tree::nibble_prefix_tree     nibble;
+    prefix_tree::alphabet_prefix_tree   alphabet( prefix_tree::alphabet_codec( "abcdefghijklmnopqrstuvwxyz." ) );
+
+    EXPECT_EQ( nibble.append_sorted( sorted.begin(), sorted.end() ), sorted.size() );
+    EXPECT_EQ( alphabet.append_sorted( sorted.begin(), sorted.end() ), sorted.size() );
+
+    for ( const auto &key : keys )
+    {
+        EXPECT_TRUE( nibble.exists( key ) );
+        EXPECT_TRUE( alphabet.exists( key ) );
+    }
+}
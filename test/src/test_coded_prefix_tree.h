@@ -0,0 +1,29 @@
+#ifndef TEST_CODED_PREFIX_TREE_H
+#define TEST_CODED_PREFIX_TREE_H
+
+#include <set>
+
+#include <gtest/gtest.h>
+#include "prefix_tree/coded_prefix_tree.h"
+
+class test_coded_prefix_tree : public testing::Test
+{
+public:
+    /// @brief keys     DNS like names and some keys of other bytes.
+    std::vector<std::string>    keys;
+
+public:
+    test_coded_prefix_tree() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+    /**
+     * @brief check     Compare keys, order, ranges and removal of tree
+     *                  with std::set.
+     */
+    template <typename tree_t>
+    void check( tree_t &tree );
+};
+
+#endif // TEST_CODED_PREFIX_TREE_H
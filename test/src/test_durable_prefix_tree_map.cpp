@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test_durable_prefix_tree_map.h"
+
+
+namespace
+{
+
+
+/**
+ * @brief make_op   Operation number i: every fifth one removes key.
+ */
+bool make_op( size_t i, std::string &key, std::string &value )
+{
+    uint64_t h = ( i + 1 ) * 0x9E3779B97F4A7C15ull;
+    key   = "key/" + std::to_string( ( h >> 20 ) % 300 );
+    value = std::string( 1 + ( h >> 40 ) % 40, static_cast<char>( 'a' + i % 26 ) );
+    return i % 5 == 4;
+}
+
+
+} // namespace
+
+
+
+void test_durable_prefix_tree_map::SetUp()
+{
+    char name[] = "/tmp/test_durable_XXXXXX";
+    ASSERT_NE( mkdtemp( name ), nullptr );
+    directory = name;
+}
+
+
+void test_durable_prefix_tree_map::TearDown()
+{
+    std::filesystem::remove_all( directory );
+}
+
+
+test_durable_prefix_tree_map::model_type test_durable_prefix_tree_map::dump( const map_type &m )
+{
+    model_type result;
+    m.for_each( [&] ( const std::string &key, const std::string &value ) { result[ key ] = value; } );
+    return result;
+}
+
+
+void test_durable_prefix_tree_map::apply( map_type &m, size_t i )
+{
+    std::string key, value;
+    if ( make_op( i, key, value ) )
+        m.remove( key );
+    else
+        m.append( key, value );
+}
+
+
+void test_durable_prefix_tree_map::apply( model_type &m, size_t i )
+{
+    std::string key, value;
+    if ( make_op( i, key, value ) )
+        m.erase( key );
+    else
+        m[ key ] = value;
+}
+
+
+std::vector<std::string> test_durable_prefix_tree_map::files() const
+{
+    std::vector<std::string> result;
+    for ( const auto &entry : std::filesystem::directory_iterator( directory ) )
+        result.push_back( entry.path().filename().string() );
+    std::sort( result.begin(), result.end() );
+    return result;
+}
+
+
+void test_durable_prefix_tree_map::crash( map_type::options opts, const char *crash_at, size_t hit, size_t ops )
+{
+    std::filesystem::remove_all( directory );
+
+    int channel[ 2 ];
+    ASSERT_EQ( pipe( channel ), 0 );
+
+    pid_t child = fork();
+    ASSERT_GE( child, 0 );
+
+    if ( !child )
+    {
+        close( channel[ 0 ] );
+
+        size_t hits = 0;
+        if ( crash_at )
+            opts.failpoint = [&] ( const char *name ) { if ( !std::strcmp( name, crash_at ) && ++hits == hit ) _exit( 0 ); };
+
+        map_type m( directory, opts );
+        for ( size_t i = 0; i < ops; ++i )
+        {
+            apply( m, i );
+            if ( i % 37 == 36 )
+            {
+                m.flush();
+                size_t done = i + 1;
+                if ( write( channel[ 1 ], &done, sizeof( done ) ) != sizeof( done ) )
+                    _exit( 1 );
+            }
+        }
+        // Crash without destructors, records after last flush may be lost.
+        _exit( 0 );
+    }
+
+    close( channel[ 1 ] );
+
+    size_t flushed = 0, done;
+    while ( read( channel[ 0 ], &done, sizeof( done ) ) == sizeof( done ) )
+        flushed = done;
+    close( channel[ 0 ] );
+
+    int status;
+    ASSERT_EQ( waitpid( child, &status, 0 ), child );
+    ASSERT_TRUE( WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+
+    map_type m( directory, opts );
+    model_type recovered = dump( m );
+
+    // Recovered state is state after some count of operations not below flushed.
+    model_type model;
+    size_t i = 0;
+    for ( ; i < flushed; ++i )
+        apply( model, i );
+    for ( ; model != recovered && i < ops; ++i )
+        apply( model, i );
+
+    ASSERT_EQ( model, recovered ) << crash_at << " " << hit;
+
+    // Recovered map keeps working.
+    m.append( "after/crash", "1" );
+    m.flush();
+}
+
+
+
+TEST_F( test_durable_prefix_tree_map, test_reopen )
+{
+    model_type model;
+    size_t     logged = 0;
+    {
+        map_type m( directory );
+        ASSERT_EQ( m.recovery().snapshot_sequence, 0 );
+        ASSERT_EQ( m.recovery().log_records, 0 );
+
+        // Remove of absent key is not logged.
+        for ( size_t i = 0; i < 1000; ++i )
+        {
+            size_t before = model.size();
+            apply( m, i );
+            apply( model, i );
+            logged += i % 5 != 4 || model.size() != before;
+        }
+
+        ASSERT_TRUE( m.append( "abc", "1" ) );
+        ASSERT_FALSE( m.append( "abc", "2" ) );
+        ASSERT_TRUE( m.remove( "abc" ) );
+        ASSERT_FALSE( m.remove( "abc" ) );
+        ASSERT_EQ( dump( m ), model );
+    }
+    {
+        map_type m( directory );
+        ASSERT_EQ( m.recovery().snapshot_sequence, 0 );
+        ASSERT_EQ( m.recovery().log_records, logged + 3 );
+        ASSERT_EQ( dump( m ), model );
+
+        std::string value;
+        ASSERT_FALSE( m.find( "abc", value ) );
+        ASSERT_TRUE( m.find( model.begin()->first, value ) );
+        ASSERT_EQ( value, model.begin()->second );
+        ASSERT_TRUE( m.exists( model.begin()->first ) );
+    }
+    {
+        map_type m( directory );
+        ASSERT_EQ( m.recovery().logs, 2 );
+        ASSERT_EQ( dump( m ), model );
+    }
+}
+
+
+TEST_F( test_durable_prefix_tree_map, test_kill_after_append )
+{
+    // Default options: no sync, no flush() before kill.
+    pid_t child = fork();
+    ASSERT_GE( child, 0 );
+
+    if ( !child )
+    {
+        map_type m( directory );
+        for ( size_t i = 0; i < 100; ++i )
+            if ( !m.append( "key/" + std::to_string( i ), std::to_string( i ) ) )
+                _exit( 1 );
+        _exit( 0 );
+    }
+
+    int status;
+    ASSERT_EQ( waitpid( child, &status, 0 ), child );
+    ASSERT_TRUE( WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+
+    // Acknowledged writes survive kill of process.
+    map_type m( directory );
+    ASSERT_EQ( m.recovery().log_records, 100 );
+    for ( size_t i = 0; i < 100; ++i )
+    {
+        std::string value;
+        ASSERT_TRUE( m.find( "key/" + std::to_string( i ), value ) );
+        ASSERT_EQ( value, std::to_string( i ) );
+    }
+}
+
+
+TEST_F( test_durable_prefix_tree_map, test_snapshot )
+{
+    map_type::options opts;
+    opts.snapshot_records = 100;
+
+    model_type model;
+    {
+        map_type m( directory, opts );
+        for ( size_t i = 0; i < 1050; ++i )
+        {
+            apply( m, i );
+            apply( model, i );
+        }
+    }
+
+    std::vector<std::string> names = files();
+    ASSERT_EQ( std::count_if( names.begin(), names.end(), [] ( const std::string &n ) { return !n.compare( 0, 8, "snapshot" ); } ), 1 );
+
+    {
+        map_type m( directory, opts );
+        ASSERT_GT( m.recovery().snapshot_sequence, 0 );
+        ASSERT_GT( m.recovery().snapshot_records, 0 );
+        ASSERT_LT( m.recovery().log_records, 100 );
+        ASSERT_EQ( dump( m ), model );
+
+        m.snapshot();
+    }
+    {
+        map_type m( directory, opts );
+        ASSERT_EQ( m.recovery().snapshot_records, model.size() );
+        ASSERT_EQ( m.recovery().log_records, 0 );
+        ASSERT_EQ( dump( m ), model );
+    }
+}
+
+
+TEST_F( test_durable_prefix_tree_map, test_torn_tail )
+{
+    map_type::options opts;
+    opts.snapshot_records = 0;
+    {
+        map_type m( directory, opts );
+        for ( size_t i = 0; i < 200; ++i )
+            apply( m, i );
+    }
+
+    std::string log_path = directory + "/" + files().back();
+    std::string data;
+    {
+        std::ifstream in( log_path, std::ios::binary );
+        data.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+    }
+    ASSERT_GT( data.size(), 0 );
+
+    // Cut log at every byte of last records and corrupt a byte in middle.
+    for ( size_t cut = data.size() - 100; cut <= data.size(); cut += 7 )
+    {
+        std::filesystem::remove_all( directory );
+        std::filesystem::create_directories( directory );
+
+        std::string damaged = data.substr( 0, cut );
+        if ( cut == data.size() )
+            damaged[ data.size() / 2 ] ^= 0x55;
+
+        {
+            std::ofstream out( log_path, std::ios::binary );
+            out << damaged;
+        }
+
+        model_type recovered;
+        {
+            map_type m( directory, opts );
+            recovered = dump( m );
+            ASSERT_LT( m.recovery().log_records, 200 );
+            m.append( "after/tail", "x" );
+        }
+
+        model_type model;
+        size_t i = 0;
+        for ( ; model != recovered && i < 200; ++i )
+            apply( model, i );
+        ASSERT_EQ( model, recovered ) << cut;
+
+        // Record written after recovery is not lost behind torn tail.
+        map_type m( directory, opts );
+        std::string value;
+        ASSERT_TRUE( m.find( "after/tail", value ) ) << cut;
+    }
+}
+
+
+TEST_F( test_durable_prefix_tree_map, test_crash_injection )
+{
+    map_type::options opts;
+    opts.snapshot_records     = 120;
+    opts.group_commit_records = 16;
+
+    for ( size_t ops : { 10, 333, 1000 } )
+        crash( opts, nullptr, 0, ops );
+
+    for ( const char *point : { "snapshot.rotated", "snapshot.written", "snapshot.renamed" } )
+        for ( size_t hit : { 1, 2, 5 } )
+            crash( opts, point, hit, 1000 );
+
+    opts.sync_every_operation = true;
+    crash( opts, "snapshot.written", 3, 1000 );
+}
+
+
+TEST_F( test_durable_prefix_tree_map, test_group_commit )
+{
+    map_type::options opts;
+    opts.sync_every_operation = true;
+    opts.snapshot_records     = 500;
+
+    const size_t threads_count = 4;
+    const size_t per_thread    = 200;
+    {
+        map_type m( directory, opts );
+
+        std::vector<std::thread> threads;
+        for ( size_t t = 0; t < threads_count; ++t )
+        {
+            threads.emplace_back(
+                [&, t] ()
+                {
+                    for ( size_t i = 0; i < per_thread; ++i )
+                        m.append( std::to_string( t ) + "/" + std::to_string( i ), std::to_string( i ) );
+                }
+            );
+        }
+
+        for ( auto &t : threads )
+            t.join();
+    }
+
+    map_type m( directory, opts );
+    model_type recovered = dump( m );
+    ASSERT_EQ( recovered.size(), threads_count * per_thread );
+    ASSERT_EQ( recovered[ "3/199" ], "199" );
+}
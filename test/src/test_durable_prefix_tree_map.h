@@ -0,0 +1,53 @@
+#ifndef TEST_DURABLE_PREFIX_TREE_MAP_H
+#define TEST_DURABLE_PREFIX_TREE_MAP_H
+
+#include <map>
+
+#include <gtest/gtest.h>
+#include "prefix_tree/durable_prefix_tree_map.h"
+
+class test_durable_prefix_tree_map : public testing::Test
+{
+public:
+    typedef prefix_tree::durable_prefix_tree_map<std::string>   map_type;
+    typedef std::map<std::string, std::string>                  model_type;
+
+    /// @brief directory    Temporary directory of the map.
+    std::string     directory;
+
+public:
+    test_durable_prefix_tree_map() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+    /**
+     * @brief dump      Keys and values of map.
+     */
+    static model_type dump( const map_type &m );
+
+    /**
+     * @brief apply     Apply operation number i of deterministic sequence
+     *                  to map or model.
+     */
+    static void apply( map_type &m, size_t i );
+    static void apply( model_type &m, size_t i );
+
+    /**
+     * @brief files     Names of files of directory.
+     */
+    std::vector<std::string> files() const;
+
+    /**
+     * @brief crash     Run operations in child process which crashes at
+     *                  failpoint or after count of operations, then check
+     *                  recovered map is a state between last flush and crash.
+     * @param opts      Options of map.
+     * @param crash_at  Name of failpoint.
+     * @param hit       Number of hit of failpoint to crash at.
+     * @param ops       Count of operations.
+     */
+    void crash( map_type::options opts, const char *crash_at, size_t hit, size_t ops );
+};
+
+#endif // TEST_DURABLE_PREFIX_TREE_MAP_H
@@ -0,0 +1,147 @@
+#include <atomic>
+#include <set>
+#include <stdexcept>
+
+#include "test_executor.h"
+#include "prefix_tree/prefix_tree_map.h"
+
+
+
+void test_executor::SetUp()
+{
+    pool.reset( new prefix_tree::executor( 4 ) );
+}
+
+
+void test_executor::TearDown()
+{
+    pool.reset();
+}
+
+
+
+namespace
+{
+
+
+/**
+ * @brief fib   Nested groups: every task spawns and waits two tasks.
+ */
+size_t fib( prefix_tree::executor &pool, size_t n )
+{
+    if ( n < 2 )
+        return n;
+
+    size_t a = 0, b = 0;
+    prefix_tree::executor::task_group group( pool );
+    group.run( [&] () { a = fib( pool, n - 1 ); } );
+    group.run( [&] () { b = fib( pool, n - 2 ); } );
+    group.wait();
+
+    return a + b;
+}
+
+
+} // namespace
+
+
+
+TEST_F( test_executor, test_tasks )
+{
+    ASSERT_EQ( pool->size(), 4 );
+
+    std::atomic<size_t> sum( 0 );
+    {
+        prefix_tree::executor::task_group group( *pool );
+        for ( size_t i = 0; i < 1000; ++i )
+            group.run( [&sum, i] () { sum += i; } );
+        group.wait();
+    }
+    ASSERT_EQ( sum, 1000 * 999 / 2 );
+
+    ASSERT_EQ( fib( *pool, 18 ), 2584 );
+
+    prefix_tree::executor single( 1 );
+    ASSERT_EQ( fib( single, 12 ), 144 );
+}
+
+
+TEST_F( test_executor, test_exception )
+{
+    prefix_tree::executor::task_group group( *pool );
+    std::atomic<size_t> done( 0 );
+
+    for ( size_t i = 0; i < 100; ++i )
+        group.run( [&done, i] () { if ( i == 50 ) throw std::runtime_error( "task" ); ++done; } );
+
+    ASSERT_THROW( group.wait(), std::runtime_error );
+    ASSERT_EQ( done, 99 );
+
+    group.run( [&done] () { ++done; } );
+    group.wait();
+    ASSERT_EQ( done, 100 );
+}
+
+
+TEST_F( test_executor, test_parallel_for_each )
+{
+    prefix_tree::prefix_tree_map<size_t> map;
+    std::set<std::string> expected;
+
+    // Skewed: one deep subtree with most keys and many small ones.
+    for ( size_t i = 0; i < 20000; ++i )
+    {
+        std::string key = "deep/" + std::to_string( i * 7919 % 100003 );
+        map.append( key, i );
+        expected.insert( key );
+    }
+    for ( size_t i = 0; i < 300; ++i )
+    {
+        std::string key = std::to_string( i );
+        map.append( key, i );
+        expected.insert( key );
+    }
+
+    std::atomic<size_t> count( 0 );
+    map.parallel_for_each( "", [&] ( const std::string &key, size_t &value ) { ++value; ++count; EXPECT_TRUE( expected.count( key ) ); }, *pool );
+    ASSERT_EQ( count, expected.size() );
+    ASSERT_EQ( *map.get_value( "deep/7919" ), 2 );
+
+    // Ordered reduce: concatenation of keys equals sequential order.
+    std::string sequential;
+    for ( const auto &key : expected )
+        sequential += key + ",";
+
+    for ( size_t threads : { 1, 3, 8 } )
+    {
+        prefix_tree::executor ex( threads );
+        std::string joined = map.parallel_reduce(
+                    "", std::string(),
+                    [] ( const std::string &key, size_t & ) { return key + ","; },
+                    [] ( std::string &&left, std::string &&right ) { return left + right; },
+                    ex
+        );
+        ASSERT_EQ( joined, sequential ) << threads;
+    }
+
+    // Prefix: the prefix key itself is included.
+    map.append( "deep", 0 );
+    size_t deep = map.parallel_reduce(
+                "deep", size_t( 0 ),
+                [] ( const std::string &, size_t & ) { return size_t( 1 ); },
+                [] ( size_t &&a, size_t &&b ) { return a + b; },
+                *pool
+    );
+    ASSERT_EQ( deep, 20001 );
+
+    size_t absent = map.parallel_reduce( "nothing", size_t( 7 ), [] ( const std::string &, size_t & ) { return size_t( 1 ); }, [] ( size_t &&a, size_t &&b ) { return a + b; }, *pool );
+    ASSERT_EQ( absent, 7 );
+
+    prefix_tree::prefix_tree tree;
+    for ( const auto &key : expected )
+        tree.append( key );
+
+    std::atomic<size_t> keys( 0 );
+    tree.parallel_for_each( "", [&] ( const std::string & ) { ++keys; }, *pool );
+    ASSERT_EQ( keys, expected.size() );
+}
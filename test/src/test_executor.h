@@ -0,0 +1,19 @@
+#ifndef TEST_EXECUTOR_H
+#define TEST_EXECUTOR_H
+
+#include <gtest/gtest.h>
+#include "prefix_tree/executor.h"
+
+class test_executor : public testing::Test
+{
+public:
+    std::unique_ptr<prefix_tree::executor>  pool;
+
+public:
+    test_executor() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // TEST_EXECUTOR_H
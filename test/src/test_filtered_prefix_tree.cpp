@@ -0,0 +1,195 @@
+#include <random>
+
+#include "test_filtered_prefix_tree.h"
+
+
+
+void test_filtered_prefix_tree::SetUp()
+{
+    std::mt19937_64 rnd( 42 );
+
+    for ( size_t i = 0; i < 20000; ++i )
+    {
+        std::string key = "user/" + std::to_string( rnd() % 1000 ) + "/" + std::to_string( i );
+        keys.push_back( key );
+        misses.push_back( "miss/" + key );
+    }
+}
+
+
+void test_filtered_prefix_tree::TearDown()
+{
+    keys.clear();
+    misses.clear();
+}
+
+
+
+TEST_F( test_filtered_prefix_tree, test_bloom_filter )
+{
+    prefix_tree::blocked_bloom_filter filter( keys.size(), 10 );
+
+    for ( const auto &key : keys )
+        filter.insert( key );
+    for ( const auto &key : keys )
+        EXPECT_TRUE( filter.may_contain( key ) );
+
+    size_t false_positives = 0;
+    for ( const auto &key : misses )
+        false_positives += filter.may_contain( key );
+
+    // About 1% for 10 bits per key, blocking costs a bit more.
+    double rate = static_cast<double>( false_positives ) / misses.size();
+    EXPECT_LT( rate, 0.03 );
+    EXPECT_NEAR( filter.estimated_false_positive_rate(), rate, 0.01 );
+    EXPECT_EQ( filter.size(), keys.size() );
+    EXPECT_EQ( filter.memory_usage() % 64, 0 );
+
+    filter.clear();
+    EXPECT_EQ( filter.size(), 0 );
+    EXPECT_FALSE( filter.may_contain( keys[ 0 ] ) );
+}
+
+
+TEST_F( test_filtered_prefix_tree, test_key_filter )
+{
+    prefix_tree::key_filter::options opts;
+    opts.prefix_lengths = { 8, 5, 5, 0 };
+
+    prefix_tree::key_filter filter( keys.size(), opts );
+    EXPECT_EQ( filter.get_options().prefix_lengths, std::vector<size_t>( { 5, 8 } ) );
+
+    for ( const auto &key : keys )
+        filter.insert( key );
+
+    for ( const auto &key : keys )
+    {
+        EXPECT_TRUE( filter.may_contain( key ) );
+        for ( size_t len = 0; len <= key.size(); ++len )
+            EXPECT_TRUE( filter.may_contain_prefix( key.substr( 0, len ) ) );
+    }
+
+    // Prefixes shorter than 5 are not filtered.
+    EXPECT_TRUE( filter.may_contain_prefix( "miss" ) );
+    EXPECT_FALSE( filter.may_contain_prefix( "miss/" ) );
+    EXPECT_FALSE( filter.may_contain_prefix( "miss/user/1" ) );
+}
+
+
+TEST_F( test_filtered_prefix_tree, test_tree )
+{
+    prefix_tree::key_filter::options opts;
+    opts.prefix_lengths = { 5, 8 };
+
+    // Filter grows from small size.
+    prefix_tree::filtered_prefix_tree tree( 16, opts );
+
+    for ( const auto &key : keys )
+        EXPECT_TRUE( tree.append( key ) );
+    EXPECT_GE( tree.get_filter().key_bits().capacity(), keys.size() );
+
+    for ( const auto &key : keys )
+    {
+        EXPECT_TRUE( tree.exists( key ) );
+        EXPECT_TRUE( tree.exists( key.substr( 0, 7 ), false ) );
+        EXPECT_EQ( tree.find( key ).get_key(), key );
+    }
+
+    for ( const auto &key : misses )
+    {
+        EXPECT_FALSE( tree.exists( key ) );
+        EXPECT_FALSE( tree.exists( key, false ) );
+        EXPECT_EQ( tree.find( key ), tree.end() );
+    }
+
+    auto stats = tree.filter_stats();
+    EXPECT_EQ( stats.keys, keys.size() );
+    EXPECT_LT( stats.key_false_positive_rate, 0.03 );
+    EXPECT_GT( stats.memory, 0 );
+
+    // Removed keys are forgotten after compaction.
+    for ( size_t i = 0; i < keys.size(); i += 2 )
+        EXPECT_TRUE( tree.remove_lazy( keys[ i ] ) );
+    while ( tree.compact( 1000 ) )
+        ;
+    EXPECT_EQ( tree.filter_stats().keys, keys.size() / 2 );
+
+    for ( size_t i = 0; i < keys.size(); ++i )
+        EXPECT_EQ( tree.exists( keys[ i ] ), i % 2 == 1 );
+}
+
+
+TEST_F( test_filtered_prefix_tree, test_append_sorted )
+{
+    std::vector<std::string> sorted( keys );
+    std::sort( sorted.begin(), sorted.end() );
+
+    prefix_tree::filtered_prefix_tree tree( 16 );
+    EXPECT_EQ( tree.append_sorted( sorted.begin(), sorted.end() ), sorted.size() );
+
+    for ( const auto &key : keys )
+        EXPECT_TRUE( tree.exists( key ) );
+    EXPECT_EQ( tree.filter_stats().keys, keys.size() );
+}
+
+
+TEST_F( test_filtered_prefix_tree, test_map_append_sorted )
+{
+    prefix_tree::filtered_prefix_tree_map<std::string> map( 16 );
+    map.append( "beta", "b" );
+
+    std::vector<std::string> sorted = { "alpha", "beta", "gamma" };
+    EXPECT_EQ( map.append_sorted( sorted.begin(), sorted.end() ), 2 );
+
+    // Values of appended keys are constructed, present value is kept.
+    ASSERT_NE( map.get_value( "alpha" ), nullptr );
+    EXPECT_TRUE( map.get_value( "alpha" )->empty() );
+    EXPECT_EQ( *map.get_value( "beta" ), "b" );
+    *map.get_value( "gamma" ) = std::string( 100, 'g' );
+    map.remove( "gamma" );
+    EXPECT_FALSE( map.exists( "gamma" ) );
+}
+
+
+TEST_F( test_filtered_prefix_tree, test_map )
+{
+    prefix_tree::filtered_prefix_tree_map<size_t> map( keys.size() );
+
+    for ( size_t i = 0; i < keys.size(); ++i )
+        EXPECT_TRUE( map.append( keys[ i ], i ) );
+    EXPECT_TRUE( map.try_emplace( "a", 1 ).second );
+    EXPECT_FALSE( map.emplace( "a", 2 ).second );
+    EXPECT_FALSE( map.insert_or_assign( "a", 3 ).second );
+    EXPECT_TRUE( map.insert_or_assign( "b", 4 ).second );
+
+    for ( size_t i = 0; i < keys.size(); ++i )
+    {
+        ASSERT_NE( map.get_value( keys[ i ] ), nullptr );
+        EXPECT_EQ( *map.get_value( keys[ i ] ), i );
+        EXPECT_EQ( map.find( keys[ i ] ).get_value(), i );
+    }
+    EXPECT_EQ( *map.get_value( "a" ), 3 );
+    EXPECT_EQ( *map.get_value( "b" ), 4 );
+
+    for ( const auto &key : misses )
+    {
+        EXPECT_EQ( map.get_value( key ), nullptr );
+        EXPECT_FALSE( map.exists( key ) );
+        EXPECT_EQ( map.find( key ), map.end() );
+    }
+
+    // Keys of operator[] are filtered as others.
+    map[ "c" ] = 5;
+    map[ std::string( "d" ) ] = 6;
+    EXPECT_TRUE( map.exists( "c" ) );
+    ASSERT_NE( map.get_value( "d" ), nullptr );
+    EXPECT_EQ( *map.get_value( "d" ), 6 );
+    EXPECT_EQ( map[ "c" ], 5 );
+    map.remove( "c" );
+    map.remove( "d" );
+
+    map.remove( "a" );
+    map.rebuild();
+    EXPECT_FALSE( map.exists( "a" ) );
+    EXPECT_EQ( map.filter_stats().keys, keys.size() + 1 );
+}
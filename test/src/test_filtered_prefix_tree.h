@@ -0,0 +1,22 @@
+#ifndef TEST_FILTERED_PREFIX_TREE_H
+#define TEST_FILTERED_PREFIX_TREE_H
+
+#include <gtest/gtest.h>
+#include "prefix_tree/filtered_prefix_tree.h"
+
+class test_filtered_prefix_tree : public testing::Test
+{
+public:
+    /// @brief keys     Stored keys.
+    std::vector<std::string>    keys;
+    /// @brief misses   Keys which are never stored.
+    std::vector<std::string>    misses;
+
+public:
+    test_filtered_prefix_tree() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // TEST_FILTERED_PREFIX_TREE_H
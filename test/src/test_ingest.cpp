@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <random>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "test_ingest.h"
+
+
+
+void test_ingest::SetUp()
+{
+    char name[] = "/tmp/test_ingest_XXXXXX";
+    int fd = mkstemp( name );
+    ASSERT_GE( fd, 0 );
+    path = name;
+
+    // Random keys, CRLF and empty lines, one line longer than chunks of tests,
+    // no newline at end of file.
+    std::mt19937_64 rnd( 3 );
+    std::string data;
+    for ( size_t i = 0; i < 20000; ++i )
+    {
+        std::string key( 1 + rnd() % 16, 'a' );
+        for ( auto &c : key )
+            c = static_cast<char>( 'a' + rnd() % 6 );
+
+        expected.insert( key );
+        data += key;
+        data += i % 7 ? "\n" : "\r\n";
+        if ( i % 101 == 0 )
+            data += "\n";
+    }
+
+    std::string long_key( 5000, 'z' );
+    expected.insert( long_key );
+    data += long_key + "\nlast";
+    expected.insert( "last" );
+
+    ASSERT_EQ( write( fd, data.data(), data.size() ), static_cast<ssize_t>( data.size() ) );
+    close( fd );
+}
+
+
+void test_ingest::TearDown()
+{
+    std::remove( path.c_str() );
+}
+
+
+std::vector<std::string> test_ingest::keys( prefix_tree::prefix_tree &tree )
+{
+    std::vector<std::string> result;
+    for ( auto it = tree.begin( true ); it != tree.end(); ++it )
+        result.push_back( it.get_key() );
+    return result;
+}
+
+
+
+TEST_F( test_ingest, test_load )
+{
+    for ( size_t chunk : { 64, 1000, 1 << 20 } )
+    {
+        for ( size_t threads : { 1, 3 } )
+        {
+            prefix_tree::ingest_options opts;
+            opts.chunk_bytes   = chunk;
+            opts.parse_threads = threads;
+            opts.queue_depth   = 2;
+
+            prefix_tree::prefix_tree tree;
+            prefix_tree::ingest_stats stats = prefix_tree::ingest( tree, path, opts );
+
+            ASSERT_EQ( keys( tree ), std::vector<std::string>( expected.begin(), expected.end() ) ) << chunk << " " << threads;
+            ASSERT_EQ( stats.keys, 20002 );
+            ASSERT_EQ( stats.appended, expected.size() );
+            ASSERT_EQ( stats.parse.threads, threads );
+            ASSERT_GT( stats.chunks, 0 );
+            ASSERT_GE( stats.insert.utilization( stats.seconds ), 0 );
+            ASSERT_LE( stats.insert.utilization( stats.seconds ), 1 );
+        }
+    }
+}
+
+
+TEST_F( test_ingest, test_existing_keys )
+{
+    prefix_tree::prefix_tree tree;
+    tree.append( "last" );
+    tree.append( "new" );
+
+    prefix_tree::ingest_stats stats = prefix_tree::ingest( tree, path );
+    ASSERT_EQ( stats.appended, expected.size() - 1 );
+    ASSERT_TRUE( tree.exists( "new" ) );
+
+    std::ostringstream out;
+    stats.write( out );
+    ASSERT_NE( out.str().find( "keys/s=" ), std::string::npos );
+    ASSERT_NE( out.str().find( "insert threads=1" ), std::string::npos );
+}
+
+
+TEST_F( test_ingest, test_errors )
+{
+    prefix_tree::prefix_tree tree;
+    ASSERT_THROW( prefix_tree::ingest( tree, path + ".absent" ), std::system_error );
+    ASSERT_THROW( prefix_tree::ingest( tree, -1 ), std::system_error );
+}
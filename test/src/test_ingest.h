@@ -0,0 +1,29 @@
+#ifndef TEST_INGEST_H
+#define TEST_INGEST_H
+
+#include <set>
+
+#include <gtest/gtest.h>
+#include "prefix_tree/ingest.h"
+
+class test_ingest : public testing::Test
+{
+public:
+    /// @brief path     Temporary input file.
+    std::string             path;
+    /// @brief expected Keys written to input.
+    std::set<std::string>   expected;
+
+public:
+    test_ingest() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+    /**
+     * @brief keys      Keys of tree in order.
+     */
+    static std::vector<std::string> keys( prefix_tree::prefix_tree &tree );
+};
+
+#endif // TEST_INGEST_H
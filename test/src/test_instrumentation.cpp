@@ -0,0 +1,158 @@
+#include <sstream>
+#include <thread>
+
+#include "test_instrumentation.h"
+#include "prefix_tree/instrumented_prefix_tree.h"
+#include "prefix_tree/prefix_tree_map.h"
+
+
+using prefix_tree::operation;
+using prefix_tree::latency_histogram;
+using prefix_tree::latency_instrumentation;
+
+
+namespace
+{
+
+
+/// @brief The counting_instrumentation struct  User defined policy.
+struct counting_instrumentation
+{
+    static size_t visits;
+    static size_t allocations;
+
+    class probe
+    {
+    public:
+        explicit probe( operation ) {}
+
+        inline void visit() { ++visits; }
+        inline void allocate() { ++allocations; }
+    };
+};
+
+size_t counting_instrumentation::visits      = 0;
+size_t counting_instrumentation::allocations = 0;
+
+
+} // namespace
+
+
+
+void test_instrumentation::SetUp()
+{
+    latency_instrumentation::reset();
+}
+
+
+void test_instrumentation::TearDown()
+{
+    latency_instrumentation::reset();
+}
+
+
+
+TEST_F( test_instrumentation, test_histogram )
+{
+    for ( uint64_t v : { 0ull, 1ull, 15ull, 16ull, 17ull, 100ull, 1000ull, 123456789ull } )
+    {
+        unsigned int b = latency_histogram::bucket( v );
+        ASSERT_LE( latency_histogram::lower_bound( b ), v );
+        if ( b + 1 < latency_histogram::BUCKETS )
+        {
+            ASSERT_GT( latency_histogram::lower_bound( b + 1 ), v );
+        }
+    }
+
+    latency_histogram h;
+    for ( uint64_t v = 1; v <= 1000; ++v )
+        h.record( v );
+
+    ASSERT_EQ( h.count(), 1000u );
+    ASSERT_EQ( h.max(), 1000u );
+    ASSERT_EQ( h.percentile( 100 ), 1000u );
+
+    uint64_t p50 = h.percentile( 50 );
+    ASSERT_LE( p50, 500u );
+    ASSERT_GE( p50, 500u - 500u / latency_histogram::SUB );
+}
+
+
+TEST_F( test_instrumentation, test_map_counters )
+{
+    prefix_tree::prefix_tree_map<int, latency_instrumentation> map;
+
+    map.append( "abc", 1 );
+    map.append( "abd", 2 );
+    map.append( "abc", 3 );
+    ASSERT_TRUE( map.exists( "abc" ) );
+    ASSERT_FALSE( map.exists( "xyz" ) );
+    ASSERT_EQ( map.find( "abd" ).get_value(), 2 );
+    map.remove( "abd" );
+
+    latency_instrumentation::snapshot s = latency_instrumentation::take_snapshot();
+
+    ASSERT_EQ( s[ operation::APPEND ].operations, 3u );
+    ASSERT_EQ( s[ operation::APPEND ].allocations, 4u );
+    // Root is visited too.
+    ASSERT_EQ( s[ operation::APPEND ].max_depth, 4u );
+    ASSERT_EQ( s[ operation::APPEND ].latency.count(), 3u );
+    ASSERT_EQ( s[ operation::FIND ].operations, 3u );
+    ASSERT_EQ( s[ operation::FIND ].allocations, 0u );
+    ASSERT_EQ( s[ operation::REMOVE ].operations, 1u );
+
+    std::ostringstream out;
+    s.write( out );
+    ASSERT_NE( out.str().find( "append operations=3" ), std::string::npos );
+
+    latency_instrumentation::reset();
+    s = latency_instrumentation::take_snapshot();
+    ASSERT_EQ( s[ operation::APPEND ].operations, 0u );
+    ASSERT_EQ( s[ operation::APPEND ].latency.count(), 0u );
+}
+
+
+TEST_F( test_instrumentation, test_user_policy )
+{
+    prefix_tree::prefix_tree_map<int, counting_instrumentation> map;
+
+    map.append( "abc", 1 );
+    map.append( "abd", 2 );
+    ASSERT_EQ( counting_instrumentation::allocations, 4u );
+    ASSERT_EQ( counting_instrumentation::visits, 8u );
+
+    ASSERT_TRUE( map.exists( "abc" ) );
+    map.remove( "abd" );
+    ASSERT_FALSE( map.exists( "abd" ) );
+    ASSERT_GT( counting_instrumentation::visits, 8u );
+}
+
+
+TEST_F( test_instrumentation, test_tree_threads )
+{
+    const size_t THREADS = 4;
+    const size_t KEYS    = 100;
+
+    std::vector<std::thread> threads;
+    for ( size_t t = 0; t < THREADS; ++t )
+    {
+        threads.emplace_back(
+                    [=] ()
+                    {
+                        prefix_tree::instrumented_prefix_tree<latency_instrumentation> tree;
+                        for ( size_t i = 0; i < KEYS; ++i )
+                            tree.append( std::to_string( t * KEYS + i ) );
+                        for ( size_t i = 0; i < KEYS; ++i )
+                            tree.exists( std::to_string( i ) );
+                    }
+        );
+    }
+    for ( auto &t : threads )
+        t.join();
+
+    // Counters of finished threads are kept.
+    latency_instrumentation::snapshot s = latency_instrumentation::take_snapshot();
+    ASSERT_EQ( s[ operation::APPEND ].operations, THREADS * KEYS );
+    ASSERT_EQ( s[ operation::FIND ].operations, THREADS * KEYS );
+    ASSERT_GT( s[ operation::FIND ].nodes_visited, 0u );
+}
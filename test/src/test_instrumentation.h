@@ -0,0 +1,16 @@
+#ifndef TEST_INSTRUMENTATION_H
+#define TEST_INSTRUMENTATION_H
+
+#include <gtest/gtest.h>
+#include "prefix_tree/instrumentation.h"
+
+class test_instrumentation : public testing::Test
+{
+public:
+    test_instrumentation() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // TEST_INSTRUMENTATION_H
@@ -0,0 +1,214 @@
+#include <random>
+
+#include "test_merkle_prefix_tree.h"
+
+
+
+void test_merkle_prefix_tree::SetUp()
+{
+    std::mt19937_64 rnd( 42 );
+    const char      alphabet[] = "abcdefgh/";
+
+    for ( size_t i = 0; i < 20000; ++i )
+    {
+        std::string key( 3 + rnd() % 12, ' ' );
+        for ( auto &c : key )
+            c = alphabet[ rnd() % ( sizeof( alphabet ) - 1 ) ];
+        keys.push_back( key );
+    }
+}
+
+
+void test_merkle_prefix_tree::TearDown()
+{
+    keys.clear();
+}
+
+
+std::vector<std::string> test_merkle_prefix_tree::keys_of( prefix_tree::merkle_prefix_tree &tree )
+{
+    std::vector<std::string> result;
+    for ( auto it = tree.begin( true ); it != tree.end(); ++it )
+        result.push_back( it.get_key() );
+    return result;
+}
+
+
+
+TEST_F( test_merkle_prefix_tree, test_hash )
+{
+    prefix_tree::merkle_prefix_tree a, b;
+    EXPECT_EQ( a.root_hash(), 0 );
+
+    // Hash does not depend on order of appends.
+    for ( const auto &key : keys )
+        EXPECT_TRUE( a.append( key ) );
+    for ( auto it = keys.rbegin(); it != keys.rend(); ++it )
+        b.append( *it );
+    EXPECT_NE( a.root_hash(), 0 );
+    EXPECT_EQ( a.root_hash(), b.root_hash() );
+
+    uint64_t full = a.root_hash();
+    EXPECT_TRUE( a.append( keys[ 0 ] ) );
+    EXPECT_EQ( a.root_hash(), full );
+
+    // Removal restores previous hash, remove of absent key changes nothing.
+    a.remove( keys[ 0 ] + "/x" );
+    EXPECT_EQ( a.root_hash(), full );
+    a.append( "zzz" );
+    EXPECT_NE( a.root_hash(), full );
+    a.remove( "zzz" );
+    EXPECT_EQ( a.root_hash(), full );
+
+    // Keys and prefixes of keys differ.
+    a.append( keys[ 1 ] + "a" );
+    a.remove( keys[ 1 ] );
+    EXPECT_NE( a.root_hash(), full );
+    a.append( keys[ 1 ] );
+    a.remove( keys[ 1 ] + "a" );
+    EXPECT_EQ( a.root_hash(), full );
+
+    // Subtree hash is relative to its prefix.
+    prefix_tree::merkle_prefix_tree c;
+    for ( const auto &key : keys )
+    {
+        if ( key.compare( 0, 2, "ab" ) == 0 )
+            c.append( "x" + key.substr( 2 ) );
+    }
+    EXPECT_EQ( a.subtree_hash( "ab" ), c.subtree_hash( "x" ) );
+    EXPECT_EQ( a.subtree_hash( "zz" ), 0 );
+
+    a.remove_prefix( "ab" );
+    b.remove_prefix( "ab" );
+    EXPECT_EQ( a.root_hash(), b.root_hash() );
+    EXPECT_EQ( a.subtree_hash( "ab" ), 0 );
+
+    // Hashes kept incrementally are equal to computed again.
+    uint64_t kept = a.root_hash();
+    a.rehash();
+    EXPECT_EQ( a.root_hash(), kept );
+    a.relayout();
+    EXPECT_EQ( a.root_hash(), kept );
+    EXPECT_EQ( keys_of( a ), keys_of( b ) );
+
+    a.remove_prefix( "" );
+    EXPECT_EQ( a.root_hash(), 0 );
+}
+
+
+TEST_F( test_merkle_prefix_tree, test_diff )
+{
+    prefix_tree::merkle_prefix_tree from, to;
+    std::set<std::string>           appended, removed;
+
+    for ( const auto &key : keys )
+    {
+        from.append( key );
+        to.append( key );
+    }
+
+    size_t same = prefix_tree::merkle_prefix_tree::diff( from, to, [&] ( const std::string &, prefix_tree::log_op ) { FAIL(); } );
+    EXPECT_EQ( same, 2 );
+
+    to.remove_prefix( "hhh" );
+    for ( const auto &key : keys )
+    {
+        if ( key.compare( 0, 3, "hhh" ) == 0 )
+            removed.insert( key );
+    }
+
+    // "new" is out of alphabet of keys.
+    for ( size_t i = 0; i < 10; ++i )
+    {
+        to.remove( keys[ i * 100 ] );
+        to.append( keys[ i * 100 + 1 ] + "new" );
+        removed.insert( keys[ i * 100 ] );
+        appended.insert( keys[ i * 100 + 1 ] + "new" );
+    }
+
+    std::vector<std::string> reported;
+    size_t visited = prefix_tree::merkle_prefix_tree::diff( from, to, [&] ( const std::string &key, prefix_tree::log_op op )
+    {
+        reported.push_back( key );
+        if ( op == prefix_tree::log_op::APPEND )
+            EXPECT_EQ( appended.erase( key ), 1 ) << key;
+        else
+            EXPECT_EQ( removed.erase( key ), 1 ) << key;
+    } );
+
+    EXPECT_TRUE( appended.empty() );
+    EXPECT_TRUE( removed.empty() );
+    EXPECT_TRUE( std::is_sorted( reported.begin(), reported.end() ) );
+
+    // Cost is bound by change, not by tree.
+    EXPECT_LT( visited, from.stats().nodes / 20 );
+}
+
+
+TEST_F( test_merkle_prefix_tree, test_delta )
+{
+    prefix_tree::merkle_prefix_tree primary, replica;
+
+    for ( size_t i = 0; i < keys.size() / 2; ++i )
+    {
+        primary.append( keys[ i ] );
+        replica.append( keys[ i ] );
+    }
+
+    // Primary is changed, replica follows by deltas.
+    for ( size_t round = 0; round < 5; ++round )
+    {
+        prefix_tree::merkle_prefix_tree before;
+        for ( const auto &key : keys_of( primary ) )
+            before.append( key );
+
+        for ( size_t i = 0; i < 100; ++i )
+        {
+            primary.append( keys[ keys.size() / 2 + round * 100 + i ] );
+            primary.remove( keys[ round * 100 + i ] );
+        }
+
+        std::string delta = prefix_tree::merkle_prefix_tree::encode_delta( before, primary );
+        EXPECT_LT( delta.size(), 200 * 24 );
+        EXPECT_TRUE( replica.apply_delta( delta ) );
+        EXPECT_EQ( replica.root_hash(), primary.root_hash() );
+
+        // Delta is bound to its source.
+        EXPECT_FALSE( replica.apply_delta( delta ) );
+    }
+
+    EXPECT_EQ( keys_of( replica ), keys_of( primary ) );
+
+    // Corrupted delta is rejected before any change.
+    prefix_tree::merkle_prefix_tree other;
+    other.append( "a" );
+    std::string delta = prefix_tree::merkle_prefix_tree::encode_delta( replica, other );
+    uint64_t    hash  = replica.root_hash();
+    std::string intact = delta;
+    std::vector<std::string> before = keys_of( replica );
+    EXPECT_FALSE( replica.apply_delta( delta.substr( 0, delta.size() - 1 ) ) );
+
+    // Flipped byte of key fails CRC.
+    std::string flipped = delta;
+    flipped.back() ^= 1;
+    EXPECT_FALSE( replica.apply_delta( flipped ) );
+    EXPECT_EQ( replica.root_hash(), hash );
+
+    // Flipped byte of key with CRC forged too: changes are undone.
+    uint32_t crc = prefix_tree::crc32c( flipped.data() + 20, flipped.size() - 20 );
+    for ( int i = 0; i < 4; ++i )
+        flipped[ 16 + i ] = static_cast<char>( crc >> ( 8 * i ) );
+    EXPECT_FALSE( replica.apply_delta( flipped ) );
+    EXPECT_EQ( replica.root_hash(), hash );
+    EXPECT_EQ( keys_of( replica ), before );
+
+    delta[ 20 ] = 7;
+    EXPECT_FALSE( replica.apply_delta( delta ) );
+    EXPECT_FALSE( replica.apply_delta( "" ) );
+    EXPECT_EQ( replica.root_hash(), hash );
+    EXPECT_EQ( keys_of( replica ), before );
+
+    // Intact delta still applies.
+    EXPECT_TRUE( replica.apply_delta( intact ) );
+    EXPECT_EQ( keys_of( replica ), keys_of( other ) );
+}
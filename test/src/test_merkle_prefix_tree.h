@@ -0,0 +1,24 @@
+#ifndef TEST_MERKLE_PREFIX_TREE_H
+#define TEST_MERKLE_PREFIX_TREE_H
+
+#include <set>
+
+#include <gtest/gtest.h>
+#include "prefix_tree/merkle_prefix_tree.h"
+
+class test_merkle_prefix_tree : public testing::Test
+{
+public:
+    std::vector<std::string>    keys;
+
+public:
+    test_merkle_prefix_tree() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+    /// @brief keys_of  Keys of tree in order.
+    static std::vector<std::string> keys_of( prefix_tree::merkle_prefix_tree &tree );
+};
+
+#endif // TEST_MERKLE_PREFIX_TREE_H
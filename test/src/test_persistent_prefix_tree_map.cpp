@@ -0,0 +1,153 @@
+#include <thread>
+
+#include "test_persistent_prefix_tree_map.h"
+
+
+
+void test_persistent_prefix_tree_map::SetUp()
+{
+    map.reset( new map_type() );
+}
+
+
+void test_persistent_prefix_tree_map::TearDown()
+{
+    map.reset();
+}
+
+
+std::vector<std::string> test_persistent_prefix_tree_map::dump( const map_type &m )
+{
+    std::vector<std::string> result;
+    m.for_each( [&] ( const std::string &key, const std::string &value ) { result.push_back( key + "=" + value ); } );
+    return result;
+}
+
+
+
+TEST_F( test_persistent_prefix_tree_map, test_update )
+{
+    ASSERT_TRUE( map->insert_or_assign( "abc", std::string( "1" ) ) );
+    ASSERT_TRUE( map->insert_or_assign( std::string( "ab" ), "2" ) );
+    ASSERT_TRUE( map->try_emplace( "b", 3, 'x' ) );
+    ASSERT_FALSE( map->try_emplace( "b", 1, 'y' ) );
+    ASSERT_FALSE( map->insert_or_assign( "abc", "4" ) );
+    ASSERT_EQ( map->size(), 3 );
+
+    ASSERT_EQ( *map->find( "abc" ), "4" );
+    ASSERT_EQ( map->find( "a" ), nullptr );
+    ASSERT_TRUE( map->exists( "a", false ) );
+    ASSERT_FALSE( map->exists( "a" ) );
+
+    std::vector<std::string> expected = { "ab=2", "abc=4", "b=xxx" };
+    ASSERT_EQ( dump( *map ), expected );
+
+    std::vector<std::string> prefixed;
+    map->for_each( "ab", [&] ( const std::string &key, const std::string & ) { prefixed.push_back( key ); } );
+    ASSERT_EQ( prefixed, std::vector<std::string>( { "ab", "abc" } ) );
+
+    ASSERT_FALSE( map->remove( "a" ) );
+    ASSERT_TRUE( map->remove( "ab" ) );
+    ASSERT_TRUE( map->remove( "abc" ) );
+    ASSERT_FALSE( map->exists( "a", false ) );
+    ASSERT_EQ( dump( *map ), std::vector<std::string>( 1, "b=xxx" ) );
+    ASSERT_EQ( map->size(), 1 );
+}
+
+
+TEST_F( test_persistent_prefix_tree_map, test_snapshot )
+{
+    for ( int i = 0; i < 100; ++i )
+        map->insert_or_assign( std::to_string( i ), std::to_string( i ) );
+
+    map_type v1 = map->snapshot();
+    ASSERT_EQ( map->unshared_nodes( v1 ), 0 );
+
+    map->insert_or_assign( "42", "changed" );
+    map->remove( "7" );
+    map->insert_or_assign( "100", "new" );
+
+    ASSERT_EQ( *v1.find( "42" ), "42" );
+    ASSERT_EQ( *v1.find( "7" ), "7" );
+    ASSERT_EQ( v1.find( "100" ), nullptr );
+    ASSERT_EQ( v1.size(), 100 );
+
+    ASSERT_EQ( *map->find( "42" ), "changed" );
+    ASSERT_EQ( map->find( "7" ), nullptr );
+    ASSERT_EQ( *map->find( "100" ), "new" );
+    ASSERT_EQ( map->size(), 100 );
+
+    // Values of unchanged keys are shared.
+    ASSERT_EQ( map->find( "43" ), v1.find( "43" ) );
+
+    // Old version outlives the one it was taken from.
+    map.reset();
+    ASSERT_EQ( dump( v1 ).size(), 100 );
+}
+
+
+TEST_F( test_persistent_prefix_tree_map, test_path_copy )
+{
+    const std::string LONG_KEY( 1000, 'k' );
+
+    map->insert_or_assign( LONG_KEY, "0" );
+    for ( int i = 0; i < 1000; ++i )
+        map->insert_or_assign( LONG_KEY + std::to_string( i ), std::to_string( i ) );
+
+    map_type v1 = map->snapshot();
+
+    // Only path of changed key is copied.
+    map->insert_or_assign( LONG_KEY + "500", "x" );
+    ASSERT_EQ( map->unshared_nodes( v1 ), LONG_KEY.size() + 4 );
+
+    // Nodes owned by the version are changed in place.
+    map->insert_or_assign( LONG_KEY + "501", "y" );
+    ASSERT_EQ( map->unshared_nodes( v1 ), LONG_KEY.size() + 5 );
+
+    // Absent key does not copy anything.
+    map_type v2 = map->snapshot();
+    ASSERT_FALSE( map->remove( "absent" ) );
+    ASSERT_FALSE( map->try_emplace( LONG_KEY, "z" ) );
+    ASSERT_EQ( map->unshared_nodes( v2 ), 0 );
+}
+
+
+TEST_F( test_persistent_prefix_tree_map, test_concurrent_readers )
+{
+    for ( int i = 0; i < 1000; ++i )
+        map->insert_or_assign( std::to_string( i ), std::to_string( i ) );
+
+    std::vector<std::thread> readers;
+    std::atomic<size_t> errors( 0 );
+
+    for ( int t = 0; t < 4; ++t )
+    {
+        readers.emplace_back(
+                    [&errors] ( map_type version )
+                    {
+                        for ( int round = 0; round < 20; ++round )
+                            for ( int i = 0; i < 1000; ++i )
+                            {
+                                const std::string *value = version.find( std::to_string( i ) );
+                                if ( !value || *value != std::to_string( i ) )
+                                    ++errors;
+                            }
+                    },
+                    map->snapshot()
+        );
+    }
+
+    for ( int i = 0; i < 1000; ++i )
+    {
+        if ( i % 2 )
+            map->remove( std::to_string( i ) );
+        else
+            map->insert_or_assign( std::to_string( i ), "w" );
+    }
+
+    for ( auto &t : readers )
+        t.join();
+
+    ASSERT_EQ( errors, 0 );
+    ASSERT_EQ( map->size(), 500 );
+}
@@ -0,0 +1,26 @@
+#ifndef TEST_PERSISTENT_PREFIX_TREE_MAP_H
+#define TEST_PERSISTENT_PREFIX_TREE_MAP_H
+
+#include <gtest/gtest.h>
+#include "prefix_tree/persistent_prefix_tree_map.h"
+
+class test_persistent_prefix_tree_map : public testing::Test
+{
+public:
+    typedef prefix_tree::persistent_prefix_tree_map<std::string>    map_type;
+
+    std::unique_ptr<map_type>   map;
+
+public:
+    test_persistent_prefix_tree_map() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+    /**
+     * @brief dump      Keys and values as "<key>=<value>".
+     */
+    static std::vector<std::string> dump( const map_type &m );
+};
+
+#endif // TEST_PERSISTENT_PREFIX_TREE_MAP_H
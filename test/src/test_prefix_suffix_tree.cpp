@@ -0,0 +1,112 @@
+#include <random>
+
+#include "test_prefix_suffix_tree.h"
+
+
+
+void test_prefix_suffix_tree::SetUp()
+{
+    std::mt19937_64 rnd( 42 );
+    const char     *hosts_[]   = { "www", "mail", "api", "cdn", "static" };
+    const char     *domains[]  = { "example", "test", "sample", "demo" };
+    const char     *zones[]    = { "com", "org", "net", "co.uk" };
+
+    for ( size_t i = 0; i < 5000; ++i )
+    {
+        std::string host = hosts_[ rnd() % 5 ];
+        host += std::to_string( rnd() % 100 ) + ".";
+        host += domains[ rnd() % 4 ];
+        host += ".";
+        host += zones[ rnd() % 4 ];
+        hosts.insert( host );
+    }
+
+    hosts.insert( "\xff\xff" );
+    hosts.insert( "a\xff" );
+}
+
+
+void test_prefix_suffix_tree::TearDown()
+{
+    hosts.clear();
+}
+
+
+std::vector<std::string> test_prefix_suffix_tree::scan( const std::string &prefix, const std::string &suffix ) const
+{
+    std::vector<std::string> result;
+    for ( const auto &host : hosts )
+    {
+        if ( host.compare( 0, prefix.size(), prefix ) == 0 &&
+             host.size() >= suffix.size() && host.compare( host.size() - suffix.size(), suffix.size(), suffix ) == 0 )
+            result.push_back( host );
+    }
+    return result;
+}
+
+
+
+TEST_F( test_prefix_suffix_tree, test_ends_with )
+{
+    prefix_tree::prefix_suffix_tree tree;
+    for ( const auto &host : hosts )
+        EXPECT_TRUE( tree.append( host ) );
+
+    for ( const char *suffix : { ".example.com", ".co.uk", "uk", "", "\xff", "none" } )
+    {
+        std::vector<std::string> found;
+        size_t count = tree.ends_with( suffix, [&] ( const std::string &key ) { found.push_back( key ); } );
+        EXPECT_EQ( count, found.size() );
+
+        // Keys are in original order, sorted by reversed key.
+        std::sort( found.begin(), found.end() );
+        EXPECT_EQ( found, scan( "", suffix ) ) << suffix;
+    }
+
+    auto r = tree.ends_with( "mail1.test.net" );
+    ASSERT_NE( r.first, r.second );
+    EXPECT_EQ( r.first.get_key().substr( r.first.get_key().size() - 14 ), "mail1.test.net" );
+
+    std::vector<std::string> found;
+    tree.starts_with( "api", [&] ( const std::string &key ) { found.push_back( key ); } );
+    EXPECT_EQ( found, scan( "api", "" ) );
+
+    std::vector<std::string> all;
+    for ( auto it = tree.begin(); it != tree.end(); ++it )
+        all.push_back( it.get_key() );
+    EXPECT_EQ( all, scan( "", "" ) );
+}
+
+
+TEST_F( test_prefix_suffix_tree, test_match )
+{
+    prefix_tree::prefix_suffix_tree tree;
+    for ( const auto &host : hosts )
+        tree.append( host );
+
+    // Small prefix side, small suffix side, overlap and empty parts.
+    const std::pair<const char*, const char*> queries[] = {
+        { "www1", ".com" }, { "", "mail1.demo.org" }, { "api", "" }, { "", "" },
+        { "cdn5.sample.co", "co.uk" }, { "x", ".com" }, { "www", "none" }
+    };
+
+    for ( const auto &q : queries )
+    {
+        std::vector<std::string> found;
+        size_t count = tree.match( q.first, q.second, [&] ( const std::string &key ) { found.push_back( key ); } );
+        EXPECT_EQ( count, found.size() );
+        EXPECT_EQ( found, scan( q.first, q.second ) ) << q.first << " " << q.second;
+    }
+
+    // Removed keys are absent from both sides.
+    for ( const auto &host : scan( "www", "" ) )
+        tree.remove( host );
+
+    EXPECT_FALSE( tree.exists( *scan( "www", "" ).begin() ) );
+    EXPECT_EQ( tree.match( "www", ".com", [] ( const std::string & ) {} ), 0 );
+    EXPECT_EQ( tree.ends_with( ".com", [] ( const std::string &key ) { EXPECT_NE( key.compare( 0, 3, "www" ), 0 ); } ),
+               scan( "", ".com" ).size() - scan( "www", ".com" ).size() );
+
+    auto usage = tree.memory_usage();
+    EXPECT_GT( usage.nodes, 0 );
+}
@@ -0,0 +1,25 @@
+#ifndef TEST_PREFIX_SUFFIX_TREE_H
+#define TEST_PREFIX_SUFFIX_TREE_H
+
+#include <set>
+
+#include <gtest/gtest.h>
+#include "prefix_tree/prefix_suffix_tree.h"
+
+class test_prefix_suffix_tree : public testing::Test
+{
+public:
+    /// @brief hosts    Host names.
+    std::set<std::string>       hosts;
+
+public:
+    test_prefix_suffix_tree() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+    /// @brief scan     Expected keys by full scan.
+    std::vector<std::string> scan( const std::string &prefix, const std::string &suffix ) const;
+};
+
+#endif // TEST_PREFIX_SUFFIX_TREE_H
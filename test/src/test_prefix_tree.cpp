@@ -1,4 +1,7 @@
 #include "test_prefix_tree.h"
+#include <random>
+#include <set>
+
 #include "prefix_tree/prefix_tree.h"
 
 
@@ -223,3 +226,617 @@ TEST_F( test_prefix_tree, test_operator_bool )
     auto it_end = tree->end();
     ASSERT_FALSE( it_end.operator bool() );
 }
+
+
+static std::vector<std::string> keys( prefix_tree::prefix_tree &tree )
+{
+    std::vector<std::string> result;
+    for ( auto it = tree.begin( true ); it != tree.end(); ++it )
+        result.push_back( it.get_key() );
+    return result;
+}
+
+
+TEST_F( test_prefix_tree, test_merge )
+{
+    for ( bool parallel : { false, true } )
+    {
+        SetUp();
+
+        prefix_tree::prefix_tree other;
+
+        ASSERT_TRUE( tree->append( "abc" ) );
+        ASSERT_TRUE( tree->append( "abd" ) );
+        ASSERT_TRUE( tree->append( "x" ) );
+
+        ASSERT_TRUE( other.append( "ab" ) );
+        ASSERT_TRUE( other.append( "abd" ) );
+        ASSERT_TRUE( other.append( "abde" ) );
+        ASSERT_TRUE( other.append( "def" ) );
+        ASSERT_TRUE( other.append( "xyz" ) );
+
+        tree->merge( std::move( other ), parallel );
+
+        std::vector<std::string> expected = { "ab", "abc", "abd", "abde", "def", "x", "xyz" };
+        ASSERT_EQ( keys( *tree ), expected );
+        ASSERT_EQ( other.begin( false ), other.end() );
+
+        // Moved subtree must be linked to its new parent.
+        auto it = tree->begin( true );
+        while ( it.get_key() != "xyz" )
+            ++it;
+        --it;
+        ASSERT_EQ( "x", it.get_key() );
+    }
+}
+
+
+TEST_F( test_prefix_tree, test_intersect )
+{
+    for ( bool parallel : { false, true } )
+    {
+        SetUp();
+
+        prefix_tree::prefix_tree other;
+
+        ASSERT_TRUE( tree->append( "abc" ) );
+        ASSERT_TRUE( tree->append( "abcd" ) );
+        ASSERT_TRUE( tree->append( "abd" ) );
+        ASSERT_TRUE( tree->append( "def" ) );
+        ASSERT_TRUE( tree->append( "x" ) );
+
+        ASSERT_TRUE( other.append( "ab" ) );
+        ASSERT_TRUE( other.append( "abcd" ) );
+        ASSERT_TRUE( other.append( "abd" ) );
+        ASSERT_TRUE( other.append( "defg" ) );
+        ASSERT_TRUE( other.append( "x" ) );
+
+        tree->intersect( other, parallel );
+
+        std::vector<std::string> expected = { "abcd", "abd", "x" };
+        ASSERT_EQ( keys( *tree ), expected );
+        ASSERT_FALSE( tree->exists( "d", false ) );
+    }
+}
+
+
+TEST_F( test_prefix_tree, test_difference )
+{
+    for ( bool parallel : { false, true } )
+    {
+        SetUp();
+
+        prefix_tree::prefix_tree other;
+
+        ASSERT_TRUE( tree->append( "abc" ) );
+        ASSERT_TRUE( tree->append( "abcd" ) );
+        ASSERT_TRUE( tree->append( "abd" ) );
+        ASSERT_TRUE( tree->append( "def" ) );
+        ASSERT_TRUE( tree->append( "x" ) );
+
+        ASSERT_TRUE( other.append( "abcd" ) );
+        ASSERT_TRUE( other.append( "abd" ) );
+        ASSERT_TRUE( other.append( "def" ) );
+        ASSERT_TRUE( other.append( "y" ) );
+
+        tree->difference( other, parallel );
+
+        std::vector<std::string> expected = { "abc", "x" };
+        ASSERT_EQ( keys( *tree ), expected );
+        ASSERT_FALSE( tree->exists( "abd", false ) );
+        ASSERT_FALSE( tree->exists( "d", false ) );
+    }
+}
+
+
+TEST_F( test_prefix_tree, test_remove_prefix )
+{
+    ASSERT_TRUE( tree->append( "tenant1/a" ) );
+    ASSERT_TRUE( tree->append( "tenant1/b/c" ) );
+    ASSERT_TRUE( tree->append( "tenant1/" ) );
+    ASSERT_TRUE( tree->append( "tenant12" ) );
+    ASSERT_TRUE( tree->append( "tenant2/a" ) );
+
+    tree->remove_prefix( "tenant1/" );
+
+    std::vector<std::string> expected = { "tenant12", "tenant2/a" };
+    ASSERT_EQ( keys( *tree ), expected );
+
+    tree->remove_prefix( "tenant2/" );
+    ASSERT_FALSE( tree->exists( "tenant2", false ) );
+    ASSERT_TRUE( tree->exists( "tenant12" ) );
+
+    tree->remove_prefix( "missing" );
+    tree->remove_prefix( "" );
+    ASSERT_EQ( tree->begin( false ), tree->end() );
+}
+
+
+TEST_F( test_prefix_tree, test_extract_insert_subtree )
+{
+    prefix_tree::prefix_tree other;
+
+    ASSERT_TRUE( tree->append( "ab" ) );
+    ASSERT_TRUE( tree->append( "abc" ) );
+    ASSERT_TRUE( tree->append( "abde" ) );
+    ASSERT_TRUE( tree->append( "x" ) );
+
+    ASSERT_EQ( tree->extract_subtree( "zz" ), nullptr );
+
+    auto subtree = tree->extract_subtree( "ab" );
+    ASSERT_NE( subtree, nullptr );
+
+    std::vector<std::string> rest = { "x" };
+    ASSERT_EQ( keys( *tree ), rest );
+    ASSERT_FALSE( tree->exists( "a", false ) );
+
+    std::vector<std::string> relative = { "c", "de" };
+    ASSERT_EQ( keys( *subtree ), relative );
+    ASSERT_TRUE( subtree->exists( "" ) );
+
+    ASSERT_TRUE( other.append( "shard/abd" ) );
+    ASSERT_TRUE( other.insert_subtree( "shard/ab", std::move( subtree ) ) );
+    ASSERT_TRUE( other.insert_subtree( "new/", tree->extract_subtree( "" ) ) );
+
+    std::vector<std::string> expected = { "new/x", "shard/ab", "shard/abc", "shard/abd", "shard/abde" };
+    ASSERT_EQ( keys( other ), expected );
+    ASSERT_EQ( tree->begin( false ), tree->end() );
+
+    auto it = other.begin( true );
+    while ( it.get_key() != "shard/abde" )
+        ++it;
+    --it;
+    ASSERT_EQ( "shard/abd", it.get_key() );
+}
+
+
+TEST_F( test_prefix_tree, test_find_key )
+{
+    ASSERT_TRUE( tree->append( "abc" ) );
+    ASSERT_TRUE( tree->append( "abd" ) );
+
+    auto it = tree->find( "abc" );
+    ASSERT_NE( it, tree->end() );
+    ASSERT_EQ( "abc", it.get_key() );
+    ++it;
+    ASSERT_EQ( "abd", it.get_key() );
+
+    ASSERT_EQ( tree->find( "ab" ), tree->end() );
+    ASSERT_EQ( "ab", tree->find( std::string( "ab" ), false ).get_key() );
+    ASSERT_EQ( tree->find( "abx" ), tree->end() );
+}
+
+
+TEST_F( test_prefix_tree, test_binary_order )
+{
+    static const std::string TEST_KEY   = "a";
+    static const std::string TEST_KEY1  = "a\x7f";
+    static const std::string TEST_KEY2  = "a\x80";
+    static const std::string TEST_KEY3  = "\xff";
+
+    ASSERT_TRUE( tree->append( TEST_KEY3 ) );
+    ASSERT_TRUE( tree->append( TEST_KEY2 ) );
+    ASSERT_TRUE( tree->append( TEST_KEY1 ) );
+    ASSERT_TRUE( tree->append( TEST_KEY ) );
+
+    std::vector<std::string> expected = { TEST_KEY, TEST_KEY1, TEST_KEY2, TEST_KEY3 };
+    ASSERT_EQ( keys( *tree ), expected );
+}
+
+
+TEST_F( test_prefix_tree, test_wide_nodes )
+{
+    std::set<std::string> expected;
+    std::mt19937 rnd( 1 );
+
+    for ( int i = 0; i < 20000; ++i )
+    {
+        std::string key( 1 + rnd() % 3, ' ' );
+        for ( auto &c : key )
+            c = static_cast<char>( 1 + rnd() % 255 );
+
+        if ( rnd() % 3 )
+        {
+            ASSERT_TRUE( tree->append( key ) );
+            expected.insert( key );
+        }
+        else
+        {
+            tree->remove( key );
+            expected.erase( key );
+        }
+    }
+
+    ASSERT_EQ( keys( *tree ), std::vector<std::string>( expected.begin(), expected.end() ) );
+
+    auto it = tree->begin( true );
+    for ( size_t i = 1; i < expected.size(); ++i )
+        ++it;
+    for ( auto rit = expected.rbegin(); rit != expected.rend(); ++rit, --it )
+        ASSERT_EQ( *rit, it.get_key() );
+    ASSERT_EQ( it, tree->end() );
+}
+
+
+TEST_F( test_prefix_tree, test_memory_usage )
+{
+    ASSERT_LE( sizeof( prefix_tree::prefix_tree ), 16 );
+
+    auto empty = tree->memory_usage();
+    ASSERT_EQ( empty.nodes, 1 );
+    ASSERT_EQ( empty.leaves, 1 );
+    ASSERT_EQ( empty.container_bytes, 0 );
+
+    ASSERT_TRUE( tree->append( "abc" ) );
+    ASSERT_TRUE( tree->append( "abd" ) );
+
+    // Single child chains are kept in node itself, only "ab" has block.
+    auto usage = tree->memory_usage();
+    ASSERT_EQ( usage.nodes, 5 );
+    ASSERT_EQ( usage.leaves, 2 );
+    ASSERT_EQ( usage.node_bytes, 5 * sizeof( prefix_tree::prefix_tree ) );
+    ASSERT_GT( usage.container_bytes, 0 );
+    ASSERT_EQ( usage.total(), usage.node_bytes + usage.container_bytes );
+}
+
+
+TEST_F( test_prefix_tree, test_stats )
+{
+    ASSERT_TRUE( tree->append( "abcd" ) );
+    ASSERT_TRUE( tree->append( "abce" ) );
+    ASSERT_TRUE( tree->append( "x" ) );
+    ASSERT_TRUE( tree->append( "xyz" ) );
+
+    auto stats = tree->stats();
+
+    ASSERT_EQ( stats.nodes, 9 );
+    ASSERT_EQ( stats.finite_nodes, 4 );
+    ASSERT_EQ( stats.non_finite_nodes, 5 );
+    ASSERT_EQ( stats.node_bytes, 9 * sizeof( prefix_tree::prefix_tree ) );
+    ASSERT_EQ( stats.value_bytes, 0 );
+    ASSERT_EQ( stats.container_bytes, tree->memory_usage().container_bytes );
+
+    std::vector<size_t> depth   = { 1, 2, 2, 2, 2 };
+    std::vector<size_t> fan_out = { 3, 4, 2 };
+    // Chains are "a", "ab" (ends at "abc" with two children) and "xy".
+    std::vector<size_t> chain   = { 0, 1, 1 };
+
+    ASSERT_EQ( stats.depth, depth );
+    ASSERT_EQ( stats.fan_out, fan_out );
+    ASSERT_EQ( stats.chain_length, chain );
+}
+
+
+TEST_F( test_prefix_tree, test_relayout )
+{
+    std::set<std::string> expected;
+    std::mt19937 rnd( 2 );
+
+    auto random_key = [&] ()
+    {
+        std::string key( 1 + rnd() % 8, ' ' );
+        for ( auto &c : key )
+            c = static_cast<char>( 'a' + rnd() % 6 );
+        return key;
+    };
+
+    for ( int i = 0; i < 20000; ++i )
+    {
+        std::string key = random_key();
+        ASSERT_TRUE( tree->append( key ) );
+        expected.insert( key );
+    }
+
+    auto usage = tree->memory_usage();
+    tree->relayout();
+    ASSERT_EQ( keys( *tree ), std::vector<std::string>( expected.begin(), expected.end() ) );
+    ASSERT_EQ( tree->memory_usage().nodes, usage.nodes );
+
+    // The tree stays usable: nodes are mixed from arena and heap.
+    for ( int i = 0; i < 20000; ++i )
+    {
+        std::string key = random_key();
+        if ( rnd() % 2 )
+        {
+            ASSERT_TRUE( tree->append( key ) );
+            expected.insert( key );
+        }
+        else
+        {
+            tree->remove( key );
+            expected.erase( key );
+        }
+    }
+    ASSERT_EQ( keys( *tree ), std::vector<std::string>( expected.begin(), expected.end() ) );
+
+    tree->relayout();
+    ASSERT_EQ( keys( *tree ), std::vector<std::string>( expected.begin(), expected.end() ) );
+
+    // Subtree outlives relayout of its former tree.
+    auto subtree = tree->extract_subtree( "ab" );
+    tree->relayout();
+    ASSERT_FALSE( tree->exists( "ab", false ) );
+
+    for ( const auto &key : expected )
+        tree->remove( key );
+    ASSERT_EQ( tree->begin( true ), tree->end() );
+    ASSERT_TRUE( subtree->exists( "", false ) );
+}
+
+
+TEST_F( test_prefix_tree, test_long_keys )
+{
+    // Deep enough to overflow stack of recursive implementation.
+    const size_t LEN = 500000;
+
+    std::string key( LEN, 'a' );
+    std::string key1 = key;
+    key1[ LEN / 2 ] = 'b';
+
+    ASSERT_TRUE( tree->append( key ) );
+    ASSERT_TRUE( tree->append( key1 ) );
+    ASSERT_TRUE( tree->append( key.substr( 0, LEN / 4 ) ) );
+
+    ASSERT_TRUE( tree->exists( key ) );
+    ASSERT_TRUE( tree->exists( key1 ) );
+    ASSERT_FALSE( tree->exists( key.substr( 0, LEN / 3 ) ) );
+    ASSERT_TRUE( tree->exists( key.substr( 0, LEN / 3 ), false ) );
+    ASSERT_EQ( tree->find( key1 ).get_key(), key1 );
+
+    tree->remove( key );
+    ASSERT_FALSE( tree->exists( key ) );
+    ASSERT_FALSE( tree->exists( key.substr( 0, LEN / 2 + 1 ), false ) );
+    ASSERT_TRUE( tree->exists( key1 ) );
+    ASSERT_EQ( tree->memory_usage().nodes, LEN + 1 );
+
+    tree->remove( key.substr( 0, LEN / 4 ) );
+    ASSERT_EQ( tree->memory_usage().nodes, LEN + 1 );
+    ASSERT_EQ( keys( *tree ), std::vector<std::string>( 1, key1 ) );
+
+    // Destructor of deep tree.
+    tree.reset( new prefix_tree::prefix_tree() );
+    ASSERT_TRUE( tree->append( key ) );
+    tree.reset();
+}
+
+
+TEST_F( test_prefix_tree, test_append_sorted )
+{
+    std::vector<std::string> words = { "b", "ab", "abc", "", "a", "abd", "b", "ba", "\xff", "a\x01" };
+
+    ASSERT_EQ( tree->append_sorted( words.begin(), words.end() ), words.size() - 1 );
+
+    std::set<std::string> expected( words.begin(), words.end() );
+    expected.erase( "" );
+    ASSERT_EQ( keys( *tree ), std::vector<std::string>( expected.begin(), expected.end() ) );
+    ASSERT_TRUE( tree->exists( "" ) );
+
+    std::sort( words.begin(), words.end() );
+    prefix_tree::prefix_tree sorted;
+    ASSERT_EQ( sorted.append_sorted( words.begin(), words.end() ), words.size() - 1 );
+    ASSERT_EQ( keys( sorted ), keys( *tree ) );
+
+    // Second pass appends nothing and creates no nodes.
+    size_t nodes = sorted.memory_usage().nodes;
+    ASSERT_EQ( sorted.append_sorted( words.begin(), words.end() ), 0 );
+    ASSERT_EQ( sorted.memory_usage().nodes, nodes );
+    ASSERT_EQ( nodes, tree->memory_usage().nodes );
+}
+
+
+TEST_F( test_prefix_tree, test_lower_upper_bound )
+{
+    std::mt19937 rnd( 11 );
+    auto word = [&] ( size_t max_len )
+    {
+        std::string w( rnd() % ( max_len + 1 ), 'a' );
+        for ( auto &c : w )
+            c = "abcd\xfe"[ rnd() % 5 ];
+        return w;
+    };
+
+    std::set<std::string> finite, all;
+    for ( size_t i = 0; i < 300; ++i )
+    {
+        std::string w = word( 6 );
+        if ( w.empty() )
+            continue;
+
+        tree->append( w );
+        finite.insert( w );
+        for ( size_t len = 1; len <= w.size(); ++len )
+            all.insert( w.substr( 0, len ) );
+    }
+
+    for ( size_t i = 0; i < 2000; ++i )
+    {
+        std::string probe = word( 7 );
+
+        for ( bool finite_only : { true, false } )
+        {
+            const std::set<std::string> &expected = finite_only ? finite : all;
+
+            auto lower = tree->lower_bound( probe, finite_only );
+            auto it    = expected.lower_bound( probe );
+            if ( it == expected.end() )
+                ASSERT_EQ( lower, tree->end() ) << probe;
+            else
+                ASSERT_EQ( lower.get_key(), *it ) << probe;
+
+            auto upper = tree->upper_bound( probe, finite_only );
+            it         = expected.upper_bound( probe );
+            if ( it == expected.end() )
+                ASSERT_EQ( upper, tree->end() ) << probe;
+            else
+                ASSERT_EQ( upper.get_key(), *it ) << probe;
+        }
+    }
+
+    ASSERT_EQ( tree->lower_bound( "" ), tree->begin( true ) );
+    ASSERT_EQ( tree->lower_bound( "\xff" ), tree->end() );
+    ASSERT_EQ( tree->lower_bound( nullptr ), tree->end() );
+}
+
+
+TEST_F( test_prefix_tree, test_range )
+{
+    std::set<std::string> expected;
+    for ( size_t i = 0; i < 1000; ++i )
+    {
+        std::string key = std::to_string( i * 7 );
+        tree->append( key );
+        expected.insert( key );
+    }
+
+    auto collect = [] ( std::pair<prefix_tree::prefix_tree::iterator, prefix_tree::prefix_tree::iterator> r )
+    {
+        std::vector<std::string> result;
+        for ( auto it = r.first; it != r.second; ++it )
+            result.push_back( it.get_key() );
+        return result;
+    };
+
+    for ( const auto &bounds : std::vector<std::pair<std::string, std::string> >{ { "1", "2" }, { "10", "105" }, { "", "~" }, { "5", "5" }, { "6", "5" }, { "699", "7" } } )
+    {
+        std::vector<std::string> slice(
+                    expected.lower_bound( bounds.first ),
+                    bounds.first < bounds.second ? expected.lower_bound( bounds.second ) : expected.lower_bound( bounds.first )
+        );
+        ASSERT_EQ( collect( tree->range( bounds.first, bounds.second ) ), slice ) << bounds.first << " " << bounds.second;
+    }
+
+    // Pagination by cursor: next page starts after last key of previous one.
+    std::vector<std::string> paged;
+    std::string cursor;
+    for ( bool first = true; ; first = false )
+    {
+        auto it = first ? tree->begin( true ) : tree->upper_bound( cursor );
+        size_t n = 0;
+        for ( ; it != tree->end() && n < 64; ++it, ++n )
+            paged.push_back( cursor = it.get_key() );
+        if ( it == tree->end() )
+            break;
+    }
+    ASSERT_EQ( paged, std::vector<std::string>( expected.begin(), expected.end() ) );
+}
+
+
+TEST_F( test_prefix_tree, test_remove_lazy )
+{
+    std::set<std::string> expected;
+    for ( size_t i = 0; i < 2000; ++i )
+    {
+        std::string key = "k" + std::to_string( i * 13 );
+        tree->append( key );
+        expected.insert( key );
+    }
+
+    ASSERT_FALSE( tree->compact( 100 ) );
+    ASSERT_FALSE( tree->remove_lazy( "k1" ) );
+    ASSERT_FALSE( tree->remove_lazy( "" ) );
+
+    size_t nodes = tree->memory_usage().nodes;
+    for ( size_t i = 0; i < 2000; i += 2 )
+    {
+        std::string key = "k" + std::to_string( i * 13 );
+        ASSERT_TRUE( tree->remove_lazy( key ) );
+        expected.erase( key );
+    }
+
+    // Removed keys are invisible, nodes are not freed yet.
+    ASSERT_EQ( tree->memory_usage().nodes, nodes );
+    ASSERT_FALSE( tree->exists( "k0" ) );
+    ASSERT_TRUE( tree->exists( "k13" ) );
+    ASSERT_TRUE( tree->append( "k26" ) );
+    expected.insert( "k26" );
+
+    std::vector<std::string> keys;
+    for ( auto it = tree->begin( true ); it != tree->end(); ++it )
+        keys.push_back( it.get_key() );
+    ASSERT_EQ( keys, std::vector<std::string>( expected.begin(), expected.end() ) );
+
+    // Tombstones survive relayout.
+    tree->relayout();
+
+    size_t calls = 1;
+    while ( tree->compact( 16 ) )
+        ++calls;
+    ASSERT_GT( calls, 10 );
+    ASSERT_FALSE( tree->compact( 16 ) );
+
+    prefix_tree::prefix_tree fresh;
+    for ( const auto &key : expected )
+        fresh.append( key );
+    ASSERT_EQ( tree->memory_usage().nodes, fresh.memory_usage().nodes );
+
+    keys.clear();
+    for ( auto it = tree->begin( true ); it != tree->end(); ++it )
+        keys.push_back( it.get_key() );
+    ASSERT_EQ( keys, std::vector<std::string>( expected.begin(), expected.end() ) );
+
+    // Removal of all keys by zero budget calls.
+    for ( const auto &key : expected )
+        tree->remove_lazy( key );
+    while ( tree->compact( 0 ) )
+        ;
+    ASSERT_EQ( tree->memory_usage().nodes, 1 );
+}
+
+
+TEST_F( test_prefix_tree, test_remove_lazy_prefixes )
+{
+    prefix_tree::prefix_tree eager;
+    std::vector<std::string> prefixes;
+    for ( size_t i = 0; i < 500; ++i )
+    {
+        std::string key = "p" + std::to_string( i * 7 );
+        tree->append( key );
+        eager.append( key );
+        for ( size_t len = 0; len <= key.size(); ++len )
+            prefixes.push_back( key.substr( 0, len ) );
+    }
+
+    for ( size_t i = 0; i < 500; i += 3 )
+    {
+        std::string key = "p" + std::to_string( i * 7 );
+        ASSERT_TRUE( tree->remove_lazy( key ) );
+        eager.remove( key );
+    }
+
+    // Prefixes left without keys are invisible as after remove().
+    ASSERT_FALSE( tree->exists( "p0", false ) );
+    ASSERT_FALSE( tree->find( "p0", false ) );
+    for ( const auto &prefix : prefixes )
+    {
+        ASSERT_EQ( tree->exists( prefix, false ), eager.exists( prefix, false ) ) << prefix;
+        ASSERT_EQ( tree->lower_bound( prefix, false ).get_key(), eager.lower_bound( prefix, false ).get_key() ) << prefix;
+        ASSERT_EQ( tree->upper_bound( prefix, false ).get_key(), eager.upper_bound( prefix, false ).get_key() ) << prefix;
+    }
+
+    auto all_nodes = [] ( prefix_tree::prefix_tree &t )
+    {
+        std::vector<std::string> keys;
+        for ( auto it = t.begin( false ); it != t.end(); ++it )
+            keys.push_back( it.get_key() );
+        return keys;
+    };
+
+    // Backward from the last node.
+    auto all_nodes_back = [] ( prefix_tree::prefix_tree &t, const std::string &last )
+    {
+        std::vector<std::string> keys;
+        for ( auto it = t.lower_bound( last, false ); it; --it )
+            keys.push_back( it.get_key() );
+        return keys;
+    };
+
+    auto forward = all_nodes( *tree );
+    ASSERT_EQ( forward, all_nodes( eager ) );
+    ASSERT_EQ( all_nodes_back( *tree, forward.back() ), all_nodes_back( eager, forward.back() ) );
+    ASSERT_EQ( all_nodes_back( *tree, forward.back() ).size(), forward.size() );
+
+    // Append revives the prefix.
+    tree->append( "p0" );
+    ASSERT_TRUE( tree->exists( "p", false ) );
+    ASSERT_TRUE( tree->exists( "p0", false ) );
+}
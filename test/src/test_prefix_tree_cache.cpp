@@ -0,0 +1,193 @@
+#include <random>
+#include <stdexcept>
+
+#include "test_prefix_tree_cache.h"
+
+
+
+void test_prefix_tree_cache::SetUp()
+{
+    for ( size_t i = 0; i < 1000; ++i )
+        keys.push_back( "/usr/lib/" + std::to_string( i ) );
+}
+
+
+void test_prefix_tree_cache::TearDown()
+{
+    keys.clear();
+}
+
+
+
+TEST_F( test_prefix_tree_cache, test_unbounded )
+{
+    prefix_tree::prefix_tree_cache<size_t> cache;
+
+    for ( size_t i = 0; i < keys.size(); ++i )
+        EXPECT_EQ( cache.put( keys[ i ], i ), i );
+    EXPECT_EQ( cache.size(), keys.size() );
+
+    for ( size_t i = 0; i < keys.size(); ++i )
+    {
+        ASSERT_NE( cache.get( keys[ i ] ), nullptr );
+        EXPECT_EQ( *cache.get( keys[ i ] ), i );
+    }
+    EXPECT_EQ( cache.get( "/usr/lib" ), nullptr );
+    EXPECT_EQ( cache.get( "" ), nullptr );
+
+    cache.put( keys[ 0 ], 7 );
+    EXPECT_EQ( *cache.get( keys[ 0 ] ), 7 );
+    EXPECT_EQ( cache.size(), keys.size() );
+
+    EXPECT_TRUE( cache.remove( keys[ 0 ] ) );
+    EXPECT_FALSE( cache.remove( keys[ 0 ] ) );
+    EXPECT_EQ( cache.get( keys[ 0 ] ), nullptr );
+
+    auto stats = cache.stats();
+    EXPECT_EQ( stats.hits, 2 * keys.size() + 1 );
+    EXPECT_EQ( stats.misses, 3 );
+    EXPECT_EQ( stats.evictions, 0 );
+    EXPECT_EQ( stats.entries, keys.size() - 1 );
+
+    cache.reset_stats();
+    EXPECT_EQ( cache.stats().hits, 0 );
+    EXPECT_EQ( cache.stats().hit_rate(), 0 );
+}
+
+
+TEST_F( test_prefix_tree_cache, test_clock )
+{
+    prefix_tree::prefix_tree_cache<size_t>::options opts;
+    opts.max_entries = 100;
+
+    prefix_tree::prefix_tree_cache<size_t> cache( opts );
+
+    // Hot entries are read between inserts, the rest is read once.
+    for ( size_t i = 0; i < keys.size(); ++i )
+    {
+        cache.put( keys[ i ], i );
+        for ( size_t hot = 0; hot < 10; ++hot )
+        {
+            if ( !cache.get( keys[ hot ] ) )
+                cache.put( keys[ hot ], hot );
+        }
+        EXPECT_LE( cache.size(), 100 );
+    }
+
+    for ( size_t hot = 0; hot < 10; ++hot )
+        EXPECT_NE( cache.get( keys[ hot ] ), nullptr );
+
+    auto stats = cache.stats();
+    EXPECT_EQ( stats.entries, 100 );
+    EXPECT_GE( stats.evictions, keys.size() - 100 );
+    EXPECT_GT( stats.hit_rate(), 0.99 );
+
+    // Iteration sees entries which are left only.
+    size_t count = 0;
+    for ( auto it = cache.begin(); it != cache.end(); ++it )
+    {
+        EXPECT_EQ( *cache.get( it.get_key() ), it.get_value() );
+        ++count;
+    }
+    EXPECT_EQ( count, 100 );
+}
+
+
+TEST_F( test_prefix_tree_cache, test_empty_key )
+{
+    prefix_tree::prefix_tree_cache<size_t>::options opts;
+    opts.max_entries = 1;
+    prefix_tree::prefix_tree_cache<size_t> cache( opts );
+
+    // Root is not an entry: empty key is rejected, eviction stays valid.
+    EXPECT_THROW( cache.put( "", 1 ), std::invalid_argument );
+    EXPECT_EQ( cache.size(), 0 );
+    EXPECT_EQ( cache.get( "" ), nullptr );
+
+    cache.put( keys[ 0 ], 1 );
+    EXPECT_THROW( cache.put( "", 2 ), std::invalid_argument );
+    cache.put( keys[ 1 ], 2 );
+    EXPECT_EQ( cache.size(), 1 );
+    EXPECT_EQ( cache.stats().evictions, 1 );
+    EXPECT_EQ( *cache.get( keys[ 1 ] ), 2 );
+}
+
+
+TEST_F( test_prefix_tree_cache, test_bytes )
+{
+    prefix_tree::prefix_tree_cache<std::string>::options opts;
+    opts.max_bytes = 4096;
+
+    prefix_tree::prefix_tree_cache<std::string> cache( opts );
+
+    std::mt19937_64 rnd( 42 );
+    for ( size_t i = 0; i < 10000; ++i )
+    {
+        const std::string &key = keys[ rnd() % keys.size() ];
+        if ( !cache.get( key ) )
+            cache.put( key, key );
+        EXPECT_LE( cache.stats().bytes, opts.max_bytes );
+    }
+
+    auto stats = cache.stats();
+    EXPECT_GT( stats.evictions, 0 );
+    EXPECT_EQ( stats.hits + stats.misses, 10000 );
+    EXPECT_EQ( stats.evictions + stats.entries, stats.misses );
+
+    // Nodes of evicted keys are pruned.
+    prefix_tree::prefix_tree_map<std::string> same;
+    for ( auto it = cache.begin(); it != cache.end(); ++it )
+        same.append( it.get_key(), it.get_value() );
+    EXPECT_EQ( cache.memory_usage().nodes, same.memory_usage().nodes );
+
+    // Bytes are nodes and blocks without root plus values.
+    auto usage = cache.memory_usage();
+    auto empty = prefix_tree::prefix_tree_map<std::string>().memory_usage();
+    EXPECT_EQ( stats.bytes, usage.node_bytes + usage.container_bytes - empty.node_bytes +
+                            stats.entries * sizeof( std::string ) );
+
+    // Entry larger than budget is kept alone.
+    cache.put( std::string( opts.max_bytes, 'x' ), "big" );
+    EXPECT_EQ( cache.size(), 1 );
+    EXPECT_EQ( *cache.get( std::string( opts.max_bytes, 'x' ) ), "big" );
+}
+
+
+TEST_F( test_prefix_tree_cache, test_value_bytes )
+{
+    const std::string big( 8 * 1024, 'v' );
+
+    prefix_tree::prefix_tree_cache<std::string>::options opts;
+    opts.max_bytes = 64 * 1024;
+
+    // Default size of value is sizeof, nodes of keys fit the budget.
+    prefix_tree::prefix_tree_cache<std::string> by_sizeof( opts );
+    for ( size_t i = 0; i < 100; ++i )
+        by_sizeof.put( keys[ i ], big );
+    EXPECT_EQ( by_sizeof.size(), 100 );
+    EXPECT_EQ( by_sizeof.stats().evictions, 0 );
+
+    // Heap of values drives eviction: at most 7 values of 8 KB fit.
+    opts.value_bytes = [] ( const std::string &value ) { return sizeof( value ) + value.capacity(); };
+
+    prefix_tree::prefix_tree_cache<std::string> cache( opts );
+    for ( size_t i = 0; i < 100; ++i )
+    {
+        cache.put( keys[ i ], big );
+        EXPECT_LE( cache.stats().bytes, opts.max_bytes );
+    }
+    EXPECT_LE( cache.size(), 7 );
+    EXPECT_EQ( cache.stats().evictions + cache.size(), 100 );
+
+    // Value growing in place evicts other entries.
+    prefix_tree::prefix_tree_cache<std::string> grow( opts );
+    for ( size_t i = 0; i < 10; ++i )
+        grow.put( keys[ i ], "v" );
+    EXPECT_EQ( grow.size(), 10 );
+
+    // Value with nodes of its key exceeds budget, it is kept alone.
+    grow.put( keys[ 0 ], std::string( opts.max_bytes - 64, 'v' ) );
+    EXPECT_EQ( grow.size(), 1 );
+    EXPECT_EQ( grow.get( keys[ 0 ] )->size(), opts.max_bytes - 64 );
+    EXPECT_EQ( grow.stats().evictions, 9 );
+}
@@ -0,0 +1,19 @@
+#ifndef TEST_PREFIX_TREE_CACHE_H
+#define TEST_PREFIX_TREE_CACHE_H
+
+#include <gtest/gtest.h>
+#include "prefix_tree/prefix_tree_cache.h"
+
+class test_prefix_tree_cache : public testing::Test
+{
+public:
+    std::vector<std::string>    keys;
+
+public:
+    test_prefix_tree_cache() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // TEST_PREFIX_TREE_CACHE_H
@@ -1,7 +1,56 @@
+#include <array>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 #include "test_prefix_tree_map.h"
 #include "prefix_tree/prefix_tree_map.h"
 
 
+namespace
+{
+
+
+/**
+ * @brief The counted struct    Value counting alive objects and copies.
+ */
+struct counted
+{
+    static int  alive;
+    static int  copies;
+
+    std::string payload;
+
+    counted() : payload() { ++alive; }
+    counted( const std::string &payload_, int repeat ) : payload() { ++alive; for ( int i = 0; i < repeat; ++i ) payload += payload_; }
+    counted( const counted &other ) : payload( other.payload ) { ++alive; ++copies; }
+    counted( counted &&other ) : payload( std::move( other.payload ) ) { ++alive; }
+    ~counted() { --alive; }
+
+    counted& operator=( const counted &other ) { payload = other.payload; ++copies; return *this; }
+    counted& operator=( counted &&other ) { payload = std::move( other.payload ); return *this; }
+};
+
+int counted::alive  = 0;
+int counted::copies = 0;
+
+
+/// @brief The throwing struct  Value whose constructor throws on negative argument.
+struct throwing
+{
+    std::array<char, 64>    data;
+
+    explicit throwing( int x ) : data()
+    {
+        if ( x < 0 )
+            throw std::runtime_error( "negative" );
+    }
+};
+
+
+} // namespace
+
+
 
 void test_prefix_tree_map::SetUp()
 {
@@ -55,3 +104,363 @@ TEST_F( test_prefix_tree_map, test_append )
     ASSERT_NE( it, tree->end() );
     ASSERT_EQ( it.get_value(), TEST_VALUE4 );
 }
+
+
+TEST_F( test_prefix_tree_map, test_merge )
+{
+    prefix_tree::prefix_tree_map<int> other;
+
+    ASSERT_TRUE( tree->append( "abc", 1 ) );
+    ASSERT_TRUE( tree->append( "x", 2 ) );
+
+    ASSERT_TRUE( other.append( "ab", 10 ) );
+    ASSERT_TRUE( other.append( "abc", 20 ) );
+    ASSERT_TRUE( other.append( "xyz", 30 ) );
+
+    tree->merge( std::move( other ) );
+
+    ASSERT_EQ( tree->find( "ab" ).get_value(), 10 );
+    ASSERT_EQ( tree->find( "abc" ).get_value(), 1 );
+    ASSERT_EQ( tree->find( "x" ).get_value(), 2 );
+    ASSERT_EQ( tree->find( "xyz" ).get_value(), 30 );
+}
+
+
+TEST_F( test_prefix_tree_map, test_merge_root_value )
+{
+    for ( bool parallel : { false, true } )
+    {
+        counted::alive = 0;
+        {
+            prefix_tree::prefix_tree_map<counted> map, other;
+            map.emplace( "a", "x", 1 );
+            other.emplace( "", "root", 1 );
+            other.emplace( "b", "y", 1 );
+            other.emplace( "c", "z", 1 );
+
+            map.merge( std::move( other ), parallel );
+
+            // Value of root is moved and other is empty.
+            ASSERT_EQ( map.get_value( "" )->payload, "root" );
+            ASSERT_FALSE( other.exists( "" ) );
+            ASSERT_EQ( other.begin(), other.end() );
+            ASSERT_EQ( counted::alive, 4 );
+        }
+        ASSERT_EQ( counted::alive, 0 );
+    }
+}
+
+
+TEST_F( test_prefix_tree_map, test_intersect_difference )
+{
+    prefix_tree::prefix_tree_map<int> other;
+
+    ASSERT_TRUE( tree->append( "abc", 1 ) );
+    ASSERT_TRUE( tree->append( "abd", 2 ) );
+    ASSERT_TRUE( tree->append( "x", 3 ) );
+
+    ASSERT_TRUE( other.append( "abc", 10 ) );
+    ASSERT_TRUE( other.append( "x", 30 ) );
+
+    prefix_tree::prefix_tree_map<int> diff;
+    ASSERT_TRUE( diff.append( "abc", 1 ) );
+    ASSERT_TRUE( diff.append( "abd", 2 ) );
+    ASSERT_TRUE( diff.append( "x", 3 ) );
+
+    tree->intersect( other, true );
+    ASSERT_EQ( tree->find( "abc" ).get_value(), 1 );
+    ASSERT_EQ( tree->find( "x" ).get_value(), 3 );
+    ASSERT_FALSE( tree->exists( "abd" ) );
+
+    diff.difference( other );
+    ASSERT_EQ( diff.find( "abd" ).get_value(), 2 );
+    ASSERT_FALSE( diff.exists( "abc" ) );
+    ASSERT_FALSE( diff.exists( "x" ) );
+}
+
+
+TEST_F( test_prefix_tree_map, test_extract_insert_subtree )
+{
+    ASSERT_TRUE( tree->append( "t1/", 1 ) );
+    ASSERT_TRUE( tree->append( "t1/a", 2 ) );
+    ASSERT_TRUE( tree->append( "t2/a", 3 ) );
+
+    prefix_tree::prefix_tree_map<int> other;
+    ASSERT_TRUE( other.insert_subtree( "moved/", tree->extract_subtree( "t1/" ) ) );
+
+    ASSERT_EQ( other.find( "moved/" ).get_value(), 1 );
+    ASSERT_EQ( other.find( "moved/a" ).get_value(), 2 );
+    ASSERT_FALSE( tree->exists( "t1/a" ) );
+
+    tree->remove_prefix( "t2" );
+    ASSERT_EQ( tree->begin(), tree->end() );
+}
+
+
+TEST_F( test_prefix_tree_map, test_stats )
+{
+    ASSERT_TRUE( tree->append( "ab", 1 ) );
+    ASSERT_TRUE( tree->append( "ac", 2 ) );
+
+    auto stats = tree->stats();
+
+    ASSERT_EQ( stats.nodes, 4 );
+    ASSERT_EQ( stats.finite_nodes, 2 );
+    // Small values are kept inline.
+    ASSERT_EQ( stats.value_bytes, 0 );
+    ASSERT_EQ( stats.total_bytes(), tree->memory_usage().total() );
+}
+
+
+TEST_F( test_prefix_tree_map, test_value_storage )
+{
+    typedef std::array<char, 200> large_value;
+
+    // Size of node does not depend on type of value.
+    ASSERT_EQ( sizeof( prefix_tree::prefix_tree_map<char> ), sizeof( prefix_tree::prefix_tree_map<large_value> ) );
+    ASSERT_EQ( sizeof( prefix_tree::prefix_tree_map<int> ), sizeof( prefix_tree::prefix_tree ) + sizeof( void* ) );
+
+    prefix_tree::prefix_tree_map<large_value> map;
+    large_value value;
+    value.fill( 'a' );
+
+    ASSERT_TRUE( map.append( "abc", value ) );
+    value.fill( 'b' );
+    ASSERT_TRUE( map.append( "ab", value ) );
+    ASSERT_TRUE( map.emplace( "xyz" ).second );
+
+    auto stats = map.stats();
+    ASSERT_EQ( stats.nodes, 7 );
+    ASSERT_EQ( stats.value_bytes, 3 * sizeof( large_value ) );
+    ASSERT_EQ( stats.total_bytes(), map.memory_usage().total() );
+
+    ASSERT_EQ( map.find( "abc" ).get_value()[ 0 ], 'a' );
+    ASSERT_EQ( map.find( "ab" ).get_value()[ 199 ], 'b' );
+
+    map.remove( "ab" );
+    ASSERT_EQ( map.stats().value_bytes, 2 * sizeof( large_value ) );
+    ASSERT_EQ( map.find( "abc" ).get_value()[ 0 ], 'a' );
+
+    // Storage of removed value is reused.
+    const char *removed = map.get_value( "xyz" )->data();
+    map.remove( "xyz" );
+    ASSERT_EQ( map.emplace( "klm" ).first.data(), removed );
+}
+
+
+TEST_F( test_prefix_tree_map, test_value_storage_threads )
+{
+    typedef std::array<char, 200> large_value;
+    typedef prefix_tree::prefix_tree_map<large_value> map_type;
+
+    // Values are allocated by threads and released by other thread: free
+    // lists of exited threads go back to the shared pool.
+    const size_t COUNT = 1000;
+    std::vector<map_type> maps( 4 );
+    std::vector<std::thread> threads;
+    for ( size_t t = 0; t < maps.size(); ++t )
+    {
+        threads.emplace_back( [&maps, t, COUNT] ()
+        {
+            large_value value;
+            value.fill( static_cast<char>( 'a' + t ) );
+            for ( size_t i = 0; i < COUNT; ++i )
+                maps[ t ].append( std::to_string( i ), value );
+            for ( size_t i = 0; i < COUNT; i += 2 )
+                maps[ t ].remove( std::to_string( i ) );
+        } );
+    }
+    for ( auto &thread : threads )
+        thread.join();
+
+    for ( size_t t = 0; t < maps.size(); ++t )
+    {
+        ASSERT_EQ( maps[ t ].stats().value_bytes, COUNT / 2 * sizeof( large_value ) );
+        ASSERT_EQ( maps[ t ].get_value( "1" )->front(), 'a' + t );
+        ASSERT_EQ( maps[ t ].get_value( "999" )->back(), 'a' + t );
+        ASSERT_EQ( maps[ t ].get_value( "0" ), nullptr );
+    }
+    maps.clear();
+
+    std::thread reuse( [] ()
+    {
+        map_type map;
+        for ( size_t i = 0; i < COUNT; ++i )
+            map.emplace( std::to_string( i ) ).first.fill( 'z' );
+        ASSERT_EQ( map.get_value( "500" )->front(), 'z' );
+    } );
+    reuse.join();
+}
+
+
+TEST_F( test_prefix_tree_map, test_emplace )
+{
+    counted::alive  = 0;
+    counted::copies = 0;
+
+    {
+        prefix_tree::prefix_tree_map<counted> map;
+
+        auto emplaced = map.emplace( "abc", "x", 3 );
+        ASSERT_TRUE( emplaced.second );
+        ASSERT_EQ( emplaced.first.payload, "xxx" );
+
+        auto present = map.try_emplace( std::string( "abc" ), "y", 1 );
+        ASSERT_FALSE( present.second );
+        ASSERT_EQ( &present.first, &emplaced.first );
+        ASSERT_EQ( present.first.payload, "xxx" );
+
+        // Interior nodes keep no values.
+        ASSERT_EQ( counted::alive, 1 );
+
+        counted value( "z", 2 );
+        ASSERT_FALSE( map.insert_or_assign( "abc", std::move( value ) ).second );
+        ASSERT_TRUE( map.insert_or_assign( "ab", counted( "w", 1 ) ).second );
+        ASSERT_EQ( map.find( "abc" ).get_value().payload, "zz" );
+
+        ASSERT_TRUE( map.append( std::string( "a" ), counted( "v", 1 ) ) );
+        map[ "abcd" ].payload = "u";
+        ASSERT_EQ( map[ std::string( "abcd" ) ].payload, "u" );
+        ASSERT_EQ( map.get_value( "ab" )->payload, "w" );
+        ASSERT_EQ( map.get_value( "abcde" ), nullptr );
+
+        map.find( "a" ).get_value().payload = "t";
+        ASSERT_EQ( map.get_value( "a" )->payload, "t" );
+        ASSERT_EQ( counted::copies, 0 );
+        ASSERT_EQ( counted::alive, 5 );
+
+        // Values are destroyed when keys are removed.
+        map.remove( "ab" );
+        map.remove( "abcd" );
+        ASSERT_EQ( counted::alive, 3 );
+
+        prefix_tree::prefix_tree_map<counted> other;
+        other.emplace( "ab", "s", 1 );
+        other.emplace( "abc", "r", 1 );
+        map.merge( std::move( other ) );
+        ASSERT_EQ( map.get_value( "ab" )->payload, "s" );
+        ASSERT_EQ( map.get_value( "abc" )->payload, "zz" );
+
+        prefix_tree::prefix_tree_map<counted> keys;
+        keys.emplace( "abc" );
+        map.difference( keys );
+        ASSERT_EQ( map.get_value( "abc" ), nullptr );
+
+        auto subtree = map.extract_subtree( "a" );
+        ASSERT_EQ( subtree->get_value( "" )->payload, "t" );
+        ASSERT_EQ( subtree->get_value( "b" )->payload, "s" );
+    }
+
+    ASSERT_EQ( counted::alive, 0 );
+    ASSERT_EQ( counted::copies, 0 );
+}
+
+
+TEST_F( test_prefix_tree_map, test_emplace_throws )
+{
+    prefix_tree::prefix_tree_map<throwing> map;
+    ASSERT_TRUE( map.emplace( "ab", 1 ).second );
+    size_t nodes = map.memory_usage().nodes;
+
+    // Nodes appended for the key are removed when constructor throws.
+    ASSERT_THROW( map.emplace( "abcdef", -1 ), std::runtime_error );
+    ASSERT_THROW( map.emplace( "xyz", -1 ), std::runtime_error );
+    ASSERT_EQ( map.memory_usage().nodes, nodes );
+
+    ASSERT_FALSE( map.exists( "abc", false ) );
+    ASSERT_FALSE( map.exists( "x", false ) );
+    ASSERT_TRUE( map.exists( "ab" ) );
+
+    // Prefix of present key keeps its nodes.
+    ASSERT_THROW( map.emplace( "a", -1 ), std::runtime_error );
+    ASSERT_EQ( map.memory_usage().nodes, nodes );
+    ASSERT_FALSE( map.exists( "a" ) );
+    ASSERT_TRUE( map.exists( "ab" ) );
+}
+
+
+TEST_F( test_prefix_tree_map, test_move_only_value )
+{
+    prefix_tree::prefix_tree_map<std::unique_ptr<int> > map;
+
+    ASSERT_TRUE( map.append( std::string( "abc" ), std::unique_ptr<int>( new int( 1 ) ) ) );
+    ASSERT_TRUE( map.emplace( "abd", new int( 2 ) ).second );
+    ASSERT_EQ( *map[ "abc" ], 1 );
+    ASSERT_EQ( *map.find( "abd" ).get_value(), 2 );
+    ASSERT_EQ( map[ "abe" ], nullptr );
+}
+
+
+TEST_F( test_prefix_tree_map, test_relayout )
+{
+    counted::alive = 0;
+
+    {
+        prefix_tree::prefix_tree_map<counted> map;
+        for ( int i = 0; i < 1000; ++i )
+            map.emplace( std::to_string( i * 7 ), std::to_string( i ), 1 );
+
+        map.relayout();
+        ASSERT_EQ( counted::alive, 1000 );
+
+        for ( int i = 0; i < 1000; ++i )
+            ASSERT_EQ( map.get_value( std::to_string( i * 7 ) )->payload, std::to_string( i ) );
+
+        map.remove( "0" );
+        ASSERT_EQ( counted::alive, 999 );
+    }
+
+    ASSERT_EQ( counted::alive, 0 );
+
+    tree->append( "abc", 1 );
+    tree->append( "abd", 2 );
+    tree->relayout();
+    ASSERT_EQ( tree->find( "abd" ).get_value(), 2 );
+}
+
+
+TEST_F( test_prefix_tree_map, test_range )
+{
+    for ( int i = 0; i < 100; ++i )
+        tree->append( std::to_string( i * 3 ), i );
+
+    auto it = tree->lower_bound( "100" );
+    ASSERT_EQ( it.get_key(), "102" );
+    ASSERT_EQ( it.get_value(), 34 );
+
+    it = tree->upper_bound( "102" );
+    ASSERT_EQ( it.get_key(), "105" );
+    ASSERT_EQ( tree->upper_bound( "99" ), tree->end() );
+
+    std::vector<int> values;
+    auto r = tree->range( "2", "21" );
+    for ( it = r.first; it != r.second; ++it )
+        values.push_back( it.get_value() );
+    ASSERT_EQ( values, std::vector<int>( { 67, 68, 69 } ) );
+}
+
+
+TEST_F( test_prefix_tree_map, test_remove_lazy )
+{
+    counted::alive = 0;
+
+    {
+        prefix_tree::prefix_tree_map<counted> map;
+        for ( int i = 0; i < 100; ++i )
+            map.emplace( std::to_string( i ), std::to_string( i ), 1 );
+
+        // Values are destroyed at once, nodes by compact().
+        for ( int i = 0; i < 100; i += 2 )
+            ASSERT_TRUE( map.remove_lazy( std::to_string( i ) ) );
+        ASSERT_EQ( counted::alive, 50 );
+        ASSERT_EQ( map.get_value( "10" ), nullptr );
+        ASSERT_EQ( map.get_value( "11" )->payload, "11" );
+
+        while ( map.compact( 4 ) )
+            ;
+        ASSERT_EQ( map.get_value( "99" )->payload, "99" );
+        ASSERT_EQ( counted::alive, 50 );
+    }
+
+    ASSERT_EQ( counted::alive, 0 );
+}
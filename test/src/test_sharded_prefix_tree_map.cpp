@@ -0,0 +1,183 @@
+#include <atomic>
+#include <random>
+#include <set>
+#include <thread>
+
+#include "test_sharded_prefix_tree_map.h"
+
+
+namespace
+{
+
+
+/**
+ * @brief check_sorted  Fill map with keys and check for_each order and values.
+ */
+template <typename map_t>
+void check_sorted( map_t &map, const std::vector<std::string> &keys )
+{
+    for ( size_t i = 0; i < keys.size(); ++i )
+        ASSERT_TRUE( map.insert_or_assign( keys[ i ], i ) );
+
+    std::set<std::string> expected( keys.begin(), keys.end() );
+    std::vector<std::string> visited;
+
+    map.for_each(
+        [&] ( const std::string &key, const size_t &value )
+        {
+            ASSERT_EQ( keys[ value ], key );
+            visited.push_back( key );
+        }
+    );
+
+    ASSERT_EQ( visited, std::vector<std::string>( expected.begin(), expected.end() ) );
+}
+
+
+} // namespace
+
+
+
+void test_sharded_prefix_tree_map::SetUp()
+{
+    std::mt19937_64 rnd( 7 );
+    std::set<std::string> unique;
+
+    while ( unique.size() < 5000 )
+    {
+        std::string key( 1 + rnd() % 12, 'a' );
+        for ( auto &c : key )
+            c = static_cast<char>( 1 + rnd() % 255 );
+        unique.insert( key );
+    }
+
+    keys.assign( unique.begin(), unique.end() );
+    std::shuffle( keys.begin(), keys.end(), rnd );
+}
+
+
+void test_sharded_prefix_tree_map::TearDown()
+{
+    keys.clear();
+}
+
+
+
+TEST_F( test_sharded_prefix_tree_map, test_update )
+{
+    prefix_tree::sharded_prefix_tree_map<std::string, 4> map;
+
+    ASSERT_TRUE( map.insert_or_assign( "abc", std::string( "1" ) ) );
+    ASSERT_FALSE( map.insert_or_assign( "abc", "2" ) );
+    ASSERT_TRUE( map.try_emplace( "zzz", 3, 'x' ) );
+    ASSERT_FALSE( map.try_emplace( "zzz", 1, 'y' ) );
+
+    std::string value;
+    ASSERT_TRUE( map.find( "abc", value ) );
+    ASSERT_EQ( value, "2" );
+    ASSERT_TRUE( map.find( "zzz", value ) );
+    ASSERT_EQ( value, "xxx" );
+    ASSERT_FALSE( map.find( "ab", value ) );
+
+    ASSERT_TRUE( map.update( "abc", [] ( std::string &v ) { v += "!"; } ) );
+    ASSERT_FALSE( map.update( "abd", [] ( std::string &v ) { v += "!"; } ) );
+    ASSERT_TRUE( map.find( "abc", value ) );
+    ASSERT_EQ( value, "2!" );
+
+    map.remove( "abc" );
+    ASSERT_FALSE( map.exists( "abc" ) );
+    ASSERT_TRUE( map.exists( "zzz" ) );
+    ASSERT_GT( map.memory_usage().nodes, 0 );
+
+    // nullptr key is rejected as by prefix_tree_map.
+    const char *none = nullptr;
+    ASSERT_FALSE( map.insert_or_assign( none, "x" ) );
+    ASSERT_FALSE( map.try_emplace( none, 1, 'x' ) );
+    ASSERT_FALSE( map.exists( none ) );
+    ASSERT_FALSE( map.find( none, value ) );
+    ASSERT_FALSE( map.update( none, [] ( std::string &v ) { v += "!"; } ) );
+    map.remove( none );
+    ASSERT_TRUE( map.exists( "zzz" ) );
+}
+
+
+TEST_F( test_sharded_prefix_tree_map, test_sorted_iteration )
+{
+    {
+        prefix_tree::sharded_prefix_tree_map<size_t, 8> map;
+        check_sorted( map, keys );
+    }
+    {
+        prefix_tree::sharded_prefix_tree_map<size_t, 7, prefix_tree::prefix_hash_shard<3> > map;
+        check_sorted( map, keys );
+    }
+    {
+        prefix_tree::sharded_prefix_tree_map<size_t, 1> map;
+        check_sorted( map, keys );
+    }
+}
+
+
+TEST_F( test_sharded_prefix_tree_map, test_parallel_for_each )
+{
+    prefix_tree::sharded_prefix_tree_map<size_t, 16, prefix_tree::prefix_hash_shard<> > map;
+    for ( size_t i = 0; i < keys.size(); ++i )
+        map.insert_or_assign( keys[ i ], i );
+
+    std::atomic<size_t> count( 0 ), sum( 0 );
+    map.parallel_for_each(
+        [&] ( const std::string &key, const size_t &value )
+        {
+            EXPECT_EQ( keys[ value ], key );
+            ++count;
+            sum += value;
+        }
+    );
+
+    ASSERT_EQ( count, keys.size() );
+    ASSERT_EQ( sum, keys.size() * ( keys.size() - 1 ) / 2 );
+
+    // Own executor.
+    prefix_tree::executor ex( 2 );
+    count = 0;
+    map.parallel_for_each( [&] ( const std::string &, const size_t & ) { ++count; }, ex );
+    ASSERT_EQ( count, keys.size() );
+}
+
+
+TEST_F( test_sharded_prefix_tree_map, test_threads )
+{
+    prefix_tree::sharded_prefix_tree_map<size_t, 8> map;
+
+    const size_t threads_count = 4;
+    std::vector<std::thread> threads;
+
+    for ( size_t t = 0; t < threads_count; ++t )
+    {
+        threads.emplace_back(
+            [&, t] ()
+            {
+                size_t found;
+                for ( size_t i = t; i < keys.size(); i += threads_count )
+                {
+                    map.insert_or_assign( keys[ i ], i );
+                    map.find( keys[ ( i * 7 ) % keys.size() ], found );
+                    map.update( keys[ i ], [] ( size_t &v ) { v += 0; } );
+                }
+            }
+        );
+    }
+
+    for ( auto &t : threads )
+        t.join();
+
+    size_t count = 0;
+    map.for_each(
+        [&] ( const std::string &key, const size_t &value )
+        {
+            ASSERT_EQ( keys[ value ], key );
+            ++count;
+        }
+    );
+    ASSERT_EQ( count, keys.size() );
+}
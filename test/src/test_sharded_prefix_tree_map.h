@@ -0,0 +1,20 @@
+#ifndef TEST_SHARDED_PREFIX_TREE_MAP_H
+#define TEST_SHARDED_PREFIX_TREE_MAP_H
+
+#include <gtest/gtest.h>
+#include "prefix_tree/sharded_prefix_tree_map.h"
+
+class test_sharded_prefix_tree_map : public testing::Test
+{
+public:
+    /// @brief keys     Random keys, unique and unordered.
+    std::vector<std::string>    keys;
+
+public:
+    test_sharded_prefix_tree_map() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // TEST_SHARDED_PREFIX_TREE_MAP_H
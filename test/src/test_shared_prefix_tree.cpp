@@ -0,0 +1,330 @@
+#include <atomic>
+#include <csignal>
+#include <map>
+#include <new>
+#include <system_error>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "test_shared_prefix_tree.h"
+
+
+namespace
+{
+
+
+const size_t WRITERS = 3;
+const size_t READERS = 3;
+const size_t KEYS    = 3000;
+
+
+inline std::string make_key( size_t writer, size_t i )
+{
+    return "w" + std::to_string( writer ) + "/" + std::to_string( i );
+}
+
+
+/**
+ * @brief consistent    Every key visited has value of its number, keys are
+ *                      ordered and their count is equal to size().
+ */
+bool consistent( const prefix_tree::shared_prefix_tree &tree )
+{
+    std::string last;
+    size_t      count = 0;
+    bool        ok    = true;
+
+    tree.for_each( "", [&] ( const std::string &key, uint64_t value )
+    {
+        ok = ok && ( !count || last < key ) && key.substr( key.find( '/' ) + 1 ) == std::to_string( value );
+        last = key;
+        ++count;
+    } );
+
+    return ok && count == tree.size();
+}
+
+
+} // namespace
+
+
+
+void test_shared_prefix_tree::SetUp()
+{
+    name = "/prefix_tree_test_" + std::to_string( getpid() ) + "_" + testing::UnitTest::GetInstance()->current_test_info()->name();
+    prefix_tree::shared_prefix_tree::unlink( name );
+}
+
+
+void test_shared_prefix_tree::TearDown()
+{
+    prefix_tree::shared_prefix_tree::unlink( name );
+}
+
+
+pid_t test_shared_prefix_tree::fork( const std::function<bool()> &function )
+{
+    pid_t child = ::fork();
+    if ( child )
+        return child;
+
+    bool ok = false;
+    try
+    {
+        ok = function();
+    }
+    catch ( ... )
+    {
+    }
+    _exit( ok ? 0 : 1 );
+}
+
+
+size_t test_shared_prefix_tree::wait( const std::vector<pid_t> &children )
+{
+    size_t failed = 0;
+    for ( pid_t child : children )
+    {
+        int status = 0;
+        if ( waitpid( child, &status, 0 ) != child || !WIFEXITED( status ) || WEXITSTATUS( status ) )
+            ++failed;
+    }
+    return failed;
+}
+
+
+
+TEST_F( test_shared_prefix_tree, test_append_remove )
+{
+    prefix_tree::shared_prefix_tree tree( name, 1 << 20 );
+    uint64_t                        value = 0;
+
+    EXPECT_TRUE( tree.append( "abc", 1 ) );
+    EXPECT_TRUE( tree.append( "ab", 2 ) );
+    EXPECT_TRUE( tree.append( "abd", 3 ) );
+    EXPECT_TRUE( tree.append( "", 4 ) );
+    EXPECT_TRUE( tree.append( "b", 5 ) );
+    EXPECT_FALSE( tree.append( "abc", 6 ) );
+    EXPECT_EQ( tree.size(), 5 );
+
+    EXPECT_TRUE( tree.find( "abc", value ) );
+    EXPECT_EQ( value, 6 );
+    EXPECT_TRUE( tree.exists( "" ) );
+    EXPECT_FALSE( tree.exists( "a" ) );
+    EXPECT_FALSE( tree.exists( "abcd" ) );
+
+    // Second mapping of the same segment sees changes.
+    prefix_tree::shared_prefix_tree other( name );
+    EXPECT_TRUE( other.find( "abd", value ) );
+    EXPECT_EQ( value, 3 );
+
+    std::map<std::string, uint64_t> visited;
+    other.for_each( "ab", [&] ( const std::string &key, uint64_t v ) { visited[ key ] = v; } );
+    EXPECT_EQ( visited, ( std::map<std::string, uint64_t>{ { "ab", 2 }, { "abc", 6 }, { "abd", 3 } } ) );
+
+    std::vector<std::string> keys;
+    other.for_each( "", [&] ( const std::string &key, uint64_t ) { keys.push_back( key ); } );
+    EXPECT_EQ( keys, ( std::vector<std::string>{ "", "ab", "abc", "abd", "b" } ) );
+
+    EXPECT_TRUE( tree.remove( "ab" ) );
+    EXPECT_FALSE( tree.remove( "ab" ) );
+    EXPECT_FALSE( tree.remove( "a" ) );
+    EXPECT_TRUE( other.exists( "abc" ) );
+    EXPECT_TRUE( tree.remove( "abc" ) );
+    EXPECT_TRUE( tree.remove( "abd" ) );
+    EXPECT_TRUE( tree.remove( "" ) );
+    EXPECT_TRUE( tree.remove( "b" ) );
+    EXPECT_EQ( other.size(), 0 );
+
+    // Retired memory is reused without readers.
+    tree.reclaim();
+    EXPECT_EQ( tree.used_bytes(), 0 );
+}
+
+
+TEST_F( test_shared_prefix_tree, test_processes )
+{
+    prefix_tree::shared_prefix_tree tree( name, 16 << 20 );
+    std::vector<pid_t>              children;
+
+    // Writers append keys and remove even ones, readers check values meanwhile.
+    for ( size_t w = 0; w < WRITERS; ++w )
+    {
+        children.push_back( fork( [&, w] ()
+        {
+            prefix_tree::shared_prefix_tree t( name );
+            for ( size_t i = 0; i < KEYS; ++i )
+            {
+                if ( !t.append( make_key( w, i ), i ) )
+                    return false;
+            }
+            for ( size_t i = 0; i < KEYS; i += 2 )
+            {
+                if ( !t.remove( make_key( w, i ) ) )
+                    return false;
+            }
+            return t.append( "done/" + std::to_string( w ), w );
+        } ) );
+    }
+
+    for ( size_t r = 0; r < READERS; ++r )
+    {
+        children.push_back( fork( [&, r] ()
+        {
+            prefix_tree::shared_prefix_tree t( name );
+            size_t                          round = 0;
+
+            for ( bool done = false; !done; ++round )
+            {
+                done = true;
+                for ( size_t w = 0; w < WRITERS; ++w )
+                    done = done && t.exists( "done/" + std::to_string( w ) );
+
+                for ( size_t w = 0; w < WRITERS; ++w )
+                {
+                    for ( size_t i = r; i < KEYS; i += 97 )
+                    {
+                        uint64_t value;
+                        if ( t.find( make_key( w, i ), value ) && value != i )
+                            return false;
+                    }
+                }
+
+                std::string last;
+                bool        ok = true;
+                t.for_each( "w" + std::to_string( round % WRITERS ) + "/", [&] ( const std::string &key, uint64_t value )
+                {
+                    ok = ok && last < key && key.substr( 3 ) == std::to_string( value );
+                    last = key;
+                } );
+                if ( !ok )
+                    return false;
+            }
+            return true;
+        } ) );
+    }
+
+    EXPECT_EQ( wait( children ), 0 );
+
+    for ( size_t w = 0; w < WRITERS; ++w )
+    {
+        for ( size_t i = 0; i < KEYS; ++i )
+            EXPECT_EQ( tree.exists( make_key( w, i ) ), i % 2 == 1 ) << make_key( w, i );
+    }
+    EXPECT_EQ( tree.size(), WRITERS * ( KEYS / 2 + 1 ) );
+    EXPECT_TRUE( consistent( tree ) );
+}
+
+
+TEST_F( test_shared_prefix_tree, test_writer_crash )
+{
+    prefix_tree::shared_prefix_tree tree( name, 16 << 20 );
+
+    // Writer is killed at any point, possibly holding the lock.
+    for ( size_t round = 0; round < 10; ++round )
+    {
+        pid_t child = fork( [&, round] ()
+        {
+            prefix_tree::shared_prefix_tree t( name );
+            for ( size_t i = 0; ; ++i )
+            {
+                t.append( make_key( round, i % KEYS ), i % KEYS );
+                if ( i % 3 == 2 )
+                    t.remove( make_key( round, ( i / 3 ) % KEYS ) );
+            }
+            return true;
+        } );
+
+        std::this_thread::sleep_for( std::chrono::milliseconds( 5 + round * 3 ) );
+        kill( child, SIGKILL );
+        int status = 0;
+        ASSERT_EQ( waitpid( child, &status, 0 ), child );
+
+        EXPECT_TRUE( tree.append( "alive/" + std::to_string( round ), round ) );
+        EXPECT_TRUE( consistent( tree ) );
+    }
+}
+
+
+TEST_F( test_shared_prefix_tree, test_dead_reader )
+{
+    prefix_tree::shared_prefix_tree tree( name, 1 << 20 );
+
+    for ( size_t i = 0; i < 100; ++i )
+        tree.append( make_key( 0, i ), i );
+
+    // Reader dies inside for_each and leaves its slot announced.
+    pid_t child = fork( [&] ()
+    {
+        prefix_tree::shared_prefix_tree t( name );
+        t.for_each( "", [] ( const std::string &, uint64_t ) { _exit( 0 ); } );
+        return false;
+    } );
+    EXPECT_EQ( wait( { child } ), 0 );
+
+    for ( size_t i = 0; i < 100; ++i )
+        EXPECT_TRUE( tree.remove( make_key( 0, i ) ) );
+
+    tree.reclaim();
+    EXPECT_EQ( tree.used_bytes(), 0 );
+}
+
+
+TEST_F( test_shared_prefix_tree, test_reader_slots )
+{
+    prefix_tree::shared_prefix_tree tree( name, 1 << 20 );
+    tree.append( make_key( 0, 0 ), 0 );
+
+    // Readers stopped inside for_each take all 256 slots.
+    std::atomic<size_t>         inside( 0 );
+    std::atomic<bool>           release( false );
+    std::vector<std::thread>    readers;
+
+    for ( size_t i = 0; i < 256; ++i )
+    {
+        readers.emplace_back( [&] ()
+        {
+            tree.for_each( "", [&] ( const std::string &, uint64_t )
+            {
+                ++inside;
+                while ( !release )
+                    std::this_thread::yield();
+            } );
+        } );
+    }
+    while ( inside < readers.size() )
+        std::this_thread::yield();
+
+    uint64_t value;
+    EXPECT_THROW( tree.find( make_key( 0, 0 ), value ), std::system_error );
+
+    release = true;
+    for ( auto &reader : readers )
+        reader.join();
+
+    EXPECT_TRUE( tree.find( make_key( 0, 0 ), value ) );
+}
+
+
+TEST_F( test_shared_prefix_tree, test_out_of_memory )
+{
+    prefix_tree::shared_prefix_tree tree( name, 64 << 10 );
+    size_t                          appended = 0;
+
+    EXPECT_THROW(
+        for ( ; appended < 100000; ++appended )
+            tree.append( make_key( 0, appended ), appended ),
+        std::bad_alloc
+    );
+
+    EXPECT_EQ( tree.size(), appended );
+    EXPECT_TRUE( consistent( tree ) );
+
+    // Removed keys free memory for new ones.
+    for ( size_t i = appended - 100; i < appended; ++i )
+        EXPECT_TRUE( tree.remove( make_key( 0, i ) ) );
+    EXPECT_TRUE( tree.append( make_key( 0, appended - 1 ), appended - 1 ) );
+    EXPECT_TRUE( consistent( tree ) );
+}
@@ -0,0 +1,36 @@
+#ifndef TEST_SHARED_PREFIX_TREE_H
+#define TEST_SHARED_PREFIX_TREE_H
+
+#include <functional>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "prefix_tree/shared_prefix_tree.h"
+
+class test_shared_prefix_tree : public testing::Test
+{
+public:
+    /// @brief name     Name of segment unique for process and test.
+    std::string     name;
+
+public:
+    test_shared_prefix_tree() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+
+    /**
+     * @brief fork      Run function in child process.
+     * @param function  Function, child exits with 0 if it returns true.
+     * @return          Pid of child.
+     */
+    static pid_t fork( const std::function<bool()> &function );
+
+    /**
+     * @brief wait      Wait for children.
+     * @return          Count of children failed.
+     */
+    static size_t wait( const std::vector<pid_t> &children );
+};
+
+#endif // TEST_SHARED_PREFIX_TREE_H
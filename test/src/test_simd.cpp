@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <random>
+
+#include "test_simd.h"
+
+
+using prefix_tree::simd::level;
+
+
+
+void test_simd::SetUp()
+{
+    for ( level l : { level::SCALAR, level::SSE2, level::AVX2 } )
+        if ( prefix_tree::simd::supported( l ) )
+            levels.push_back( l );
+}
+
+
+void test_simd::TearDown()
+{
+    levels.clear();
+}
+
+
+
+TEST_F( test_simd, test_lower_bound )
+{
+    std::mt19937 rnd( 3 );
+
+    for ( size_t n : { 0, 1, 15, 16, 17, 31, 32, 33, 100, 256 } )
+    {
+        std::vector<unsigned char> labels( 256 );
+        for ( size_t i = 0; i < 256; ++i )
+            labels[ i ] = static_cast<unsigned char>( i );
+        std::shuffle( labels.begin(), labels.end(), rnd );
+        labels.resize( n );
+        std::sort( labels.begin(), labels.end() );
+
+        for ( unsigned int c = 0; c < 256; ++c )
+        {
+            size_t expected = static_cast<size_t>(
+                        std::lower_bound( labels.begin(), labels.end(), static_cast<unsigned char>( c ) ) - labels.begin()
+            );
+
+            for ( level l : levels )
+                ASSERT_EQ( prefix_tree::simd::get_kernels( l ).lower_bound( labels.data(), n, static_cast<unsigned char>( c ) ), expected );
+            ASSERT_EQ( prefix_tree::simd::lower_bound( labels.data(), n, static_cast<unsigned char>( c ) ), expected );
+        }
+    }
+}
+
+
+TEST_F( test_simd, test_mismatch )
+{
+    std::string a( 200, 'x' );
+    for ( size_t i = 0; i < a.size(); ++i )
+        a[ i ] = static_cast<char>( i * 7 );
+
+    for ( size_t n : { 0, 1, 15, 16, 17, 32, 100, 200 } )
+    {
+        for ( size_t pos = 0; pos <= n; ++pos )
+        {
+            std::string b = a;
+            if ( pos < n )
+                b[ pos ] = static_cast<char>( b[ pos ] ^ 0x80 );
+
+            const unsigned char *pa = reinterpret_cast<const unsigned char*>( a.data() );
+            const unsigned char *pb = reinterpret_cast<const unsigned char*>( b.data() );
+
+            for ( level l : levels )
+                ASSERT_EQ( prefix_tree::simd::get_kernels( l ).mismatch( pa, pb, n ), pos );
+            ASSERT_EQ( prefix_tree::simd::mismatch( pa, pb, n ), pos );
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#ifndef TEST_SIMD_H
+#define TEST_SIMD_H
+
+#include <gtest/gtest.h>
+#include "prefix_tree/simd.h"
+
+class test_simd : public testing::Test
+{
+public:
+    /// @brief levels   Levels supported by CPU.
+    std::vector<prefix_tree::simd::level>  levels;
+
+public:
+    test_simd() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // TEST_SIMD_H
@@ -0,0 +1,86 @@
+#include <random>
+#include <set>
+#include <string>
+
+#include "test_static_prefix_tree.h"
+
+
+namespace
+{
+
+
+constexpr const char   *PREFIXES[]  = { "", "a", "ab", "abc", "b", "ab" };
+
+constexpr auto          METHODS     = prefix_tree::make_static_prefix_tree<test_static_prefix_tree::METHODS>();
+constexpr auto          PREFIX_TREE = prefix_tree::make_static_prefix_tree<PREFIXES>();
+
+// Lookups are done at compile time too.
+static_assert( METHODS.find( "GET" ) == 0 );
+static_assert( METHODS.find( "PATCH" ) == 8 );
+static_assert( METHODS.find( "GE" ) == decltype( METHODS )::NOT_FOUND );
+static_assert( METHODS.find( "" ) == decltype( METHODS )::NOT_FOUND );
+static_assert( std::is_same<decltype( METHODS )::state_type, uint8_t>::value );
+
+
+} // namespace
+
+
+
+void test_static_prefix_tree::SetUp()
+{
+}
+
+
+void test_static_prefix_tree::TearDown()
+{
+}
+
+
+
+TEST_F( test_static_prefix_tree, test_find )
+{
+    std::set<std::string> keys;
+    for ( size_t i = 0; i < std::size( METHODS ); ++i )
+    {
+        EXPECT_EQ( ::METHODS.find( METHODS[ i ] ), static_cast<int>( i ) );
+        keys.emplace( METHODS[ i ] );
+    }
+    EXPECT_EQ( ::METHODS.size(), std::size( METHODS ) );
+
+    // Random strings of key bytes and others agree with model.
+    std::mt19937_64 rnd( 42 );
+    const char      alphabet[] = "GETHADOSPUCNRx\xff";
+
+    for ( size_t i = 0; i < 100000; ++i )
+    {
+        std::string key( rnd() % 9, ' ' );
+        for ( auto &c : key )
+            c = alphabet[ rnd() % ( sizeof( alphabet ) - 1 ) ];
+
+        EXPECT_EQ( ::METHODS.exists( key ), keys.count( key ) == 1 ) << key;
+    }
+}
+
+
+TEST_F( test_static_prefix_tree, test_prefixes )
+{
+    // Empty key, keys which are prefixes of others and duplicate.
+    EXPECT_EQ( PREFIX_TREE.find( "" ), 0 );
+    EXPECT_EQ( PREFIX_TREE.find( "ab" ), 2 );
+    EXPECT_EQ( PREFIX_TREE.find( "abc" ), 3 );
+    EXPECT_FALSE( PREFIX_TREE.exists( "abcd" ) );
+    EXPECT_FALSE( PREFIX_TREE.exists( "ba" ) );
+
+    size_t length = 99;
+    EXPECT_EQ( PREFIX_TREE.longest_prefix( "abx", length ), 2 );
+    EXPECT_EQ( length, 2 );
+    EXPECT_EQ( PREFIX_TREE.longest_prefix( "abcabc", length ), 3 );
+    EXPECT_EQ( length, 3 );
+    EXPECT_EQ( PREFIX_TREE.longest_prefix( "xyz", length ), 0 );
+    EXPECT_EQ( length, 0 );
+
+    size_t body = 0;
+    EXPECT_EQ( ::METHODS.longest_prefix( "OPTIONS * HTTP/1.1", body ), 6 );
+    EXPECT_EQ( body, 7 );
+    EXPECT_EQ( ::METHODS.longest_prefix( "GOT", body ), decltype( ::METHODS )::NOT_FOUND );
+}
@@ -0,0 +1,20 @@
+#ifndef TEST_STATIC_PREFIX_TREE_H
+#define TEST_STATIC_PREFIX_TREE_H
+
+#include <gtest/gtest.h>
+#include "prefix_tree/static_prefix_tree.h"
+
+class test_static_prefix_tree : public testing::Test
+{
+public:
+    /// @brief METHODS      Keys of tree under test.
+    static constexpr std::string_view   METHODS[] = { "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT", "OPTIONS", "TRACE", "PATCH" };
+
+public:
+    test_static_prefix_tree() = default;
+
+    virtual void SetUp() override;
+    virtual void TearDown() override;
+};
+
+#endif // TEST_STATIC_PREFIX_TREE_H
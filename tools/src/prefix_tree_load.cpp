@@ -0,0 +1,92 @@
+/**
+ * Load newline delimited keys to snapshot of durable storage.
+ *
+ * Keys of the directory (if any) are recovered first with their encoded
+ * values, keys of input are added by ingest pipeline and the result is
+ * written as new snapshot. Recovered keys keep their values, new keys of
+ * input get empty values, so the directory of
+ * durable_prefix_tree_map<std::string> stays readable by it.
+ *
+ * Usage: prefix_tree_load <input|-> <directory> [parse_threads=auto] [chunk_mb=4]
+ */
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+#include "prefix_tree/ingest.h"
+#include "prefix_tree/prefix_tree_map.h"
+#include "prefix_tree/write_ahead_log.h"
+
+
+int main( int argc, char *argv[] )
+{
+    if ( argc < 3 )
+    {
+        std::cerr << "Usage: " << argv[ 0 ] << " <input|-> <directory> [parse_threads=auto] [chunk_mb=4]" << std::endl;
+        return 2;
+    }
+
+    prefix_tree::ingest_options opts;
+    if ( argc > 3 )
+        opts.parse_threads = static_cast<size_t>( std::strtoull( argv[ 3 ], nullptr, 10 ) );
+    if ( argc > 4 )
+        opts.chunk_bytes = static_cast<size_t>( std::strtoull( argv[ 4 ], nullptr, 10 ) ) << 20;
+
+    try
+    {
+        prefix_tree::prefix_tree                        tree;
+        // Encoded values of recovered keys.
+        prefix_tree::prefix_tree_map<std::string>       values;
+        prefix_tree::durable_storage::options           storage_opts;
+        prefix_tree::durable_storage                    storage( argv[ 2 ], storage_opts );
+
+        auto recovered = storage.recover(
+                    [&] ( const prefix_tree::log_record &record )
+                    {
+                        if ( record.op == prefix_tree::log_op::REMOVE )
+                        {
+                            tree.remove( record.key );
+                            values.remove( record.key );
+                        }
+                        else
+                        {
+                            tree.append( record.key );
+                            values.insert_or_assign( record.key, record.value );
+                        }
+                    }
+        );
+        std::cerr << "recovered keys=" << recovered.snapshot_records + recovered.log_records << std::endl;
+
+        prefix_tree::ingest_stats stats = prefix_tree::ingest( tree, argv[ 1 ], opts );
+        stats.write( std::cerr );
+
+        auto it  = tree.begin( true );
+        auto end = tree.end();
+        storage.snapshot(
+                    [&] ( prefix_tree::log_record &record )
+                    {
+                        if ( it == end )
+                            return false;
+
+                        record.key = it.get_key();
+
+                        auto found = values.find( record.key );
+                        if ( found != values.end() )
+                            record.value = found.get_value();
+                        else
+                            record.value.clear();
+
+                        ++it;
+                        return true;
+                    }
+        );
+    }
+    catch ( const std::exception &e )
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}